@@ -140,6 +140,8 @@ static String getAllSystemInfo()
       << "CPU has 3DNOW:   " << (SystemStats::has3DNow()  ? "yes" : "no") << newLine
       << "CPU has AVX:     " << (SystemStats::hasAVX()    ? "yes" : "no") << newLine
       << "CPU has AVX2:    " << (SystemStats::hasAVX2()   ? "yes" : "no") << newLine
+      << "CPU has FMA3:    " << (SystemStats::hasFMA3()   ? "yes" : "no") << newLine
+      << "CPU has AVX512F: " << (SystemStats::hasAVX512F() ? "yes" : "no") << newLine
       << newLine;
 
     systemInfo
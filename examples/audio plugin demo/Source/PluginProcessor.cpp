@@ -254,6 +254,7 @@ void JuceDemoPluginAudioProcessor::releaseResources()
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
     keyboardState.reset();
+    synth.releaseResources();
 }
 
 void JuceDemoPluginAudioProcessor::reset()
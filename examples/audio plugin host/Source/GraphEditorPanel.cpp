@@ -311,7 +311,8 @@ private:
 };
 
 //==============================================================================
-class FilterComponent    : public Component
+class FilterComponent    : public Component,
+                           public SettableTooltipClient
 {
 public:
     FilterComponent (FilterGraph& graph_,
@@ -452,9 +453,54 @@ public:
 
         g.fillRect (x, y, w, h);
 
+        if (timings.numBlocks > 0)
+        {
+            // shade the filter in proportion to how much of the callback's time it's using..
+            g.setColour (Colours::red.withAlpha ((float) jlimit (0.0, 0.8, timings.maxLoad)));
+            g.fillRect (x, y, w, h);
+        }
+
         g.setColour (findColour (TextEditor::textColourId));
         g.setFont (font);
-        g.drawFittedText (getName(), getLocalBounds().reduced (4, 2), Justification::centred, 2);
+
+        if (timings.numBlocks > 0)
+        {
+            const Rectangle<int> area (getLocalBounds().reduced (4, 2));
+            g.drawFittedText (getName(), area.withTrimmedBottom (area.getHeight() / 3), Justification::centred, 2);
+
+            g.setFont (Font (11.0f));
+            g.drawFittedText (String (timings.averageLoad * 100.0, 1) + "% avg, "
+                                + String (timings.maxLoad * 100.0, 1) + "% max",
+                              area.withTrimmedTop (area.getHeight() / 2).withTrimmedBottom (pinSize / 2),
+                              Justification::centred, 1);
+        }
+        else
+        {
+            g.drawFittedText (getName(), getLocalBounds().reduced (4, 2), Justification::centred, 2);
+        }
+    }
+
+    void setTimings (const AudioProcessorGraph::NodeTimings& newTimings)
+    {
+        timings = newTimings;
+
+        if (timings.numBlocks > 0)
+        {
+            String tip;
+            tip << getName() << ": " << String (timings.minMs, 3) << " / " << String (timings.averageMs, 3)
+                << " / " << String (timings.maxMs, 3) << " ms min/avg/max per block, load histogram [";
+
+            for (int i = 0; i < AudioProcessorGraph::NodeTimings::numHistogramBins; ++i)
+                tip << (i > 0 ? " " : "") << timings.histogram[i];
+
+            setTooltip (tip + "]");
+        }
+        else
+        {
+            setTooltip (String());
+        }
+
+        repaint();
     }
 
     void resized() override
@@ -575,6 +621,7 @@ private:
     Font font;
     int numIns, numOuts;
     DropShadowEffect shadow;
+    AudioProcessorGraph::NodeTimings timings;
 
     GraphEditorPanel* getGraphPanel() const noexcept
     {
@@ -969,6 +1016,45 @@ void GraphEditorPanel::updateComponents()
     }
 }
 
+void GraphEditorPanel::setShowingNodeTimings (const bool shouldShow)
+{
+    if (shouldShow)
+    {
+        graph.getGraph().resetNodeTimings();
+        startTimer (500);
+    }
+    else
+    {
+        stopTimer();
+
+        for (int i = getNumChildComponents(); --i >= 0;)
+            if (FilterComponent* const fc = dynamic_cast<FilterComponent*> (getChildComponent (i)))
+                fc->setTimings (AudioProcessorGraph::NodeTimings());
+    }
+}
+
+void GraphEditorPanel::timerCallback()
+{
+    // Show the timings for the last half-second, and then start again..
+    AudioProcessorGraph& g = graph.getGraph();
+    const Array<AudioProcessorGraph::NodeTimings> timings (g.getNodeTimings());
+    g.resetNodeTimings();
+
+    for (int i = getNumChildComponents(); --i >= 0;)
+    {
+        if (FilterComponent* const fc = dynamic_cast<FilterComponent*> (getChildComponent (i)))
+        {
+            AudioProcessorGraph::NodeTimings filterTimings;
+
+            for (int j = 0; j < timings.size(); ++j)
+                if (timings.getReference (j).nodeId == fc->filterID)
+                    filterTimings = timings.getReference (j);
+
+            fc->setTimings (filterTimings);
+        }
+    }
+}
+
 void GraphEditorPanel::beginConnectorDrag (const uint32 sourceFilterID, const int sourceFilterChannel,
                                            const uint32 destFilterID, const int destFilterChannel,
                                            const MouseEvent& e)
@@ -1135,6 +1221,8 @@ GraphDocumentComponent::GraphDocumentComponent (AudioPluginFormatManager& format
     deviceManager->addMidiInputCallback (String(), &graphPlayer.getMidiMessageCollector());
 
     graphPanel->updateComponents();
+
+    setNodeProfilingEnabled (getAppProperties().getUserSettings()->getBoolValue ("nodeProfiling", false));
 }
 
 GraphDocumentComponent::~GraphDocumentComponent()
@@ -1159,6 +1247,12 @@ void GraphDocumentComponent::createNewPlugin (const PluginDescription* desc, int
     graphPanel->createNewPlugin (desc, x, y);
 }
 
+void GraphDocumentComponent::setNodeProfilingEnabled (const bool shouldProfile)
+{
+    graph->getGraph().setNodeProfilingEnabled (shouldProfile);
+    graphPanel->setShowingNodeTimings (shouldProfile);
+}
+
 void GraphDocumentComponent::unfocusKeyboardComponent()
 {
     keyboardComp->unfocusAllComponents();
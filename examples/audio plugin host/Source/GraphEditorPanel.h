@@ -38,7 +38,8 @@ class PinComponent;
     A panel that displays and edits a FilterGraph.
 */
 class GraphEditorPanel   : public Component,
-                           public ChangeListener
+                           public ChangeListener,
+                           private Timer
 {
 public:
     GraphEditorPanel (FilterGraph& graph);
@@ -64,11 +65,17 @@ public:
     void dragConnector (const MouseEvent& e);
     void endDraggingConnector (const MouseEvent& e);
 
+    //==============================================================================
+    /** Shows or hides the CPU load of each filter, while the graph is profiling its nodes. */
+    void setShowingNodeTimings (bool shouldShow);
+
     //==============================================================================
 private:
     FilterGraph& graph;
     ScopedPointer<ConnectorComponent> draggingConnector;
 
+    void timerCallback() override;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphEditorPanel)
 };
 
@@ -90,6 +97,7 @@ public:
     //==============================================================================
     void createNewPlugin (const PluginDescription* desc, int x, int y);
     inline void setDoublePrecision (bool doublePrecision) { graphPlayer.setDoublePrecisionProcessing (doublePrecision); }
+    void setNodeProfilingEnabled (bool shouldProfile);
 
     //==============================================================================
     ScopedPointer<FilterGraph> graph;
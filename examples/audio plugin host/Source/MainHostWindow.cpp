@@ -252,6 +252,7 @@ PopupMenu MainHostWindow::getMenuForIndex (int topLevelMenuIndex, const String&
         menu.addSeparator();
         menu.addCommandItem (&getCommandManager(), CommandIDs::showAudioSettings);
         menu.addCommandItem (&getCommandManager(), CommandIDs::toggleDoublePrecision);
+        menu.addCommandItem (&getCommandManager(), CommandIDs::toggleNodeProfiling);
 
         menu.addSeparator();
         menu.addCommandItem (&getCommandManager(), CommandIDs::aboutBox);
@@ -355,6 +356,7 @@ void MainHostWindow::getAllCommands (Array <CommandID>& commands)
                               CommandIDs::showPluginListEditor,
                               CommandIDs::showAudioSettings,
                               CommandIDs::toggleDoublePrecision,
+                              CommandIDs::toggleNodeProfiling,
                               CommandIDs::aboutBox,
                               CommandIDs::allWindowsForward
                             };
@@ -404,6 +406,10 @@ void MainHostWindow::getCommandInfo (const CommandID commandID, ApplicationComma
         updatePrecisionMenuItem (result);
         break;
 
+    case CommandIDs::toggleNodeProfiling:
+        updateNodeProfilingMenuItem (result);
+        break;
+
     case CommandIDs::aboutBox:
         result.setInfo ("About...", String(), category, 0);
         break;
@@ -472,6 +478,23 @@ bool MainHostWindow::perform (const InvocationInfo& info)
         }
         break;
 
+    case CommandIDs::toggleNodeProfiling:
+        if (PropertiesFile* props = getAppProperties().getUserSettings())
+        {
+            const bool shouldProfile = ! isNodeProfilingEnabled();
+            props->setValue ("nodeProfiling", var (shouldProfile));
+
+            {
+                ApplicationCommandInfo cmdInfo (info.commandID);
+                updateNodeProfilingMenuItem (cmdInfo);
+                menuItemsChanged();
+            }
+
+            if (graphEditor != nullptr)
+                graphEditor->setNodeProfilingEnabled (shouldProfile);
+        }
+        break;
+
     case CommandIDs::aboutBox:
         // TODO
         break;
@@ -584,3 +607,17 @@ void MainHostWindow::updatePrecisionMenuItem (ApplicationCommandInfo& info)
     info.setInfo ("Double floating point precision rendering", String(), "General", 0);
     info.setTicked (isDoublePrecisionProcessing());
 }
+
+bool MainHostWindow::isNodeProfilingEnabled()
+{
+    if (PropertiesFile* props = getAppProperties().getUserSettings())
+        return props->getBoolValue ("nodeProfiling", false);
+
+    return false;
+}
+
+void MainHostWindow::updateNodeProfilingMenuItem (ApplicationCommandInfo& info)
+{
+    info.setInfo ("Show the CPU load of each plug-in", String(), "General", 0);
+    info.setTicked (isNodeProfilingEnabled());
+}
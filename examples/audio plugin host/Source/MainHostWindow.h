@@ -42,6 +42,7 @@ namespace CommandIDs
     static const int aboutBox               = 0x30300;
     static const int allWindowsForward      = 0x30400;
     static const int toggleDoublePrecision  = 0x30500;
+    static const int toggleNodeProfiling    = 0x30600;
 }
 
 ApplicationCommandManager& getCommandManager();
@@ -93,6 +94,9 @@ public:
     bool isDoublePrecisionProcessing();
     void updatePrecisionMenuItem (ApplicationCommandInfo& info);
 
+    bool isNodeProfilingEnabled();
+    void updateNodeProfilingMenuItem (ApplicationCommandInfo& info);
+
 private:
     //==============================================================================
     AudioDeviceManager deviceManager;
@@ -0,0 +1,282 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+/**
+    Times the FFT class over orders 6 to 16, and compares it with the recursive
+    implementation that it replaced, which is kept here as LegacyFFT.
+
+    Run the app with "--fft-benchmark" on the command line to use this.
+*/
+class FFTBenchmark
+{
+public:
+    FFTBenchmark() {}
+
+    void run()
+    {
+        Logger::writeToLog ("FFT: microseconds per transform (and speedup over the old implementation)");
+        Logger::writeToLog ("order | old complex | complex            | complex (double) | old real-only | real-only          | packed real");
+        Logger::writeToLog ("----- | ----------- | ------------------ | ---------------- | ------------- | ------------------ | ------------------");
+
+        for (int order = 6; order <= 16; ++order)
+        {
+            const int size = 1 << order;
+            const LegacyFFT legacy (order);
+            const FFT fft (order, false);
+
+            HeapBlock<FFT::Complex> input ((size_t) size), output ((size_t) size);
+            HeapBlock<FFT::ComplexDouble> inputDouble ((size_t) size), outputDouble ((size_t) size);
+            HeapBlock<float> realData ((size_t) size * 2);
+            Random random (42);
+
+            for (int i = 0; i < size; ++i)
+            {
+                input[i].r = random.nextFloat() * 2.0f - 1.0f;
+                input[i].i = random.nextFloat() * 2.0f - 1.0f;
+                inputDouble[i].r = input[i].r;
+                inputDouble[i].i = input[i].i;
+            }
+
+            const double oldComplex = timeTransform (size, [&] { legacy.perform (input, output); });
+            const double newComplex = timeTransform (size, [&] { fft.perform (input, output); });
+            const double newDouble  = timeTransform (size, [&] { fft.perform (inputDouble, outputDouble); });
+
+            const double oldReal = timeTransform (size, [&] { fillReals (realData, input, size); legacy.performRealOnlyForwardTransform (realData); });
+            const double newReal = timeTransform (size, [&] { fillReals (realData, input, size); fft.performRealOnlyForwardTransform (realData); });
+            const double packed  = timeTransform (size, [&] { fft.performRealForward (&input->r, output); });
+
+            Logger::writeToLog (String (order).paddedRight (' ', 6)
+                                 + "| " + String (oldComplex, 2).paddedRight (' ', 12)
+                                 + "| " + withSpeedup (newComplex, oldComplex).paddedRight (' ', 19)
+                                 + "| " + String (newDouble, 2).paddedRight (' ', 17)
+                                 + "| " + String (oldReal, 2).paddedRight (' ', 14)
+                                 + "| " + withSpeedup (newReal, oldReal).paddedRight (' ', 19)
+                                 + "| " + withSpeedup (packed, oldReal));
+        }
+    }
+
+private:
+    //==============================================================================
+    // This is the mixed-radix recursive FFT that the FFT class used to contain.
+    struct LegacyFFT
+    {
+        typedef FFT::Complex Complex;
+
+        LegacyFFT (int order)  : fftSize (1 << order), twiddleTable ((size_t) fftSize), scratch ((size_t) fftSize)
+        {
+            for (int i = 0; i < fftSize; ++i)
+            {
+                const double phase = -2.0 * double_Pi * i / fftSize;
+                twiddleTable[i].r = (float) cos (phase);
+                twiddleTable[i].i = (float) sin (phase);
+            }
+
+            const int root = (int) std::sqrt ((double) fftSize);
+            int divisor = 4, n = fftSize;
+
+            for (int i = 0; i < numElementsInArray (factors); ++i)
+            {
+                while ((n % divisor) != 0)
+                {
+                    if (divisor == 2)       divisor = 3;
+                    else if (divisor == 4)  divisor = 2;
+                    else                    divisor += 2;
+
+                    if (divisor > root)
+                        divisor = n;
+                }
+
+                n /= divisor;
+
+                factors[i].radix = divisor;
+                factors[i].length = n;
+            }
+        }
+
+        void perform (const Complex* input, Complex* output) const noexcept
+        {
+            perform (input, output, 1, 1, factors);
+        }
+
+        void performRealOnlyForwardTransform (float* d) const noexcept
+        {
+            for (int i = 0; i < fftSize; ++i)
+            {
+                scratch[i].r = d[i];
+                scratch[i].i = 0;
+            }
+
+            perform (scratch, reinterpret_cast<Complex*> (d));
+        }
+
+    private:
+        struct Factor { int radix, length; };
+
+        const int fftSize;
+        Factor factors[32];
+        HeapBlock<Complex> twiddleTable, scratch;
+
+        static Complex add (Complex a, Complex b) noexcept  { Complex c = { a.r + b.r, a.i + b.i }; return c; }
+        static Complex sub (Complex a, Complex b) noexcept  { Complex c = { a.r - b.r, a.i - b.i }; return c; }
+        static Complex mul (Complex a, Complex b) noexcept  { Complex c = { a.r * b.r - a.i * b.i, a.r * b.i + a.i * b.r }; return c; }
+
+        void perform (const Complex* input, Complex* output, const int stride, const int strideIn, const Factor* facs) const noexcept
+        {
+            const Factor factor (*facs++);
+            Complex* const originalOutput = output;
+            const Complex* const outputEnd = output + factor.radix * factor.length;
+
+            if (stride == 1 && factor.radix <= 5)
+            {
+                for (int i = 0; i < factor.radix; ++i)
+                    perform (input + stride * strideIn * i, output + i * factor.length, stride * factor.radix, strideIn, facs);
+
+                butterfly (factor, output, stride);
+                return;
+            }
+
+            if (factor.length == 1)
+            {
+                do
+                {
+                    *output++ = *input;
+                    input += stride * strideIn;
+                }
+                while (output < outputEnd);
+            }
+            else
+            {
+                do
+                {
+                    perform (input, output, stride * factor.radix, strideIn, facs);
+                    input += stride * strideIn;
+                    output += factor.length;
+                }
+                while (output < outputEnd);
+            }
+
+            butterfly (factor, originalOutput, stride);
+        }
+
+        void butterfly (const Factor factor, Complex* data, const int stride) const noexcept
+        {
+            if (factor.radix == 2)  butterfly2 (data, stride, factor.length);
+            if (factor.radix == 4)  butterfly4 (data, stride, factor.length);
+        }
+
+        void butterfly2 (Complex* data, const int stride, const int length) const noexcept
+        {
+            Complex* dataEnd = data + length;
+            const Complex* tw = twiddleTable;
+
+            for (int i = length; --i >= 0;)
+            {
+                const Complex s (mul (*dataEnd, *tw));
+                tw += stride;
+                *dataEnd++ = sub (*data, s);
+                *data = add (*data, s);
+                ++data;
+            }
+        }
+
+        void butterfly4 (Complex* data, const int stride, const int length) const noexcept
+        {
+            const int lengthX2 = length * 2;
+            const int lengthX3 = length * 3;
+
+            const Complex* twiddle1 = twiddleTable;
+            const Complex* twiddle2 = twiddle1;
+            const Complex* twiddle3 = twiddle1;
+
+            for (int i = length; --i >= 0;)
+            {
+                const Complex s0 = mul (data[length],   *twiddle1);
+                const Complex s1 = mul (data[lengthX2], *twiddle2);
+                const Complex s2 = mul (data[lengthX3], *twiddle3);
+                const Complex s3 = add (s0, s2);
+                const Complex s4 = sub (s0, s2);
+                const Complex s5 = sub (*data, s1);
+                *data = add (*data, s1);
+                data[lengthX2] = sub (*data, s3);
+                twiddle1 += stride;
+                twiddle2 += stride * 2;
+                twiddle3 += stride * 3;
+                *data = add (*data, s3);
+
+                data[length].r   = s5.r + s4.i;
+                data[length].i   = s5.i - s4.r;
+                data[lengthX3].r = s5.r - s4.i;
+                data[lengthX3].i = s5.i + s4.r;
+
+                ++data;
+            }
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (LegacyFFT)
+    };
+
+    //==============================================================================
+    static void fillReals (float* dest, const FFT::Complex* source, int size) noexcept
+    {
+        for (int i = 0; i < size; ++i)
+            dest[i] = source[i].r;
+    }
+
+    static String withSpeedup (double time, double oldTime)
+    {
+        return String (time, 2) + " (" + String (oldTime / time, 2) + "x)";
+    }
+
+    template <typename TransformFunction>
+    static double timeTransform (int size, TransformFunction transform)
+    {
+        // Keep the total amount of work roughly constant, so that every size takes a similar time
+        const int numRepeats = jmax (8, (1 << 22) / size);
+        double bestTimeMs = 0;
+
+        for (int attempt = 0; attempt < 3; ++attempt)
+        {
+            const double startMs = Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < numRepeats; ++i)
+                transform();
+
+            const double timeMs = Time::getMillisecondCounterHiRes() - startMs;
+
+            if (attempt == 0 || timeMs < bestTimeMs)
+                bestTimeMs = timeMs;
+        }
+
+        return bestTimeMs * 1000.0 / numRepeats;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (FFTBenchmark)
+};
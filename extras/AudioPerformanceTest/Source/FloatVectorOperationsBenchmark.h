@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+/**
+    Times the FloatVectorOperations functions which have AVX2 and AVX-512 versions,
+    over buffer sizes from 16 to 65536 samples, using each instruction set that the
+    CPU supports, and compares them with the baseline SSE versions.
+
+    Run the app with "--fvo-benchmark" on the command line to use this.
+*/
+class FloatVectorOperationsBenchmark
+{
+public:
+    FloatVectorOperationsBenchmark() {}
+
+    void run()
+    {
+        const FloatVectorOperations::InstructionSet originalSet = FloatVectorOperations::getActiveInstructionSet();
+
+        Array<FloatVectorOperations::InstructionSet> sets;
+
+        for (int set = FloatVectorOperations::baselineInstructionSet; set <= FloatVectorOperations::avx512InstructionSet; ++set)
+            if (FloatVectorOperations::setMaximumInstructionSet ((FloatVectorOperations::InstructionSet) set) == set)
+                sets.add ((FloatVectorOperations::InstructionSet) set);
+
+        String header ("kernel                     | size  "), divider ("-------------------------- | ----- ");
+
+        for (int i = 0; i < sets.size(); ++i)
+        {
+            header  << "| " << getName (sets.getUnchecked (i)).paddedRight (' ', 17);
+            divider << "| -----------------";
+        }
+
+        Logger::writeToLog ("FloatVectorOperations: ns per sample (and speedup over the baseline)");
+        Logger::writeToLog (header);
+        Logger::writeToLog (divider);
+
+        for (int kernel = 0; kernel < numKernels; ++kernel)
+        {
+            for (int size = 16; size <= 65536; size *= 4)
+            {
+                String line (String (getKernelName (kernel)).paddedRight (' ', 27) + "| " + String (size).paddedRight (' ', 6));
+                double baselineTime = 0;
+
+                for (int i = 0; i < sets.size(); ++i)
+                {
+                    FloatVectorOperations::setMaximumInstructionSet (sets.getUnchecked (i));
+                    const double time = timeKernel (kernel, size);
+
+                    if (i == 0)
+                        baselineTime = time;
+
+                    line << "| " << (String (time, 3) + " (" + String (baselineTime / time, 2) + "x)").paddedRight (' ', 17);
+                }
+
+                Logger::writeToLog (line);
+            }
+        }
+
+        FloatVectorOperations::setMaximumInstructionSet (originalSet);
+    }
+
+private:
+    //==============================================================================
+    enum
+    {
+        addFloat, addTwoSourcesFloat, addWithMultiplyFloat, addWithMultiplyDouble, multiplyFloat,
+        copyWithMultiplyFloat, copyWithMultiplyDouble, clipFloat, findMinAndMaxFloat, findMinAndMaxDouble,
+        convertFixedToFloat, numKernels
+    };
+
+    static const char* getKernelName (int kernel)
+    {
+        const char* const names[] = { "add (float)", "add 2 sources (float)", "addWithMultiply (float)", "addWithMultiply (double)",
+                                      "multiply (float)", "copyWithMultiply (float)", "copyWithMultiply (double)", "clip (float)",
+                                      "findMinAndMax (float)", "findMinAndMax (double)", "convertFixedToFloat" };
+
+        return names[kernel];
+    }
+
+    static String getName (FloatVectorOperations::InstructionSet set)
+    {
+        switch (set)
+        {
+            case FloatVectorOperations::avx2InstructionSet:    return "AVX2";
+            case FloatVectorOperations::avx512InstructionSet:  return "AVX-512";
+            default:                                           return "SSE";
+        }
+    }
+
+    double timeKernel (int kernel, int size)
+    {
+        fillBuffers (size);
+
+        // Keep the total amount of work roughly constant, so that every size takes a similar time
+        const int numRepeats = jmax (8, (1 << 24) / size);
+        double bestTimeMs = 0;
+
+        for (int attempt = 0; attempt < 3; ++attempt)
+        {
+            const double startMs = Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < numRepeats; ++i)
+                runKernel (kernel, size);
+
+            const double timeMs = Time::getMillisecondCounterHiRes() - startMs;
+
+            if (attempt == 0 || timeMs < bestTimeMs)
+                bestTimeMs = timeMs;
+        }
+
+        return bestTimeMs * 1.0e6 / ((double) numRepeats * size);
+    }
+
+    void runKernel (int kernel, int size)
+    {
+        float* const f1 = floats1.getData();
+        float* const f2 = floats2.getData();
+        double* const d1 = doubles1.getData();
+        double* const d2 = doubles2.getData();
+
+        switch (kernel)
+        {
+            case addFloat:                FloatVectorOperations::add (f1, f2, size); break;
+            case addTwoSourcesFloat:      FloatVectorOperations::add (f1, f2, f1, size); break;
+            case addWithMultiplyFloat:    FloatVectorOperations::addWithMultiply (f1, f2, 0.5f, size); break;
+            case addWithMultiplyDouble:   FloatVectorOperations::addWithMultiply (d1, d2, 0.5, size); break;
+            case multiplyFloat:           FloatVectorOperations::multiply (f1, f2, size); break;
+            case copyWithMultiplyFloat:   FloatVectorOperations::copyWithMultiply (f1, f2, 0.5f, size); break;
+            case copyWithMultiplyDouble:  FloatVectorOperations::copyWithMultiply (d1, d2, 0.5, size); break;
+            case clipFloat:               FloatVectorOperations::clip (f1, f2, -0.5f, 0.5f, size); break;
+            case findMinAndMaxFloat:      rangeSum += FloatVectorOperations::findMinAndMax (f2, size).getLength(); break;
+            case findMinAndMaxDouble:     rangeSum += FloatVectorOperations::findMinAndMax (d2, size).getLength(); break;
+            case convertFixedToFloat:     FloatVectorOperations::convertFixedToFloat (f1, ints.getData(), 1.0f / 0x7fffffff, size); break;
+            default:                      jassertfalse; break;
+        }
+    }
+
+    void fillBuffers (int size)
+    {
+        floats1.calloc ((size_t) size);
+        floats2.malloc ((size_t) size);
+        doubles1.calloc ((size_t) size);
+        doubles2.malloc ((size_t) size);
+        ints.malloc ((size_t) size);
+
+        Random random (42);
+
+        // small values, so that running the kernels repeatedly on the same buffers can't overflow
+        for (int i = 0; i < size; ++i)
+        {
+            floats2[i] = random.nextFloat() * 2.0f - 1.0f;
+            doubles2[i] = random.nextDouble() * 2.0 - 1.0;
+            ints[i] = random.nextInt();
+        }
+    }
+
+    HeapBlock<float> floats1, floats2;
+    HeapBlock<double> doubles1, doubles2;
+    HeapBlock<int> ints;
+    double rangeSum = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (FloatVectorOperationsBenchmark)
+};
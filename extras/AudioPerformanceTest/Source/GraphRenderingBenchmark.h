@@ -0,0 +1,233 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+/**
+    Measures how long an AudioProcessorGraph full of CPU-heavy nodes takes to
+    render a block, for each number of rendering threads from 1 up to the number
+    of CPUs, and checks that every thread count produces identical audio. It also
+    logs how many rendering ops the graph needs before and after they're fused.
+
+    Run the app with "--graph-benchmark" on the command line to use this.
+*/
+class GraphRenderingBenchmark
+{
+public:
+    GraphRenderingBenchmark (int numNodesToUse = 60, int blockSizeToUse = 512)
+        : numNodes (numNodesToUse), blockSize (blockSizeToUse)
+    {}
+
+    void run()
+    {
+        Logger::writeToLog ("AudioProcessorGraph rendering: " + String (numNodes) + " nodes, "
+                             + String (blockSize) + " samples per block");
+        Logger::writeToLog ("threads | avg ms/block | speedup | output");
+        Logger::writeToLog ("------- | ------------ | ------- | ------");
+
+        AudioBuffer<float> serialOutput;
+        double serialTimeMs = 0;
+
+        for (int numThreads = 1; numThreads <= SystemStats::getNumCpus(); ++numThreads)
+        {
+            AudioBuffer<float> output;
+            const double timeMs = timeGraph (numThreads, output);
+
+            if (numThreads == 1)
+            {
+                serialOutput.makeCopyOf (output);
+                serialTimeMs = timeMs;
+            }
+
+            Logger::writeToLog (String (numThreads).paddedRight (' ', 8) + "| "
+                                 + String (timeMs, 3).paddedRight (' ', 13) + "| "
+                                 + (String (serialTimeMs / timeMs, 2) + "x").paddedRight (' ', 8) + "| "
+                                 + (buffersMatch (serialOutput, output) ? "identical" : "DIFFERENT"));
+        }
+    }
+
+private:
+    //==============================================================================
+    /** A processor that burns a fixed amount of CPU per sample with a chain of one-pole filters. */
+    struct BusyProcessor  : public AudioProcessor
+    {
+        BusyProcessor (float coeff)
+            : AudioProcessor (BusesProperties().withInput  ("Input",  AudioChannelSet::stereo(), true)
+                                               .withOutput ("Output", AudioChannelSet::stereo(), true)),
+              coefficient (coeff)
+        {}
+
+        const String getName() const override                   { return "Busy"; }
+        void prepareToPlay (double, int) override               { reset(); }
+        void releaseResources() override                        {}
+        void reset() override                                   { zeromem (state, sizeof (state)); }
+        double getTailLengthSeconds() const override            { return 0; }
+        bool acceptsMidi() const override                       { return false; }
+        bool producesMidi() const override                      { return false; }
+        bool hasEditor() const override                         { return false; }
+        AudioProcessorEditor* createEditor() override           { return nullptr; }
+        int getNumPrograms() override                           { return 0; }
+        int getCurrentProgram() override                        { return 0; }
+        void setCurrentProgram (int) override                   {}
+        const String getProgramName (int) override              { return {}; }
+        void changeProgramName (int, const String&) override    {}
+        void getStateInformation (MemoryBlock&) override        {}
+        void setStateInformation (const void*, int) override    {}
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer&) override
+        {
+            for (int ch = 0; ch < jmin (2, buffer.getNumChannels()); ++ch)
+            {
+                float* data = buffer.getWritePointer (ch);
+
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                {
+                    float x = data[i];
+
+                    for (int stage = 0; stage < numStages; ++stage)
+                    {
+                        float& s = state[ch][stage];
+                        s += (x - s) * coefficient;
+                        x = s;
+                    }
+
+                    data[i] = x;
+                }
+            }
+        }
+
+        enum { numStages = 64 };
+        const float coefficient;
+        float state[2][numStages];
+    };
+
+    //==============================================================================
+    double timeGraph (int numThreads, AudioBuffer<float>& output)
+    {
+        AudioProcessorGraph graph;
+        graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+        typedef AudioProcessorGraph::AudioGraphIOProcessor IOProcessor;
+        const uint32 inputId  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode))->nodeId;
+        const uint32 outputId = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode))->nodeId;
+
+        // a mix of parallel branches, some of which contain two nodes in series
+        for (int i = 0; i < numNodes;)
+        {
+            const uint32 firstId = graph.addNode (new BusyProcessor (0.1f + 0.8f * (i % 7) / 7.0f))->nodeId;
+            uint32 lastId = firstId;
+            ++i;
+
+            if (i % 3 == 0 && i < numNodes)
+            {
+                lastId = graph.addNode (new BusyProcessor (0.3f))->nodeId;
+                connectStereo (graph, firstId, lastId);
+                ++i;
+            }
+
+            connectStereo (graph, inputId, firstId);
+            connectStereo (graph, lastId, outputId);
+        }
+
+        graph.setNumRenderingThreads (numThreads);
+        graph.prepareToPlay (44100.0, blockSize);
+
+        if (numThreads == 1)
+            logStatistics (graph.getRenderingStatistics());
+
+        const int numBlocks = 200;
+        AudioBuffer<float> block (2, blockSize);
+        MidiBuffer midi;
+        Random random (42);
+
+        output.setSize (2, numBlocks * blockSize);
+        double totalTimeMs = 0;
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    block.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+            const double startMs = Time::getMillisecondCounterHiRes();
+            graph.processBlock (block, midi);
+            totalTimeMs += Time::getMillisecondCounterHiRes() - startMs;
+
+            for (int ch = 0; ch < 2; ++ch)
+                output.copyFrom (ch, b * blockSize, block, ch, 0, blockSize);
+        }
+
+        graph.releaseResources();
+        return totalTimeMs / numBlocks;
+    }
+
+    static void logStatistics (const AudioProcessorGraph::RenderingStatistics& stats)
+    {
+        Logger::writeToLog ("Rendering program: " + String (stats.numAudioBuffers) + " audio buffers, "
+                             + String (stats.numMidiBuffers) + " midi buffers, "
+                             + String ((int) stats.programSizeBytes) + " bytes");
+        Logger::writeToLog ("  before fusion: " + describeOpCounts (stats.opsBeforeFusion));
+        Logger::writeToLog ("  after fusion:  " + describeOpCounts (stats.opsAfterFusion)
+                             + " (" + String (stats.numElidedClears) + " clears elided)");
+    }
+
+    static String describeOpCounts (const AudioProcessorGraph::OpCounts& counts)
+    {
+        return String (counts.getTotal()) + " ops = "
+                 + String (counts.numProcesses) + " process, "
+                 + String (counts.numClears) + " clear, "
+                 + String (counts.numCopies) + " copy, "
+                 + String (counts.numAdds) + " add, "
+                 + String (counts.numSums) + " sum, "
+                 + String (counts.numDelays) + " delay, "
+                 + String (counts.numMidiOps) + " midi";
+    }
+
+    static void connectStereo (AudioProcessorGraph& graph, uint32 sourceId, uint32 destId)
+    {
+        for (int ch = 0; ch < 2; ++ch)
+            graph.addConnection (sourceId, ch, destId, ch);
+    }
+
+    static bool buffersMatch (const AudioBuffer<float>& a, const AudioBuffer<float>& b)
+    {
+        if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() != b.getNumSamples())
+            return false;
+
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            if (memcmp (a.getReadPointer (ch), b.getReadPointer (ch), sizeof (float) * (size_t) a.getNumSamples()) != 0)
+                return false;
+
+        return true;
+    }
+
+    const int numNodes, blockSize;
+
+    JUCE_DECLARE_NON_COPYABLE (GraphRenderingBenchmark)
+};
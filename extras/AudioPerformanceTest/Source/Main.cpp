@@ -26,6 +26,12 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainComponent.h"
+#include "GraphRenderingBenchmark.h"
+#include "FloatVectorOperationsBenchmark.h"
+#include "FFTBenchmark.h"
+#include "SynthesiserBenchmark.h"
+#include "ParallelDecodingBenchmark.h"
+#include "ThumbnailBenchmark.h"
 
 Component* createMainContentComponent();
 
@@ -41,8 +47,52 @@ public:
     bool moreThanOneInstanceAllowed() override       { return true; }
 
     //==============================================================================
-    void initialise (const String&) override
+    void initialise (const String& commandLine) override
     {
+        // These benchmarks print their results to the log and then quit, rather
+        // than opening the main window..
+        if (commandLine.contains ("--graph-benchmark"))
+        {
+            GraphRenderingBenchmark().run();
+            quit();
+            return;
+        }
+
+        if (commandLine.contains ("--fvo-benchmark"))
+        {
+            FloatVectorOperationsBenchmark().run();
+            quit();
+            return;
+        }
+
+        if (commandLine.contains ("--fft-benchmark"))
+        {
+            FFTBenchmark().run();
+            quit();
+            return;
+        }
+
+        if (commandLine.contains ("--synth-benchmark"))
+        {
+            SynthesiserBenchmark().run();
+            quit();
+            return;
+        }
+
+        if (commandLine.contains ("--decode-benchmark"))
+        {
+            ParallelDecodingBenchmark().run();
+            quit();
+            return;
+        }
+
+        if (commandLine.contains ("--thumbnail-benchmark"))
+        {
+            ThumbnailBenchmark().run();
+            quit();
+            return;
+        }
+
         mainWindow = new MainWindow (getApplicationName());
     }
 
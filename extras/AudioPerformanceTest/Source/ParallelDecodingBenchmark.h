@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+/**
+    Measures AudioFormatManager::decodeFileInParallel() on a couple of minutes of
+    stereo audio in each of the compressed formats (and WAV for comparison), with
+    increasing numbers of decoding threads.
+
+    Throughput is given in MB of decoded float data per second.
+
+    Run the app with "--decode-benchmark" on the command line to use this.
+*/
+class ParallelDecodingBenchmark
+{
+public:
+    ParallelDecodingBenchmark() {}
+
+    void run()
+    {
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        const int numSamples = 44100 * 120;
+        const int maxThreads = SystemStats::getNumCpus();
+        AudioBuffer<float> source (createTestSignal (numSamples));
+
+        String header ("format "), divider ("------ ");
+
+        for (int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            header  << "| " << (String (threads) + (threads == 1 ? " thread" : " threads")).paddedRight (' ', 17);
+            divider << "| -----------------";
+        }
+
+        Logger::writeToLog ("Decoding " + String (numSamples / 44100) + "s of stereo audio: MB/s (and speedup over one thread)");
+        Logger::writeToLog (header);
+        Logger::writeToLog (divider);
+
+        const char* const extensions[] = { "wav", "flac", "ogg" };
+
+        for (int i = 0; i < numElementsInArray (extensions); ++i)
+        {
+            AudioFormat* const format = formatManager.findFormatForFileExtension (extensions[i]);
+
+            if (format == nullptr)
+                continue;
+
+            TemporaryFile tempFile (format->getFileExtensions()[0]);
+
+            {
+                ScopedPointer<AudioFormatWriter> writer (format->createWriterFor (tempFile.getFile().createOutputStream(),
+                                                                                  44100.0, 2, 16, StringPairArray(), 0));
+
+                if (writer == nullptr)
+                    continue;
+
+                writer->writeFromAudioSampleBuffer (source, 0, numSamples);
+            }
+
+            String line (String (extensions[i]).paddedRight (' ', 7));
+            double singleThreadedRate = 0;
+
+            for (int threads = 1; threads <= maxThreads; threads *= 2)
+            {
+                const double rate = timeDecoding (formatManager, tempFile.getFile(), threads);
+
+                if (threads == 1)
+                    singleThreadedRate = rate;
+
+                line << "| " << (String (rate, 1) + " (" + String (rate / singleThreadedRate, 2) + "x)").paddedRight (' ', 17);
+            }
+
+            Logger::writeToLog (line);
+        }
+    }
+
+private:
+    //==============================================================================
+    static AudioBuffer<float> createTestSignal (int numSamples)
+    {
+        AudioBuffer<float> buffer (2, numSamples);
+        Random r;
+        double phase = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float tone = (float) std::sin (phase);
+            phase += 0.02 + 0.01 * std::sin (i * 0.00001);
+
+            buffer.setSample (0, i, 0.5f * tone + 0.05f * (r.nextFloat() - 0.5f));
+            buffer.setSample (1, i, 0.4f * tone + 0.05f * (r.nextFloat() - 0.5f));
+        }
+
+        return buffer;
+    }
+
+    static double timeDecoding (AudioFormatManager& formatManager, const File& file, int numThreads)
+    {
+        ThreadPool pool (numThreads);
+        AudioBuffer<float> buffer;
+        double bestTimeMs = 0;
+
+        for (int attempt = 0; attempt < 3; ++attempt)
+        {
+            const double startMs = Time::getMillisecondCounterHiRes();
+            formatManager.decodeFileInParallel (file, buffer, pool);
+            const double timeMs = Time::getMillisecondCounterHiRes() - startMs;
+
+            if (attempt == 0 || timeMs < bestTimeMs)
+                bestTimeMs = timeMs;
+        }
+
+        const double megabytes = buffer.getNumChannels() * (double) buffer.getNumSamples() * sizeof (float) / (1024.0 * 1024.0);
+        return megabytes * 1000.0 / bestTimeMs;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelDecodingBenchmark)
+};
@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+/**
+    Times a Synthesiser whose voices each run an oscillator through a cascade of
+    filters, from 8 to 128 voices, rendering on the audio thread alone and then
+    with increasing numbers of voice-rendering threads.
+
+    Run the app with "--synth-benchmark" on the command line to use this.
+*/
+class SynthesiserBenchmark
+{
+public:
+    SynthesiserBenchmark() {}
+
+    void run()
+    {
+        const int maxThreads = jmax (1, SystemStats::getNumCpus() - 1);
+
+        String header ("voices "), divider ("------ ");
+
+        for (int threads = 0; threads <= maxThreads; ++threads)
+        {
+            header  << "| " << (String (threads) + " threads").paddedRight (' ', 17);
+            divider << "| -----------------";
+        }
+
+        Logger::writeToLog ("Synthesiser: microseconds per 512-sample block (and speedup over no threads)");
+        Logger::writeToLog (header);
+        Logger::writeToLog (divider);
+
+        for (int numVoices = 8; numVoices <= 128; numVoices *= 2)
+        {
+            String line (String (numVoices).paddedRight (' ', 7));
+            double singleThreadedTime = 0;
+
+            for (int threads = 0; threads <= maxThreads; ++threads)
+            {
+                const double time = timeSynth (numVoices, threads);
+
+                if (threads == 0)
+                    singleThreadedTime = time;
+
+                line << "| " << (String (time, 1) + " (" + String (singleThreadedTime / time, 2) + "x)").paddedRight (' ', 17);
+            }
+
+            Logger::writeToLog (line);
+        }
+    }
+
+private:
+    //==============================================================================
+    struct Sound  : public SynthesiserSound
+    {
+        bool appliesToNote (int) override       { return true; }
+        bool appliesToChannel (int) override    { return true; }
+    };
+
+    struct Voice  : public SynthesiserVoice
+    {
+        bool canPlaySound (SynthesiserSound*) override  { return true; }
+
+        void startNote (int note, float, SynthesiserSound*, int) override
+        {
+            increment = MidiMessage::getMidiNoteInHertz (note) / getSampleRate();
+
+            for (int i = 0; i < numElementsInArray (filters); ++i)
+                filters[i].setCoefficients (IIRCoefficients::makeLowPass (getSampleRate(), 2000.0 + 500.0 * i));
+        }
+
+        void stopNote (float, bool) override            { clearCurrentNote(); }
+        void pitchWheelMoved (int) override             {}
+        void controllerMoved (int, int) override        {}
+
+        void renderNextBlock (AudioBuffer<float>& buffer, int startSample, int numSamples) override
+        {
+            if (! isVoiceActive())
+                return;
+
+            float* const data = temp;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                data[i] = (float) (2.0 * phase - 1.0);
+                phase += increment;
+                phase -= std::floor (phase);
+            }
+
+            for (int i = 0; i < numElementsInArray (filters); ++i)
+                filters[i].processSamples (data, numSamples);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                buffer.addFrom (channel, startSample, data, numSamples, 0.05f);
+        }
+
+        IIRFilter filters[8];
+        float temp[512];
+        double phase = 0, increment = 0;
+    };
+
+    static double timeSynth (int numVoices, int numThreads)
+    {
+        Synthesiser synth;
+        synth.addSound (new Sound());
+
+        for (int i = 0; i < numVoices; ++i)
+            synth.addVoice (new Voice());
+
+        synth.setCurrentPlaybackSampleRate (44100.0);
+        synth.setNumVoiceRenderingThreads (numThreads);
+
+        for (int i = 0; i < numVoices; ++i)
+            synth.noteOn (1, 20 + i % 100, 0.8f);
+
+        AudioBuffer<float> buffer (2, 512);
+        MidiBuffer midi;
+        const int numBlocks = 500;
+        double bestTimeMs = 0;
+
+        for (int attempt = 0; attempt < 3; ++attempt)
+        {
+            const double startMs = Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                buffer.clear();
+                synth.renderNextBlock (buffer, midi, 0, buffer.getNumSamples());
+            }
+
+            const double timeMs = Time::getMillisecondCounterHiRes() - startMs;
+
+            if (attempt == 0 || timeMs < bestTimeMs)
+                bestTimeMs = timeMs;
+        }
+
+        return bestTimeMs * 1000.0 / numBlocks;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (SynthesiserBenchmark)
+};
@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+/**
+    Builds an AudioThumbnail of a three-hour stereo recording by feeding it blocks,
+    as happens while recording, and then times how long it takes to redraw it at a
+    range of zoom levels and to save it to an AudioThumbnailCache stream.
+
+    Run the app with "--thumbnail-benchmark" on the command line to use this.
+*/
+class ThumbnailBenchmark
+{
+public:
+    ThumbnailBenchmark() {}
+
+    void run()
+    {
+        const double sampleRate = 44100.0;
+        const int64 totalSamples = (int64) sampleRate * 60 * 60 * 3;
+        const int blockSize = 512;
+
+        AudioFormatManager formatManager;
+        AudioThumbnailCache cache (1);
+        AudioThumbnail thumbnail (512, formatManager, cache);
+
+        AudioBuffer<float> block (createTestSignal ((int) sampleRate * 10));
+
+        double startMs = Time::getMillisecondCounterHiRes();
+        thumbnail.reset (2, sampleRate, totalSamples);
+
+        for (int64 pos = 0; pos < totalSamples; pos += blockSize)
+            thumbnail.addBlock (pos, block, (int) (pos % (block.getNumSamples() - blockSize)),
+                                (int) jmin ((int64) blockSize, totalSamples - pos));
+
+        Logger::writeToLog ("Adding 3 hours of audio in " + String (blockSize) + "-sample blocks: "
+                              + String (Time::getMillisecondCounterHiRes() - startMs, 1) + " ms");
+
+        Image image (Image::RGB, 1600, 400, true);
+        Graphics g (image);
+        g.setColour (Colours::white);
+
+        const double totalLength = thumbnail.getTotalLength();
+        const double visibleLengths[] = { totalLength, 60.0 * 60.0, 60.0 * 10, 60.0, 10.0 };
+        const int numRedraws = 20;
+
+        for (int i = 0; i < numElementsInArray (visibleLengths); ++i)
+        {
+            startMs = Time::getMillisecondCounterHiRes();
+
+            for (int n = 0; n < numRedraws; ++n)
+            {
+                // scrolling the view means that the thumbnail can't reuse its cached window
+                const double start = (totalLength - visibleLengths[i]) * n / numRedraws;
+                thumbnail.drawChannels (g, image.getBounds(), start, start + visibleLengths[i], 1.0f);
+            }
+
+            const double drawingMs = (Time::getMillisecondCounterHiRes() - startMs) / numRedraws;
+
+            // ..and this is just the part of the drawing that looks up the levels for each pixel
+            startMs = Time::getMillisecondCounterHiRes();
+            const double timePerPixel = visibleLengths[i] / image.getWidth();
+            float mn, mx, total = 0;
+
+            for (int n = 0; n < numRedraws; ++n)
+            {
+                const double start = (totalLength - visibleLengths[i]) * n / numRedraws;
+
+                for (int x = 0; x < image.getWidth(); ++x)
+                {
+                    thumbnail.getApproximateMinMax (start + x * timePerPixel, start + (x + 1) * timePerPixel, 0, mn, mx);
+                    total += mx - mn;
+                }
+            }
+
+            const double lookupMs = (Time::getMillisecondCounterHiRes() - startMs) / numRedraws;
+
+            Logger::writeToLog ("Drawing " + String (visibleLengths[i] / 60.0, 1).paddedLeft (' ', 6) + " minutes across "
+                                  + String (image.getWidth()) + " pixels: " + String (drawingMs, 3) + " ms per redraw, "
+                                  + String (lookupMs, 3) + " ms to find the levels for one channel"
+                                  + (total < 0 ? "!" : ""));
+        }
+
+        startMs = Time::getMillisecondCounterHiRes();
+        cache.storeThumb (thumbnail, 1);
+        Logger::writeToLog ("Storing in the cache: " + String (Time::getMillisecondCounterHiRes() - startMs, 1) + " ms");
+
+        startMs = Time::getMillisecondCounterHiRes();
+        MemoryOutputStream cacheData;
+        cache.writeToStream (cacheData);
+        Logger::writeToLog ("Writing the cache to a stream: " + String (Time::getMillisecondCounterHiRes() - startMs, 1) + " ms, "
+                              + String (cacheData.getDataSize() / 1024) + " KB");
+
+        startMs = Time::getMillisecondCounterHiRes();
+        MemoryInputStream cacheInput (cacheData.getData(), cacheData.getDataSize(), false);
+        cache.readFromStream (cacheInput);
+        thumbnail.setReader (nullptr, 0);
+        cache.loadThumb (thumbnail, 1);
+        Logger::writeToLog ("Reading it back: " + String (Time::getMillisecondCounterHiRes() - startMs, 1) + " ms");
+    }
+
+private:
+    //==============================================================================
+    static AudioBuffer<float> createTestSignal (int numSamples)
+    {
+        AudioBuffer<float> buffer (2, numSamples);
+        Random r;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float envelope = 0.5f + 0.45f * (float) std::sin (i * 0.0001);
+
+            buffer.setSample (0, i, envelope * (r.nextFloat() * 2.0f - 1.0f));
+            buffer.setSample (1, i, envelope * 0.5f * (r.nextFloat() * 2.0f - 1.0f));
+        }
+
+        return buffer;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ThumbnailBenchmark)
+};
@@ -157,6 +157,10 @@
  //#define JUCE_CHECK_MEMORY_LEAKS
 #endif
 
+#ifndef    JUCE_ENABLE_ALLOCATION_HOOKS
+ #define   JUCE_ENABLE_ALLOCATION_HOOKS 1
+#endif
+
 #ifndef    JUCE_DONT_AUTOLINK_TO_WIN32_LIBRARIES
  //#define JUCE_DONT_AUTOLINK_TO_WIN32_LIBRARIES
 #endif
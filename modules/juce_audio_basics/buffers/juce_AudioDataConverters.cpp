@@ -20,8 +20,66 @@
   ==============================================================================
 */
 
+namespace
+{
+    // The packed 24-bit formats are converted via a small buffer of ints, so that they can
+    // use the vector conversions in FloatVectorOperations.
+    enum { intBufferSize = 256 };
+
+    template <void (*writeSample) (int, void*)>
+    void convertFloatToInt24 (const float* source, char* dest, int numSamples, int destBytesPerSample) noexcept
+    {
+        int32 ints[intBufferSize];
+
+        while (numSamples > 0)
+        {
+            const int num = jmin (numSamples, (int) intBufferSize);
+            FloatVectorOperations::convertFloatToInt24 (ints, source, num);
+
+            for (int i = 0; i < num; ++i)
+            {
+                writeSample (ints[i], dest);
+                dest += destBytesPerSample;
+            }
+
+            source += num;
+            numSamples -= num;
+        }
+    }
+
+    template <int (*readSample) (const void*)>
+    void convertInt24ToFloat (const char* source, float* dest, int numSamples, int srcBytesPerSample) noexcept
+    {
+        int32 ints[intBufferSize];
+
+        while (numSamples > 0)
+        {
+            const int num = jmin (numSamples, (int) intBufferSize);
+
+            for (int i = 0; i < num; ++i)
+            {
+                ints[i] = readSample (source);
+                source += srcBytesPerSample;
+            }
+
+            FloatVectorOperations::convertInt24ToFloat (dest, ints, num);
+            dest += num;
+            numSamples -= num;
+        }
+    }
+}
+
+//==============================================================================
 void AudioDataConverters::convertFloatToInt16LE (const float* source, void* dest, int numSamples, const int destBytesPerSample)
 {
+   #if JUCE_LITTLE_ENDIAN
+    if (destBytesPerSample == 2)
+    {
+        FloatVectorOperations::convertFloatToInt16 (static_cast<int16*> (dest), source, numSamples);
+        return;
+    }
+   #endif
+
     const double maxVal = (double) 0x7fff;
     char* intData = static_cast<char*> (dest);
 
@@ -47,6 +105,14 @@ void AudioDataConverters::convertFloatToInt16LE (const float* source, void* dest
 
 void AudioDataConverters::convertFloatToInt16BE (const float* source, void* dest, int numSamples, const int destBytesPerSample)
 {
+   #if JUCE_BIG_ENDIAN
+    if (destBytesPerSample == 2)
+    {
+        FloatVectorOperations::convertFloatToInt16 (static_cast<int16*> (dest), source, numSamples);
+        return;
+    }
+   #endif
+
     const double maxVal = (double) 0x7fff;
     char* intData = static_cast<char*> (dest);
 
@@ -77,11 +143,7 @@ void AudioDataConverters::convertFloatToInt24LE (const float* source, void* dest
 
     if (dest != (void*) source || destBytesPerSample <= 4)
     {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            ByteOrder::littleEndian24BitToChars (roundToInt (jlimit (-maxVal, maxVal, maxVal * source[i])), intData);
-            intData += destBytesPerSample;
-        }
+        convertFloatToInt24<ByteOrder::littleEndian24BitToChars> (source, intData, numSamples, destBytesPerSample);
     }
     else
     {
@@ -102,11 +164,7 @@ void AudioDataConverters::convertFloatToInt24BE (const float* source, void* dest
 
     if (dest != (void*) source || destBytesPerSample <= 4)
     {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            ByteOrder::bigEndian24BitToChars (roundToInt (jlimit (-maxVal, maxVal, maxVal * source[i])), intData);
-            intData += destBytesPerSample;
-        }
+        convertFloatToInt24<ByteOrder::bigEndian24BitToChars> (source, intData, numSamples, destBytesPerSample);
     }
     else
     {
@@ -122,6 +180,14 @@ void AudioDataConverters::convertFloatToInt24BE (const float* source, void* dest
 
 void AudioDataConverters::convertFloatToInt32LE (const float* source, void* dest, int numSamples, const int destBytesPerSample)
 {
+   #if JUCE_LITTLE_ENDIAN
+    if (destBytesPerSample == 4)
+    {
+        FloatVectorOperations::convertFloatToInt32 (static_cast<int32*> (dest), source, numSamples);
+        return;
+    }
+   #endif
+
     const double maxVal = (double) 0x7fffffff;
     char* intData = static_cast<char*> (dest);
 
@@ -147,6 +213,14 @@ void AudioDataConverters::convertFloatToInt32LE (const float* source, void* dest
 
 void AudioDataConverters::convertFloatToInt32BE (const float* source, void* dest, int numSamples, const int destBytesPerSample)
 {
+   #if JUCE_BIG_ENDIAN
+    if (destBytesPerSample == 4)
+    {
+        FloatVectorOperations::convertFloatToInt32 (static_cast<int32*> (dest), source, numSamples);
+        return;
+    }
+   #endif
+
     const double maxVal = (double) 0x7fffffff;
     char* intData = static_cast<char*> (dest);
 
@@ -209,6 +283,14 @@ void AudioDataConverters::convertFloatToFloat32BE (const float* source, void* de
 //==============================================================================
 void AudioDataConverters::convertInt16LEToFloat (const void* const source, float* const dest, int numSamples, const int srcBytesPerSample)
 {
+   #if JUCE_LITTLE_ENDIAN
+    if (srcBytesPerSample == 2 && source != (void*) dest)
+    {
+        FloatVectorOperations::convertInt16ToFloat (dest, static_cast<const int16*> (source), numSamples);
+        return;
+    }
+   #endif
+
     const float scale = 1.0f / 0x7fff;
     const char* intData = static_cast<const char*> (source);
 
@@ -234,6 +316,14 @@ void AudioDataConverters::convertInt16LEToFloat (const void* const source, float
 
 void AudioDataConverters::convertInt16BEToFloat (const void* const source, float* const dest, int numSamples, const int srcBytesPerSample)
 {
+   #if JUCE_BIG_ENDIAN
+    if (srcBytesPerSample == 2 && source != (void*) dest)
+    {
+        FloatVectorOperations::convertInt16ToFloat (dest, static_cast<const int16*> (source), numSamples);
+        return;
+    }
+   #endif
+
     const float scale = 1.0f / 0x7fff;
     const char* intData = static_cast<const char*> (source);
 
@@ -264,11 +354,7 @@ void AudioDataConverters::convertInt24LEToFloat (const void* const source, float
 
     if (source != (void*) dest || srcBytesPerSample >= 4)
     {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            dest[i] = scale * (short) ByteOrder::littleEndian24Bit (intData);
-            intData += srcBytesPerSample;
-        }
+        convertInt24ToFloat<ByteOrder::littleEndian24Bit> (intData, dest, numSamples, srcBytesPerSample);
     }
     else
     {
@@ -277,7 +363,7 @@ void AudioDataConverters::convertInt24LEToFloat (const void* const source, float
         for (int i = numSamples; --i >= 0;)
         {
             intData -= srcBytesPerSample;
-            dest[i] = scale * (short) ByteOrder::littleEndian24Bit (intData);
+            dest[i] = scale * ByteOrder::littleEndian24Bit (intData);
         }
     }
 }
@@ -289,11 +375,7 @@ void AudioDataConverters::convertInt24BEToFloat (const void* const source, float
 
     if (source != (void*) dest || srcBytesPerSample >= 4)
     {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            dest[i] = scale * (short) ByteOrder::bigEndian24Bit (intData);
-            intData += srcBytesPerSample;
-        }
+        convertInt24ToFloat<ByteOrder::bigEndian24Bit> (intData, dest, numSamples, srcBytesPerSample);
     }
     else
     {
@@ -302,13 +384,21 @@ void AudioDataConverters::convertInt24BEToFloat (const void* const source, float
         for (int i = numSamples; --i >= 0;)
         {
             intData -= srcBytesPerSample;
-            dest[i] = scale * (short) ByteOrder::bigEndian24Bit (intData);
+            dest[i] = scale * ByteOrder::bigEndian24Bit (intData);
         }
     }
 }
 
 void AudioDataConverters::convertInt32LEToFloat (const void* const source, float* const dest, int numSamples, const int srcBytesPerSample)
 {
+   #if JUCE_LITTLE_ENDIAN
+    if (srcBytesPerSample == 4)
+    {
+        FloatVectorOperations::convertInt32ToFloat (dest, static_cast<const int32*> (source), numSamples);
+        return;
+    }
+   #endif
+
     const float scale = 1.0f / 0x7fffffff;
     const char* intData = static_cast<const char*> (source);
 
@@ -334,6 +424,14 @@ void AudioDataConverters::convertInt32LEToFloat (const void* const source, float
 
 void AudioDataConverters::convertInt32BEToFloat (const void* const source, float* const dest, int numSamples, const int srcBytesPerSample)
 {
+   #if JUCE_BIG_ENDIAN
+    if (srcBytesPerSample == 4)
+    {
+        FloatVectorOperations::convertInt32ToFloat (dest, static_cast<const int32*> (source), numSamples);
+        return;
+    }
+   #endif
+
     const float scale = 1.0f / 0x7fffffff;
     const char* intData = static_cast<const char*> (source);
 
@@ -437,17 +535,7 @@ void AudioDataConverters::interleaveSamples (const float** const source,
                                              const int numSamples,
                                              const int numChannels)
 {
-    for (int chan = 0; chan < numChannels; ++chan)
-    {
-        int i = chan;
-        const float* src = source [chan];
-
-        for (int j = 0; j < numSamples; ++j)
-        {
-            dest [i] = src [j];
-            i += numChannels;
-        }
-    }
+    FloatVectorOperations::interleave (dest, source, numChannels, numSamples);
 }
 
 void AudioDataConverters::deinterleaveSamples (const float* const source,
@@ -455,16 +543,334 @@ void AudioDataConverters::deinterleaveSamples (const float* const source,
                                                const int numSamples,
                                                const int numChannels)
 {
-    for (int chan = 0; chan < numChannels; ++chan)
+    FloatVectorOperations::deinterleave (dest, source, numChannels, numSamples);
+}
+
+//==============================================================================
+namespace
+{
+    // Each of these reads a sample in one of the packed formats as a left-justified int
+    // (or as the raw bits of a float), and writes one back again.
+    struct PackedInt16LE
+    {
+        enum { bytesPerSample = 2 };
+        static int read (const char* p) noexcept            { return (int) ((uint32) ByteOrder::littleEndianShort (p) << 16); }
+        static void write (char* p, int value) noexcept     { const uint16 v = ByteOrder::swapIfBigEndian ((uint16) ((uint32) value >> 16)); memcpy (p, &v, sizeof (v)); }
+    };
+
+    struct PackedInt16BE
+    {
+        enum { bytesPerSample = 2 };
+        static int read (const char* p) noexcept            { return (int) ((uint32) ByteOrder::bigEndianShort (p) << 16); }
+        static void write (char* p, int value) noexcept     { const uint16 v = ByteOrder::swapIfLittleEndian ((uint16) ((uint32) value >> 16)); memcpy (p, &v, sizeof (v)); }
+    };
+
+    struct PackedInt24LE
+    {
+        enum { bytesPerSample = 3 };
+        static int read (const char* p) noexcept            { return (int) ((uint32) ByteOrder::littleEndian24Bit (p) << 8); }
+        static void write (char* p, int value) noexcept     { ByteOrder::littleEndian24BitToChars (value >> 8, p); }
+    };
+
+    struct PackedInt24BE
+    {
+        enum { bytesPerSample = 3 };
+        static int read (const char* p) noexcept            { return (int) ((uint32) ByteOrder::bigEndian24Bit (p) << 8); }
+        static void write (char* p, int value) noexcept     { ByteOrder::bigEndian24BitToChars (value >> 8, p); }
+    };
+
+    struct PackedInt32LE
+    {
+        enum { bytesPerSample = 4 };
+        static int read (const char* p) noexcept            { return (int) ByteOrder::littleEndianInt (p); }
+        static void write (char* p, int value) noexcept     { const uint32 v = ByteOrder::swapIfBigEndian ((uint32) value); memcpy (p, &v, sizeof (v)); }
+    };
+
+    struct PackedInt32BE
+    {
+        enum { bytesPerSample = 4 };
+        static int read (const char* p) noexcept            { return (int) ByteOrder::bigEndianInt (p); }
+        static void write (char* p, int value) noexcept     { const uint32 v = ByteOrder::swapIfLittleEndian ((uint32) value); memcpy (p, &v, sizeof (v)); }
+    };
+
+   #if JUCE_LITTLE_ENDIAN
+    // On a little-endian CPU, loading the four bytes that end with a 24-bit sample leaves it in
+    // the top 24 bits of an int, which is quicker than assembling it a byte at a time. That load
+    // would start before the data for the very first sample, so this can't be used for that one.
+    struct PackedInt24LEFollowingData
+    {
+        enum { bytesPerSample = 3 };
+        static int read (const char* p) noexcept            { uint32 v; memcpy (&v, p - 1, sizeof (v)); return (int) (v & 0xffffff00); }
+    };
+   #endif
+
+    int getBytesPerSample (AudioDataConverters::DataFormat format) noexcept
+    {
+        switch (format)
+        {
+            case AudioDataConverters::int16LE:
+            case AudioDataConverters::int16BE:  return 2;
+            case AudioDataConverters::int24LE:
+            case AudioDataConverters::int24BE:  return 3;
+            default:                            return 4;
+        }
+    }
+
+    template <class Format>
+    void deinterleaveInts (const char* source, int numSourceChannels, int* const* dest, int numDestChannels,
+                           int startSample, int numSamples) noexcept
+    {
+        if (startSample >= numSamples)
+            return;
+
+        const int frameSize = numSourceChannels * (int) Format::bytesPerSample;
+
+        for (int ch = 0; ch < numDestChannels; ++ch)
+        {
+            if (int* const d = dest[ch])
+            {
+                if (ch < numSourceChannels)
+                {
+                    const char* s = source + startSample * frameSize + ch * (int) Format::bytesPerSample;
+
+                    for (int i = startSample; i < numSamples; ++i)
+                    {
+                        d[i] = Format::read (s);
+                        s += frameSize;
+                    }
+                }
+                else
+                {
+                    zeromem (d + startSample, sizeof (int) * (size_t) (numSamples - startSample));
+                }
+            }
+        }
+    }
+
+    template <class Format>
+    void interleaveInts (const int* const* source, int numChannels, char* dest,
+                         int startSample, int numSamples) noexcept
+    {
+        const int frameSize = numChannels * (int) Format::bytesPerSample;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            char* d = dest + startSample * frameSize + ch * (int) Format::bytesPerSample;
+            const int* const s = source[ch];
+
+            for (int i = startSample; i < numSamples; ++i)
+            {
+                Format::write (d, s != nullptr ? s[i] : 0);
+                d += frameSize;
+            }
+        }
+    }
+
+    template <typename Type>
+    bool allChannelsPresent (Type* const* channels, int numChannels) noexcept
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            if (channels[ch] == nullptr)
+                return false;
+
+        return true;
+    }
+
+    enum { maxChannelsForBlocks = 64 };
+
+   #if JUCE_LITTLE_ENDIAN
+    // The samples are converted while they're still interleaved, a block that fits in the
+    // cache at a time, and then split up, so both passes use the vector kernels.
+    void deinterleaveInt16LEToFloat (const int16* source, int numChannels, float* const* dest, int numSamples) noexcept
+    {
+        const float scale = 1.0f / 0x8000;
+
+        if (numChannels == 1)
+        {
+            FloatVectorOperations::convertInt16ToFloat (dest[0], source, scale, numSamples);
+            return;
+        }
+
+        float block[2048];
+        float* blockDest[maxChannelsForBlocks];
+        const int framesPerBlock = numElementsInArray (block) / numChannels;
+
+        for (int start = 0; start < numSamples; start += framesPerBlock)
+        {
+            const int num = jmin (framesPerBlock, numSamples - start);
+            FloatVectorOperations::convertInt16ToFloat (block, source + start * numChannels, scale, num * numChannels);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                blockDest[ch] = dest[ch] + start;
+
+            FloatVectorOperations::deinterleave (blockDest, block, numChannels, num);
+        }
+    }
+   #endif
+
+   #if JUCE_USE_SSE_INTRINSICS && JUCE_LITTLE_ENDIAN
+    // This packs the bulk of the mono and stereo little-endian 16-bit cases, and returns the
+    // number of frames it's done, leaving any remainder for the scalar loop.
+    int interleaveInt16Vectors (const int* const* source, int numChannels, char* dest, int numSamples) noexcept
     {
-        int i = chan;
-        float* dst = dest [chan];
+        int i = 0;
 
-        for (int j = 0; j < numSamples; ++j)
+        if (numChannels == 1)
         {
-            dst [j] = source [i];
-            i += numChannels;
+            const int* const s = source[0];
+
+            for (; i <= numSamples - 8; i += 8)
+            {
+                const __m128i a = _mm_srai_epi32 (_mm_loadu_si128 ((const __m128i*) (s + i)), 16);
+                const __m128i b = _mm_srai_epi32 (_mm_loadu_si128 ((const __m128i*) (s + i + 4)), 16);
+                _mm_storeu_si128 ((__m128i*) (dest + i * 2), _mm_packs_epi32 (a, b));
+            }
         }
+        else
+        {
+            const int* const left = source[0];
+            const int* const right = source[1];
+            const __m128i topHalves = _mm_set1_epi32 ((int) 0xffff0000);
+
+            for (; i <= numSamples - 4; i += 4)
+            {
+                const __m128i l = _mm_srli_epi32 (_mm_loadu_si128 ((const __m128i*) (left + i)), 16);
+                const __m128i r = _mm_and_si128 (_mm_loadu_si128 ((const __m128i*) (right + i)), topHalves);
+                _mm_storeu_si128 ((__m128i*) (dest + i * 4), _mm_or_si128 (l, r));
+            }
+        }
+
+        return i;
+    }
+   #endif
+}
+
+void AudioDataConverters::deinterleaveToInt32 (const DataFormat sourceFormat, const void* const source, const int numSourceChannels,
+                                               int* const* const dest, const int numDestChannels, const int numSamples)
+{
+    const char* const data = static_cast<const char*> (source);
+
+    // Whole frames of 32-bit little-endian data only need their words moving into place, which
+    // the float deinterleaver does without looking at the values. 32-bit Intel builds may copy
+    // floats through the x87 unit, which would quieten any int that looks like a signalling NaN.
+   #if JUCE_LITTLE_ENDIAN && (JUCE_64BIT || ! JUCE_INTEL)
+    if ((sourceFormat == int32LE || sourceFormat == float32LE)
+         && numSourceChannels == numDestChannels && allChannelsPresent (dest, numDestChannels))
+    {
+        FloatVectorOperations::deinterleave (reinterpret_cast<float* const*> (dest), reinterpret_cast<const float*> (data),
+                                             numSourceChannels, numSamples);
+        return;
+    }
+   #endif
+
+    switch (sourceFormat)
+    {
+        case int16LE:       deinterleaveInts<PackedInt16LE> (data, numSourceChannels, dest, numDestChannels, 0, numSamples); break;
+        case int16BE:       deinterleaveInts<PackedInt16BE> (data, numSourceChannels, dest, numDestChannels, 0, numSamples); break;
+        case int24BE:       deinterleaveInts<PackedInt24BE> (data, numSourceChannels, dest, numDestChannels, 0, numSamples); break;
+        case int32LE:
+        case float32LE:     deinterleaveInts<PackedInt32LE> (data, numSourceChannels, dest, numDestChannels, 0, numSamples); break;
+        case int32BE:
+        case float32BE:     deinterleaveInts<PackedInt32BE> (data, numSourceChannels, dest, numDestChannels, 0, numSamples); break;
+
+        case int24LE:
+           #if JUCE_LITTLE_ENDIAN
+            deinterleaveInts<PackedInt24LE> (data, numSourceChannels, dest, numDestChannels, 0, jmin (1, numSamples));
+            deinterleaveInts<PackedInt24LEFollowingData> (data, numSourceChannels, dest, numDestChannels, 1, numSamples);
+           #else
+            deinterleaveInts<PackedInt24LE> (data, numSourceChannels, dest, numDestChannels, 0, numSamples);
+           #endif
+            break;
+
+        default:            jassertfalse; break;
+    }
+}
+
+void AudioDataConverters::deinterleaveToFloat (const DataFormat sourceFormat, const void* const source, const int numSourceChannels,
+                                               float* const* const dest, const int numDestChannels, const int numSamples)
+{
+    if (sourceFormat == float32LE || sourceFormat == float32BE)
+    {
+        deinterleaveToInt32 (sourceFormat, source, numSourceChannels, reinterpret_cast<int* const*> (dest), numDestChannels, numSamples);
+        return;
+    }
+
+   #if JUCE_LITTLE_ENDIAN
+    if (sourceFormat == int16LE && numSourceChannels == numDestChannels && numDestChannels <= maxChannelsForBlocks
+         && allChannelsPresent (dest, numDestChannels))
+    {
+        deinterleaveInt16LEToFloat (static_cast<const int16*> (source), numSourceChannels, dest, numSamples);
+        return;
+    }
+   #endif
+
+    // The ints are unpacked straight into the destination and then converted in place. This is
+    // done a block at a time so that the conversion finds the data still in the cache.
+    const int blockSize = 1024;
+    const int numChannelsToConvert = jmin (numSourceChannels, numDestChannels);
+    const int frameSize = numSourceChannels * getBytesPerSample (sourceFormat);
+    const float scale = 1.0f / (float) 0x80000000u;
+    float* blockDest[maxChannelsForBlocks];
+
+    if (numDestChannels > maxChannelsForBlocks)
+    {
+        deinterleaveToInt32 (sourceFormat, source, numSourceChannels, reinterpret_cast<int* const*> (dest), numDestChannels, numSamples);
+
+        for (int ch = 0; ch < numChannelsToConvert; ++ch)
+            if (float* const d = dest[ch])
+                FloatVectorOperations::convertFixedToFloat (d, reinterpret_cast<const int*> (d), scale, numSamples);
+
+        return;
+    }
+
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        const int num = jmin (blockSize, numSamples - start);
+
+        for (int ch = 0; ch < numDestChannels; ++ch)
+            blockDest[ch] = dest[ch] != nullptr ? dest[ch] + start : nullptr;
+
+        deinterleaveToInt32 (sourceFormat, addBytesToPointer (source, start * frameSize), numSourceChannels,
+                             reinterpret_cast<int* const*> (blockDest), numDestChannels, num);
+
+        for (int ch = 0; ch < numChannelsToConvert; ++ch)
+            if (float* const d = blockDest[ch])
+                FloatVectorOperations::convertFixedToFloat (d, reinterpret_cast<const int*> (d), scale, num);
+    }
+}
+
+void AudioDataConverters::interleaveFromInt32 (const DataFormat destFormat, const int* const* const source, const int numChannels,
+                                               void* const dest, const int numSamples)
+{
+    char* const data = static_cast<char*> (dest);
+    int numDone = 0;
+
+    // (see deinterleaveToInt32() for why this is skipped on 32-bit Intel builds)
+   #if JUCE_LITTLE_ENDIAN && (JUCE_64BIT || ! JUCE_INTEL)
+    if ((destFormat == int32LE || destFormat == float32LE) && allChannelsPresent (source, numChannels))
+    {
+        FloatVectorOperations::interleave (reinterpret_cast<float*> (data), reinterpret_cast<const float* const*> (source),
+                                           numChannels, numSamples);
+        return;
+    }
+   #endif
+
+   #if JUCE_USE_SSE_INTRINSICS && JUCE_LITTLE_ENDIAN
+    if (destFormat == int16LE && (numChannels == 1 || numChannels == 2) && allChannelsPresent (source, numChannels))
+        numDone = interleaveInt16Vectors (source, numChannels, data, numSamples);
+   #endif
+
+    switch (destFormat)
+    {
+        case int16LE:       interleaveInts<PackedInt16LE> (source, numChannels, data, numDone, numSamples); break;
+        case int16BE:       interleaveInts<PackedInt16BE> (source, numChannels, data, numDone, numSamples); break;
+        case int24LE:       interleaveInts<PackedInt24LE> (source, numChannels, data, numDone, numSamples); break;
+        case int24BE:       interleaveInts<PackedInt24BE> (source, numChannels, data, numDone, numSamples); break;
+        case int32LE:
+        case float32LE:     interleaveInts<PackedInt32LE> (source, numChannels, data, numDone, numSamples); break;
+        case int32BE:
+        case float32BE:     interleaveInts<PackedInt32BE> (source, numChannels, data, numDone, numSamples); break;
+        default:            jassertfalse; break;
     }
 }
 
@@ -577,9 +983,189 @@ public:
         }
     };
 
+    static void testDataConverters (UnitTest& unitTest, Random& r)
+    {
+        const int numSamples = 1000;
+        float original[numSamples], converted[numSamples], inPlace[numSamples];
+        char data[numSamples * 4];
+
+        for (int i = 0; i < numSamples; ++i)
+            original[i] = r.nextFloat() * 2.0f - 1.0f;
+
+        const AudioDataConverters::DataFormat formats[] = { AudioDataConverters::int16LE, AudioDataConverters::int16BE,
+                                                            AudioDataConverters::int24LE, AudioDataConverters::int24BE,
+                                                            AudioDataConverters::int32LE, AudioDataConverters::int32BE };
+        const int bitDepths[] = { 16, 16, 24, 24, 32, 32 };
+
+        for (int f = 0; f < numElementsInArray (formats); ++f)
+        {
+            // (allowing for the float's own rounding error as well as the integer's)
+            const double errorMargin = 1.0 / (double) ((int64) 1 << (bitDepths[f] - 1)) + 1.0e-7;
+
+            AudioDataConverters::convertFloatToFormat (formats[f], original, data, numSamples);
+            AudioDataConverters::convertFormatToFloat (formats[f], data, converted, numSamples);
+
+            memcpy (inPlace, original, sizeof (inPlace));
+            AudioDataConverters::convertFloatToFormat (formats[f], inPlace, inPlace, numSamples);
+            AudioDataConverters::convertFormatToFloat (formats[f], inPlace, inPlace, numSamples);
+
+            double biggestDiff = 0;
+
+            for (int i = 0; i < numSamples; ++i)
+                biggestDiff = jmax (biggestDiff, std::abs ((double) converted[i] - original[i]),
+                                    std::abs ((double) inPlace[i] - original[i]));
+
+            unitTest.expect (biggestDiff <= errorMargin);
+        }
+
+        HeapBlock<float> channelData (numSamples * 8);
+        HeapBlock<float> interleaved (numSamples * 8);
+
+        for (int numChannels = 1; numChannels <= 8; ++numChannels)
+        {
+            const float* sources[8];
+            float* dests[8];
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                sources[ch] = original;
+                dests[ch] = channelData + ch * numSamples;
+            }
+
+            AudioDataConverters::interleaveSamples (sources, interleaved, numSamples, numChannels);
+            AudioDataConverters::deinterleaveSamples (interleaved, dests, numSamples, numChannels);
+
+            bool allMatch = true;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                allMatch = allMatch && memcmp (dests[ch], original, sizeof (original)) == 0;
+
+            unitTest.expect (allMatch);
+        }
+    }
+
+    // Checks the block conversions against AudioData::Pointer, with odd numbers of samples and
+    // an extra dest channel so that the scalar tails and channel-clearing get exercised too
+    template <class F, class E>
+    static void testPackedConversions (UnitTest& unitTest, Random& r)
+    {
+        typedef AudioData::Pointer<F, E, AudioData::Interleaved, AudioData::NonConst> PackedType;
+
+        const int format = AudioDataConverters::getDataFormat<F, E>();
+        unitTest.expect (format >= 0);
+
+        for (int numChannels = 1; numChannels <= 4; ++numChannels)
+        {
+            const int numSamples = 1 + r.nextInt (2500);
+            HeapBlock<char> packed ((size_t) (numSamples * numChannels * PackedType::getBytesPerSample()), true);
+            HeapBlock<char> repacked ((size_t) (numSamples * numChannels * PackedType::getBytesPerSample()), true);
+            AudioBuffer<float> ints (numChannels + 1, numSamples), floats (numChannels + 1, numSamples);
+            ints.clear();
+            floats.clear();
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                PackedType p (packed + ch * PackedType::getBytesPerSample(), numChannels);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    if (F::isFloat)
+                        p.setAsFloat (r.nextFloat() * 2.0f - 1.0f);
+                    else
+                        p.setAsInt32 (r.nextInt());
+
+                    ++p;
+                }
+            }
+
+            // the dest channel after the sources should be cleared, and a null one skipped
+            ints.setSample (numChannels, 0, 1.0f);
+            floats.setSample (numChannels, 0, 1.0f);
+
+            int* intChans[5];
+            float* floatChans[5];
+
+            for (int ch = 0; ch <= numChannels; ++ch)
+            {
+                intChans[ch] = reinterpret_cast<int*> (ints.getWritePointer (ch));
+                floatChans[ch] = floats.getWritePointer (ch);
+            }
+
+            const AudioDataConverters::DataFormat f = (AudioDataConverters::DataFormat) format;
+            AudioDataConverters::deinterleaveToInt32 (f, packed, numChannels, intChans, numChannels + 1, numSamples);
+            AudioDataConverters::deinterleaveToFloat (f, packed, numChannels, floatChans, numChannels + 1, numSamples);
+            AudioDataConverters::interleaveFromInt32 (f, intChans, numChannels, repacked, numSamples);
+
+            bool allMatch = (intChans[numChannels][0] == 0 && floatChans[numChannels][0] == 0.0f);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                PackedType p (packed + ch * PackedType::getBytesPerSample(), numChannels);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const float expectedFloat = p.getAsFloat();
+                    int expectedInt = p.getAsInt32();
+
+                    if (F::isFloat)
+                        memcpy (&expectedInt, &expectedFloat, sizeof (int));
+
+                    allMatch = allMatch && intChans[ch][i] == expectedInt && floatChans[ch][i] == expectedFloat;
+                    ++p;
+                }
+            }
+
+            unitTest.expect (allMatch);
+            unitTest.expect (memcmp (packed, repacked, (size_t) (numSamples * numChannels * PackedType::getBytesPerSample())) == 0);
+
+            {
+                // with a destination for each source channel, the vector kernels do the work
+                AudioBuffer<float> matchedInts (numChannels, numSamples), matchedFloats (numChannels, numSamples);
+                int* matchedIntChans[4];
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    matchedIntChans[ch] = reinterpret_cast<int*> (matchedInts.getWritePointer (ch));
+
+                AudioDataConverters::deinterleaveToInt32 (f, packed, numChannels, matchedIntChans, numChannels, numSamples);
+                AudioDataConverters::deinterleaveToFloat (f, packed, numChannels, matchedFloats.getArrayOfWritePointers(), numChannels, numSamples);
+
+                bool matchedChannelsMatch = true;
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    matchedChannelsMatch = matchedChannelsMatch
+                                            && memcmp (matchedIntChans[ch], intChans[ch], sizeof (int) * (size_t) numSamples) == 0
+                                            && memcmp (matchedFloats.getReadPointer (ch), floatChans[ch], sizeof (float) * (size_t) numSamples) == 0;
+
+                unitTest.expect (matchedChannelsMatch);
+            }
+
+            if (numChannels > 1)
+            {
+                // a null source channel is written as silence
+                intChans[1] = nullptr;
+                AudioDataConverters::interleaveFromInt32 (f, intChans, numChannels, repacked, numSamples);
+                PackedType p (repacked + PackedType::getBytesPerSample(), numChannels);
+                unitTest.expect (p.findMinAndMax ((size_t) numSamples).isEmpty());
+            }
+        }
+    }
+
     void runTest() override
     {
         Random r = getRandom();
+        beginTest ("AudioDataConverters");
+        testDataConverters (*this, r);
+        beginTest ("Packed block conversions");
+        testPackedConversions<AudioData::Int16,   AudioData::LittleEndian> (*this, r);
+        testPackedConversions<AudioData::Int16,   AudioData::BigEndian>    (*this, r);
+        testPackedConversions<AudioData::Int24,   AudioData::LittleEndian> (*this, r);
+        testPackedConversions<AudioData::Int24,   AudioData::BigEndian>    (*this, r);
+        testPackedConversions<AudioData::Int32,   AudioData::LittleEndian> (*this, r);
+        testPackedConversions<AudioData::Int32,   AudioData::BigEndian>    (*this, r);
+        testPackedConversions<AudioData::Float32, AudioData::LittleEndian> (*this, r);
+        testPackedConversions<AudioData::Float32, AudioData::BigEndian>    (*this, r);
+        expectEquals (AudioDataConverters::getDataFormat<AudioData::Int24in32, AudioData::LittleEndian>(), -1);
+        expectEquals (AudioDataConverters::getDataFormat<AudioData::Int8, AudioData::BigEndian>(), -1);
         beginTest ("Round-trip conversion: Int8");
         Test1 <AudioData::Int8>::test (*this, r);
         beginTest ("Round-trip conversion: Int16");
@@ -704,7 +704,56 @@ public:
     static void deinterleaveSamples (const float* source, float** dest,
                                      int numSamples, int numChannels);
 
+    //==============================================================================
+    /** Splits a block of interleaved samples in one of the packed formats into separate
+        channels of floats, converting them in the same pass.
+
+        Any null pointers in the dest array are skipped, and any dest channels beyond
+        numSourceChannels are cleared. This has vectorised code-paths for the common
+        mono and stereo cases.
+    */
+    static void deinterleaveToFloat (DataFormat sourceFormat, const void* source, int numSourceChannels,
+                                     float* const* dest, int numDestChannels, int numSamples);
+
+    /** Splits a block of interleaved samples in one of the packed formats into separate
+        channels of 32-bit ints.
+
+        The integer formats are left-justified, so that e.g. a 16-bit sample ends up in the
+        top 16 bits of its int. The float formats are just byte-swapped if necessary, so the
+        ints will contain the raw bits of each float. Null dest pointers are skipped, and
+        any dest channels beyond numSourceChannels are cleared.
+    */
+    static void deinterleaveToInt32 (DataFormat sourceFormat, const void* source, int numSourceChannels,
+                                     int* const* dest, int numDestChannels, int numSamples);
+
+    /** Interleaves some channels of left-justified 32-bit ints into one of the packed formats.
+
+        This is the inverse of deinterleaveToInt32(): the integer formats keep the top bits of
+        each int, and the float formats store the ints' bits as they are. Any null pointers in
+        the source array produce silent channels.
+    */
+    static void interleaveFromInt32 (DataFormat destFormat, const int* const* source, int numChannels,
+                                     void* dest, int numSamples);
+
+    /** Returns the DataFormat that holds samples of one of the AudioData sample types in a
+        given AudioData endianness, or -1 if there isn't a matching one.
+    */
+    template <class SampleFormat, class Endianness>
+    static int getDataFormat() noexcept     { return getDataFormatFor ((const SampleFormat*) nullptr, (const Endianness*) nullptr); }
+
 private:
+    static int getDataFormatFor (const void*, const void*) noexcept                                         { return -1; }
+    static int getDataFormatFor (const AudioData::Int16*, const AudioData::LittleEndian*) noexcept          { return int16LE; }
+    static int getDataFormatFor (const AudioData::Int16*, const AudioData::BigEndian*) noexcept             { return int16BE; }
+    static int getDataFormatFor (const AudioData::Int24*, const AudioData::LittleEndian*) noexcept          { return int24LE; }
+    static int getDataFormatFor (const AudioData::Int24*, const AudioData::BigEndian*) noexcept             { return int24BE; }
+    static int getDataFormatFor (const AudioData::Int32*, const AudioData::LittleEndian*) noexcept          { return int32LE; }
+    static int getDataFormatFor (const AudioData::Int32*, const AudioData::BigEndian*) noexcept             { return int32BE; }
+    static int getDataFormatFor (const AudioData::Int24in32*, const AudioData::LittleEndian*) noexcept      { return -1; }
+    static int getDataFormatFor (const AudioData::Int24in32*, const AudioData::BigEndian*) noexcept         { return -1; }
+    static int getDataFormatFor (const AudioData::Float32*, const AudioData::LittleEndian*) noexcept        { return float32LE; }
+    static int getDataFormatFor (const AudioData::Float32*, const AudioData::BigEndian*) noexcept           { return float32BE; }
+
     AudioDataConverters();
     JUCE_DECLARE_NON_COPYABLE (AudioDataConverters)
 };
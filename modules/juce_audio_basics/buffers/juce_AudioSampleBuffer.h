@@ -629,14 +629,7 @@ public:
                 jassert (isPositiveAndBelow (channel, numChannels));
                 jassert (startSample >= 0 && startSample + numSamples <= size);
 
-                const Type increment = (endGain - startGain) / numSamples;
-                auto* d = channels [channel] + startSample;
-
-                while (--numSamples >= 0)
-                {
-                    *d++ *= startGain;
-                    startGain += increment;
-                }
+                FloatVectorOperations::multiplyWithRamp (channels [channel] + startSample, startGain, endGain, numSamples);
             }
         }
     }
@@ -785,14 +778,7 @@ public:
             if (numSamples > 0 && (startGain != 0 || endGain != 0))
             {
                 isClear = false;
-                const Type increment = (endGain - startGain) / numSamples;
-                auto* d = channels [destChannel] + destStartSample;
-
-                while (--numSamples >= 0)
-                {
-                    *d++ += startGain * *source++;
-                    startGain += increment;
-                }
+                FloatVectorOperations::addWithRamp (channels [destChannel] + destStartSample, source, startGain, endGain, numSamples);
             }
         }
     }
@@ -941,14 +927,7 @@ public:
             if (numSamples > 0 && (startGain != 0 || endGain != 0))
             {
                 isClear = false;
-                const Type increment = (endGain - startGain) / numSamples;
-                auto* d = channels [destChannel] + destStartSample;
-
-                while (--numSamples >= 0)
-                {
-                    *d++ = startGain * *source++;
-                    startGain += increment;
-                }
+                FloatVectorOperations::copyWithRamp (channels [destChannel] + destStartSample, source, startGain, endGain, numSamples);
             }
         }
     }
@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+/*  This file is deliberately included more than once by juce_FloatVectorOperations.cpp:
+    once inside the namespace for each of the wider x86 instruction sets. Each of those
+    namespaces declares Ops32 and Ops64 structs, and defines JUCE_WIDE_VECTOR_TARGET as the
+    attribute that lets the compiler use that instruction set in a function, so that these
+    kernels can live in the same binary as the baseline SSE code.
+
+    The wider instruction sets don't penalise unaligned loads and stores, so unlike the
+    SSE versions, these don't need separate aligned code-paths.
+*/
+
+// Each kernel's vector loop is wrapped in a scope which clears the upper halves of the vector
+// registers when it ends, because if any SSE code runs while they're dirty (including helper
+// functions called by the scalar loops that follow), some CPUs stall on every instruction.
+// Compilers don't always do this for functions that only enable AVX with an attribute.
+struct UpperStateClearer
+{
+    JUCE_WIDE_VECTOR_TARGET ~UpperStateClearer() noexcept  { _mm256_zeroupper(); }
+};
+
+template <typename Ops>
+struct Kernels
+{
+    typedef typename Ops::Type Type;
+    typedef typename Ops::ParallelType ParallelType;
+    enum { numParallel = Ops::numParallel };
+
+    JUCE_WIDE_VECTOR_TARGET static void add (Type* dest, const Type* src, int num) noexcept
+    {
+        int i = 0;
+
+        {
+            const UpperStateClearer clearer;
+
+            for (; i <= num - numParallel; i += numParallel)
+                Ops::storeU (dest + i, Ops::add (Ops::loadU (dest + i), Ops::loadU (src + i)));
+        }
+
+        for (; i < num; ++i)
+            dest[i] += src[i];
+    }
+
+    JUCE_WIDE_VECTOR_TARGET static void add (Type* dest, const Type* src1, const Type* src2, int num) noexcept
+    {
+        int i = 0;
+
+        {
+            const UpperStateClearer clearer;
+
+            for (; i <= num - numParallel; i += numParallel)
+                Ops::storeU (dest + i, Ops::add (Ops::loadU (src1 + i), Ops::loadU (src2 + i)));
+        }
+
+        for (; i < num; ++i)
+            dest[i] = src1[i] + src2[i];
+    }
+
+    JUCE_WIDE_VECTOR_TARGET static void addWithMultiply (Type* dest, const Type* src, Type multiplier, int num) noexcept
+    {
+        int i = 0;
+
+        {
+            const UpperStateClearer clearer;
+            const ParallelType mult = Ops::load1 (multiplier);
+
+            for (; i <= num - numParallel; i += numParallel)
+                Ops::storeU (dest + i, Ops::multiplyAdd (Ops::loadU (src + i), mult, Ops::loadU (dest + i)));
+        }
+
+        for (; i < num; ++i)
+            dest[i] += src[i] * multiplier;
+    }
+
+    JUCE_WIDE_VECTOR_TARGET static void addWithMultiply (Type* dest, const Type* src1, const Type* src2, int num) noexcept
+    {
+        int i = 0;
+
+        {
+            const UpperStateClearer clearer;
+
+            for (; i <= num - numParallel; i += numParallel)
+                Ops::storeU (dest + i, Ops::multiplyAdd (Ops::loadU (src1 + i), Ops::loadU (src2 + i), Ops::loadU (dest + i)));
+        }
+
+        for (; i < num; ++i)
+            dest[i] += src1[i] * src2[i];
+    }
+
+    JUCE_WIDE_VECTOR_TARGET static void multiply (Type* dest, const Type* src, int num) noexcept
+    {
+        int i = 0;
+
+        {
+            const UpperStateClearer clearer;
+
+            for (; i <= num - numParallel; i += numParallel)
+                Ops::storeU (dest + i, Ops::mul (Ops::loadU (dest + i), Ops::loadU (src + i)));
+        }
+
+        for (; i < num; ++i)
+            dest[i] *= src[i];
+    }
+
+    JUCE_WIDE_VECTOR_TARGET static void multiply (Type* dest, Type multiplier, int num) noexcept
+    {
+        int i = 0;
+
+        {
+            const UpperStateClearer clearer;
+            const ParallelType mult = Ops::load1 (multiplier);
+
+            for (; i <= num - numParallel; i += numParallel)
+                Ops::storeU (dest + i, Ops::mul (Ops::loadU (dest + i), mult));
+        }
+
+        for (; i < num; ++i)
+            dest[i] *= multiplier;
+    }
+
+    JUCE_WIDE_VECTOR_TARGET static void copyWithMultiply (Type* dest, const Type* src, Type multiplier, int num) noexcept
+    {
+        int i = 0;
+
+        {
+            const UpperStateClearer clearer;
+            const ParallelType mult = Ops::load1 (multiplier);
+
+            for (; i <= num - numParallel; i += numParallel)
+                Ops::storeU (dest + i, Ops::mul (mult, Ops::loadU (src + i)));
+        }
+
+        for (; i < num; ++i)
+            dest[i] = src[i] * multiplier;
+    }
+
+    JUCE_WIDE_VECTOR_TARGET static void clip (Type* dest, const Type* src, Type low, Type high, int num) noexcept
+    {
+        int i = 0;
+
+        {
+            const UpperStateClearer clearer;
+            const ParallelType lo = Ops::load1 (low);
+            const ParallelType hi = Ops::load1 (high);
+
+            for (; i <= num - numParallel; i += numParallel)
+                Ops::storeU (dest + i, Ops::max (Ops::min (Ops::loadU (src + i), hi), lo));
+        }
+
+        for (; i < num; ++i)
+            dest[i] = jmax (jmin (src[i], high), low);
+    }
+
+    JUCE_WIDE_VECTOR_TARGET static void convertFixedToFloat (Type* dest, const int* src, Type multiplier, int num) noexcept
+    {
+        int i = 0;
+
+        {
+            const UpperStateClearer clearer;
+            const ParallelType mult = Ops::load1 (multiplier);
+
+            for (; i <= num - numParallel; i += numParallel)
+                Ops::storeU (dest + i, Ops::mul (mult, Ops::loadIntsAsFloats (src + i)));
+        }
+
+        for (; i < num; ++i)
+            dest[i] = src[i] * multiplier;
+    }
+
+    JUCE_WIDE_VECTOR_TARGET static Range<Type> findMinAndMax (const Type* src, int num) noexcept
+    {
+        if (num < numParallel * 2)
+            return Range<Type>::findMinAndMax (src, num);
+
+        Type mins[numParallel], maxs[numParallel];
+        int i = numParallel;
+
+        {
+            const UpperStateClearer clearer;
+            ParallelType mn = Ops::loadU (src);
+            ParallelType mx = mn;
+
+            for (; i <= num - numParallel; i += numParallel)
+            {
+                const ParallelType v = Ops::loadU (src + i);
+                mn = Ops::min (mn, v);
+                mx = Ops::max (mx, v);
+            }
+
+            Ops::storeU (mins, mn);
+            Ops::storeU (maxs, mx);
+        }
+
+        Range<Type> result (juce::findMinimum (mins, (int) numParallel),
+                            juce::findMaximum (maxs, (int) numParallel));
+
+        for (; i < num; ++i)
+            result = result.getUnionWith (src[i]);
+
+        return result;
+    }
+};
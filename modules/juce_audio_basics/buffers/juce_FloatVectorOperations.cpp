@@ -481,6 +481,589 @@ namespace FloatVectorHelpers
             return Range<Type>::findMinAndMax (src, num);
         }
     };
+   #else
+    // On platforms without vector intrinsics, this lets the FusedOps templates below become plain loops
+    template <typename FloatType>
+    struct ScalarOps
+    {
+        typedef FloatType Type;
+        typedef FloatType ParallelType;
+        enum { numParallel = 1 };
+
+        static forcedinline ParallelType load1 (Type v) noexcept                        { return v; }
+        static forcedinline ParallelType loadU (const Type* v) noexcept                 { return *v; }
+        static forcedinline void storeU (Type* dest, ParallelType a) noexcept           { *dest = a; }
+
+        static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept  { return a + b; }
+        static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept  { return a * b; }
+        static forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept  { return jmax (a, b); }
+        static forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept  { return jmin (a, b); }
+    };
+
+    template<int typeSize> struct ModeType    { typedef ScalarOps<float> Mode; };
+    template<>             struct ModeType<8> { typedef ScalarOps<double> Mode; };
+   #endif
+
+    //==============================================================================
+    // These do the jobs of several of the simpler functions in a single pass over the data.
+    template <typename Mode>
+    struct FusedOps
+    {
+        typedef typename Mode::Type Type;
+        typedef typename Mode::ParallelType ParallelType;
+        enum { numParallel = Mode::numParallel };
+
+        enum RampType { rampDest, copySrcWithRamp, addSrcWithRamp };
+
+        // The gain for sample i is calculated as startGain + i * increment rather than by adding
+        // the increment for each sample, so that each lane of a vector can work out its own gain,
+        // and rounding errors don't accumulate over long blocks.
+        template <int rampType>
+        static void applyRamp (Type* dest, const Type* src, Type startGain, Type endGain, int num) noexcept
+        {
+            const Type increment = (endGain - startGain) / (Type) num;
+            const Type laneIndexes[] = { 0, 1, 2, 3 }; // (no vector type has more than 4 lanes)
+
+            const ParallelType start = Mode::load1 (startGain);
+            const ParallelType inc   = Mode::load1 (increment);
+            const ParallelType step  = Mode::load1 ((Type) numParallel);
+            ParallelType index = Mode::loadU (laneIndexes);
+            int i = 0;
+
+            for (; i <= num - numParallel; i += numParallel)
+            {
+                const ParallelType gain = Mode::add (start, Mode::mul (index, inc));
+                index = Mode::add (index, step);
+
+                if (rampType == rampDest)
+                    Mode::storeU (dest + i, Mode::mul (Mode::loadU (dest + i), gain));
+                else if (rampType == copySrcWithRamp)
+                    Mode::storeU (dest + i, Mode::mul (Mode::loadU (src + i), gain));
+                else
+                    Mode::storeU (dest + i, Mode::add (Mode::loadU (dest + i), Mode::mul (Mode::loadU (src + i), gain)));
+            }
+
+            for (; i < num; ++i)
+            {
+                const Type gain = startGain + (Type) i * increment;
+
+                if (rampType == rampDest)              dest[i] *= gain;
+                else if (rampType == copySrcWithRamp)  dest[i] = src[i] * gain;
+                else                                   dest[i] += src[i] * gain;
+            }
+        }
+
+        static void addWithMultiply (Type* dest, const Type* const* sources, const Type* multipliers, int numSources, int num) noexcept
+        {
+            // This many multipliers are kept in registers; any further sources are added in another pass
+            enum { maxSourcesPerPass = 8 };
+
+            for (int first = 0; first < numSources; first += maxSourcesPerPass)
+            {
+                const int numInPass = jmin ((int) maxSourcesPerPass, numSources - first);
+                const Type* const* const srcs = sources + first;
+                const Type* const mults = multipliers + first;
+
+                ParallelType parallelMults[maxSourcesPerPass];
+
+                for (int s = 0; s < numInPass; ++s)
+                    parallelMults[s] = Mode::load1 (mults[s]);
+
+                int i = 0;
+
+                for (; i <= num - numParallel; i += numParallel)
+                {
+                    ParallelType sum = Mode::loadU (dest + i);
+
+                    for (int s = 0; s < numInPass; ++s)
+                        sum = Mode::add (sum, Mode::mul (Mode::loadU (srcs[s] + i), parallelMults[s]));
+
+                    Mode::storeU (dest + i, sum);
+                }
+
+                for (; i < num; ++i)
+                {
+                    Type sum = dest[i];
+
+                    for (int s = 0; s < numInPass; ++s)
+                        sum += srcs[s][i] * mults[s];
+
+                    dest[i] = sum;
+                }
+            }
+        }
+
+        static void addWithClip (Type* dest, const Type* src, Type low, Type high, int num) noexcept
+        {
+            const ParallelType lo = Mode::load1 (low);
+            const ParallelType hi = Mode::load1 (high);
+            int i = 0;
+
+            for (; i <= num - numParallel; i += numParallel)
+                Mode::storeU (dest + i, Mode::max (Mode::min (Mode::add (Mode::loadU (dest + i), Mode::loadU (src + i)), hi), lo));
+
+            for (; i < num; ++i)
+                dest[i] = jmax (jmin (dest[i] + src[i], high), low);
+        }
+
+        static Range<Type> addWithMultiplyAndFindMinAndMax (Type* dest, const Type* src, Type multiplier, int num) noexcept
+        {
+            if (num < numParallel)
+            {
+                for (int i = 0; i < num; ++i)
+                    dest[i] += src[i] * multiplier;
+
+                return Range<Type>::findMinAndMax (dest, num);
+            }
+
+            const ParallelType mult = Mode::load1 (multiplier);
+            ParallelType mn = Mode::add (Mode::loadU (dest), Mode::mul (Mode::loadU (src), mult));
+            ParallelType mx = mn;
+            Mode::storeU (dest, mn);
+            int i = numParallel;
+
+            for (; i <= num - numParallel; i += numParallel)
+            {
+                const ParallelType v = Mode::add (Mode::loadU (dest + i), Mode::mul (Mode::loadU (src + i), mult));
+                Mode::storeU (dest + i, v);
+                mn = Mode::min (mn, v);
+                mx = Mode::max (mx, v);
+            }
+
+            Type mins[numParallel], maxs[numParallel];
+            Mode::storeU (mins, mn);
+            Mode::storeU (maxs, mx);
+
+            Range<Type> result (juce::findMinimum (mins, (int) numParallel),
+                                juce::findMaximum (maxs, (int) numParallel));
+
+            for (; i < num; ++i)
+            {
+                dest[i] += src[i] * multiplier;
+                result = result.getUnionWith (dest[i]);
+            }
+
+            return result;
+        }
+    };
+
+    //==============================================================================
+    // These do as many whole vectors of samples as they can, for the channel counts which have
+    // vector versions, and return the number of samples that they've done.
+    static int interleaveVectors (float* dest, const float* const* src, int numChannels, int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        if (numChannels == 2)
+        {
+            for (; i <= num - 4; i += 4)
+            {
+                const __m128 a = _mm_loadu_ps (src[0] + i);
+                const __m128 b = _mm_loadu_ps (src[1] + i);
+                _mm_storeu_ps (dest + 2 * i,     _mm_unpacklo_ps (a, b));
+                _mm_storeu_ps (dest + 2 * i + 4, _mm_unpackhi_ps (a, b));
+            }
+        }
+        else if (numChannels % 4 == 0)
+        {
+            // each group of 4 channels is a 4x4 transpose
+            for (; i <= num - 4; i += 4)
+            {
+                for (int ch = 0; ch < numChannels; ch += 4)
+                {
+                    __m128 r0 = _mm_loadu_ps (src[ch] + i),     r1 = _mm_loadu_ps (src[ch + 1] + i);
+                    __m128 r2 = _mm_loadu_ps (src[ch + 2] + i), r3 = _mm_loadu_ps (src[ch + 3] + i);
+                    _MM_TRANSPOSE4_PS (r0, r1, r2, r3);
+
+                    float* const d = dest + i * numChannels + ch;
+                    _mm_storeu_ps (d, r0);
+                    _mm_storeu_ps (d + numChannels, r1);
+                    _mm_storeu_ps (d + numChannels * 2, r2);
+                    _mm_storeu_ps (d + numChannels * 3, r3);
+                }
+            }
+        }
+       #elif JUCE_USE_ARM_NEON
+        if (numChannels == 2)
+        {
+            for (; i <= num - 4; i += 4)
+            {
+                float32x4x2_t v;
+                v.val[0] = vld1q_f32 (src[0] + i);
+                v.val[1] = vld1q_f32 (src[1] + i);
+                vst2q_f32 (dest + 2 * i, v);
+            }
+        }
+        else if (numChannels == 4)
+        {
+            for (; i <= num - 4; i += 4)
+            {
+                float32x4x4_t v;
+                v.val[0] = vld1q_f32 (src[0] + i);
+                v.val[1] = vld1q_f32 (src[1] + i);
+                v.val[2] = vld1q_f32 (src[2] + i);
+                v.val[3] = vld1q_f32 (src[3] + i);
+                vst4q_f32 (dest + 4 * i, v);
+            }
+        }
+       #else
+        ignoreUnused (dest, src, numChannels, num);
+       #endif
+
+        return i;
+    }
+
+    static int deinterleaveVectors (float* const* dest, const float* src, int numChannels, int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        if (numChannels == 2)
+        {
+            for (; i <= num - 4; i += 4)
+            {
+                const __m128 a = _mm_loadu_ps (src + 2 * i);
+                const __m128 b = _mm_loadu_ps (src + 2 * i + 4);
+                _mm_storeu_ps (dest[0] + i, _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0)));
+                _mm_storeu_ps (dest[1] + i, _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1)));
+            }
+        }
+        else if (numChannels % 4 == 0)
+        {
+            for (; i <= num - 4; i += 4)
+            {
+                for (int ch = 0; ch < numChannels; ch += 4)
+                {
+                    const float* const s = src + i * numChannels + ch;
+                    __m128 r0 = _mm_loadu_ps (s),                   r1 = _mm_loadu_ps (s + numChannels);
+                    __m128 r2 = _mm_loadu_ps (s + numChannels * 2), r3 = _mm_loadu_ps (s + numChannels * 3);
+                    _MM_TRANSPOSE4_PS (r0, r1, r2, r3);
+
+                    _mm_storeu_ps (dest[ch] + i, r0);
+                    _mm_storeu_ps (dest[ch + 1] + i, r1);
+                    _mm_storeu_ps (dest[ch + 2] + i, r2);
+                    _mm_storeu_ps (dest[ch + 3] + i, r3);
+                }
+            }
+        }
+       #elif JUCE_USE_ARM_NEON
+        if (numChannels == 2)
+        {
+            for (; i <= num - 4; i += 4)
+            {
+                const float32x4x2_t v = vld2q_f32 (src + 2 * i);
+                vst1q_f32 (dest[0] + i, v.val[0]);
+                vst1q_f32 (dest[1] + i, v.val[1]);
+            }
+        }
+        else if (numChannels == 4)
+        {
+            for (; i <= num - 4; i += 4)
+            {
+                const float32x4x4_t v = vld4q_f32 (src + 4 * i);
+                vst1q_f32 (dest[0] + i, v.val[0]);
+                vst1q_f32 (dest[1] + i, v.val[1]);
+                vst1q_f32 (dest[2] + i, v.val[2]);
+                vst1q_f32 (dest[3] + i, v.val[3]);
+            }
+        }
+       #else
+        ignoreUnused (dest, src, numChannels, num);
+       #endif
+
+        return i;
+    }
+
+    //==============================================================================
+    // The dithered conversions add triangular-PDF noise of up to +/-1 LSB, made from the difference
+    // of two uniform values from a xorshift generator. The vector version runs a separate sequence
+    // in each lane, where lane 0 follows the same sequence as the scalar version.
+    static forcedinline uint32 nextRandom (uint32 x) noexcept
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        return x ^ (x << 5);
+    }
+
+    static forcedinline float nextDither (uint32& seed) noexcept
+    {
+        const int a = (int) ((seed = nextRandom (seed)) >> 8);
+        const int b = (int) ((seed = nextRandom (seed)) >> 8);
+        return (float) (a - b) * (1.0f / (1 << 24));
+    }
+
+   #if JUCE_USE_SSE_INTRINSICS
+    struct DitherVector
+    {
+        // (multiplying by an odd number can't turn a non-zero seed into zero, which xorshift can't escape from)
+        DitherVector (uint32 seed) noexcept
+            : state (_mm_set_epi32 ((int) nextRandom (seed * 7), (int) nextRandom (seed * 5), (int) nextRandom (seed * 3), (int) seed))
+        {}
+
+        forcedinline __m128 next() noexcept
+        {
+            const __m128i a = _mm_srli_epi32 (step(), 8);
+            const __m128i b = _mm_srli_epi32 (step(), 8);
+            return _mm_mul_ps (_mm_cvtepi32_ps (_mm_sub_epi32 (a, b)), _mm_set1_ps (1.0f / (1 << 24)));
+        }
+
+        uint32 getSeed() const noexcept     { return (uint32) _mm_cvtsi128_si32 (state); }
+
+    private:
+        forcedinline __m128i step() noexcept
+        {
+            state = _mm_xor_si128 (state, _mm_slli_epi32 (state, 13));
+            state = _mm_xor_si128 (state, _mm_srli_epi32 (state, 17));
+            state = _mm_xor_si128 (state, _mm_slli_epi32 (state, 5));
+            return state;
+        }
+
+        __m128i state;
+    };
+   #endif
+
+    template <bool dithered>
+    static void convertFloatToInt16 (int16* dest, const float* src, int num, uint32& seed) noexcept
+    {
+        const float maxVal = (float) 0x7fff;
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const __m128 hi = _mm_set1_ps (maxVal);
+        const __m128 lo = _mm_set1_ps (-maxVal);
+        DitherVector dither (seed);
+
+        for (; i <= num - 8; i += 8)
+        {
+            __m128 a = _mm_mul_ps (_mm_loadu_ps (src + i), hi);
+            __m128 b = _mm_mul_ps (_mm_loadu_ps (src + i + 4), hi);
+
+            if (dithered)
+            {
+                a = _mm_add_ps (a, dither.next());
+                b = _mm_add_ps (b, dither.next());
+            }
+
+            const __m128i ints1 = _mm_cvtps_epi32 (_mm_max_ps (_mm_min_ps (a, hi), lo));
+            const __m128i ints2 = _mm_cvtps_epi32 (_mm_max_ps (_mm_min_ps (b, hi), lo));
+            _mm_storeu_si128 ((__m128i*) (dest + i), _mm_packs_epi32 (ints1, ints2));
+        }
+
+        if (dithered)
+            seed = dither.getSeed();
+       #endif
+
+        for (; i < num; ++i)
+            dest[i] = (int16) roundToInt (jlimit (-maxVal, maxVal, maxVal * src[i] + (dithered ? nextDither (seed) : 0.0f)));
+    }
+
+    // The 24 and 32-bit versions are scaled in double precision, because a float's
+    // mantissa isn't big enough to hold the results exactly.
+    template <bool dithered>
+    static void convertFloatToInt (int32* dest, const float* src, double maxVal, int num, uint32& seed) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const __m128d hi = _mm_set1_pd (maxVal);
+        const __m128d lo = _mm_set1_pd (-maxVal);
+        DitherVector dither (seed);
+
+        for (; i <= num - 4; i += 4)
+        {
+            const __m128 s = _mm_loadu_ps (src + i);
+            __m128d a = _mm_mul_pd (_mm_cvtps_pd (s), hi);
+            __m128d b = _mm_mul_pd (_mm_cvtps_pd (_mm_movehl_ps (s, s)), hi);
+
+            if (dithered)
+            {
+                const __m128 d = dither.next();
+                a = _mm_add_pd (a, _mm_cvtps_pd (d));
+                b = _mm_add_pd (b, _mm_cvtps_pd (_mm_movehl_ps (d, d)));
+            }
+
+            const __m128i ints1 = _mm_cvtpd_epi32 (_mm_max_pd (_mm_min_pd (a, hi), lo));
+            const __m128i ints2 = _mm_cvtpd_epi32 (_mm_max_pd (_mm_min_pd (b, hi), lo));
+            _mm_storeu_si128 ((__m128i*) (dest + i), _mm_unpacklo_epi64 (ints1, ints2));
+        }
+
+        if (dithered)
+            seed = dither.getSeed();
+       #endif
+
+        for (; i < num; ++i)
+            dest[i] = roundToInt (jlimit (-maxVal, maxVal, maxVal * src[i] + (dithered ? (double) nextDither (seed) : 0.0)));
+    }
+
+    static void convertInt16ToFloat (float* dest, const int16* src, float multiplier, int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const __m128 mult = _mm_set1_ps (multiplier);
+
+        for (; i <= num - 8; i += 8)
+        {
+            // (unpacking each 16-bit value into the top of a 32-bit lane and shifting it back down sign-extends it)
+            const __m128i v = _mm_loadu_si128 ((const __m128i*) (src + i));
+            _mm_storeu_ps (dest + i,     _mm_mul_ps (mult, _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpacklo_epi16 (v, v), 16))));
+            _mm_storeu_ps (dest + i + 4, _mm_mul_ps (mult, _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpackhi_epi16 (v, v), 16))));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            dest[i] = multiplier * src[i];
+    }
+
+    //==============================================================================
+   #if JUCE_USE_AVX_INTRINSICS
+    #if JUCE_MSVC
+     #define JUCE_AVX2_TARGET
+     #define JUCE_AVX512_TARGET
+    #else
+     #define JUCE_AVX2_TARGET    __attribute__ ((target ("avx2,fma")))
+     #define JUCE_AVX512_TARGET  __attribute__ ((target ("avx512f,avx2,fma")))
+    #endif
+
+    namespace AVX2
+    {
+        #define JUCE_WIDE_VECTOR_TARGET JUCE_AVX2_TARGET
+
+        struct Ops32
+        {
+            typedef float Type;
+            typedef __m256 ParallelType;
+            enum { numParallel = 8 };
+
+            JUCE_AVX2_TARGET static forcedinline ParallelType load1 (Type v) noexcept                        { return _mm256_set1_ps (v); }
+            JUCE_AVX2_TARGET static forcedinline ParallelType loadU (const Type* v) noexcept                 { return _mm256_loadu_ps (v); }
+            JUCE_AVX2_TARGET static forcedinline void storeU (Type* dest, ParallelType a) noexcept           { _mm256_storeu_ps (dest, a); }
+            JUCE_AVX2_TARGET static forcedinline ParallelType loadIntsAsFloats (const int* v) noexcept       { return _mm256_cvtepi32_ps (_mm256_loadu_si256 ((const __m256i*) v)); }
+
+            JUCE_AVX2_TARGET static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm256_add_ps (a, b); }
+            JUCE_AVX2_TARGET static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm256_mul_ps (a, b); }
+            JUCE_AVX2_TARGET static forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm256_max_ps (a, b); }
+            JUCE_AVX2_TARGET static forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm256_min_ps (a, b); }
+
+            // returns (a * b) + c
+            JUCE_AVX2_TARGET static forcedinline ParallelType multiplyAdd (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm256_fmadd_ps (a, b, c); }
+        };
+
+        struct Ops64
+        {
+            typedef double Type;
+            typedef __m256d ParallelType;
+            enum { numParallel = 4 };
+
+            JUCE_AVX2_TARGET static forcedinline ParallelType load1 (Type v) noexcept                        { return _mm256_set1_pd (v); }
+            JUCE_AVX2_TARGET static forcedinline ParallelType loadU (const Type* v) noexcept                 { return _mm256_loadu_pd (v); }
+            JUCE_AVX2_TARGET static forcedinline void storeU (Type* dest, ParallelType a) noexcept           { _mm256_storeu_pd (dest, a); }
+
+            JUCE_AVX2_TARGET static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm256_add_pd (a, b); }
+            JUCE_AVX2_TARGET static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm256_mul_pd (a, b); }
+            JUCE_AVX2_TARGET static forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm256_max_pd (a, b); }
+            JUCE_AVX2_TARGET static forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm256_min_pd (a, b); }
+
+            // returns (a * b) + c
+            JUCE_AVX2_TARGET static forcedinline ParallelType multiplyAdd (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm256_fmadd_pd (a, b, c); }
+        };
+
+        #include "juce_FloatVectorKernels.h"
+        #undef JUCE_WIDE_VECTOR_TARGET
+    }
+
+    namespace AVX512
+    {
+        #define JUCE_WIDE_VECTOR_TARGET JUCE_AVX512_TARGET
+
+        // The masked forms of min, max and int conversion are used with a full mask because
+        // some versions of gcc give false maybe-uninitialised warnings for the unmasked ones.
+
+        struct Ops32
+        {
+            typedef float Type;
+            typedef __m512 ParallelType;
+            enum { numParallel = 16 };
+
+            JUCE_AVX512_TARGET static forcedinline ParallelType load1 (Type v) noexcept                        { return _mm512_set1_ps (v); }
+            JUCE_AVX512_TARGET static forcedinline ParallelType loadU (const Type* v) noexcept                 { return _mm512_loadu_ps (v); }
+            JUCE_AVX512_TARGET static forcedinline void storeU (Type* dest, ParallelType a) noexcept           { _mm512_storeu_ps (dest, a); }
+            JUCE_AVX512_TARGET static forcedinline ParallelType loadIntsAsFloats (const int* v) noexcept       { return _mm512_maskz_cvtepi32_ps (0xffff, _mm512_loadu_si512 (v)); }
+
+            JUCE_AVX512_TARGET static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm512_add_ps (a, b); }
+            JUCE_AVX512_TARGET static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm512_mul_ps (a, b); }
+            JUCE_AVX512_TARGET static forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm512_maskz_max_ps (0xffff, a, b); }
+            JUCE_AVX512_TARGET static forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm512_maskz_min_ps (0xffff, a, b); }
+
+            // returns (a * b) + c
+            JUCE_AVX512_TARGET static forcedinline ParallelType multiplyAdd (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm512_fmadd_ps (a, b, c); }
+        };
+
+        struct Ops64
+        {
+            typedef double Type;
+            typedef __m512d ParallelType;
+            enum { numParallel = 8 };
+
+            JUCE_AVX512_TARGET static forcedinline ParallelType load1 (Type v) noexcept                        { return _mm512_set1_pd (v); }
+            JUCE_AVX512_TARGET static forcedinline ParallelType loadU (const Type* v) noexcept                 { return _mm512_loadu_pd (v); }
+            JUCE_AVX512_TARGET static forcedinline void storeU (Type* dest, ParallelType a) noexcept           { _mm512_storeu_pd (dest, a); }
+
+            JUCE_AVX512_TARGET static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm512_add_pd (a, b); }
+            JUCE_AVX512_TARGET static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm512_mul_pd (a, b); }
+            JUCE_AVX512_TARGET static forcedinline ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm512_maskz_max_pd (0xff, a, b); }
+            JUCE_AVX512_TARGET static forcedinline ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm512_maskz_min_pd (0xff, a, b); }
+
+            // returns (a * b) + c
+            JUCE_AVX512_TARGET static forcedinline ParallelType multiplyAdd (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm512_fmadd_pd (a, b, c); }
+        };
+
+        #include "juce_FloatVectorKernels.h"
+        #undef JUCE_WIDE_VECTOR_TARGET
+    }
+
+    static FloatVectorOperations::InstructionSet findBestInstructionSet() noexcept
+    {
+        if (SystemStats::hasAVX512F())
+            return FloatVectorOperations::avx512InstructionSet;
+
+        if (SystemStats::hasAVX2() && SystemStats::hasFMA3())
+            return FloatVectorOperations::avx2InstructionSet;
+
+        return FloatVectorOperations::baselineInstructionSet;
+    }
+
+    static Atomic<int> activeInstructionSet (-1);
+
+    static forcedinline int getActiveInstructionSet() noexcept
+    {
+        int set = activeInstructionSet.get();
+
+        if (set < 0)
+        {
+            set = (int) findBestInstructionSet();
+            activeInstructionSet = set;
+        }
+
+        return set;
+    }
+
+    // Below this size, the SSE loops finish before the wider ones have paid for themselves
+    enum { minimumSizeForWideKernels = 16 };
+
+    #define JUCE_PERFORM_WIDE_VEC_OP(bits, kernelCall) \
+        if (num >= FloatVectorHelpers::minimumSizeForWideKernels) \
+        { \
+            switch (FloatVectorHelpers::getActiveInstructionSet()) \
+            { \
+                case FloatVectorOperations::avx512InstructionSet:  return FloatVectorHelpers::AVX512::Kernels<FloatVectorHelpers::AVX512::Ops##bits>::kernelCall; \
+                case FloatVectorOperations::avx2InstructionSet:    return FloatVectorHelpers::AVX2::Kernels<FloatVectorHelpers::AVX2::Ops##bits>::kernelCall; \
+                default:                                           break; \
+            } \
+        }
+   #else
+    #define JUCE_PERFORM_WIDE_VEC_OP(bits, kernelCall)
    #endif
 }
 
@@ -549,6 +1132,7 @@ void JUCE_CALLTYPE FloatVectorOperations::copyWithMultiply (float* dest, const f
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmul (src, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (32, copyWithMultiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -560,6 +1144,7 @@ void JUCE_CALLTYPE FloatVectorOperations::copyWithMultiply (double* dest, const
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmulD (src, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (64, copyWithMultiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -609,6 +1194,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src, in
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vadd (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (32, add (dest, src, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i], Mode::add (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -618,6 +1204,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, const double* src,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vaddD (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (64, add (dest, src, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i], Mode::add (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -627,6 +1214,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src1, c
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vadd (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (32, add (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] + src2[i], Mode::add (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -636,6 +1224,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, const double* src1,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vaddD (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (64, add (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] + src2[i], Mode::add (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -681,6 +1270,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const fl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsma (src, 1, &multiplier, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (32, addWithMultiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i] * multiplier, Mode::add (d, Mode::mul (mult, s)),
                                   JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -689,6 +1279,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const fl
 
 void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (double* dest, const double* src, double multiplier, int num) noexcept
 {
+    JUCE_PERFORM_WIDE_VEC_OP (64, addWithMultiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i] * multiplier, Mode::add (d, Mode::mul (mult, s)),
                                   JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -699,6 +1290,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const fl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vma ((float*) src1, 1, (float*) src2, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (32, addWithMultiply (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] += src1[i] * src2[i], Mode::add (d, Mode::mul (s1, s2)),
                                              JUCE_LOAD_SRC1_SRC2_DEST,
                                              JUCE_INCREMENT_SRC1_SRC2_DEST, )
@@ -710,6 +1302,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (double* dest, const d
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmaD ((double*) src1, 1, (double*) src2, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (64, addWithMultiply (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] += src1[i] * src2[i], Mode::add (d, Mode::mul (s1, s2)),
                                              JUCE_LOAD_SRC1_SRC2_DEST,
                                              JUCE_INCREMENT_SRC1_SRC2_DEST, )
@@ -721,6 +1314,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmul (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (32, multiply (dest, src, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] *= src[i], Mode::mul (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -730,6 +1324,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, const double*
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmulD (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (64, multiply (dest, src, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] *= src[i], Mode::mul (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -757,6 +1352,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, float multiplie
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmul (dest, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (32, multiply (dest, multiplier, num))
     JUCE_PERFORM_VEC_OP_DEST (dest[i] *= multiplier, Mode::mul (d, mult), JUCE_LOAD_DEST,
                               const Mode::ParallelType mult = Mode::load1 (multiplier);)
    #endif
@@ -767,6 +1363,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, double multipl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmulD (dest, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (64, multiply (dest, multiplier, num))
     JUCE_PERFORM_VEC_OP_DEST (dest[i] *= multiplier, Mode::mul (d, mult), JUCE_LOAD_DEST,
                               const Mode::ParallelType mult = Mode::load1 (multiplier);)
    #endif
@@ -774,6 +1371,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, double multipl
 
 void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* src, float multiplier, int num) noexcept
 {
+    JUCE_PERFORM_WIDE_VEC_OP (32, copyWithMultiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -781,6 +1379,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* sr
 
 void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, const double* src, double multiplier, int num) noexcept
 {
+    JUCE_PERFORM_WIDE_VEC_OP (64, copyWithMultiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -842,6 +1441,7 @@ void JUCE_CALLTYPE FloatVectorOperations::convertFixedToFloat (float* dest, cons
                                   vmulq_n_f32 (vcvtq_f32_s32 (vld1q_s32 (src)), multiplier),
                                   JUCE_LOAD_NONE, JUCE_INCREMENT_SRC_DEST, )
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (32, convertFixedToFloat (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier,
                                   Mode::mul (mult, _mm_cvtepi32_ps (_mm_loadu_si128 ((const __m128i*) src))),
                                   JUCE_LOAD_NONE, JUCE_INCREMENT_SRC_DEST,
@@ -920,6 +1520,7 @@ void JUCE_CALLTYPE FloatVectorOperations::clip (float* dest, const float* src, f
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vclip ((float*) src, 1, &low, &high, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (32, clip (dest, src, low, high, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = jmax (jmin (src[i], high), low), Mode::max (Mode::min (s, hi), lo),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType lo = Mode::load1 (low); const Mode::ParallelType hi = Mode::load1 (high);)
@@ -933,6 +1534,7 @@ void JUCE_CALLTYPE FloatVectorOperations::clip (double* dest, const double* src,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vclipD ((double*) src, 1, &low, &high, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_PERFORM_WIDE_VEC_OP (64, clip (dest, src, low, high, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = jmax (jmin (src[i], high), low), Mode::max (Mode::min (s, hi), lo),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType lo = Mode::load1 (low); const Mode::ParallelType hi = Mode::load1 (high);)
@@ -942,6 +1544,7 @@ void JUCE_CALLTYPE FloatVectorOperations::clip (double* dest, const double* src,
 Range<float> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const float* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_PERFORM_WIDE_VEC_OP (32, findMinAndMax (src, num))
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps32>::findMinAndMax (src, num);
    #else
     return Range<float>::findMinAndMax (src, num);
@@ -951,6 +1554,7 @@ Range<float> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const float* sr
 Range<double> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const double* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_PERFORM_WIDE_VEC_OP (64, findMinAndMax (src, num))
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps64>::findMinAndMax (src, num);
    #else
     return Range<double>::findMinAndMax (src, num);
@@ -993,6 +1597,162 @@ double JUCE_CALLTYPE FloatVectorOperations::findMaximum (const double* src, int
    #endif
 }
 
+//==============================================================================
+void JUCE_CALLTYPE FloatVectorOperations::multiplyWithRamp (float* dest, float startGain, float endGain, int num) noexcept
+{
+    typedef FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (float)>::Mode> Ops;
+    Ops::applyRamp<Ops::rampDest> (dest, nullptr, startGain, endGain, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::multiplyWithRamp (double* dest, double startGain, double endGain, int num) noexcept
+{
+    typedef FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (double)>::Mode> Ops;
+    Ops::applyRamp<Ops::rampDest> (dest, nullptr, startGain, endGain, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::copyWithRamp (float* dest, const float* src, float startGain, float endGain, int num) noexcept
+{
+    typedef FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (float)>::Mode> Ops;
+    Ops::applyRamp<Ops::copySrcWithRamp> (dest, src, startGain, endGain, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::copyWithRamp (double* dest, const double* src, double startGain, double endGain, int num) noexcept
+{
+    typedef FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (double)>::Mode> Ops;
+    Ops::applyRamp<Ops::copySrcWithRamp> (dest, src, startGain, endGain, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::addWithRamp (float* dest, const float* src, float startGain, float endGain, int num) noexcept
+{
+    typedef FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (float)>::Mode> Ops;
+    Ops::applyRamp<Ops::addSrcWithRamp> (dest, src, startGain, endGain, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::addWithRamp (double* dest, const double* src, double startGain, double endGain, int num) noexcept
+{
+    typedef FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (double)>::Mode> Ops;
+    Ops::applyRamp<Ops::addSrcWithRamp> (dest, src, startGain, endGain, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const float* const* sources, const float* multipliers, int numSources, int num) noexcept
+{
+    FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (float)>::Mode>::addWithMultiply (dest, sources, multipliers, numSources, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (double* dest, const double* const* sources, const double* multipliers, int numSources, int num) noexcept
+{
+    FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (double)>::Mode>::addWithMultiply (dest, sources, multipliers, numSources, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::addWithClip (float* dest, const float* src, float low, float high, int num) noexcept
+{
+    jassert (high >= low);
+    FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (float)>::Mode>::addWithClip (dest, src, low, high, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::addWithClip (double* dest, const double* src, double low, double high, int num) noexcept
+{
+    jassert (high >= low);
+    FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (double)>::Mode>::addWithClip (dest, src, low, high, num);
+}
+
+Range<float> JUCE_CALLTYPE FloatVectorOperations::addWithMultiplyAndFindMinAndMax (float* dest, const float* src, float multiplier, int num) noexcept
+{
+    return FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (float)>::Mode>::addWithMultiplyAndFindMinAndMax (dest, src, multiplier, num);
+}
+
+Range<double> JUCE_CALLTYPE FloatVectorOperations::addWithMultiplyAndFindMinAndMax (double* dest, const double* src, double multiplier, int num) noexcept
+{
+    return FloatVectorHelpers::FusedOps<FloatVectorHelpers::ModeType<sizeof (double)>::Mode>::addWithMultiplyAndFindMinAndMax (dest, src, multiplier, num);
+}
+
+//==============================================================================
+void JUCE_CALLTYPE FloatVectorOperations::interleave (float* dest, const float* const* sources, int numChannels, int num) noexcept
+{
+    const int numDone = FloatVectorHelpers::interleaveVectors (dest, sources, numChannels, num);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* const src = sources[ch];
+
+        for (int i = numDone; i < num; ++i)
+            dest[i * numChannels + ch] = src[i];
+    }
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::deinterleave (float* const* dests, const float* src, int numChannels, int num) noexcept
+{
+    const int numDone = FloatVectorHelpers::deinterleaveVectors (dests, src, numChannels, num);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* const dest = dests[ch];
+
+        for (int i = numDone; i < num; ++i)
+            dest[i] = src[i * numChannels + ch];
+    }
+}
+
+//==============================================================================
+void JUCE_CALLTYPE FloatVectorOperations::convertFloatToInt16 (int16* dest, const float* src, int num, uint32* ditherSeed) noexcept
+{
+    if (ditherSeed != nullptr)
+    {
+        if (*ditherSeed == 0)
+            *ditherSeed = 1;
+
+        FloatVectorHelpers::convertFloatToInt16<true> (dest, src, num, *ditherSeed);
+    }
+    else
+    {
+        uint32 unusedSeed = 0;
+        FloatVectorHelpers::convertFloatToInt16<false> (dest, src, num, unusedSeed);
+    }
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::convertFloatToInt24 (int32* dest, const float* src, int num, uint32* ditherSeed) noexcept
+{
+    if (ditherSeed != nullptr)
+    {
+        if (*ditherSeed == 0)
+            *ditherSeed = 1;
+
+        FloatVectorHelpers::convertFloatToInt<true> (dest, src, (double) 0x7fffff, num, *ditherSeed);
+    }
+    else
+    {
+        uint32 unusedSeed = 0;
+        FloatVectorHelpers::convertFloatToInt<false> (dest, src, (double) 0x7fffff, num, unusedSeed);
+    }
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::convertFloatToInt32 (int32* dest, const float* src, int num) noexcept
+{
+    uint32 unusedSeed = 0;
+    FloatVectorHelpers::convertFloatToInt<false> (dest, src, (double) 0x7fffffff, num, unusedSeed);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::convertInt16ToFloat (float* dest, const int16* src, int num) noexcept
+{
+    FloatVectorHelpers::convertInt16ToFloat (dest, src, 1.0f / 0x7fff, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::convertInt16ToFloat (float* dest, const int16* src, float multiplier, int num) noexcept
+{
+    FloatVectorHelpers::convertInt16ToFloat (dest, src, multiplier, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::convertInt24ToFloat (float* dest, const int32* src, int num) noexcept
+{
+    convertFixedToFloat (dest, src, 1.0f / 0x7fffff, num);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::convertInt32ToFloat (float* dest, const int32* src, int num) noexcept
+{
+    convertFixedToFloat (dest, src, 1.0f / 0x7fffffff, num);
+}
+
+//==============================================================================
 void JUCE_CALLTYPE FloatVectorOperations::enableFlushToZeroMode (bool shouldEnable) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS
@@ -1009,6 +1769,26 @@ void JUCE_CALLTYPE FloatVectorOperations::disableDenormalisedNumberSupport() noe
    #endif
 }
 
+FloatVectorOperations::InstructionSet JUCE_CALLTYPE FloatVectorOperations::setMaximumInstructionSet (InstructionSet maximumToUse) noexcept
+{
+   #if JUCE_USE_AVX_INTRINSICS
+    FloatVectorHelpers::activeInstructionSet = jmin ((int) maximumToUse, (int) FloatVectorHelpers::findBestInstructionSet());
+   #else
+    ignoreUnused (maximumToUse);
+   #endif
+
+    return getActiveInstructionSet();
+}
+
+FloatVectorOperations::InstructionSet JUCE_CALLTYPE FloatVectorOperations::getActiveInstructionSet() noexcept
+{
+   #if JUCE_USE_AVX_INTRINSICS
+    return (InstructionSet) FloatVectorHelpers::getActiveInstructionSet();
+   #else
+    return baselineInstructionSet;
+   #endif
+}
+
 //==============================================================================
 //==============================================================================
 #if JUCE_UNIT_TESTS
@@ -1026,8 +1806,8 @@ public:
             const int range = random.nextBool() ? 500 : 10;
             const int num = random.nextInt (range) + 1;
 
-            HeapBlock<ValueType> buffer1 ((size_t) num + 16), buffer2 ((size_t) num + 16);
-            HeapBlock<int> buffer3 ((size_t) num + 16);
+            HeapBlock<ValueType> buffer1 ((size_t) num + 16, true), buffer2 ((size_t) num + 16, true);
+            HeapBlock<int> buffer3 ((size_t) num + 16, true);
 
            #if JUCE_ARM
             ValueType* const data1 = buffer1;
@@ -1098,6 +1878,82 @@ public:
             FloatVectorOperations::fill (data2, (ValueType) 3, num);
             FloatVectorOperations::addWithMultiply (data1, data1, data2, num);
             u.expect (areAllValuesEqual (data1, num, (ValueType) 8));
+
+            testFusedFunctions (u, random, num);
+        }
+
+        static void testFusedFunctions (UnitTest& u, Random& random, int num)
+        {
+            const int maxSources = 11;
+            HeapBlock<ValueType> buffer ((size_t) (num + 4) * (maxSources + 2));
+
+            ValueType* const src = buffer;
+            ValueType* const dest = buffer + (num + 4);
+            const ValueType* sources[maxSources];
+            ValueType multipliers[maxSources];
+
+            for (int i = 0; i < maxSources; ++i)
+            {
+                // (offset by a random number of values so that the sources aren't all equally aligned)
+                ValueType* const s = buffer + (num + 4) * (i + 2) + random.nextInt (4);
+                fillRandomly (random, s, num);
+                sources[i] = s;
+                multipliers[i] = (ValueType) (random.nextDouble() * 2.0 - 1.0);
+            }
+
+            fillRandomly (random, src, num);
+            fillRandomly (random, dest, num);
+            HeapBlock<ValueType> original ((size_t) num), expected ((size_t) num);
+            FloatVectorOperations::copy (original, dest, num);
+
+            const ValueType startGain = (ValueType) random.nextDouble(), endGain = (ValueType) (random.nextDouble() * 2.0);
+
+            for (int i = 0; i < num; ++i)
+                expected[i] = original[i] * (startGain + (ValueType) i * (endGain - startGain) / (ValueType) num);
+
+            FloatVectorOperations::multiplyWithRamp (dest, startGain, endGain, num);
+            u.expect (buffersMatchApproximately (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)
+                expected[i] = src[i] * (startGain + (ValueType) i * (endGain - startGain) / (ValueType) num);
+
+            FloatVectorOperations::copyWithRamp (dest, src, startGain, endGain, num);
+            u.expect (buffersMatchApproximately (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)
+                expected[i] += original[i];
+
+            FloatVectorOperations::copy (dest, original, num);
+            FloatVectorOperations::addWithRamp (dest, src, startGain, endGain, num);
+            u.expect (buffersMatchApproximately (dest, expected, num));
+
+            const int numSources = random.nextInt (maxSources) + 1;
+            FloatVectorOperations::copy (expected, original, num);
+
+            for (int s = 0; s < numSources; ++s)
+                for (int i = 0; i < num; ++i)
+                    expected[i] += sources[s][i] * multipliers[s];
+
+            FloatVectorOperations::copy (dest, original, num);
+            FloatVectorOperations::addWithMultiply (dest, sources, multipliers, numSources, num);
+            u.expect (buffersMatchApproximately (dest, expected, num));
+
+            const ValueType low = (ValueType) 300, high = (ValueType) 1500;
+
+            for (int i = 0; i < num; ++i)
+                expected[i] = jlimit (low, high, original[i] + src[i]);
+
+            FloatVectorOperations::copy (dest, original, num);
+            FloatVectorOperations::addWithClip (dest, src, low, high, num);
+            u.expect (buffersMatch (dest, expected, num));
+
+            for (int i = 0; i < num; ++i)
+                expected[i] = original[i] + src[i] * multipliers[0];
+
+            FloatVectorOperations::copy (dest, original, num);
+            const Range<ValueType> range (FloatVectorOperations::addWithMultiplyAndFindMinAndMax (dest, src, multipliers[0], num));
+            u.expect (buffersMatchApproximately (dest, expected, num));
+            u.expect (range == Range<ValueType>::findMinAndMax (dest, num));
         }
 
         static void doConversionTest (UnitTest& u, float* data1, float* data2, int* const int1, int num)
@@ -1149,17 +2005,211 @@ public:
         {
             return std::abs (v1 - v2) < std::numeric_limits<ValueType>::epsilon();
         }
+
+        static bool buffersMatchApproximately (const ValueType* d1, const ValueType* d2, int num)
+        {
+            for (int i = 0; i < num; ++i)
+                if (std::abs (d1[i] - d2[i]) > (std::abs (d1[i]) + std::abs (d2[i]) + 1) * std::numeric_limits<ValueType>::epsilon() * 8)
+                    return false;
+
+            return true;
+        }
+
+        // Runs each of the functions which have wider versions with the given instruction set,
+        // and checks that they give the same results as the baseline versions.
+        static void compareWithBaseline (UnitTest& u, Random random, FloatVectorOperations::InstructionSet set)
+        {
+            const int num = random.nextInt (600) + 1;
+            HeapBlock<ValueType> src1 ((size_t) num + 16), src2 ((size_t) num + 16), dest1 ((size_t) num + 16), dest2 ((size_t) num + 16);
+            HeapBlock<int> ints ((size_t) num + 16);
+
+            ValueType* const s1 = addBytesToPointer (src1.getData(), random.nextInt (16));
+            ValueType* const s2 = addBytesToPointer (src2.getData(), random.nextInt (16));
+            ValueType* const d1 = addBytesToPointer (dest1.getData(), random.nextInt (16));
+            ValueType* const d2 = addBytesToPointer (dest2.getData(), random.nextInt (16));
+            int* const i1 = addBytesToPointer (ints.getData(), random.nextInt (16));
+
+            fillRandomly (random, s1, num);
+            fillRandomly (random, s2, num);
+            fillRandomly (random, i1, num);
+
+            const ValueType low = (ValueType) 200, high = (ValueType) 700;
+
+            u.expect (matchesBaseline (set, s2, d1, d2, num, false, [=] (ValueType* d) { FloatVectorOperations::add (d, s1, num); }));
+            u.expect (matchesBaseline (set, s2, d1, d2, num, false, [=] (ValueType* d) { FloatVectorOperations::add (d, s1, s2, num); }));
+            u.expect (matchesBaseline (set, s2, d1, d2, num, true,  [=] (ValueType* d) { FloatVectorOperations::addWithMultiply (d, s1, (ValueType) 0.3, num); }));
+            u.expect (matchesBaseline (set, s2, d1, d2, num, true,  [=] (ValueType* d) { FloatVectorOperations::addWithMultiply (d, s1, s2, num); }));
+            u.expect (matchesBaseline (set, s2, d1, d2, num, false, [=] (ValueType* d) { FloatVectorOperations::multiply (d, s1, num); }));
+            u.expect (matchesBaseline (set, s2, d1, d2, num, false, [=] (ValueType* d) { FloatVectorOperations::multiply (d, (ValueType) 0.3, num); }));
+            u.expect (matchesBaseline (set, s2, d1, d2, num, false, [=] (ValueType* d) { FloatVectorOperations::copyWithMultiply (d, s1, (ValueType) 0.3, num); }));
+            u.expect (matchesBaseline (set, s2, d1, d2, num, false, [=] (ValueType* d) { FloatVectorOperations::clip (d, s1, low, high, num); }));
+            compareConversionWithBaseline (u, set, d1, d2, i1, num);
+
+            FloatVectorOperations::setMaximumInstructionSet (FloatVectorOperations::baselineInstructionSet);
+            const Range<ValueType> baselineRange (FloatVectorOperations::findMinAndMax (s1, num));
+            FloatVectorOperations::setMaximumInstructionSet (set);
+            u.expect (FloatVectorOperations::findMinAndMax (s1, num) == baselineRange);
+        }
+
+        static void compareConversionWithBaseline (UnitTest& u, FloatVectorOperations::InstructionSet set, float* d1, float* d2, const int* ints, int num)
+        {
+            u.expect (matchesBaseline (set, d1, d1, d2, num, false, [=] (float* d) { FloatVectorOperations::convertFixedToFloat (d, ints, 1.0f / 0x7fffffff, num); }));
+        }
+
+        static void compareConversionWithBaseline (UnitTest&, FloatVectorOperations::InstructionSet, double*, double*, const int*, int) {}
+
+        template <typename OperationType>
+        static bool matchesBaseline (FloatVectorOperations::InstructionSet set, const ValueType* initialValues,
+                                     ValueType* d1, ValueType* d2, int num, bool allowRoundingDifferences,
+                                     OperationType operation)
+        {
+            FloatVectorOperations::copy (d2, initialValues, num);
+
+            if (d1 != initialValues)
+                FloatVectorOperations::copy (d1, initialValues, num);
+
+            FloatVectorOperations::setMaximumInstructionSet (FloatVectorOperations::baselineInstructionSet);
+            operation (d1);
+            FloatVectorOperations::setMaximumInstructionSet (set);
+            operation (d2);
+
+            for (int i = 0; i < num; ++i)
+            {
+                if (allowRoundingDifferences ? std::abs (d1[i] - d2[i]) > std::abs (d1[i]) * std::numeric_limits<ValueType>::epsilon() * 2
+                                             : d1[i] != d2[i])
+                    return false;
+            }
+
+            return true;
+        }
     };
 
+    void testInterleavingAndIntegerConversions (Random random)
+    {
+        const int num = random.nextInt (500) + 1;
+        const int numChannels = random.nextInt (9) + 1;
+        HeapBlock<float> interleaved ((size_t) (num * numChannels), true), channelData ((size_t) (num * numChannels * 2), true);
+        const float* sources[9] = { nullptr };
+        float* dests[9] = { nullptr };
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* const s = channelData + num * ch;
+
+            for (int i = 0; i < num; ++i)
+                s[i] = random.nextFloat();
+
+            sources[ch] = s;
+            dests[ch] = channelData + num * (numChannels + ch);
+        }
+
+        FloatVectorOperations::interleave (interleaved, sources, numChannels, num);
+        bool interleavedCorrectly = true;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < num; ++i)
+                interleavedCorrectly = interleavedCorrectly && interleaved[i * numChannels + ch] == sources[ch][i];
+
+        expect (interleavedCorrectly);
+
+        FloatVectorOperations::deinterleave (dests, interleaved, numChannels, num);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            expect (memcmp (dests[ch], sources[ch], sizeof (float) * (size_t) num) == 0);
+
+        // (going slightly out of range to check the clipping)
+        HeapBlock<float> floats ((size_t) num, true), convertedBack ((size_t) num, true);
+        HeapBlock<int16> shorts ((size_t) num, true), ditheredShorts ((size_t) num, true);
+        HeapBlock<int32> ints ((size_t) num, true);
+
+        for (int i = 0; i < num; ++i)
+            floats[i] = random.nextFloat() * 2.4f - 1.2f;
+
+        FloatVectorOperations::convertFloatToInt16 (shorts, floats, num);
+        bool int16Correct = true;
+
+        for (int i = 0; i < num; ++i)
+            int16Correct = int16Correct && std::abs (shorts[i] - roundToInt (jlimit (-32767.0, 32767.0, 32767.0 * floats[i]))) <= 1;
+
+        expect (int16Correct);
+
+        uint32 seed = (uint32) random.nextInt();
+        const uint32 originalSeed = seed;
+        FloatVectorOperations::convertFloatToInt16 (ditheredShorts, floats, num, &seed);
+        bool ditherInRange = true;
+
+        for (int i = 0; i < num; ++i)
+            ditherInRange = ditherInRange && std::abs (ditheredShorts[i] - shorts[i]) <= 1 && std::abs ((int) ditheredShorts[i]) <= 0x7fff;
+
+        expect (ditherInRange);
+        expect (seed != originalSeed);
+
+        FloatVectorOperations::convertInt16ToFloat (convertedBack, shorts, num);
+        bool int16ToFloatCorrect = true;
+
+        for (int i = 0; i < num; ++i)
+            int16ToFloatCorrect = int16ToFloatCorrect && convertedBack[i] == (1.0f / 0x7fff) * shorts[i];
+
+        FloatVectorOperations::convertInt16ToFloat (convertedBack, shorts, 1.0f / 0x8000, num);
+
+        for (int i = 0; i < num; ++i)
+            int16ToFloatCorrect = int16ToFloatCorrect && convertedBack[i] == (1.0f / 0x8000) * shorts[i];
+
+        expect (int16ToFloatCorrect);
+
+        FloatVectorOperations::convertFloatToInt24 (ints, floats, num);
+        expect (intsMatch (ints, floats, (double) 0x7fffff, num));
+
+        FloatVectorOperations::convertFloatToInt24 (ints, floats, num, &seed);
+        bool dithered24BitInRange = true;
+
+        for (int i = 0; i < num; ++i)
+            dithered24BitInRange = dithered24BitInRange && std::abs (ints[i] - roundToInt (jlimit (-8388607.0, 8388607.0, 8388607.0 * floats[i]))) <= 1;
+
+        expect (dithered24BitInRange);
+
+        FloatVectorOperations::convertFloatToInt32 (ints, floats, num);
+        expect (intsMatch (ints, floats, (double) 0x7fffffff, num));
+    }
+
+    static bool intsMatch (const int32* ints, const float* floats, double maxValue, int num)
+    {
+        for (int i = 0; i < num; ++i)
+            if (ints[i] != roundToInt (jlimit (-maxValue, maxValue, maxValue * floats[i])))
+                return false;
+
+        return true;
+    }
+
     void runTest() override
     {
-        beginTest ("FloatVectorOperations");
+        const FloatVectorOperations::InstructionSet originalSet = FloatVectorOperations::getActiveInstructionSet();
 
-        for (int i = 1000; --i >= 0;)
+        for (int set = FloatVectorOperations::baselineInstructionSet; set <= FloatVectorOperations::avx512InstructionSet; ++set)
         {
-            TestRunner<float>::runTest (*this, getRandom());
-            TestRunner<double>::runTest (*this, getRandom());
+            if (FloatVectorOperations::setMaximumInstructionSet ((FloatVectorOperations::InstructionSet) set) != set)
+                continue;
+
+            beginTest ("FloatVectorOperations (instruction set " + String (set) + ")");
+
+            for (int i = 1000; --i >= 0;)
+            {
+                TestRunner<float>::runTest (*this, getRandom());
+                TestRunner<double>::runTest (*this, getRandom());
+                testInterleavingAndIntegerConversions (getRandom());
+            }
+
+            if (set != FloatVectorOperations::baselineInstructionSet)
+            {
+                for (int i = 100; --i >= 0;)
+                {
+                    TestRunner<float>::compareWithBaseline (*this, getRandom(), (FloatVectorOperations::InstructionSet) set);
+                    TestRunner<double>::compareWithBaseline (*this, getRandom(), (FloatVectorOperations::InstructionSet) set);
+                }
+            }
         }
+
+        FloatVectorOperations::setMaximumInstructionSet (originalSet);
     }
 };
 
@@ -191,6 +191,120 @@ public:
     /** Finds the maximum value in the given array. */
     static double JUCE_CALLTYPE findMaximum (const double* src, int numValues) noexcept;
 
+    //==============================================================================
+    /** Multiplies the destination values by a gain which ramps linearly from startGain towards endGain.
+        The gain applied to value i is startGain + i * (endGain - startGain) / numValues, so endGain
+        itself is the gain that the following block should start with.
+    */
+    static void JUCE_CALLTYPE multiplyWithRamp (float* dest, float startGain, float endGain, int numValues) noexcept;
+
+    /** Multiplies the destination values by a gain which ramps linearly from startGain towards endGain.
+        The gain applied to value i is startGain + i * (endGain - startGain) / numValues, so endGain
+        itself is the gain that the following block should start with.
+    */
+    static void JUCE_CALLTYPE multiplyWithRamp (double* dest, double startGain, double endGain, int numValues) noexcept;
+
+    /** Copies a vector of floats, multiplying it by a gain which ramps linearly from startGain towards endGain.
+        @see multiplyWithRamp
+    */
+    static void JUCE_CALLTYPE copyWithRamp (float* dest, const float* src, float startGain, float endGain, int numValues) noexcept;
+
+    /** Copies a vector of doubles, multiplying it by a gain which ramps linearly from startGain towards endGain.
+        @see multiplyWithRamp
+    */
+    static void JUCE_CALLTYPE copyWithRamp (double* dest, const double* src, double startGain, double endGain, int numValues) noexcept;
+
+    /** Multiplies the source values by a gain which ramps linearly from startGain towards endGain, and adds them to the destination values.
+        @see multiplyWithRamp
+    */
+    static void JUCE_CALLTYPE addWithRamp (float* dest, const float* src, float startGain, float endGain, int numValues) noexcept;
+
+    /** Multiplies the source values by a gain which ramps linearly from startGain towards endGain, and adds them to the destination values.
+        @see multiplyWithRamp
+    */
+    static void JUCE_CALLTYPE addWithRamp (double* dest, const double* src, double startGain, double endGain, int numValues) noexcept;
+
+    /** Multiplies each of a set of source vectors by its own multiplier, and adds them all to the destination values.
+        This does the same job as calling addWithMultiply() once for each source, but makes a single
+        pass over the destination for every 8 sources.
+    */
+    static void JUCE_CALLTYPE addWithMultiply (float* dest, const float* const* sources, const float* multipliers,
+                                               int numSources, int numValues) noexcept;
+
+    /** Multiplies each of a set of source vectors by its own multiplier, and adds them all to the destination values.
+        This does the same job as calling addWithMultiply() once for each source, but makes a single
+        pass over the destination for every 8 sources.
+    */
+    static void JUCE_CALLTYPE addWithMultiply (double* dest, const double* const* sources, const double* multipliers,
+                                               int numSources, int numValues) noexcept;
+
+    /** Adds the source values to the destination values, and hard clips the results so that they're in the range low to high. */
+    static void JUCE_CALLTYPE addWithClip (float* dest, const float* src, float low, float high, int numValues) noexcept;
+
+    /** Adds the source values to the destination values, and hard clips the results so that they're in the range low to high. */
+    static void JUCE_CALLTYPE addWithClip (double* dest, const double* src, double low, double high, int numValues) noexcept;
+
+    /** Multiplies each source value by the given multiplier and adds it to the destination value,
+        returning the minimum and maximum of the resulting destination values.
+        This does the job of addWithMultiply() followed by findMinAndMax() in a single pass, e.g.
+        for metering the level of a mix as it's being built.
+    */
+    static Range<float> JUCE_CALLTYPE addWithMultiplyAndFindMinAndMax (float* dest, const float* src, float multiplier, int numValues) noexcept;
+
+    /** Multiplies each source value by the given multiplier and adds it to the destination value,
+        returning the minimum and maximum of the resulting destination values.
+        This does the job of addWithMultiply() followed by findMinAndMax() in a single pass, e.g.
+        for metering the level of a mix as it's being built.
+    */
+    static Range<double> JUCE_CALLTYPE addWithMultiplyAndFindMinAndMax (double* dest, const double* src, double multiplier, int numValues) noexcept;
+
+    //==============================================================================
+    /** Interleaves a set of separate channels into a single buffer, so that
+        dest[i * numChannels + channel] = sources[channel][i].
+        Stereo and multiples of 4 channels have vector versions.
+    */
+    static void JUCE_CALLTYPE interleave (float* dest, const float* const* sources, int numChannels, int numValues) noexcept;
+
+    /** Splits an interleaved buffer into separate channels, so that
+        dests[channel][i] = src[i * numChannels + channel].
+        Stereo and multiples of 4 channels have vector versions.
+    */
+    static void JUCE_CALLTYPE deinterleave (float* const* dests, const float* src, int numChannels, int numValues) noexcept;
+
+    //==============================================================================
+    /** Converts a vector of floats to 16-bit integers, where +/-1.0 becomes +/-0x7fff.
+        Values are clipped to that range and rounded to the nearest integer.
+
+        If ditherSeed is non-null, triangular-PDF dither of up to +/-1 LSB is added before rounding,
+        using the random seed that it points to, which is updated so that successive blocks can
+        carry on the same sequence.
+    */
+    static void JUCE_CALLTYPE convertFloatToInt16 (int16* dest, const float* src, int numValues, uint32* ditherSeed = nullptr) noexcept;
+
+    /** Converts a vector of floats to 24-bit integers in the low bytes of 32-bit ints, where +/-1.0 becomes +/-0x7fffff.
+        @see convertFloatToInt16
+    */
+    static void JUCE_CALLTYPE convertFloatToInt24 (int32* dest, const float* src, int numValues, uint32* ditherSeed = nullptr) noexcept;
+
+    /** Converts a vector of floats to 32-bit integers, where +/-1.0 becomes +/-0x7fffffff.
+        There's no dithered version of this, because a float has less resolution than the result.
+        @see convertFloatToInt16
+    */
+    static void JUCE_CALLTYPE convertFloatToInt32 (int32* dest, const float* src, int numValues) noexcept;
+
+    /** Converts a vector of 16-bit integers to floats, where +/-0x7fff becomes +/-1.0. */
+    static void JUCE_CALLTYPE convertInt16ToFloat (float* dest, const int16* src, int numValues) noexcept;
+
+    /** Converts a vector of 16-bit integers to floats, multiplying each one by the given value. */
+    static void JUCE_CALLTYPE convertInt16ToFloat (float* dest, const int16* src, float multiplier, int numValues) noexcept;
+
+    /** Converts a vector of 24-bit integers held in 32-bit ints to floats, where +/-0x7fffff becomes +/-1.0. */
+    static void JUCE_CALLTYPE convertInt24ToFloat (float* dest, const int32* src, int numValues) noexcept;
+
+    /** Converts a vector of 32-bit integers to floats, where +/-0x7fffffff becomes +/-1.0. */
+    static void JUCE_CALLTYPE convertInt32ToFloat (float* dest, const int32* src, int numValues) noexcept;
+
+    //==============================================================================
     /** On Intel CPUs, this method enables or disables the SSE flush-to-zero mode.
         Effectively, this is a wrapper around a call to _MM_SET_FLUSH_ZERO_MODE
     */
@@ -201,4 +315,32 @@ public:
         call before audio processing code where you really want to avoid denormalisation performance hits.
     */
     static void JUCE_CALLTYPE disableDenormalisedNumberSupport() noexcept;
+
+    //==============================================================================
+    /** The instruction sets that some of these functions can choose between at runtime.
+        @see setMaximumInstructionSet
+    */
+    enum InstructionSet
+    {
+        baselineInstructionSet = 0, /**< The SSE2, NEON or vDSP versions, depending on the platform. */
+        avx2InstructionSet,         /**< AVX2 and FMA3 versions, processing 256 bits at a time. */
+        avx512InstructionSet        /**< AVX-512 versions, processing 512 bits at a time. */
+    };
+
+    /** On x86 CPUs, add, addWithMultiply, multiply, copyWithMultiply, clip, findMinAndMax and
+        convertFixedToFloat have AVX2 and AVX-512 versions, and the widest one that the CPU
+        supports is picked at runtime. This lets you prevent it from going beyond a given
+        instruction set, e.g. to compare their performance, and returns the one that will
+        actually be used. The FFT class also uses this to choose between its SSE and AVX2
+        butterflies.
+
+        Note that the AVX versions of addWithMultiply use fused multiply-adds, which only round
+        once, so their results can differ very slightly from the baseline versions.
+    */
+    static InstructionSet JUCE_CALLTYPE setMaximumInstructionSet (InstructionSet maximumToUse) noexcept;
+
+    /** Returns the instruction set that the functions which have several versions will use.
+        @see setMaximumInstructionSet
+    */
+    static InstructionSet JUCE_CALLTYPE getActiveInstructionSet() noexcept;
 };
@@ -0,0 +1,468 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+/*  One uniformly-partitioned section of the impulse response, which is convolved using
+    overlap-save with a frequency-domain delay line.
+
+    Its input arrives in blocks of partitionSize samples, and the result of each block is
+    needed partitionSize samples later if it's processed on the audio thread, or
+    2 * partitionSize samples later if it has a background thread. So there are two
+    slots for the input and output blocks: while the audio thread fills one input slot
+    and reads the matching output slot, the background thread works on the other pair.
+*/
+struct Convolution::Segment
+{
+    Segment (const AudioSampleBuffer& impulseResponse, int numChannelsToProcess,
+             int responseOffset, int blockSize, int numPartitionsToUse, bool useBackgroundThread)
+        : partitionSize (blockSize),
+          numPartitions (numPartitionsToUse),
+          numChannels (numChannelsToProcess),
+          numResponseChannels (jmin (numChannelsToProcess, impulseResponse.getNumChannels())),
+          numBins (blockSize + 1),
+          forwardFFT (getFFTOrder (blockSize), false),
+          inverseFFT (getFFTOrder (blockSize), true),
+          inputs (numChannelsToProcess, 2 * blockSize),
+          outputs (numChannelsToProcess, 2 * blockSize),
+          previousInputs (numChannelsToProcess, blockSize),
+          responseSpectra ((size_t) (numResponseChannels * numPartitions * numBins)),
+          delayLine ((size_t) (numChannels * numPartitions * numBins)),
+          accumulator ((size_t) numBins),
+          timeData ((size_t) (2 * blockSize + 2))
+    {
+        for (int channel = 0; channel < numResponseChannels; ++channel)
+        {
+            for (int partition = 0; partition < numPartitions; ++partition)
+            {
+                const int start = responseOffset + partition * partitionSize;
+                const int num = jlimit (0, partitionSize, impulseResponse.getNumSamples() - start);
+
+                FloatVectorOperations::clear (timeData, 2 * partitionSize);
+
+                if (num > 0)
+                    FloatVectorOperations::copy (timeData, impulseResponse.getReadPointer (channel, start), num);
+
+                forwardFFT.performRealForward (timeData, getResponseSpectrum (channel, partition));
+            }
+        }
+
+        reset();
+
+        if (useBackgroundThread)
+        {
+            thread = new BackgroundThread (*this);
+            thread->startThread (8);
+        }
+    }
+
+    ~Segment()
+    {
+        if (thread != nullptr)
+        {
+            thread->signalThreadShouldExit();
+            thread->notify();
+            thread->stopThread (5000);
+        }
+    }
+
+    void reset() noexcept
+    {
+        waitForBackgroundJob();
+
+        inputs.clear();
+        outputs.clear();
+        previousInputs.clear();
+        zeromem (delayLine, sizeof (FFT::Complex) * (size_t) (numChannels * numPartitions * numBins));
+
+        delayLinePosition = 0;
+        position = 0;
+        numJobs = 0;
+        numJobsPosted = 0;
+        numJobsFinished = 0;
+    }
+
+    // The slot that the audio thread is currently filling and reading
+    int getCurrentSlot() const noexcept             { return numJobs & 1; }
+
+    float* getInput (int channel) noexcept          { return inputs.getWritePointer (channel, getCurrentSlot() * partitionSize); }
+    const float* getOutput (int channel) noexcept   { return outputs.getReadPointer (channel, getCurrentSlot() * partitionSize); }
+
+    // Called on the audio thread when a whole block of input has arrived
+    void finishBlock() noexcept
+    {
+        if (thread == nullptr)
+        {
+            processBlock (0);
+            return;
+        }
+
+        waitForBackgroundJob();
+        numJobsPosted = ++numJobs;
+        thread->notify();
+    }
+
+    const int partitionSize, numPartitions;
+    int position = 0;
+
+private:
+    //==============================================================================
+    struct BackgroundThread  : public Thread
+    {
+        BackgroundThread (Segment& s)  : Thread ("Convolution"), segment (s) {}
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                for (int job = segment.numJobsFinished.get(); job < segment.numJobsPosted.get(); ++job)
+                {
+                    segment.processBlock (job & 1);
+                    segment.numJobsFinished = job + 1;
+                    segment.jobFinished.signal();
+                }
+
+                wait (-1);
+            }
+        }
+
+        Segment& segment;
+
+        JUCE_DECLARE_NON_COPYABLE (BackgroundThread)
+    };
+
+    const int numChannels, numResponseChannels, numBins;
+    const FFT forwardFFT, inverseFFT;
+    AudioSampleBuffer inputs, outputs, previousInputs;
+    HeapBlock<FFT::Complex> responseSpectra, delayLine, accumulator;
+    HeapBlock<float> timeData;
+    int delayLinePosition = 0, numJobs = 0;
+
+    ScopedPointer<BackgroundThread> thread;
+    Atomic<int> numJobsPosted, numJobsFinished;
+    WaitableEvent jobFinished;
+
+    static int getFFTOrder (int blockSize) noexcept
+    {
+        int order = 1;
+
+        while ((1 << order) < 2 * blockSize)
+            ++order;
+
+        return order;
+    }
+
+    FFT::Complex* getResponseSpectrum (int channel, int partition) const noexcept
+    {
+        return responseSpectra + (channel * numPartitions + partition) * numBins;
+    }
+
+    FFT::Complex* getDelayLineSpectrum (int channel, int index) const noexcept
+    {
+        return delayLine + (channel * numPartitions + index) * numBins;
+    }
+
+    void waitForBackgroundJob() noexcept
+    {
+        if (thread != nullptr)
+            while (numJobsFinished.get() != numJobsPosted.get())
+                jobFinished.wait();
+    }
+
+    void processBlock (int slot) noexcept
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* const input = inputs.getReadPointer (channel, slot * partitionSize);
+            float* const previous = previousInputs.getWritePointer (channel);
+
+            FloatVectorOperations::copy (timeData, previous, partitionSize);
+            FloatVectorOperations::copy (timeData + partitionSize, input, partitionSize);
+            FloatVectorOperations::copy (previous, input, partitionSize);
+
+            forwardFFT.performRealForward (timeData, getDelayLineSpectrum (channel, delayLinePosition));
+
+            zeromem (accumulator, sizeof (FFT::Complex) * (size_t) numBins);
+
+            for (int partition = 0; partition < numPartitions; ++partition)
+            {
+                int index = delayLinePosition - partition;
+
+                if (index < 0)
+                    index += numPartitions;
+
+                multiplyAndAdd (accumulator, getDelayLineSpectrum (channel, index),
+                                getResponseSpectrum (channel % numResponseChannels, partition), numBins);
+            }
+
+            inverseFFT.performRealInverse (accumulator, timeData);
+
+            // overlap-save: only the second half of the result is a complete convolution
+            FloatVectorOperations::copy (outputs.getWritePointer (channel, slot * partitionSize),
+                                         timeData + partitionSize, partitionSize);
+        }
+
+        if (++delayLinePosition >= numPartitions)
+            delayLinePosition = 0;
+    }
+
+    static void multiplyAndAdd (FFT::Complex* dest, const FFT::Complex* a, const FFT::Complex* b, int num) noexcept
+    {
+        for (int i = 0; i < num; ++i)
+        {
+            dest[i].r += a[i].r * b[i].r - a[i].i * b[i].i;
+            dest[i].i += a[i].r * b[i].i + a[i].i * b[i].r;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Segment)
+};
+
+//==============================================================================
+Convolution::Convolution() {}
+Convolution::~Convolution() {}
+
+void Convolution::loadImpulseResponse (const AudioSampleBuffer& impulseResponse, int numChannelsToProcess,
+                                       int newHeadSize, int maxPartitionSize)
+{
+    // The partition sizes must be powers of two
+    jassert (isPowerOfTwo (newHeadSize) && isPowerOfTwo (maxPartitionSize));
+
+    clear();
+
+    if (impulseResponse.getNumChannels() == 0 || impulseResponse.getNumSamples() == 0 || numChannelsToProcess <= 0)
+        return;
+
+    numChannels = numChannelsToProcess;
+    numResponseChannels = jmin (numChannels, impulseResponse.getNumChannels());
+    impulseResponseLength = impulseResponse.getNumSamples();
+    headSize = jmax (1, newHeadSize);
+    maxPartitionSize = jmax (headSize, maxPartitionSize);
+
+    const int headLength = jmin (headSize, impulseResponseLength);
+    headResponse.setSize (numResponseChannels, headLength);
+
+    for (int channel = 0; channel < numResponseChannels; ++channel)
+        headResponse.copyFrom (channel, 0, impulseResponse, channel, 0, headLength);
+
+    headHistory.setSize (numChannels, 2 * headSize);
+    headHistory.clear();
+
+    // The first segment is processed on the audio thread as soon as each block of the
+    // head size has arrived, so it can start straight after the head. Every bigger one is
+    // processed in the background, so it starts at twice its partition size, which gives
+    // it a whole block of time to finish.
+    int offset = headSize, partitionSize = headSize;
+
+    while (offset < impulseResponseLength)
+    {
+        const int nextPartitionSize = jmin (partitionSize * 16, maxPartitionSize);
+        const int end = nextPartitionSize > partitionSize ? jmin (impulseResponseLength, 2 * nextPartitionSize)
+                                                          : impulseResponseLength;
+
+        segments.add (new Segment (impulseResponse, numChannels, offset, partitionSize,
+                                   (end - offset + partitionSize - 1) / partitionSize,
+                                   offset > partitionSize));
+
+        offset = nextPartitionSize > partitionSize ? 2 * nextPartitionSize : end;
+        partitionSize = nextPartitionSize;
+    }
+
+    reset();
+}
+
+void Convolution::clear()
+{
+    segments.clear();
+    headResponse.setSize (0, 0);
+    headHistory.setSize (0, 0);
+    numChannels = numResponseChannels = impulseResponseLength = 0;
+    headSize = headPosition = 0;
+}
+
+void Convolution::reset() noexcept
+{
+    headHistory.clear();
+    headPosition = 0;
+
+    for (int i = 0; i < segments.size(); ++i)
+        segments.getUnchecked (i)->reset();
+}
+
+void Convolution::process (const float* const* inputChannels, float* const* outputChannels,
+                           int numChannelsToProcess, int numSamples) noexcept
+{
+    jassert (numChannelsToProcess <= numChannels || numChannels == 0);
+
+    if (numChannels == 0)
+    {
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            FloatVectorOperations::clear (outputChannels[channel], numSamples);
+
+        return;
+    }
+
+    numChannelsToProcess = jmin (numChannelsToProcess, numChannels);
+
+    for (int done = 0; done < numSamples;)
+    {
+        const int num = jmin (numSamples - done, headSize - headPosition);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* const newest = headHistory.getWritePointer (channel, headSize + headPosition);
+
+            if (channel < numChannelsToProcess && inputChannels[channel] != nullptr)
+                FloatVectorOperations::copy (newest, inputChannels[channel] + done, num);
+            else
+                FloatVectorOperations::clear (newest, num);
+
+            if (channel >= numChannelsToProcess)
+                continue;
+
+            float* const output = outputChannels[channel] + done;
+            const float* const response = headResponse.getReadPointer (channel % numResponseChannels);
+
+            FloatVectorOperations::copyWithMultiply (output, newest, response[0], num);
+
+            for (int i = 1; i < headResponse.getNumSamples(); ++i)
+                FloatVectorOperations::addWithMultiply (output, newest - i, response[i], num);
+
+            for (int i = 0; i < segments.size(); ++i)
+            {
+                Segment& segment = *segments.getUnchecked (i);
+                FloatVectorOperations::add (output, segment.getOutput (channel) + segment.position, num);
+            }
+        }
+
+        for (int i = 0; i < segments.size(); ++i)
+            segments.getUnchecked (i)->position += num;
+
+        done += num;
+        headPosition += num;
+
+        if (headPosition == headSize)
+            finishHeadBlock();
+    }
+}
+
+void Convolution::finishHeadBlock() noexcept
+{
+    for (int i = 0; i < segments.size(); ++i)
+    {
+        Segment& segment = *segments.getUnchecked (i);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            FloatVectorOperations::copy (segment.getInput (channel) + segment.position - headSize,
+                                         headHistory.getReadPointer (channel, headSize), headSize);
+
+        if (segment.position == segment.partitionSize)
+        {
+            segment.position = 0;
+            segment.finishBlock();
+        }
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float* const history = headHistory.getWritePointer (channel);
+        FloatVectorOperations::copy (history, history + headSize, headSize);
+    }
+
+    headPosition = 0;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ConvolutionTests  : public UnitTest
+{
+public:
+    ConvolutionTests() : UnitTest ("Convolution") {}
+
+    void runTest() override
+    {
+        beginTest ("Non-uniform partitions");
+        testAgainstDirectConvolution (getRandom(), 5000, 2, 32, 1024);
+
+        beginTest ("Uniform partitions");
+        testAgainstDirectConvolution (getRandom(), 3000, 1, 64, 64);
+
+        beginTest ("Short response");
+        testAgainstDirectConvolution (getRandom(), 20, 1, 64, 16384);
+    }
+
+    void testAgainstDirectConvolution (Random random, int responseLength, int numResponseChannels,
+                                       int headSize, int maxPartitionSize)
+    {
+        const int numChannels = 2, numSamples = 20000;
+
+        AudioSampleBuffer response (numResponseChannels, responseLength), input (numChannels, numSamples);
+        fillWithNoise (response, random);
+        fillWithNoise (input, random);
+
+        Convolution convolution;
+        convolution.loadImpulseResponse (response, numChannels, headSize, maxPartitionSize);
+        expectEquals (convolution.getImpulseResponseLength(), responseLength);
+
+        // process it in place, in randomly-sized blocks
+        AudioSampleBuffer output (input);
+
+        for (int pos = 0; pos < numSamples;)
+        {
+            const int num = jmin (numSamples - pos, random.nextInt (300) + 1);
+            float* channels[] = { output.getWritePointer (0, pos), output.getWritePointer (1, pos) };
+
+            convolution.process (channels, channels, numChannels, num);
+            pos += num;
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* const x = input.getReadPointer (channel);
+            const float* const h = response.getReadPointer (channel % numResponseChannels);
+            double maxError = 0;
+
+            for (int i = 0; i < numSamples; i += 7)
+            {
+                double expected = 0;
+
+                for (int j = jmax (0, i - responseLength + 1); j <= i; ++j)
+                    expected += x[j] * (double) h[i - j];
+
+                maxError = jmax (maxError, std::abs (expected - output.getSample (channel, i)));
+            }
+
+            expect (maxError < 1.0e-3, "error = " + String (maxError));
+        }
+    }
+
+    static void fillWithNoise (AudioSampleBuffer& buffer, Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+    }
+};
+
+static ConvolutionTests convolutionTests;
+
+#endif
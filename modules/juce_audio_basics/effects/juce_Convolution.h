@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+
+//==============================================================================
+/**
+    Convolves audio with an impulse response, without adding any latency.
+
+    The start of the response (the "head") is applied directly in the time domain, and
+    the rest is split into partitions which are applied in the frequency domain using the
+    FFT class. The partitions just after the head are the same size as the head, and are
+    processed as soon as each block of that size has arrived. Further along the response
+    the partitions get progressively bigger, which makes long responses much cheaper, and
+    these bigger ones are processed by background threads, which have until their results
+    are needed to finish the work.
+
+    If a background thread does fall behind, process() will wait for it, so on a heavily
+    loaded machine it's best to use a smaller maximum partition size.
+
+    The impulse response should be at the same sample rate as the audio that you'll be
+    processing.
+
+    @see ConvolutionAudioSource, FFT
+*/
+class JUCE_API  Convolution
+{
+public:
+    /** Creates an empty Convolution, which will output silence until you give it an
+        impulse response with loadImpulseResponse().
+    */
+    Convolution();
+
+    /** Destructor. */
+    ~Convolution();
+
+    //==============================================================================
+    /** Loads an impulse response, and prepares to process a number of channels with it.
+
+        If the impulse response has fewer channels than numChannelsToProcess, its channels
+        are re-used cyclically, so e.g. a mono response will be applied to every channel.
+
+        The headSize is the number of samples that are convolved directly, and must be a
+        power of two. The partitions after the head then grow by a factor of 16 each time
+        until they reach maxPartitionSize. If maxPartitionSize is the same as the head size,
+        all the partitions are the same size, and no background threads are used.
+
+        This allocates memory, performs a lot of FFTs, and starts threads, so you mustn't
+        call it while process() may be running.
+    */
+    void loadImpulseResponse (const AudioSampleBuffer& impulseResponse,
+                              int numChannelsToProcess,
+                              int headSize = 64,
+                              int maxPartitionSize = 16384);
+
+    /** Removes the impulse response, and stops any background threads. */
+    void clear();
+
+    /** Clears the stored input, so that any tail from previous audio is silenced. */
+    void reset() noexcept;
+
+    /** Convolves a block of audio.
+
+        The input and output pointers can refer to the same buffers. If numChannels is
+        less than the number of channels that the object was prepared for, the others are
+        treated as silent. Any of the input pointers can also be null to mean silence.
+    */
+    void process (const float* const* inputChannels, float* const* outputChannels,
+                  int numChannels, int numSamples) noexcept;
+
+    //==============================================================================
+    /** Returns the number of channels that the object was prepared to process. */
+    int getNumChannels() const noexcept                         { return numChannels; }
+
+    /** Returns the length of the impulse response that is being used. */
+    int getImpulseResponseLength() const noexcept               { return impulseResponseLength; }
+
+private:
+    //==============================================================================
+    struct Segment;
+    OwnedArray<Segment> segments;
+    AudioSampleBuffer headResponse, headHistory;
+    int numChannels = 0, numResponseChannels = 0, impulseResponseLength = 0;
+    int headSize = 0, headPosition = 0;
+
+    void finishHeadBlock() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Convolution)
+};
@@ -20,284 +20,823 @@
   ==============================================================================
 */
 
-// (For the moment, we'll implement a few local operators for this complex class - one
-// day we'll probably either have a juce complex class, or use the C++11 one)
-static FFT::Complex operator+ (FFT::Complex a, FFT::Complex b) noexcept     { FFT::Complex c = { a.r + b.r, a.i + b.i }; return c; }
-static FFT::Complex operator- (FFT::Complex a, FFT::Complex b) noexcept     { FFT::Complex c = { a.r - b.r, a.i - b.i }; return c; }
-static FFT::Complex operator* (FFT::Complex a, FFT::Complex b) noexcept     { FFT::Complex c = { a.r * b.r - a.i * b.i, a.r * b.i + a.i * b.r }; return c; }
-static FFT::Complex& operator+= (FFT::Complex& a, FFT::Complex b) noexcept  { a.r += b.r; a.i += b.i; return a; }
-
-//==============================================================================
-struct FFT::FFTConfig
+namespace FFTHelpers
 {
-    FFTConfig (int sizeOfFFT, bool isInverse)
-        : fftSize (sizeOfFFT), inverse (isInverse), twiddleTable ((size_t) sizeOfFFT)
+    //==============================================================================
+    // Handles a single complex value at a time, for the first pass and the scalar builds.
+    template <typename FloatType>
+    struct ScalarOps
+    {
+        typedef FloatType Type;
+        struct ParallelType { Type r, i; };
+        enum { numComplex = 1 };
+
+        static forcedinline ParallelType load (const Type* src) noexcept                   { ParallelType v = { src[0], src[1] }; return v; }
+        static forcedinline void store (Type* dest, ParallelType a) noexcept                { dest[0] = a.r; dest[1] = a.i; }
+        static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept     { ParallelType v = { a.r + b.r, a.i + b.i }; return v; }
+        static forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept     { ParallelType v = { a.r - b.r, a.i - b.i }; return v; }
+        static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept     { ParallelType v = { a.r * b.r - a.i * b.i, a.r * b.i + a.i * b.r }; return v; }
+        static forcedinline ParallelType mulByI (ParallelType a) noexcept                  { ParallelType v = { -a.i, a.r }; return v; }
+        static forcedinline ParallelType mulByMinusI (ParallelType a) noexcept             { ParallelType v = { a.i, -a.r }; return v; }
+    };
+
+   #if JUCE_USE_SSE_INTRINSICS
+    struct SSEOps32
+    {
+        typedef float Type;
+        typedef __m128 ParallelType;
+        enum { numComplex = 2 };
+
+        static forcedinline ParallelType load (const Type* src) noexcept                   { return _mm_loadu_ps (src); }
+        static forcedinline void store (Type* dest, ParallelType a) noexcept                { _mm_storeu_ps (dest, a); }
+        static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept     { return _mm_add_ps (a, b); }
+        static forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept     { return _mm_sub_ps (a, b); }
+        static forcedinline ParallelType swapParts (ParallelType a) noexcept               { return _mm_shuffle_ps (a, a, _MM_SHUFFLE (2, 3, 0, 1)); }
+        static forcedinline ParallelType negateReals (ParallelType a) noexcept             { return _mm_xor_ps (a, _mm_set_ps (0.0f, -0.0f, 0.0f, -0.0f)); }
+        static forcedinline ParallelType negateImaginaries (ParallelType a) noexcept       { return _mm_xor_ps (a, _mm_set_ps (-0.0f, 0.0f, -0.0f, 0.0f)); }
+        static forcedinline ParallelType mulByI (ParallelType a) noexcept                  { return negateReals (swapParts (a)); }
+        static forcedinline ParallelType mulByMinusI (ParallelType a) noexcept             { return negateImaginaries (swapParts (a)); }
+
+        static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept
+        {
+            const ParallelType reals      = _mm_shuffle_ps (b, b, _MM_SHUFFLE (2, 2, 0, 0));
+            const ParallelType imaginaries = _mm_shuffle_ps (b, b, _MM_SHUFFLE (3, 3, 1, 1));
+            return _mm_add_ps (_mm_mul_ps (a, reals), negateReals (_mm_mul_ps (swapParts (a), imaginaries)));
+        }
+    };
+
+    struct SSEOps64
     {
-        for (int i = 0; i < fftSize; ++i)
+        typedef double Type;
+        typedef __m128d ParallelType;
+        enum { numComplex = 1 };
+
+        static forcedinline ParallelType load (const Type* src) noexcept                   { return _mm_loadu_pd (src); }
+        static forcedinline void store (Type* dest, ParallelType a) noexcept                { _mm_storeu_pd (dest, a); }
+        static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept     { return _mm_add_pd (a, b); }
+        static forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept     { return _mm_sub_pd (a, b); }
+        static forcedinline ParallelType swapParts (ParallelType a) noexcept               { return _mm_shuffle_pd (a, a, 1); }
+        static forcedinline ParallelType negateReals (ParallelType a) noexcept             { return _mm_xor_pd (a, _mm_set_pd (0.0, -0.0)); }
+        static forcedinline ParallelType negateImaginaries (ParallelType a) noexcept       { return _mm_xor_pd (a, _mm_set_pd (-0.0, 0.0)); }
+        static forcedinline ParallelType mulByI (ParallelType a) noexcept                  { return negateReals (swapParts (a)); }
+        static forcedinline ParallelType mulByMinusI (ParallelType a) noexcept             { return negateImaginaries (swapParts (a)); }
+
+        static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept
         {
-            const double phase = (isInverse ? 2.0 : -2.0) * double_Pi * i / fftSize;
-            twiddleTable[i].r = (float) cos (phase);
-            twiddleTable[i].i = (float) sin (phase);
+            return _mm_add_pd (_mm_mul_pd (a, _mm_unpacklo_pd (b, b)),
+                               negateReals (_mm_mul_pd (swapParts (a), _mm_unpackhi_pd (b, b))));
         }
+    };
 
-        const int root = (int) std::sqrt ((double) fftSize);
-        int divisor = 4, n = fftSize;
+    template <typename FloatType> struct VectorOps;
+    template <> struct VectorOps<float>   : public SSEOps32 {};
+    template <> struct VectorOps<double>  : public SSEOps64 {};
 
-        for (int i = 0; i < numElementsInArray (factors); ++i)
+   #elif JUCE_USE_ARM_NEON
+    struct NeonOps32
+    {
+        typedef float Type;
+        typedef float32x4_t ParallelType;
+        enum { numComplex = 2 };
+
+        static forcedinline ParallelType load (const Type* src) noexcept                   { return vld1q_f32 (src); }
+        static forcedinline void store (Type* dest, ParallelType a) noexcept                { vst1q_f32 (dest, a); }
+        static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept     { return vaddq_f32 (a, b); }
+        static forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept     { return vsubq_f32 (a, b); }
+        static forcedinline ParallelType negateReals (ParallelType a) noexcept             { const float signs[] = { -1.0f, 1.0f, -1.0f, 1.0f }; return vmulq_f32 (a, vld1q_f32 (signs)); }
+        static forcedinline ParallelType negateImaginaries (ParallelType a) noexcept       { const float signs[] = { 1.0f, -1.0f, 1.0f, -1.0f }; return vmulq_f32 (a, vld1q_f32 (signs)); }
+        static forcedinline ParallelType mulByI (ParallelType a) noexcept                  { return negateReals (vrev64q_f32 (a)); }
+        static forcedinline ParallelType mulByMinusI (ParallelType a) noexcept             { return negateImaginaries (vrev64q_f32 (a)); }
+
+        static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept
         {
-            while ((n % divisor) != 0)
-            {
-                if (divisor == 2)       divisor = 3;
-                else if (divisor == 4)  divisor = 2;
-                else                    divisor += 2;
+            const float32x4x2_t parts = vtrnq_f32 (b, b);   // (reals, imaginaries)
+            return vaddq_f32 (vmulq_f32 (a, parts.val[0]), negateReals (vmulq_f32 (vrev64q_f32 (a), parts.val[1])));
+        }
+    };
 
-                if (divisor > root)
-                    divisor = n;
-            }
+    template <typename FloatType> struct VectorOps;
+    template <> struct VectorOps<float>   : public NeonOps32 {};
+    template <> struct VectorOps<double>  : public ScalarOps<double> {};
 
-            n /= divisor;
+   #else
+    template <typename FloatType> struct VectorOps  : public ScalarOps<FloatType> {};
+   #endif
 
-            jassert (divisor == 1 || divisor == 2 || divisor == 4);
-            factors[i].radix = divisor;
-            factors[i].length = n;
-        }
-    }
+    struct PassScope
+    {
+        PassScope() noexcept {}
+    };
+
+    #define JUCE_FFT_VECTOR_TARGET
+    #include "juce_FFTKernels.h"
+    #undef JUCE_FFT_VECTOR_TARGET
 
-    void perform (const Complex* input, Complex* output) const noexcept
+    //==============================================================================
+   #if JUCE_USE_AVX_INTRINSICS
+    namespace AVX2
     {
-        perform (input, output, 1, 1, factors);
-    }
+       #if JUCE_MSVC
+        #define JUCE_FFT_VECTOR_TARGET
+       #else
+        #define JUCE_FFT_VECTOR_TARGET __attribute__ ((target ("avx2,fma")))
+       #endif
+
+        // Clears the upper halves of the vector registers at the end of each pass, so that
+        // the SSE code which runs afterwards doesn't stall.
+        struct PassScope
+        {
+            PassScope() noexcept {}
+            JUCE_FFT_VECTOR_TARGET ~PassScope() noexcept  { _mm256_zeroupper(); }
+        };
 
-    const int fftSize;
-    const bool inverse;
+        template <typename FloatType> struct VectorOps;
+
+        template <>
+        struct VectorOps<float>
+        {
+            typedef float Type;
+            typedef __m256 ParallelType;
+            enum { numComplex = 4 };
+
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType load (const Type* src) noexcept                   { return _mm256_loadu_ps (src); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline void store (Type* dest, ParallelType a) noexcept                { _mm256_storeu_ps (dest, a); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept     { return _mm256_add_ps (a, b); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept     { return _mm256_sub_ps (a, b); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType swapParts (ParallelType a) noexcept               { return _mm256_permute_ps (a, _MM_SHUFFLE (2, 3, 0, 1)); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType mulByI (ParallelType a) noexcept                  { return _mm256_xor_ps (swapParts (a), _mm256_set_ps (0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f)); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType mulByMinusI (ParallelType a) noexcept             { return _mm256_xor_ps (swapParts (a), _mm256_set_ps (-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f)); }
+
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept
+            {
+                return _mm256_fmaddsub_ps (a, _mm256_permute_ps (b, _MM_SHUFFLE (2, 2, 0, 0)),
+                                           _mm256_mul_ps (swapParts (a), _mm256_permute_ps (b, _MM_SHUFFLE (3, 3, 1, 1))));
+            }
+        };
 
-    struct Factor { int radix, length; };
-    Factor factors[32];
-    HeapBlock<Complex> twiddleTable;
+        template <>
+        struct VectorOps<double>
+        {
+            typedef double Type;
+            typedef __m256d ParallelType;
+            enum { numComplex = 2 };
+
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType load (const Type* src) noexcept                   { return _mm256_loadu_pd (src); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline void store (Type* dest, ParallelType a) noexcept                { _mm256_storeu_pd (dest, a); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType add (ParallelType a, ParallelType b) noexcept     { return _mm256_add_pd (a, b); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType sub (ParallelType a, ParallelType b) noexcept     { return _mm256_sub_pd (a, b); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType swapParts (ParallelType a) noexcept               { return _mm256_permute_pd (a, 5); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType mulByI (ParallelType a) noexcept                  { return _mm256_xor_pd (swapParts (a), _mm256_set_pd (0.0, -0.0, 0.0, -0.0)); }
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType mulByMinusI (ParallelType a) noexcept             { return _mm256_xor_pd (swapParts (a), _mm256_set_pd (-0.0, 0.0, -0.0, 0.0)); }
+
+            JUCE_FFT_VECTOR_TARGET static forcedinline ParallelType mul (ParallelType a, ParallelType b) noexcept
+            {
+                return _mm256_fmaddsub_pd (a, _mm256_permute_pd (b, 0), _mm256_mul_pd (swapParts (a), _mm256_permute_pd (b, 15)));
+            }
+        };
 
-    void perform (const Complex* input, Complex* output, const int stride, const int strideIn, const Factor* facs) const noexcept
+        #include "juce_FFTKernels.h"
+        #undef JUCE_FFT_VECTOR_TARGET
+    }
+   #endif
+
+    //==============================================================================
+    /*  A complex transform, done as a bit-reversal permutation followed by radix-4 passes
+        (with a single radix-2 pass at the start if the order is odd).
+    */
+    template <typename FloatType>
+    struct ComplexPlan
     {
-        const Factor factor (*facs++);
-        Complex* const originalOutput = output;
-        const Complex* const outputEnd = output + factor.radix * factor.length;
+        typedef FloatType Type;
 
-        if (stride == 1 && factor.radix <= 5)
+        ComplexPlan (int fftOrder, bool isInverse)
+            : order (fftOrder), size (1 << fftOrder), inverse (isInverse), bitReversed ((size_t) size)
         {
-            for (int i = 0; i < factor.radix; ++i)
-                perform (input + stride * strideIn * i, output + i * factor.length, stride * factor.radix, strideIn, facs);
+            for (int i = 0; i < size; ++i)
+            {
+                int reversed = 0;
+
+                for (int bit = 0; bit < order; ++bit)
+                    reversed |= ((i >> bit) & 1) << (order - 1 - bit);
+
+                bitReversed[i] = reversed;
+            }
+
+            int numTwiddles = 0;
 
-            butterfly (factor, output, stride);
-            return;
+            for (int quarterSize = getFirstPassSize(); quarterSize * 4 <= size; quarterSize *= 4)
+                numTwiddles += 3 * quarterSize;
+
+            twiddles.malloc ((size_t) jmax (1, 2 * numTwiddles));
+            Type* t = twiddles;
+
+            for (int quarterSize = getFirstPassSize(); quarterSize * 4 <= size; quarterSize *= 4)
+            {
+                jassert (numPasses < numElementsInArray (passes));
+
+                passes[numPasses].quarterSize = quarterSize;
+                passes[numPasses].twiddles = t;
+                ++numPasses;
+
+                for (int multiple = 1; multiple <= 3; ++multiple)
+                {
+                    for (int k = 0; k < quarterSize; ++k)
+                    {
+                        const double phase = (inverse ? 2.0 : -2.0) * double_Pi * (multiple * k) / (4 * quarterSize);
+                        *t++ = (Type) std::cos (phase);
+                        *t++ = (Type) std::sin (phase);
+                    }
+                }
+            }
         }
 
-        if (factor.length == 1)
+        // The input and output are arrays of interleaved complex values, and may be the same.
+        void perform (const Type* input, Type* output) const noexcept
         {
-            do
+            if (input == output)
             {
-                *output++ = *input;
-                input += stride * strideIn;
+                for (int i = 0; i < size; ++i)
+                {
+                    const int j = bitReversed[i];
+
+                    if (i < j)
+                    {
+                        std::swap (output[2 * i],     output[2 * j]);
+                        std::swap (output[2 * i + 1], output[2 * j + 1]);
+                    }
+                }
+
+                performFirstPass<false> (output, output);
+            }
+            else
+            {
+                performFirstPass<true> (input, output);
+            }
+
+           #if JUCE_USE_AVX_INTRINSICS
+            const bool useAVX2 = FloatVectorOperations::getActiveInstructionSet() >= FloatVectorOperations::avx2InstructionSet;
+           #endif
+
+            for (int i = 0; i < numPasses; ++i)
+            {
+                const Pass& pass = passes[i];
+
+               #if JUCE_USE_AVX_INTRINSICS
+                if (useAVX2 && pass.quarterSize >= AVX2::VectorOps<Type>::numComplex)
+                {
+                    if (inverse)  AVX2::FFTKernels<AVX2::VectorOps<Type> >::template radix4Pass<true>  (output, size, pass.quarterSize, pass.twiddles);
+                    else          AVX2::FFTKernels<AVX2::VectorOps<Type> >::template radix4Pass<false> (output, size, pass.quarterSize, pass.twiddles);
+
+                    continue;
+                }
+               #endif
+
+                jassert (pass.quarterSize >= VectorOps<Type>::numComplex);
+
+                if (inverse)  FFTKernels<VectorOps<Type> >::template radix4Pass<true>  (output, size, pass.quarterSize, pass.twiddles);
+                else          FFTKernels<VectorOps<Type> >::template radix4Pass<false> (output, size, pass.quarterSize, pass.twiddles);
             }
-            while (output < outputEnd);
         }
-        else
+
+        const int order, size;
+        const bool inverse;
+
+    private:
+        struct Pass
+        {
+            int quarterSize;
+            const Type* twiddles;
+        };
+
+        HeapBlock<int> bitReversed;
+        HeapBlock<Type> twiddles;
+        Pass passes[16];
+        int numPasses = 0;
+
+        int getFirstPassSize() const noexcept      { return (order & 1) != 0 ? 2 : 4; }
+
+        // The first pass needs no twiddles, and when working out-of-place it also does the
+        // bit-reversal, by reading its inputs from their permuted positions.
+        template <bool readPermuted>
+        void performFirstPass (const Type* input, Type* output) const noexcept
         {
-            do
+            typedef ScalarOps<Type> Ops;
+            typedef typename Ops::ParallelType Value;
+
+            const int* const sourceIndex = bitReversed;
+
+            if (order == 0)
+            {
+                output[0] = input[0];
+                output[1] = input[1];
+            }
+            else if ((order & 1) != 0)
+            {
+                for (int i = 0; i < size; i += 2)
+                {
+                    const Value a = Ops::load (input + 2 * (readPermuted ? sourceIndex[i]     : i));
+                    const Value b = Ops::load (input + 2 * (readPermuted ? sourceIndex[i + 1] : i + 1));
+
+                    Ops::store (output + 2 * i,     Ops::add (a, b));
+                    Ops::store (output + 2 * i + 2, Ops::sub (a, b));
+                }
+            }
+            else
             {
-                perform (input, output, stride * factor.radix, strideIn, facs);
-                input += stride * strideIn;
-                output += factor.length;
+                for (int i = 0; i < size; i += 4)
+                {
+                    const Value x0 = Ops::load (input + 2 * (readPermuted ? sourceIndex[i]     : i));
+                    const Value x2 = Ops::load (input + 2 * (readPermuted ? sourceIndex[i + 1] : i + 1));
+                    const Value x1 = Ops::load (input + 2 * (readPermuted ? sourceIndex[i + 2] : i + 2));
+                    const Value x3 = Ops::load (input + 2 * (readPermuted ? sourceIndex[i + 3] : i + 3));
+
+                    const Value t0 = Ops::add (x0, x2);
+                    const Value t1 = Ops::sub (x0, x2);
+                    const Value t2 = Ops::add (x1, x3);
+                    const Value t3 = inverse ? Ops::mulByI (Ops::sub (x1, x3))
+                                             : Ops::mulByMinusI (Ops::sub (x1, x3));
+
+                    Ops::store (output + 2 * i,     Ops::add (t0, t2));
+                    Ops::store (output + 2 * i + 2, Ops::add (t1, t3));
+                    Ops::store (output + 2 * i + 4, Ops::sub (t0, t2));
+                    Ops::store (output + 2 * i + 6, Ops::sub (t1, t3));
+                }
             }
-            while (output < outputEnd);
         }
 
-        butterfly (factor, originalOutput, stride);
-    }
+        JUCE_DECLARE_NON_COPYABLE (ComplexPlan)
+    };
+
+    //==============================================================================
+    /*  A real transform of size N, done by treating the even and odd samples as the real
+        and imaginary parts of a complex transform of size N / 2, and then separating the
+        two halves of the result.
 
-    void butterfly (const Factor factor, Complex* data, const int stride) const noexcept
+        The spectrum is packed as N / 2 + 1 interleaved complex bins.
+    */
+    template <typename FloatType>
+    struct RealPlan
     {
-        switch (factor.radix)
+        typedef FloatType Type;
+
+        RealPlan (int fftOrder, bool isInverse)
+            : size (1 << fftOrder), halfPlan (jmax (0, fftOrder - 1), isInverse),
+              twiddles ((size_t) (2 * (size / 4 + 1)))
         {
-            case 1:   break;
-            case 2:   butterfly2 (data, stride, factor.length); return;
-            case 4:   butterfly4 (data, stride, factor.length); return;
-            default:  jassertfalse; break;
+            for (int k = 0; k <= size / 4; ++k)
+            {
+                const double phase = (isInverse ? 2.0 : -2.0) * double_Pi * k / size;
+                twiddles[2 * k]     = (Type) std::cos (phase);
+                twiddles[2 * k + 1] = (Type) std::sin (phase);
+            }
         }
 
-        Complex* scratch = static_cast<Complex*> (alloca (sizeof (Complex) * (size_t) factor.radix));
-
-        for (int i = 0; i < factor.length; ++i)
+        // The output must have space for size + 2 values, and may be the same as the input.
+        void forward (const Type* input, Type* output) const noexcept
         {
-            for (int k = i, q1 = 0; q1 < factor.radix; ++q1)
+            if (size == 1)
             {
-                scratch[q1] = data[k];
-                k += factor.length;
+                output[0] = input[0];
+                output[1] = 0;
+                return;
             }
 
-            for (int k = i, q1 = 0; q1 < factor.radix; ++q1)
+            halfPlan.perform (input, output);
+
+            const int half = size / 2;
+            const Type z0r = output[0], z0i = output[1];
+
+            output[0] = z0r + z0i;
+            output[1] = 0;
+            output[size] = z0r - z0i;
+            output[size + 1] = 0;
+
+            for (int k = 1; k <= half / 2; ++k)
             {
-                int twiddleIndex = 0;
-                data[k] = scratch[0];
+                Type* const zk = output + 2 * k;
+                Type* const zj = output + 2 * (half - k);
+
+                // even = (z[k] + conj (z[j])) / 2, odd = -i (z[k] - conj (z[j])) / 2
+                const Type evenR = (zk[0] + zj[0]) * (Type) 0.5;
+                const Type evenI = (zk[1] - zj[1]) * (Type) 0.5;
+                const Type oddR  = (zk[1] + zj[1]) * (Type) 0.5;
+                const Type oddI  = (zj[0] - zk[0]) * (Type) 0.5;
+
+                const Type wr = twiddles[2 * k], wi = twiddles[2 * k + 1];
+                const Type rotatedR = wr * oddR - wi * oddI;
+                const Type rotatedI = wr * oddI + wi * oddR;
+
+                zk[0] = evenR + rotatedR;
+                zk[1] = evenI + rotatedI;
+                zj[0] = evenR - rotatedR;
+                zj[1] = rotatedI - evenI;
+            }
+        }
 
-                for (int q = 1; q < factor.radix; ++q)
-                {
-                    twiddleIndex += stride * k;
+        // The input holds size / 2 + 1 bins, and may be the same as the output.
+        void inverse (const Type* input, Type* output) const noexcept
+        {
+            if (size == 1)
+            {
+                output[0] = input[0];
+                return;
+            }
 
-                    if (twiddleIndex >= fftSize)
-                        twiddleIndex -= fftSize;
+            const int half = size / 2;
 
-                    data[k] += scratch[q] * twiddleTable[twiddleIndex];
-                }
+            {
+                const Type x0r = input[0], x0i = input[1], xnr = input[size], xni = input[size + 1];
 
-                k += factor.length;
+                output[0] = (x0r + xnr) - (x0i + xni);
+                output[1] = (x0i - xni) + (x0r - xnr);
             }
-        }
-    }
 
-    void butterfly2 (Complex* data, const int stride, const int length) const noexcept
-    {
-        Complex* dataEnd = data + length;
-        const Complex* tw = twiddleTable;
+            for (int k = 1; k <= half / 2; ++k)
+            {
+                const Type* const xk = input + 2 * k;
+                const Type* const xj = input + 2 * (half - k);
+
+                // even = x[k] + conj (x[j]), odd = (x[k] - conj (x[j])) * w, z[k] = even + i * odd
+                const Type evenR = xk[0] + xj[0];
+                const Type evenI = xk[1] - xj[1];
+                const Type diffR = xk[0] - xj[0];
+                const Type diffI = xk[1] + xj[1];
+
+                const Type wr = twiddles[2 * k], wi = twiddles[2 * k + 1];
+                const Type oddR = diffR * wr - diffI * wi;
+                const Type oddI = diffR * wi + diffI * wr;
+
+                output[2 * k]                  = evenR - oddI;
+                output[2 * k + 1]              = evenI + oddR;
+                output[2 * (half - k)]         = evenR + oddI;
+                output[2 * (half - k) + 1]     = oddR - evenI;
+            }
 
-        for (int i = length; --i >= 0;)
-        {
-            const Complex s (*dataEnd * *tw);
-            tw += stride;
-            *dataEnd++ = *data - s;
-            *data++ += s;
+            halfPlan.perform (output, output);
+            FloatVectorOperations::multiply (output, (Type) 1 / (Type) size, size);
         }
-    }
 
-    void butterfly4 (Complex* data, const int stride, const int length) const noexcept
+        const int size;
+
+    private:
+        ComplexPlan<Type> halfPlan;
+        HeapBlock<Type> twiddles;
+
+        JUCE_DECLARE_NON_COPYABLE (RealPlan)
+    };
+
+    //==============================================================================
+    const size_t maxFFTScratchSpaceToAlloca = 256 * 1024;
+
+    template <typename FloatType>
+    struct Plans
     {
-        const int lengthX2 = length * 2;
-        const int lengthX3 = length * 3;
+        typedef FloatType Type;
 
-        const Complex* twiddle1 = twiddleTable;
-        const Complex* twiddle2 = twiddle1;
-        const Complex* twiddle3 = twiddle1;
+        Plans (int order, bool isInverse)  : complex (order, isInverse), real (order, isInverse) {}
 
-        for (int i = length; --i >= 0;)
+        void performRealOnlyForwardTransform (Type* d) const noexcept
         {
-            const Complex s0 = data[length]   * *twiddle1;
-            const Complex s1 = data[lengthX2] * *twiddle2;
-            const Complex s2 = data[lengthX3] * *twiddle3;
-            const Complex s3 = s0 + s2;
-            const Complex s4 = s0 - s2;
-            const Complex s5 = *data - s1;
-            *data += s1;
-            data[lengthX2] = *data - s3;
-            twiddle1 += stride;
-            twiddle2 += stride * 2;
-            twiddle3 += stride * 3;
-            *data += s3;
-
-            if (inverse)
+            const int size = real.size;
+            real.forward (d, d);
+
+            for (int k = size / 2 + 1; k < size; ++k)
+            {
+                d[2 * k]     =  d[2 * (size - k)];
+                d[2 * k + 1] = -d[2 * (size - k) + 1];
+            }
+        }
+
+        // This does a full complex transform rather than assuming that the data is the
+        // spectrum of a real signal, so the imaginary parts end up in the second half.
+        void performRealOnlyInverseTransform (Type* d) const noexcept
+        {
+            const size_t scratchSize = sizeof (Type) * 2 * (size_t) real.size;
+
+            if (scratchSize < maxFFTScratchSpaceToAlloca)
             {
-                data[length].r   = s5.r - s4.i;
-                data[length].i   = s5.i + s4.r;
-                data[lengthX3].r = s5.r + s4.i;
-                data[lengthX3].i = s5.i - s4.r;
+                performRealOnlyInverseTransform (static_cast<Type*> (alloca (scratchSize)), d);
             }
             else
             {
-                data[length].r   = s5.r + s4.i;
-                data[length].i   = s5.i - s4.r;
-                data[lengthX3].r = s5.r - s4.i;
-                data[lengthX3].i = s5.i + s4.r;
+                HeapBlock<Type> heapSpace (2 * (size_t) real.size);
+                performRealOnlyInverseTransform (heapSpace.getData(), d);
             }
+        }
 
-            ++data;
+        void performRealOnlyInverseTransform (Type* scratch, Type* d) const noexcept
+        {
+            const int size = real.size;
+            const Type scaleFactor = (Type) 1 / (Type) size;
+
+            complex.perform (d, scratch);
+
+            for (int i = 0; i < size; ++i)
+            {
+                d[i]        = scratch[2 * i]     * scaleFactor;
+                d[i + size] = scratch[2 * i + 1] * scaleFactor;
+            }
         }
+
+        void performFrequencyOnlyForwardTransform (Type* d) const noexcept
+        {
+            const int size = real.size;
+            real.forward (d, d);
+
+            for (int k = 0; k <= size / 2; ++k)
+                d[k] = juce_hypot (d[2 * k], d[2 * k + 1]);
+
+            for (int k = size / 2 + 1; k < size; ++k)
+                d[k] = d[size - k];
+
+            FloatVectorOperations::clear (d + size, size);
+        }
+
+        const ComplexPlan<Type> complex;
+        const RealPlan<Type> real;
+
+        JUCE_DECLARE_NON_COPYABLE (Plans)
+    };
+}
+
+//==============================================================================
+struct FFT::FFTConfig
+{
+    FFTConfig (int order, bool isInverse)
+        : fftOrder (order), inverse (isInverse), floatPlans (order, isInverse)
+    {
+    }
+
+    ~FFTConfig()
+    {
+        delete doublePlans.get();
+    }
+
+    // The double precision tables are built the first time that they're needed, and if two
+    // threads race to do that, the loser throws its copy away.
+    const FFTHelpers::Plans<double>& getDoublePlans() const
+    {
+        if (FFTHelpers::Plans<double>* const existing = doublePlans.get())
+            return *existing;
+
+        FFTHelpers::Plans<double>* const newPlans = new FFTHelpers::Plans<double> (fftOrder, inverse);
+
+        if (! doublePlans.compareAndSetBool (newPlans, nullptr))
+            delete newPlans;
+
+        return *doublePlans.get();
     }
 
+    const int fftOrder;
+    const bool inverse;
+    const FFTHelpers::Plans<float> floatPlans;
+    mutable Atomic<FFTHelpers::Plans<double>*> doublePlans;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FFTConfig)
 };
 
 
 //==============================================================================
-FFT::FFT (int order, bool inverse)  : config (new FFTConfig (1 << order, inverse)), size (1 << order) {}
+FFT::FFT (int order, bool inverse)  : config (new FFTConfig (order, inverse)), size (1 << order) {}
 FFT::~FFT() {}
 
 void FFT::perform (const Complex* const input, Complex* const output) const noexcept
 {
-    config->perform (input, output);
+    config->floatPlans.complex.perform (&input->r, &output->r);
 }
 
-const size_t maxFFTScratchSpaceToAlloca = 256 * 1024;
+void FFT::perform (const ComplexDouble* const input, ComplexDouble* const output) const noexcept
+{
+    config->getDoublePlans().complex.perform (&input->r, &output->r);
+}
 
 void FFT::performRealOnlyForwardTransform (float* d) const noexcept
 {
-    const size_t scratchSize = 16 + sizeof (FFT::Complex) * (size_t) size;
+    // This can only be called on an FFT object that was created to do forward transforms.
+    jassert (! config->inverse);
 
-    if (scratchSize < maxFFTScratchSpaceToAlloca)
-    {
-        performRealOnlyForwardTransform (static_cast<Complex*> (alloca (scratchSize)), d);
-    }
-    else
-    {
-        HeapBlock<char> heapSpace (scratchSize);
-        performRealOnlyForwardTransform (reinterpret_cast<Complex*> (heapSpace.getData()), d);
-    }
+    config->floatPlans.performRealOnlyForwardTransform (d);
+}
+
+void FFT::performRealOnlyForwardTransform (double* d) const noexcept
+{
+    // This can only be called on an FFT object that was created to do forward transforms.
+    jassert (! config->inverse);
+
+    config->getDoublePlans().performRealOnlyForwardTransform (d);
 }
 
 void FFT::performRealOnlyInverseTransform (float* d) const noexcept
 {
-    const size_t scratchSize = 16 + sizeof (FFT::Complex) * (size_t) size;
+    // This can only be called on an FFT object that was created to do inverse transforms.
+    jassert (config->inverse);
 
-    if (scratchSize < maxFFTScratchSpaceToAlloca)
-    {
-        performRealOnlyInverseTransform (static_cast<Complex*> (alloca (scratchSize)), d);
-    }
-    else
-    {
-        HeapBlock<char> heapSpace (scratchSize);
-        performRealOnlyInverseTransform (reinterpret_cast<Complex*> (heapSpace.getData()), d);
-    }
+    config->floatPlans.performRealOnlyInverseTransform (d);
+}
+
+void FFT::performRealOnlyInverseTransform (double* d) const noexcept
+{
+    // This can only be called on an FFT object that was created to do inverse transforms.
+    jassert (config->inverse);
+
+    config->getDoublePlans().performRealOnlyInverseTransform (d);
 }
 
-void FFT::performRealOnlyForwardTransform (Complex* scratch, float* d) const noexcept
+void FFT::performFrequencyOnlyForwardTransform (float* d) const noexcept
 {
     // This can only be called on an FFT object that was created to do forward transforms.
     jassert (! config->inverse);
 
-    for (int i = 0; i < size; ++i)
-    {
-        scratch[i].r = d[i];
-        scratch[i].i = 0;
-    }
+    config->floatPlans.performFrequencyOnlyForwardTransform (d);
+}
 
-    perform (scratch, reinterpret_cast<Complex*> (d));
+void FFT::performFrequencyOnlyForwardTransform (double* d) const noexcept
+{
+    // This can only be called on an FFT object that was created to do forward transforms.
+    jassert (! config->inverse);
+
+    config->getDoublePlans().performFrequencyOnlyForwardTransform (d);
+}
+
+void FFT::performRealForward (const float* input, Complex* output) const noexcept
+{
+    // This can only be called on an FFT object that was created to do forward transforms.
+    jassert (! config->inverse);
+
+    config->floatPlans.real.forward (input, &output->r);
 }
 
-void FFT::performRealOnlyInverseTransform (Complex* scratch, float* d) const noexcept
+void FFT::performRealForward (const double* input, ComplexDouble* output) const noexcept
+{
+    // This can only be called on an FFT object that was created to do forward transforms.
+    jassert (! config->inverse);
+
+    config->getDoublePlans().real.forward (input, &output->r);
+}
+
+void FFT::performRealInverse (const Complex* input, float* output) const noexcept
 {
     // This can only be called on an FFT object that was created to do inverse transforms.
     jassert (config->inverse);
 
-    perform (reinterpret_cast<const Complex*> (d), scratch);
+    config->floatPlans.real.inverse (&input->r, output);
+}
 
-    const float scaleFactor = 1.0f / size;
+void FFT::performRealInverse (const ComplexDouble* input, double* output) const noexcept
+{
+    // This can only be called on an FFT object that was created to do inverse transforms.
+    jassert (config->inverse);
 
-    for (int i = 0; i < size; ++i)
-    {
-        d[i]        = scratch[i].r * scaleFactor;
-        d[i + size] = scratch[i].i * scaleFactor;
-    }
+    config->getDoublePlans().real.inverse (&input->r, output);
 }
 
-void FFT::performFrequencyOnlyForwardTransform (float* d) const noexcept
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class FFTTests  : public UnitTest
 {
-    performRealOnlyForwardTransform (d);
-    const int twiceSize = size * 2;
+public:
+    FFTTests() : UnitTest ("FFT") {}
 
-    for (int i = 0; i < twiceSize; i += 2)
+    template <typename FloatType, typename ComplexType>
+    struct TestRunner
     {
-        d[i / 2] = juce_hypot (d[i], d[i + 1]);
+        static void runTest (UnitTest& u, Random& random, int order)
+        {
+            const int size = 1 << order;
+            const double tolerance = (sizeof (FloatType) == sizeof (float) ? 2.0e-6 : 1.0e-14) * size;
+            const FFT forward (order, false), inverse (order, true);
+
+            HeapBlock<ComplexType> input ((size_t) size, true), output ((size_t) size, true), inPlace ((size_t) size, true);
+            HeapBlock<FFT::ComplexDouble> expected ((size_t) size, true);
+
+            for (int i = 0; i < size; ++i)
+            {
+                input[i].r = (FloatType) (random.nextDouble() * 2.0 - 1.0);
+                input[i].i = (FloatType) (random.nextDouble() * 2.0 - 1.0);
+            }
+
+            // complex transforms, out-of-place and in-place
+            forward.perform (input, output);
+            performDFT (input, expected, size, false);
+            u.expect (getMaxDifference (output, expected, size) < tolerance);
+
+            memcpy (inPlace, input, sizeof (ComplexType) * (size_t) size);
+            forward.perform (inPlace, inPlace);
+            u.expect (memcmp (inPlace, output, sizeof (ComplexType) * (size_t) size) == 0);
+
+            inverse.perform (output, inPlace);
+            performDFT (output, expected, size, true);
+            u.expect (getMaxDifference (inPlace, expected, size) < tolerance);
+
+            // real transforms
+            HeapBlock<FloatType> samples ((size_t) size, true), data ((size_t) size * 2, true), reconstructed ((size_t) size, true), zeros ((size_t) size, true);
+            HeapBlock<ComplexType> bins ((size_t) size / 2 + 1, true);
+
+            for (int i = 0; i < size; ++i)
+            {
+                samples[i] = data[i] = input[i].r;
+                input[i].i = 0;
+            }
+
+            performDFT (input, expected, size, false);
+
+            forward.performRealForward (samples, bins);
+            u.expect (getMaxDifference (bins, expected, size / 2 + 1) < tolerance);
+
+            forward.performRealOnlyForwardTransform (data);
+            u.expect (getMaxDifference (reinterpret_cast<const ComplexType*> (data.getData()), expected, size) < tolerance);
+
+            inverse.performRealInverse (bins, reconstructed);
+            u.expect (getMaxDifference (reconstructed, samples, size) < tolerance);
+
+            inverse.performRealOnlyInverseTransform (data);
+            u.expect (getMaxDifference (data, samples, size) < tolerance);
+            u.expect (getMaxDifference (data + size, zeros, size) < tolerance);
+
+            memcpy (data, samples, sizeof (FloatType) * (size_t) size);
+            forward.performFrequencyOnlyForwardTransform (data);
+
+            for (int i = 0; i < size; ++i)
+                u.expect (std::abs (data[i] - juce_hypot (expected[i].r, expected[i].i)) < tolerance);
+
+            // a real-only inverse of a spectrum that isn't symmetrical
+            memcpy (data, output, sizeof (ComplexType) * (size_t) size);
+            inverse.performRealOnlyInverseTransform (data);
+            performDFT (output, expected, size, true);
+
+            for (int i = 0; i < size; ++i)
+            {
+                u.expect (std::abs (data[i]        - expected[i].r / size) < tolerance);
+                u.expect (std::abs (data[i + size] - expected[i].i / size) < tolerance);
+            }
+        }
 
-        if (i >= size)
+        static void performDFT (const ComplexType* input, FFT::ComplexDouble* output, int size, bool inverse)
         {
-            d[i] = 0;
-            d[i + 1] = 0;
+            for (int k = 0; k < size; ++k)
+            {
+                double sumR = 0, sumI = 0;
+
+                for (int n = 0; n < size; ++n)
+                {
+                    const double phase = (inverse ? 2.0 : -2.0) * double_Pi * ((k * n) % size) / size;
+                    const double c = std::cos (phase), s = std::sin (phase);
+
+                    sumR += input[n].r * c - input[n].i * s;
+                    sumI += input[n].r * s + input[n].i * c;
+                }
+
+                output[k].r = sumR;
+                output[k].i = sumI;
+            }
+        }
+
+        static double getMaxDifference (const ComplexType* a, const FFT::ComplexDouble* b, int num)
+        {
+            double maxDiff = 0;
+
+            for (int i = 0; i < num; ++i)
+                maxDiff = jmax (maxDiff, std::abs (a[i].r - b[i].r), std::abs (a[i].i - b[i].i));
+
+            return maxDiff;
         }
+
+        static double getMaxDifference (const FloatType* a, const FloatType* b, int num)
+        {
+            double maxDiff = 0;
+
+            for (int i = 0; i < num; ++i)
+                maxDiff = jmax (maxDiff, (double) std::abs (a[i] - b[i]));
+
+            return maxDiff;
+        }
+    };
+
+    void runTest() override
+    {
+        const FloatVectorOperations::InstructionSet originalSet = FloatVectorOperations::getActiveInstructionSet();
+
+        for (int set = FloatVectorOperations::baselineInstructionSet; set <= FloatVectorOperations::avx2InstructionSet; ++set)
+        {
+            if (FloatVectorOperations::setMaximumInstructionSet ((FloatVectorOperations::InstructionSet) set) != set)
+                continue;
+
+            beginTest ("FFT (instruction set " + String (set) + ")");
+            Random random (getRandom());
+
+            for (int order = 0; order <= 10; ++order)
+            {
+                TestRunner<float, FFT::Complex>::runTest (*this, random, order);
+                TestRunner<double, FFT::ComplexDouble>::runTest (*this, random, order);
+            }
+        }
+
+        FloatVectorOperations::setMaximumInstructionSet (originalSet);
     }
-}
+};
+
+static FFTTests fftTests;
+
+#endif
@@ -21,15 +21,22 @@
 */
 
 /**
-    A very minimal FFT class.
+    Performs fast Fourier transforms of power-of-two sizes.
 
-    This is only a simple low-footprint implementation and isn't tuned for speed - it may
-    be useful for simple applications where one of the more complex FFT libraries would be
-    overkill. (But in the future it may end up becoming optimised of course...)
+    This is a radix-4 implementation which builds all its lookup tables when it's created,
+    and which uses SSE, AVX2 or NEON butterflies where they're available (the AVX2 ones are
+    chosen at runtime, see FloatVectorOperations::setMaximumInstructionSet()). Real-only
+    transforms are done with a complex transform of half the size, so they're roughly
+    twice as fast as the complex ones.
 
     The FFT class itself contains lookup tables, so there's some overhead in creating
     one, you should create and cache an FFT object for each size/direction of transform
     that you need, and re-use them to perform the actual operation.
+
+    Both single and double precision data can be transformed by the same object, but the
+    tables for double precision are only built the first time that one of the double
+    precision methods is called, so if you're going to call them on the audio thread, it's
+    best to call one of them once beforehand.
 */
 class JUCE_API  FFT
 {
@@ -49,13 +56,29 @@ public:
         float i;  /**< Imaginary part. */
     };
 
-    /** Performs an out-of-place FFT, either forward or inverse depending on the mode
-        that was passed to this object's constructor.
+    /** A double precision complex number, for the purposes of the FFT class. */
+    struct ComplexDouble
+    {
+        double r;  /**< Real part. */
+        double i;  /**< Imaginary part. */
+    };
 
-        The arrays must contain at least getSize() elements.
+    /** Performs an FFT, either forward or inverse depending on the mode that was passed
+        to this object's constructor.
+
+        The arrays must contain at least getSize() elements. The input and output can be
+        the same array, in which case the transform is done in-place. Neither transform
+        is scaled, so performing a forward and then an inverse transform will multiply
+        the data by getSize().
     */
     void perform (const Complex* input, Complex* output) const noexcept;
 
+    /** Performs a double precision FFT, either forward or inverse depending on the mode
+        that was passed to this object's constructor.
+        @see perform (const Complex*, Complex*)
+    */
+    void perform (const ComplexDouble* input, ComplexDouble* output) const noexcept;
+
     /** Performs an in-place forward transform on a block of real data.
 
         The size of the array passed in must be 2 * getSize(), and the first half
@@ -65,19 +88,66 @@ public:
     */
     void performRealOnlyForwardTransform (float* inputOutputData) const noexcept;
 
+    /** Performs an in-place double precision forward transform on a block of real data.
+        @see performRealOnlyForwardTransform (float*)
+    */
+    void performRealOnlyForwardTransform (double* inputOutputData) const noexcept;
+
     /** Performs a reverse operation to data created in performRealOnlyForwardTransform().
 
         The size of the array passed in must be 2 * getSize(), containing complex
         frequency and phase data. On return, the first half of the array will contain
         the reconstituted samples.
+
+        All getSize() bins are used, and the imaginary parts of the result are left in
+        the second half of the array. If you know that your data is the spectrum of a
+        real signal, performRealInverse() is faster, as it only needs the first
+        getSize() / 2 + 1 bins.
     */
     void performRealOnlyInverseTransform (float* inputOutputData) const noexcept;
 
+    /** Performs a double precision reverse operation to data created in performRealOnlyForwardTransform().
+        @see performRealOnlyInverseTransform (float*)
+    */
+    void performRealOnlyInverseTransform (double* inputOutputData) const noexcept;
+
     /** Takes an array and simply transforms it to the frequency spectrum.
         This may be handy for things like frequency displays or analysis.
     */
     void performFrequencyOnlyForwardTransform (float* inputOutputData) const noexcept;
 
+    /** Takes an array and simply transforms it to the frequency spectrum, in double precision.
+        @see performFrequencyOnlyForwardTransform (float*)
+    */
+    void performFrequencyOnlyForwardTransform (double* inputOutputData) const noexcept;
+
+    /** Performs a forward transform of getSize() real samples, writing only the
+        getSize() / 2 + 1 non-redundant frequency bins.
+
+        This avoids the work and the memory needed to fill in the mirrored half of the
+        spectrum that performRealOnlyForwardTransform() produces. The output can be the same
+        memory as the input, as long as it's big enough to hold getSize() + 2 floats.
+    */
+    void performRealForward (const float* input, Complex* output) const noexcept;
+
+    /** Performs a double precision forward transform of getSize() real samples, writing
+        only the getSize() / 2 + 1 non-redundant frequency bins.
+        @see performRealForward (const float*, Complex*)
+    */
+    void performRealForward (const double* input, ComplexDouble* output) const noexcept;
+
+    /** Performs the reverse of performRealForward(), turning getSize() / 2 + 1 frequency
+        bins back into getSize() real samples, scaled so that they match the original data.
+
+        The output can be the same memory as the input.
+    */
+    void performRealInverse (const Complex* input, float* output) const noexcept;
+
+    /** Performs the double precision reverse of performRealForward().
+        @see performRealInverse (const Complex*, float*)
+    */
+    void performRealInverse (const ComplexDouble* input, double* output) const noexcept;
+
     /** Returns the number of data points that this FFT was created to work with. */
     int getSize() const noexcept            { return size; }
 
@@ -86,8 +156,5 @@ private:
     ScopedPointer<FFTConfig> config;
     const int size;
 
-    void performRealOnlyForwardTransform (Complex*, float*) const noexcept;
-    void performRealOnlyInverseTransform (Complex*, float*) const noexcept;
-
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FFT)
 };
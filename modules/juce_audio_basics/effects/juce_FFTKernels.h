@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+/*  This file is deliberately included more than once by juce_FFT.cpp: once for the
+    baseline instruction set, and once inside a namespace for AVX2. Each of those namespaces
+    declares a PassScope struct, and defines JUCE_FFT_VECTOR_TARGET as the attribute that
+    lets the compiler use its instruction set in a function.
+
+    The Ops structs that these are instantiated with each handle numComplex interleaved
+    complex values at a time.
+*/
+
+template <typename Ops>
+struct FFTKernels
+{
+    typedef typename Ops::Type Type;
+    typedef typename Ops::ParallelType ParallelType;
+    enum { numComplex = Ops::numComplex };
+
+    /*  Performs one radix-4 decimation-in-time pass, combining each group of four
+        neighbouring sub-transforms of quarterSize points into one of 4 * quarterSize points.
+
+        Because the data was put into bit-reversed order, the sub-transform made from the
+        inputs at offset 2 (mod 4) is the second one in each group, and the one from the
+        inputs at offset 1 is the third one.
+
+        The twiddles are three tables of quarterSize complex values, holding w^k, w^2k
+        and w^3k, where w is the group's fundamental root of unity.
+    */
+    template <bool inverse>
+    JUCE_FFT_VECTOR_TARGET static void radix4Pass (Type* data, int size, int quarterSize, const Type* twiddles) noexcept
+    {
+        const PassScope scope;
+
+        const int stride = 2 * quarterSize;
+        const Type* const twiddles1 = twiddles;
+        const Type* const twiddles2 = twiddles1 + stride;
+        const Type* const twiddles3 = twiddles2 + stride;
+
+        for (Type* group = data, * const end = data + 2 * size; group < end; group += 4 * stride)
+        {
+            for (int k = 0; k < stride; k += 2 * numComplex)
+            {
+                Type* const p0 = group + k;
+                Type* const p1 = p0 + stride;
+                Type* const p2 = p1 + stride;
+                Type* const p3 = p2 + stride;
+
+                const ParallelType x0 = Ops::load (p0);
+                const ParallelType x1 = Ops::mul (Ops::load (p2), Ops::load (twiddles1 + k));
+                const ParallelType x2 = Ops::mul (Ops::load (p1), Ops::load (twiddles2 + k));
+                const ParallelType x3 = Ops::mul (Ops::load (p3), Ops::load (twiddles3 + k));
+
+                const ParallelType t0 = Ops::add (x0, x2);
+                const ParallelType t1 = Ops::sub (x0, x2);
+                const ParallelType t2 = Ops::add (x1, x3);
+                const ParallelType t3 = inverse ? Ops::mulByI (Ops::sub (x1, x3))
+                                                : Ops::mulByMinusI (Ops::sub (x1, x3));
+
+                Ops::store (p0, Ops::add (t0, t2));
+                Ops::store (p1, Ops::add (t1, t3));
+                Ops::store (p2, Ops::sub (t0, t2));
+                Ops::store (p3, Ops::sub (t1, t3));
+            }
+        }
+    }
+};
@@ -0,0 +1,438 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace IIRFilterBankHelpers
+{
+    struct KernelScope
+    {
+        KernelScope() noexcept {}
+    };
+
+    #define JUCE_IIR_BANK_TARGET
+    #include "juce_IIRFilterBankKernels.h"
+    #undef JUCE_IIR_BANK_TARGET
+
+    typedef FloatVectorHelpers::ModeType<4>::Mode BaselineOps;
+    typedef IIRFilterBankKernels<BaselineOps> BaselineKernels;
+
+   #if JUCE_USE_AVX_INTRINSICS
+    namespace AVX2
+    {
+        #define JUCE_IIR_BANK_TARGET JUCE_AVX2_TARGET
+
+        // Clears the upper halves of the vector registers when the kernel finishes, so that
+        // the SSE code which runs afterwards doesn't stall.
+        struct KernelScope
+        {
+            KernelScope() noexcept {}
+            JUCE_IIR_BANK_TARGET ~KernelScope() noexcept  { _mm256_zeroupper(); }
+        };
+
+        #include "juce_IIRFilterBankKernels.h"
+        #undef JUCE_IIR_BANK_TARGET
+
+        typedef IIRFilterBankKernels<FloatVectorHelpers::AVX2::Ops32> Kernels;
+    }
+   #endif
+
+    static void snapToZero (float* values, int num) noexcept
+    {
+       #if JUCE_INTEL
+        for (int i = 0; i < num; ++i)
+            if (! (values[i] < -1.0e-8f || values[i] > 1.0e-8f))
+                values[i] = 0;
+       #else
+        ignoreUnused (values, num);
+       #endif
+    }
+}
+
+//==============================================================================
+IIRFilterBank::IIRFilterBank() {}
+IIRFilterBank::~IIRFilterBank() {}
+
+void IIRFilterBank::prepare (int newNumChannels, int newNumSections)
+{
+    const SpinLock::ScopedLockType sl (writerLock);
+
+    numChannels = jmax (0, newNumChannels);
+    numSections = jmax (0, newNumSections);
+    numGroups = (numChannels + lanesPerGroup - 1) / lanesPerGroup;
+
+    const size_t numCoefficients = (size_t) (numGroups * numSections * 5 * lanesPerGroup);
+    coefficients.malloc (numCoefficients);
+    increments.calloc (numCoefficients);
+    targets.malloc (numCoefficients);
+    state.calloc ((size_t) (numGroups * numSections * 2 * lanesPerGroup));
+    samplesToTarget.calloc ((size_t) numGroups);
+
+    pending.malloc ((size_t) (numChannels * numSections * 5));
+    pendingCopy.malloc ((size_t) (numChannels * numSections * 5));
+
+    laneData.malloc ((size_t) (maxChunkSize * lanesPerGroup));
+    silence.calloc ((size_t) maxChunkSize);
+    discard.malloc ((size_t) maxChunkSize);
+
+    const float passThrough[] = { 1.0f, 0, 0, 0, 0 };
+
+    for (size_t i = 0; i < numCoefficients; ++i)
+        coefficients[i] = targets[i] = passThrough[(i / lanesPerGroup) % 5];
+
+    for (int i = 0; i < numChannels * numSections; ++i)
+        memcpy (pending + i * 5, passThrough, sizeof (passThrough));
+
+    lastVersionUsed = pendingVersion.get();
+}
+
+//==============================================================================
+void IIRFilterBank::setSmoothingLength (int numSamples) noexcept
+{
+    smoothingLength = jmax (0, numSamples);
+}
+
+void IIRFilterBank::setCoefficients (int channel, int section, const IIRCoefficients& newCoefficients) noexcept
+{
+    const float* const c = newCoefficients.coefficients;
+    const float values[] = { c[0], c[1], c[2], -c[3], -c[4] };
+
+    writePending (channel, section, values);
+}
+
+void IIRFilterBank::setCoefficients (int section, const IIRCoefficients& newCoefficients) noexcept
+{
+    const float* const c = newCoefficients.coefficients;
+    const float values[] = { c[0], c[1], c[2], -c[3], -c[4] };
+
+    writePending (-1, section, values);
+}
+
+void IIRFilterBank::makeInactive (int channel, int section) noexcept
+{
+    const float passThrough[] = { 1.0f, 0, 0, 0, 0 };
+    writePending (channel, section, passThrough);
+}
+
+// A channel of -1 means all of them
+void IIRFilterBank::writePending (int channel, int section, const float* values) noexcept
+{
+    const SpinLock::ScopedLockType sl (writerLock);
+
+    if (! (isPositiveAndBelow (section, numSections) && (channel < 0 || isPositiveAndBelow (channel, numChannels))))
+    {
+        jassertfalse;
+        return;
+    }
+
+    ++pendingVersion;
+
+    for (int i = (channel < 0 ? 0 : channel), end = (channel < 0 ? numChannels : channel + 1); i < end; ++i)
+        memcpy (pending + (i * numSections + section) * 5, values, 5 * sizeof (float));
+
+    ++pendingVersion;
+}
+
+void IIRFilterBank::updateCoefficients() noexcept
+{
+    const int version = pendingVersion.get();
+
+    if (version == lastVersionUsed || (version & 1) != 0)
+        return;
+
+    memcpy (pendingCopy, pending, sizeof (float) * (size_t) (numChannels * numSections * 5));
+
+    // if a writer got in while we were copying, the copy may be torn, so try again next time
+    if (pendingVersion.get() != version)
+        return;
+
+    lastVersionUsed = version;
+
+    for (int group = 0; group < numGroups; ++group)
+    {
+        float* const groupTargets = getGroupData (targets, group, 5);
+        bool changed = false;
+
+        for (int lane = 0; lane < lanesPerGroup; ++lane)
+        {
+            const int channel = group * lanesPerGroup + lane;
+
+            if (channel >= numChannels)
+                break;
+
+            for (int section = 0; section < numSections; ++section)
+            {
+                const float* const newValues = pendingCopy + (channel * numSections + section) * 5;
+                float* const target = groupTargets + section * 5 * lanesPerGroup + lane;
+
+                for (int i = 0; i < 5; ++i)
+                {
+                    changed = changed || target[i * lanesPerGroup] != newValues[i];
+                    target[i * lanesPerGroup] = newValues[i];
+                }
+            }
+        }
+
+        if (! changed)
+            continue;
+
+        float* const current = getGroupData (coefficients, group, 5);
+        const int num = numSections * 5 * lanesPerGroup;
+
+        if (smoothingLength > 0)
+        {
+            float* const groupIncrements = getGroupData (increments, group, 5);
+
+            for (int i = 0; i < num; ++i)
+                groupIncrements[i] = (groupTargets[i] - current[i]) / (float) smoothingLength;
+
+            samplesToTarget[group] = smoothingLength;
+        }
+        else
+        {
+            FloatVectorOperations::copy (current, groupTargets, num);
+            samplesToTarget[group] = 0;
+        }
+    }
+}
+
+//==============================================================================
+void IIRFilterBank::reset() noexcept
+{
+    updateCoefficients();
+
+    FloatVectorOperations::clear (state, numGroups * numSections * 2 * lanesPerGroup);
+    FloatVectorOperations::copy (coefficients, targets, numGroups * numSections * 5 * lanesPerGroup);
+    zeromem (samplesToTarget, sizeof (int) * (size_t) numGroups);
+}
+
+void IIRFilterBank::processSamples (float* const* channels, int numChannelsToProcess, int numSamples) noexcept
+{
+    updateCoefficients();
+
+    numChannelsToProcess = jmin (numChannelsToProcess, numChannels);
+
+    for (int group = 0; group < numGroups; ++group)
+    {
+        const int firstChannel = group * lanesPerGroup;
+        const int numChannelsInGroup = jmin ((int) lanesPerGroup, numChannelsToProcess - firstChannel);
+
+        if (numChannelsInGroup <= 0)
+            break;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int num = jmin (numSamples - done, (int) maxChunkSize);
+            const float* sources[lanesPerGroup];
+            float* dests[lanesPerGroup];
+
+            for (int lane = 0; lane < lanesPerGroup; ++lane)
+            {
+                if (lane < numChannelsInGroup)
+                {
+                    dests[lane] = channels[firstChannel + lane] + done;
+                    sources[lane] = dests[lane];
+                }
+                else
+                {
+                    sources[lane] = silence;
+                    dests[lane] = discard;
+                }
+            }
+
+            FloatVectorOperations::interleave (laneData, sources, lanesPerGroup, num);
+            processGroup (group, numChannelsInGroup, num);
+            FloatVectorOperations::deinterleave (dests, laneData, lanesPerGroup, num);
+
+            done += num;
+        }
+
+        IIRFilterBankHelpers::snapToZero (getGroupData (state, group, 2), numSections * 2 * lanesPerGroup);
+    }
+}
+
+void IIRFilterBank::processGroup (int group, int numChannelsInGroup, int numSamples) noexcept
+{
+    using namespace IIRFilterBankHelpers;
+
+    float* const groupCoefficients = getGroupData (coefficients, group, 5);
+    float* const groupIncrements = getGroupData (increments, group, 5);
+    float* const groupState = getGroupData (state, group, 2);
+
+   #if JUCE_USE_AVX_INTRINSICS
+    const bool useAVX2 = numChannelsInGroup > BaselineOps::numParallel
+                          && FloatVectorOperations::getActiveInstructionSet() >= FloatVectorOperations::avx2InstructionSet;
+   #endif
+
+    for (int start = 0; start < numSamples;)
+    {
+        const bool smoothing = samplesToTarget[group] > 0;
+        const int num = smoothing ? jmin (numSamples - start, samplesToTarget[group]) : numSamples - start;
+        float* const data = laneData + start * lanesPerGroup;
+
+       #if JUCE_USE_AVX_INTRINSICS
+        if (useAVX2)
+        {
+            AVX2::Kernels::process (data, num, numSections, groupCoefficients, groupIncrements, groupState, smoothing);
+        }
+        else
+       #endif
+        {
+            for (int lane = 0; lane < numChannelsInGroup; lane += BaselineOps::numParallel)
+                BaselineKernels::process (data + lane, num, numSections, groupCoefficients + lane,
+                                          groupIncrements + lane, groupState + lane, smoothing);
+        }
+
+        if (smoothing && (samplesToTarget[group] -= num) == 0)
+            FloatVectorOperations::copy (groupCoefficients, getGroupData (targets, group, 5), numSections * 5 * lanesPerGroup);
+
+        start += num;
+    }
+}
+
+float* IIRFilterBank::getGroupData (HeapBlock<float>& block, int group, int valuesPerSection) const noexcept
+{
+    return block + group * numSections * valuesPerSection * lanesPerGroup;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class IIRFilterBankTests  : public UnitTest
+{
+public:
+    IIRFilterBankTests() : UnitTest ("IIRFilterBank") {}
+
+    void runTest() override
+    {
+        const FloatVectorOperations::InstructionSet originalSet = FloatVectorOperations::getActiveInstructionSet();
+
+        for (int set = FloatVectorOperations::baselineInstructionSet; set <= FloatVectorOperations::avx2InstructionSet; ++set)
+        {
+            if (FloatVectorOperations::setMaximumInstructionSet ((FloatVectorOperations::InstructionSet) set) != set)
+                continue;
+
+            beginTest ("Matches IIRFilter (instruction set " + String (set) + ")");
+            testAgainstIIRFilters (getRandom(), 11, 3);
+            testAgainstIIRFilters (getRandom(), 2, 1);
+        }
+
+        FloatVectorOperations::setMaximumInstructionSet (originalSet);
+
+        beginTest ("Smoothing");
+        {
+            IIRFilterBank bank;
+            bank.prepare (1, 1);
+            bank.setSmoothingLength (100);
+
+            HeapBlock<float> data (300);
+            float* channels[] = { data.getData() };
+
+            FloatVectorOperations::fill (data, 1.0f, 300);
+            bank.processSamples (channels, 1, 10);
+            expect (FloatVectorOperations::findMinAndMax (data, 10) == Range<float> (1.0f, 1.0f));
+
+            // a gain of 0.5, which should be reached by a straight line over 100 samples
+            bank.setCoefficients (0, 0, IIRCoefficients (0.5, 0, 0, 1.0, 0, 0));
+            bank.processSamples (channels, 1, 60);
+            channels[0] += 60;
+            bank.processSamples (channels, 1, 240);
+
+            for (int i = 0; i < 300; ++i)
+                expectWithinAbsoluteError (data[i], i < 100 ? 1.0f - 0.5f * (float) (i + 1) / 100.0f : 0.5f, 1.0e-5f);
+
+            bank.makeInactive (0, 0);
+            bank.setSmoothingLength (0);
+            FloatVectorOperations::fill (data, 1.0f, 10);
+            channels[0] = data;
+            bank.processSamples (channels, 1, 10);
+            expect (FloatVectorOperations::findMinAndMax (data, 10) == Range<float> (1.0f, 1.0f));
+        }
+    }
+
+    void testAgainstIIRFilters (Random random, int numChannels, int numSections)
+    {
+        IIRFilterBank bank;
+        bank.prepare (numChannels, numSections);
+        OwnedArray<IIRFilter> filters;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            for (int section = 0; section < numSections; ++section)
+            {
+                const double frequency = 50.0 + random.nextDouble() * 15000.0;
+                IIRCoefficients c;
+
+                switch (random.nextInt (3))
+                {
+                    case 0:   c = IIRCoefficients::makeLowPass (44100.0, frequency); break;
+                    case 1:   c = IIRCoefficients::makeHighPass (44100.0, frequency); break;
+                    default:  c = IIRCoefficients::makePeakFilter (44100.0, frequency, 1.0, 2.0f); break;
+                }
+
+                bank.setCoefficients (channel, section, c);
+
+                IIRFilter* const filter = filters.add (new IIRFilter());
+                filter->setCoefficients (c);
+            }
+        }
+
+        const int numSamples = 2000;
+        AudioSampleBuffer input (numChannels, numSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                input.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        AudioSampleBuffer output (input), expected (input);
+
+        for (int pos = 0; pos < numSamples;)
+        {
+            const int num = jmin (numSamples - pos, random.nextInt (700) + 1);
+            HeapBlock<float*> channels ((size_t) numChannels);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                channels[channel] = output.getWritePointer (channel, pos);
+
+                for (int section = 0; section < numSections; ++section)
+                    filters.getUnchecked (channel * numSections + section)->processSamples (expected.getWritePointer (channel, pos), num);
+            }
+
+            bank.processSamples (channels, numChannels, num);
+            pos += num;
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float maxError = 0;
+
+            for (int i = 0; i < numSamples; ++i)
+                maxError = jmax (maxError, std::abs (output.getSample (channel, i) - expected.getSample (channel, i)));
+
+            expect (maxError < 1.0e-4f, "error = " + String (maxError));
+        }
+    }
+};
+
+static IIRFilterBankTests iirFilterBankTests;
+
+#endif
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+
+//==============================================================================
+/**
+    Applies cascades of biquad filters to many channels at once.
+
+    Each channel passes through the same number of sections, but every section of every
+    channel can have its own coefficients. The channels are processed in groups of eight,
+    with each channel in a lane of a SIMD register, so a bank of filters costs little more
+    than one or two IIRFilter objects, and the AVX2 version is picked at runtime when the
+    CPU supports it (see FloatVectorOperations::setMaximumInstructionSet()).
+
+    The coefficients can be changed from any thread without blocking the audio thread.
+    Changes are picked up at the start of the next call to processSamples(), and if you've
+    set a smoothing length, the coefficients are interpolated towards their new values
+    sample-by-sample, so that automating them doesn't cause zipper noise.
+
+    @see IIRFilter, IIRCoefficients
+*/
+class JUCE_API  IIRFilterBank
+{
+public:
+    //==============================================================================
+    /** Creates an empty filter bank. Call prepare() before using it. */
+    IIRFilterBank();
+
+    /** Destructor. */
+    ~IIRFilterBank();
+
+    //==============================================================================
+    /** Allocates the filters for a number of channels, each with a cascade of the given
+        number of biquad sections.
+
+        All the sections start off inactive, so that audio passes through them unchanged.
+        This allocates memory, so mustn't be called while processSamples() may be running.
+    */
+    void prepare (int numChannels, int numSectionsPerChannel);
+
+    /** Returns the number of channels that the bank was prepared for. */
+    int getNumChannels() const noexcept                 { return numChannels; }
+
+    /** Returns the number of sections that each channel passes through. */
+    int getNumSections() const noexcept                 { return numSections; }
+
+    //==============================================================================
+    /** Sets the number of samples over which the coefficients will move to new values.
+        If this is zero (the default), new coefficients are used immediately.
+    */
+    void setSmoothingLength (int numSamples) noexcept;
+
+    /** Changes the coefficients of one section of one channel.
+        This can be called on any thread, while processSamples() is running.
+    */
+    void setCoefficients (int channel, int section, const IIRCoefficients& newCoefficients) noexcept;
+
+    /** Changes the coefficients of one section of every channel.
+        This can be called on any thread, while processSamples() is running.
+    */
+    void setCoefficients (int section, const IIRCoefficients& newCoefficients) noexcept;
+
+    /** Makes one section of a channel pass its input through unchanged.
+        This can be called on any thread, while processSamples() is running.
+    */
+    void makeInactive (int channel, int section) noexcept;
+
+    //==============================================================================
+    /** Resets all the filters' processing pipelines, and moves any coefficients that are
+        being smoothed straight to their new values.
+    */
+    void reset() noexcept;
+
+    /** Filters some channels of audio in-place.
+        If numChannels is less than the number the bank was prepared for, the others are
+        left alone.
+    */
+    void processSamples (float* const* channels, int numChannels, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    enum { lanesPerGroup = 8, maxChunkSize = 256 };
+
+    int numChannels = 0, numSections = 0, numGroups = 0, smoothingLength = 0;
+
+    // For each group: [section][b0, b1, b2, -a1, -a2][lane]
+    HeapBlock<float> coefficients, increments, targets;
+    // For each group: [section][v1, v2][lane]
+    HeapBlock<float> state;
+    HeapBlock<int> samplesToTarget;
+    HeapBlock<float> laneData, silence, discard;
+
+    // The coefficients are passed to the audio thread through a sequence lock: writers
+    // make the version odd while they're changing the pending values, and the audio
+    // thread only uses a copy of them if the version was even and didn't change.
+    SpinLock writerLock;
+    HeapBlock<float> pending, pendingCopy;
+    Atomic<int> pendingVersion;
+    int lastVersionUsed = 0;
+
+    void writePending (int channel, int section, const float* values) noexcept;
+    void updateCoefficients() noexcept;
+    void processGroup (int group, int numChannelsInGroup, int numSamples) noexcept;
+    float* getGroupData (HeapBlock<float>&, int group, int valuesPerSection) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IIRFilterBank)
+};
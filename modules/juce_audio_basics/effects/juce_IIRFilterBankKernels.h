@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+/*  This file is deliberately included more than once by juce_IIRFilterBank.cpp: once for the
+    baseline instruction set, and once inside a namespace for AVX2. Each of those namespaces
+    declares a KernelScope struct, and defines JUCE_IIR_BANK_TARGET as the attribute that lets
+    the compiler use its instruction set in a function.
+
+    The data and coefficients are interleaved with a stride of 8 lanes, and each call
+    processes the Ops::numParallel lanes that the pointers start at.
+*/
+
+template <typename Ops>
+struct IIRFilterBankKernels
+{
+    typedef typename Ops::ParallelType ParallelType;
+    enum { stride = 8 };
+
+    // A transposed direct form II biquad, the same as IIRFilter uses
+    JUCE_IIR_BANK_TARGET static forcedinline void tick (float* sample, ParallelType b0, ParallelType b1, ParallelType b2,
+                                                        ParallelType na1, ParallelType na2,
+                                                        ParallelType& v1, ParallelType& v2) noexcept
+    {
+        const ParallelType in = Ops::loadU (sample);
+        const ParallelType out = Ops::add (Ops::mul (b0, in), v1);
+
+        v1 = Ops::add (Ops::add (Ops::mul (b1, in), Ops::mul (na1, out)), v2);
+        v2 = Ops::add (Ops::mul (b2, in), Ops::mul (na2, out));
+
+        Ops::storeU (sample, out);
+    }
+
+    // Runs each section over the whole block in turn, so that its coefficients and state
+    // can stay in registers. While smoothing, the coefficients are stepped before each sample.
+    JUCE_IIR_BANK_TARGET static void process (float* data, int numSamples, int numSections,
+                                              float* coefficients, const float* increments,
+                                              float* state, bool smoothing) noexcept
+    {
+        const KernelScope scope;
+
+        for (int section = 0; section < numSections; ++section)
+        {
+            float* const c = coefficients + section * 5 * stride;
+            float* const s = state + section * 2 * stride;
+
+            ParallelType b0 = Ops::loadU (c),              b1 = Ops::loadU (c + stride),
+                         b2 = Ops::loadU (c + 2 * stride), na1 = Ops::loadU (c + 3 * stride),
+                         na2 = Ops::loadU (c + 4 * stride);
+
+            ParallelType v1 = Ops::loadU (s), v2 = Ops::loadU (s + stride);
+
+            if (smoothing)
+            {
+                const float* const inc = increments + section * 5 * stride;
+                const ParallelType db0 = Ops::loadU (inc),              db1 = Ops::loadU (inc + stride),
+                                   db2 = Ops::loadU (inc + 2 * stride), dna1 = Ops::loadU (inc + 3 * stride),
+                                   dna2 = Ops::loadU (inc + 4 * stride);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    b0 = Ops::add (b0, db0);
+                    b1 = Ops::add (b1, db1);
+                    b2 = Ops::add (b2, db2);
+                    na1 = Ops::add (na1, dna1);
+                    na2 = Ops::add (na2, dna2);
+
+                    tick (data + i * stride, b0, b1, b2, na1, na2, v1, v2);
+                }
+
+                Ops::storeU (c, b0);
+                Ops::storeU (c + stride, b1);
+                Ops::storeU (c + 2 * stride, b2);
+                Ops::storeU (c + 3 * stride, na1);
+                Ops::storeU (c + 4 * stride, na2);
+            }
+            else
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    tick (data + i * stride, b0, b1, b2, na1, na2, v1, v2);
+            }
+
+            Ops::storeU (s, v1);
+            Ops::storeU (s + stride, v2);
+        }
+    }
+};
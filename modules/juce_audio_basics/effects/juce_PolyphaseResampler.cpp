@@ -0,0 +1,590 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace PolyphaseResamplerHelpers
+{
+    struct KernelScope
+    {
+        KernelScope() noexcept {}
+    };
+
+    #define JUCE_RESAMPLER_TARGET
+    #include "juce_PolyphaseResamplerKernels.h"
+    #undef JUCE_RESAMPLER_TARGET
+
+    typedef PolyphaseResamplerKernels<FloatVectorHelpers::ModeType<4>::Mode> BaselineKernels;
+
+   #if JUCE_USE_AVX_INTRINSICS
+    namespace AVX2
+    {
+        #define JUCE_RESAMPLER_TARGET JUCE_AVX2_TARGET
+
+        struct KernelScope
+        {
+            KernelScope() noexcept {}
+            JUCE_RESAMPLER_TARGET ~KernelScope() noexcept  { _mm256_zeroupper(); }
+        };
+
+        #include "juce_PolyphaseResamplerKernels.h"
+        #undef JUCE_RESAMPLER_TARGET
+
+        typedef PolyphaseResamplerKernels<FloatVectorHelpers::AVX2::Ops32> Kernels;
+    }
+   #endif
+
+    struct QualitySettings
+    {
+        int halfLength;     // the number of taps on each side of the centre, when not downsampling
+        double beta;        // the Kaiser window's shape parameter
+        double passband;    // the cutoff, as a proportion of the lower of the two Nyquist frequencies
+        int numPhases;      // the number of rows in the table when the ratio isn't exact
+    };
+
+    // The cutoffs put the start of each filter's stop-band at about the Nyquist frequency
+    static QualitySettings getSettings (PolyphaseResampler::Quality quality) noexcept
+    {
+        const QualitySettings settings[] = { { 8,  5.0,  0.80, 64 },
+                                             { 16, 7.0,  0.86, 128 },
+                                             { 32, 9.0,  0.91, 256 },
+                                             { 64, 12.0, 0.93, 1024 } };
+
+        return settings[jlimit (0, 3, (int) quality)];
+    }
+
+    static double besselI0 (double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 100; ++k)
+        {
+            const double t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+
+            if (term < sum * 1.0e-15)
+                break;
+        }
+
+        return sum;
+    }
+
+    // Finds a fraction numerator / denominator equal to the ratio, if the table it needs isn't too big
+    static bool findExactRatio (double ratio, int numTaps, int64& numerator, int64& denominator) noexcept
+    {
+        for (int d = 1; d <= 1024 && d * numTaps <= 262144; ++d)
+        {
+            const double n = ratio * d;
+            const double rounded = std::floor (n + 0.5);
+
+            if (rounded >= 1.0 && std::abs (n - rounded) < 1.0e-9 * d)
+            {
+                numerator = (int64) rounded;
+                denominator = d;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    enum { fixedPointBits = 32 };
+}
+
+//==============================================================================
+PolyphaseResampler::PolyphaseResampler()
+{
+    windowStarts.malloc ((size_t) maxChunkSize);
+    rows.malloc ((size_t) maxChunkSize);
+    fractions.malloc ((size_t) maxChunkSize);
+    updateTable();
+    reset();
+}
+
+PolyphaseResampler::~PolyphaseResampler() {}
+
+void PolyphaseResampler::prepare (int newNumChannels)
+{
+    numChannels = jmax (0, newNumChannels);
+    history.free();
+    resizeHistory (numTaps);
+    reset();
+}
+
+void PolyphaseResampler::setQuality (Quality newQuality)
+{
+    if (quality != newQuality)
+    {
+        quality = newQuality;
+        tableRatio = 0;
+        updateTable();
+        reset();
+    }
+}
+
+void PolyphaseResampler::setRatio (double inputSamplesPerOutputSample)
+{
+    jassert (inputSamplesPerOutputSample > 0);
+
+    if (ratio != inputSamplesPerOutputSample && inputSamplesPerOutputSample > 0)
+    {
+        ratio = inputSamplesPerOutputSample;
+        updateTable();
+    }
+}
+
+void PolyphaseResampler::reset() noexcept
+{
+    if (history != nullptr)
+        history.clear ((size_t) (numChannels * historySize));
+
+    windowEnd = 0;
+    phase = 0;
+}
+
+float* PolyphaseResampler::getHistory (int channel) const noexcept
+{
+    return history + channel * historySize;
+}
+
+void PolyphaseResampler::resizeHistory (int newNumTaps)
+{
+    const int newHistorySize = newNumTaps + maxChunkSize;
+
+    if (history != nullptr && newHistorySize == historySize)
+        return;
+
+    HeapBlock<float> newHistory ((size_t) (numChannels * newHistorySize), true);
+
+    // keep the most recent input samples, so that changing the ratio doesn't cause a gap
+    if (history != nullptr)
+    {
+        const int numToKeep = jmin (numTaps, newNumTaps);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            FloatVectorOperations::copy (newHistory + channel * newHistorySize + newNumTaps - numToKeep,
+                                         getHistory (channel) + numTaps - numToKeep, numToKeep);
+    }
+
+    history.swapWith (newHistory);
+    historySize = newHistorySize;
+}
+
+//==============================================================================
+void PolyphaseResampler::updateTable()
+{
+    using namespace PolyphaseResamplerHelpers;
+
+    const QualitySettings settings (getSettings (quality));
+
+    // When downsampling by a ratio that isn't exact, the table is made for the ratio rounded up
+    // to the next 1/32 of an octave, so that small changes to the ratio can share it
+    const double roundedRatio = ratio <= 1.0 ? 1.0 : std::pow (2.0, std::ceil (std::log (ratio) / std::log (2.0) * 32.0 - 1.0e-9) / 32.0);
+
+    int64 numerator = 0, denominator = 0;
+    const int maxTaps = ((2 * roundToInt (std::ceil (settings.halfLength * jmax (1.0, ratio))) + 15) & ~15);
+    const bool exact = findExactRatio (ratio, maxTaps, numerator, denominator);
+    const double newTableRatio = exact ? ratio : roundedRatio;
+    const int64 newDenominator = exact ? denominator : ((int64) 1 << fixedPointBits);
+
+    // move the current position to the new phase units
+    phase = jmin (newDenominator - 1, (int64) ((double) phase / (double) phaseDenominator * (double) newDenominator + 0.5));
+    phaseDenominator = newDenominator;
+    phaseIncrement = exact ? numerator : (int64) (ratio * (double) newDenominator + 0.5);
+    isIdentity = exact && numerator == 1 && denominator == 1;
+
+    if (exact == exactRatio && newTableRatio == tableRatio && table != nullptr)
+        return;
+
+    exactRatio = exact;
+    tableRatio = newTableRatio;
+
+    const double stretch = jmax (1.0, tableRatio);
+    const int newHalfLength = roundToInt (std::ceil (settings.halfLength * stretch));
+    const int newNumTaps = (2 * newHalfLength + 15) & ~15;
+    const double cutoff = 0.5 * settings.passband / stretch;
+    const int numPhases = exact ? (int) denominator : settings.numPhases;
+    const int numRows = exact ? numPhases : numPhases + 1;
+
+    phaseShift = exact ? 0 : (fixedPointBits - roundToInt (std::log ((double) numPhases) / std::log (2.0)));
+
+    resizeHistory (newNumTaps);
+
+    // keep the output lined up with the input if the delay changes
+    windowEnd = jmax (-1, windowEnd + newHalfLength - halfLength);
+    halfLength = newHalfLength;
+    numTaps = newNumTaps;
+
+    table.malloc ((size_t) (numRows * numTaps));
+    const double windowScale = 1.0 / besselI0 (settings.beta);
+
+    for (int row = 0; row < numRows; ++row)
+    {
+        float* const coefficients = table + row * numTaps;
+        const double offset = row / (double) numPhases;
+        double total = 0;
+
+        // the coefficients are reversed, so that the newest input sample uses the last one
+        for (int i = 0; i < numTaps; ++i)
+        {
+            const double x = (numTaps - 1 - i) + offset - halfLength;
+            const double w = x / halfLength;
+            double value = 0;
+
+            if (std::abs (w) < 1.0)
+            {
+                const double t = 2.0 * cutoff * x;
+                const double sinc = t == 0 ? 1.0 : std::sin (double_Pi * t) / (double_Pi * t);
+                value = 2.0 * cutoff * sinc * besselI0 (settings.beta * std::sqrt (1.0 - w * w)) * windowScale;
+            }
+
+            coefficients[i] = (float) value;
+            total += value;
+        }
+
+        // normalise each row to unity gain at DC, so that the positions don't modulate the level
+        FloatVectorOperations::multiply (coefficients, (float) (1.0 / total), numTaps);
+    }
+}
+
+//==============================================================================
+int PolyphaseResampler::getNumInputSamplesNeeded (int numOutputSamples) const noexcept
+{
+    if (numOutputSamples <= 0)
+        return 0;
+
+    const int64 lastPosition = windowEnd + (phase + (numOutputSamples - 1) * phaseIncrement) / phaseDenominator;
+    return (int) jmax ((int64) 0, lastPosition + 1);
+}
+
+int PolyphaseResampler::process (const float* const* inputs, float* const* outputs,
+                                 int numChannelsToProcess, int numOutputSamples) noexcept
+{
+    jassert (numChannelsToProcess <= numChannels);
+    numChannelsToProcess = jmin (numChannelsToProcess, numChannels);
+
+    const int numInputsNeeded = getNumInputSamplesNeeded (numOutputSamples);
+    const int64 fractionMask = ((int64) 1 << phaseShift) - 1;
+    const float fractionScale = 1.0f / (float) (fractionMask + 1);
+    const int wholeStep = (int) (phaseIncrement / phaseDenominator);
+    const int64 fractionalStep = phaseIncrement % phaseDenominator;
+    const bool useAVX2 = FloatVectorOperations::getActiveInstructionSet() >= FloatVectorOperations::avx2InstructionSet;
+    ignoreUnused (useAVX2);
+
+    int inputsDone = 0, outputsDone = 0;
+
+    while (inputsDone < numInputsNeeded || outputsDone < numOutputSamples)
+    {
+        // Each chunk appends some input to the history, and calculates all the outputs whose windows end inside it
+        const int numIn = jmin (numInputsNeeded - inputsDone, (int) maxChunkSize);
+        int numOut = 0;
+
+        while (numOut < maxChunkSize && outputsDone + numOut < numOutputSamples && windowEnd < numIn)
+        {
+            windowStarts[numOut] = windowEnd + 1;
+
+            if (exactRatio)
+            {
+                rows[numOut] = table + phase * numTaps;
+            }
+            else
+            {
+                rows[numOut] = table + (phase >> phaseShift) * numTaps;
+                fractions[numOut] = (float) (phase & fractionMask) * fractionScale;
+            }
+
+            windowEnd += wholeStep;
+            phase += fractionalStep;
+
+            if (phase >= phaseDenominator)
+            {
+                phase -= phaseDenominator;
+                ++windowEnd;
+            }
+
+            ++numOut;
+        }
+
+        // if the chunk filled up with outputs, the following ones may still need some of its input
+        const int numToConsume = jmin (numIn, windowEnd + 1);
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            float* const h = getHistory (channel);
+            float* const dest = outputs[channel] + outputsDone;
+
+            FloatVectorOperations::copy (h + numTaps, inputs[channel] + inputsDone, numIn);
+
+            if (numOut > 0)
+            {
+                if (isIdentity)
+                {
+                    FloatVectorOperations::copy (dest, h + windowStarts[0] + numTaps - 1 - halfLength, numOut);
+                }
+               #if JUCE_USE_AVX_INTRINSICS
+                else if (useAVX2)
+                {
+                    PolyphaseResamplerHelpers::AVX2::Kernels::process (h, dest, numOut, numTaps, windowStarts, rows,
+                                                                       exactRatio ? nullptr : fractions.getData());
+                }
+               #endif
+                else
+                {
+                    PolyphaseResamplerHelpers::BaselineKernels::process (h, dest, numOut, numTaps, windowStarts, rows,
+                                                                         exactRatio ? nullptr : fractions.getData());
+                }
+            }
+
+            memmove (h, h + numToConsume, sizeof (float) * (size_t) numTaps);
+        }
+
+        windowEnd -= numToConsume;
+        inputsDone += numToConsume;
+        outputsDone += numOut;
+    }
+
+    return numInputsNeeded;
+}
+
+//==============================================================================
+void PolyphaseResampler::resample (const AudioSampleBuffer& source, double sourceSampleRate,
+                                   AudioSampleBuffer& destination, double destinationSampleRate,
+                                   Quality quality)
+{
+    jassert (sourceSampleRate > 0 && destinationSampleRate > 0);
+
+    const int numChannels = source.getNumChannels();
+    const int numIn = source.getNumSamples();
+    const int numOut = (int) std::ceil (numIn * destinationSampleRate / sourceSampleRate - 1.0e-9);
+
+    destination.setSize (numChannels, numOut, false, false, true);
+
+    PolyphaseResampler resampler;
+    resampler.setQuality (quality);
+    resampler.setRatio (sourceSampleRate / destinationSampleRate);
+    resampler.prepare (numChannels);
+
+    // Starting with the window ahead by the filter's delay means that the first output lines up with the first input
+    resampler.windowEnd = resampler.halfLength;
+
+    HeapBlock<const float*> inputs ((size_t) numChannels);
+    HeapBlock<float*> outputs ((size_t) numChannels);
+    AudioSampleBuffer tail;
+
+    for (int inputPos = 0, outputPos = 0; outputPos < numOut;)
+    {
+        const int num = jmin (numOut - outputPos, 8192);
+        const int numNeeded = resampler.getNumInputSamplesNeeded (num);
+
+        if (inputPos + numNeeded <= numIn)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                inputs[channel] = source.getReadPointer (channel, inputPos);
+        }
+        else
+        {
+            // near the end, the filter needs to read past it, so use a copy that's padded with silence
+            tail.setSize (numChannels, numNeeded, false, false, true);
+            tail.clear();
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                if (inputPos < numIn)
+                    tail.copyFrom (channel, 0, source, channel, inputPos, numIn - inputPos);
+
+                inputs[channel] = tail.getReadPointer (channel);
+            }
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            outputs[channel] = destination.getWritePointer (channel, outputPos);
+
+        resampler.process (inputs, outputs, numChannels, num);
+
+        inputPos += numNeeded;
+        outputPos += num;
+    }
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PolyphaseResamplerTests  : public UnitTest
+{
+public:
+    PolyphaseResamplerTests() : UnitTest ("PolyphaseResampler") {}
+
+    void runTest() override
+    {
+        const FloatVectorOperations::InstructionSet originalSet = FloatVectorOperations::getActiveInstructionSet();
+
+        for (int set = FloatVectorOperations::baselineInstructionSet; set <= FloatVectorOperations::avx2InstructionSet; ++set)
+        {
+            if (FloatVectorOperations::setMaximumInstructionSet ((FloatVectorOperations::InstructionSet) set) != set)
+                continue;
+
+            beginTest ("Sine accuracy (instruction set " + String (set) + ")");
+            testSine (44100.0, 48000.0, true);
+            testSine (48000.0, 44100.0, true);
+            testSine (44100.0, 88200.0, true);
+            testSine (96000.0, 48000.0, true);
+            testSine (44100.0, 47999.3, false);
+            testSine (48000.0, 44011.0, false);
+
+            beginTest ("Aliasing (instruction set " + String (set) + ")");
+            testAliasing (2.0);
+            testAliasing (1.37);
+        }
+
+        FloatVectorOperations::setMaximumInstructionSet (originalSet);
+
+        beginTest ("Streaming");
+        testStreaming (44100.0 / 48000.0);
+        testStreaming (4.0);
+        testStreaming (0.25);
+        testStreaming (0.7713);
+        testStreaming (1.0);
+
+        beginTest ("Identity");
+        {
+            Random r = getRandom();
+            AudioSampleBuffer in (1, 3000), out;
+
+            for (int i = 0; i < in.getNumSamples(); ++i)
+                in.setSample (0, i, r.nextFloat() * 2.0f - 1.0f);
+
+            PolyphaseResampler::resample (in, 44100.0, out, 44100.0);
+            expectEquals (out.getNumSamples(), in.getNumSamples());
+
+            for (int i = 0; i < in.getNumSamples(); ++i)
+                expectEquals (out.getSample (0, i), in.getSample (0, i));
+        }
+    }
+
+    void testSine (double sourceRate, double destRate, bool shouldBeExact)
+    {
+        const double frequency = 1000.0;
+        AudioSampleBuffer in (2, (int) sourceRate / 4), out;
+
+        for (int i = 0; i < in.getNumSamples(); ++i)
+        {
+            in.setSample (0, i, (float) std::sin (2.0 * double_Pi * frequency * i / sourceRate));
+            in.setSample (1, i, (float) std::cos (2.0 * double_Pi * frequency * i / sourceRate));
+        }
+
+        {
+            PolyphaseResampler resampler;
+            resampler.setRatio (sourceRate / destRate);
+            expect (resampler.isUsingExactRatio() == shouldBeExact);
+        }
+
+        PolyphaseResampler::resample (in, sourceRate, out, destRate);
+        expectEquals (out.getNumSamples(), (int) std::ceil (in.getNumSamples() * destRate / sourceRate - 1.0e-9));
+
+        float maxError = 0;
+
+        // ignore the ends, where the filter reaches outside the signal
+        for (int i = 200; i < out.getNumSamples() - 200; ++i)
+        {
+            maxError = jmax (maxError, std::abs (out.getSample (0, i) - (float) std::sin (2.0 * double_Pi * frequency * i / destRate)));
+            maxError = jmax (maxError, std::abs (out.getSample (1, i) - (float) std::cos (2.0 * double_Pi * frequency * i / destRate)));
+        }
+
+        expect (maxError < 1.0e-3f, "error = " + String (maxError));
+    }
+
+    void testAliasing (double ratio)
+    {
+        // a tone above the output's Nyquist frequency, which should be filtered away
+        const double sourceRate = 48000.0, destRate = sourceRate / ratio;
+        const double frequency = destRate * 0.58;
+        AudioSampleBuffer in (1, 24000), out;
+
+        for (int i = 0; i < in.getNumSamples(); ++i)
+            in.setSample (0, i, (float) std::sin (2.0 * double_Pi * frequency * i / sourceRate));
+
+        PolyphaseResampler::resample (in, sourceRate, out, destRate);
+
+        const float peak = out.getMagnitude (0, 500, out.getNumSamples() - 1000);
+        expect (peak < Decibels::decibelsToGain (-70.0f), "level = " + String (Decibels::gainToDecibels (peak)) + " dB");
+    }
+
+    void testStreaming (double ratio)
+    {
+        Random r = getRandom();
+        const int numChannels = 3, numOut = 20000;
+        const int numIn = (int) (numOut * ratio) + 200;
+        AudioSampleBuffer in (numChannels, numIn), expected (numChannels, numOut), out (numChannels, numOut);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numIn; ++i)
+                in.setSample (channel, i, r.nextFloat() * 2.0f - 1.0f);
+
+        PolyphaseResampler resampler;
+        resampler.setRatio (ratio);
+        resampler.prepare (numChannels);
+
+        // all in one go
+        expectEquals (resampler.process (in.getArrayOfReadPointers(), expected.getArrayOfWritePointers(), numChannels, numOut),
+                      expectedInputCount (ratio, numOut));
+
+        // and in random-sized blocks
+        resampler.reset();
+
+        for (int inPos = 0, outPos = 0; outPos < numOut;)
+        {
+            const int num = jmin (numOut - outPos, r.nextInt (3000));
+            const int numNeeded = resampler.getNumInputSamplesNeeded (num);
+            const float* inputs[numChannels];
+            float* outputs[numChannels];
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                inputs[channel] = in.getReadPointer (channel, inPos);
+                outputs[channel] = out.getWritePointer (channel, outPos);
+            }
+
+            expectEquals (resampler.process (inputs, outputs, numChannels, num), numNeeded);
+            inPos += numNeeded;
+            outPos += num;
+        }
+
+        int numDifferences = 0;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numOut; ++i)
+                if (out.getSample (channel, i) != expected.getSample (channel, i))
+                    ++numDifferences;
+
+        expectEquals (numDifferences, 0);
+    }
+
+    static int expectedInputCount (double ratio, int numOut)
+    {
+        // the first output's window ends on the first input, and each following one moves on by the ratio
+        return (int) std::floor ((numOut - 1) * ratio + 1.0e-6) + 1;
+    }
+};
+
+static PolyphaseResamplerTests polyphaseResamplerTests;
+
+#endif
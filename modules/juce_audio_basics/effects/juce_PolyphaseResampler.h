@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+
+//==============================================================================
+/**
+    A high-quality sample-rate converter, using a windowed-sinc filter that's stored as a
+    table of polyphase branches.
+
+    Unlike LagrangeInterpolator and CatmullRomInterpolator, this removes the frequencies
+    that would alias when it downsamples, and the images that would appear when it
+    upsamples, so it's suitable for converting between sample rates without colouring the
+    sound. The cost is a delay of getLatencyInInputSamples(), and more work per sample,
+    which is done with SIMD dot-products.
+
+    When the ratio between the rates can be written as a fraction with a small denominator
+    (e.g. 44.1kHz <-> 48kHz, or 2x and 4x oversampling), the filter is calculated for every
+    position that an output sample can fall on, and used exactly. Other ratios (including
+    ones that change continuously, for varispeed) interpolate between a fixed set of
+    precalculated positions.
+
+    For resampling a buffer that's already in memory, the static resample() method
+    handles the delay for you.
+
+    @see ResamplingAudioSource, LagrangeInterpolator
+*/
+class JUCE_API  PolyphaseResampler
+{
+public:
+    //==============================================================================
+    /** Creates a resampler, using highQuality and a ratio of 1.0.
+        Call prepare() before using it.
+    */
+    PolyphaseResampler();
+
+    /** Destructor. */
+    ~PolyphaseResampler();
+
+    //==============================================================================
+    /** The presets that trade the filter's steepness and stop-band rejection
+        against the CPU that it uses.
+    */
+    enum Quality
+    {
+        lowQuality,     /**< 16 taps, about 50dB of rejection. */
+        mediumQuality,  /**< 32 taps, about 70dB of rejection. */
+        highQuality,    /**< 64 taps, about 90dB of rejection. */
+        bestQuality     /**< 128 taps, about 120dB of rejection. */
+    };
+
+    /** Allocates the history for a number of channels, and resets the resampler. */
+    void prepare (int numChannels);
+
+    /** Changes the filter quality. This recalculates the filter table, and resets the resampler. */
+    void setQuality (Quality newQuality);
+
+    /** Returns the current quality setting. */
+    Quality getQuality() const noexcept                         { return quality; }
+
+    /** Changes the number of input samples that are used for each output sample.
+
+        Values above 1.0 reduce the sample rate, and values below 1.0 increase it.
+        This can be called between calls to process(), and the resampler carries on from
+        the same position. If the new ratio needs a different filter table, calculating
+        it will allocate memory, but ratios that only change slightly when upsampling (or
+        within about 2% when downsampling) share the same table.
+    */
+    void setRatio (double inputSamplesPerOutputSample);
+
+    /** Returns the ratio that was passed to setRatio(). */
+    double getRatio() const noexcept                            { return ratio; }
+
+    /** Returns true if the current ratio is handled by one of the exact tables, rather
+        than by interpolating between filter positions.
+    */
+    bool isUsingExactRatio() const noexcept                     { return exactRatio; }
+
+    /** Returns the delay that the filter introduces, as a number of input samples. */
+    double getLatencyInInputSamples() const noexcept            { return (double) halfLength; }
+
+    /** Clears the history of input samples, and goes back to the start position. */
+    void reset() noexcept;
+
+    //==============================================================================
+    /** Returns the number of input samples that the next call to process() will
+        use to produce the given number of output samples.
+    */
+    int getNumInputSamplesNeeded (int numOutputSamples) const noexcept;
+
+    /** Resamples some channels of a stream.
+
+        @param inputs               the source data. Each channel must contain at least
+                                    getNumInputSamplesNeeded (numOutputSamples) samples
+        @param outputs              the buffers to write the results into
+        @param numChannels          the number of channels to process, which mustn't be
+                                    more than the number passed to prepare()
+        @param numOutputSamples     the number of output samples to create
+
+        @returns the number of input samples that were used, which will be the same as
+                 getNumInputSamplesNeeded (numOutputSamples)
+    */
+    int process (const float* const* inputs, float* const* outputs,
+                 int numChannels, int numOutputSamples) noexcept;
+
+    //==============================================================================
+    /** Converts a whole buffer to a different sample rate.
+
+        The destination is resized to hold the result, and the filter's delay is removed,
+        so the first output sample lines up with the first input sample.
+    */
+    static void resample (const AudioSampleBuffer& source, double sourceSampleRate,
+                          AudioSampleBuffer& destination, double destinationSampleRate,
+                          Quality quality = highQuality);
+
+private:
+    //==============================================================================
+    enum { maxChunkSize = 1024 };
+
+    Quality quality = highQuality;
+    double ratio = 1.0, tableRatio = 0;
+    bool exactRatio = false, isIdentity = false;
+    int numChannels = 0, halfLength = 0, numTaps = 0, historySize = 0;
+
+    // The position of the next output sample: the index of the newest input sample that
+    // it uses (relative to the next input sample to arrive), and the fractional part of its
+    // position as phase / phaseDenominator. For exact ratios the denominator is the number
+    // of phases in the table, otherwise it's 2^32, and the phase is interpolated.
+    int windowEnd = 0;
+    int64 phase = 0, phaseIncrement = 0, phaseDenominator = 1;
+    int phaseShift = 0;
+
+    HeapBlock<float> table, history;
+    HeapBlock<int> windowStarts;
+    HeapBlock<const float*> rows;
+    HeapBlock<float> fractions;
+
+    void updateTable();
+    void resizeHistory (int newNumTaps);
+    float* getHistory (int channel) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolyphaseResampler)
+};
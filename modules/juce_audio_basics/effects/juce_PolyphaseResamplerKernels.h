@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+/*  This file is deliberately included more than once by juce_PolyphaseResampler.cpp: once for
+    the baseline instruction set, and once inside a namespace for AVX2. Each of those namespaces
+    declares a KernelScope struct, and defines JUCE_RESAMPLER_TARGET as the attribute that lets
+    the compiler use its instruction set in a function.
+
+    The number of taps is always a multiple of 16, so the dot-products need no scalar tails.
+*/
+
+template <typename Ops>
+struct PolyphaseResamplerKernels
+{
+    typedef typename Ops::ParallelType ParallelType;
+    enum { numParallel = Ops::numParallel };
+
+    JUCE_RESAMPLER_TARGET static forcedinline float sum (ParallelType v) noexcept
+    {
+        float values[numParallel];
+        Ops::storeU (values, v);
+
+        float total = values[0];
+
+        for (int i = 1; i < numParallel; ++i)
+            total += values[i];
+
+        return total;
+    }
+
+    // Two accumulators, to hide some of the latency of the additions
+    JUCE_RESAMPLER_TARGET static forcedinline float dotProduct (const float* x, const float* c, int numTaps) noexcept
+    {
+        ParallelType a = Ops::mul (Ops::loadU (x), Ops::loadU (c));
+        ParallelType b = Ops::mul (Ops::loadU (x + numParallel), Ops::loadU (c + numParallel));
+
+        for (int i = 2 * numParallel; i < numTaps; i += 2 * numParallel)
+        {
+            a = Ops::add (a, Ops::mul (Ops::loadU (x + i), Ops::loadU (c + i)));
+            b = Ops::add (b, Ops::mul (Ops::loadU (x + i + numParallel), Ops::loadU (c + i + numParallel)));
+        }
+
+        return sum (Ops::add (a, b));
+    }
+
+    // Calculates the outputs for two neighbouring rows of the table at once, sharing the loads of the input
+    JUCE_RESAMPLER_TARGET static forcedinline float interpolatedDotProduct (const float* x, const float* c, int numTaps, float fraction) noexcept
+    {
+        const float* const c2 = c + numTaps;
+        ParallelType a = Ops::mul (Ops::loadU (x), Ops::loadU (c));
+        ParallelType b = Ops::mul (Ops::loadU (x), Ops::loadU (c2));
+
+        for (int i = numParallel; i < numTaps; i += numParallel)
+        {
+            const ParallelType in = Ops::loadU (x + i);
+            a = Ops::add (a, Ops::mul (in, Ops::loadU (c + i)));
+            b = Ops::add (b, Ops::mul (in, Ops::loadU (c2 + i)));
+        }
+
+        const float y1 = sum (a);
+        return y1 + fraction * (sum (b) - y1);
+    }
+
+    /*  Calculates numOutputs samples, each of which is the dot-product of numTaps input samples
+        starting at input + windowStarts[n] with the table row rows[n]. If fractions is non-null,
+        each output is interpolated between rows[n] and the row that follows it.
+    */
+    JUCE_RESAMPLER_TARGET static void process (const float* input, float* dest, int numOutputs, int numTaps,
+                                               const int* windowStarts, const float* const* rows,
+                                               const float* fractions) noexcept
+    {
+        const KernelScope scope;
+
+        if (fractions == nullptr)
+        {
+            for (int i = 0; i < numOutputs; ++i)
+                dest[i] = dotProduct (input + windowStarts[i], rows[i], numTaps);
+        }
+        else
+        {
+            for (int i = 0; i < numOutputs; ++i)
+                dest[i] = interpolatedDotProduct (input + windowStarts[i], rows[i], numTaps, fractions[i]);
+        }
+    }
+};
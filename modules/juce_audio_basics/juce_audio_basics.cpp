@@ -51,6 +51,23 @@
  #include <emmintrin.h>
 #endif
 
+/*  The AVX2 and AVX-512 versions of the FloatVectorOperations are compiled into the same binary
+    as the SSE ones and are chosen at runtime, so this needs a compiler which can target those
+    instruction sets on a per-function basis.
+*/
+#if JUCE_USE_SSE_INTRINSICS && ! defined (JUCE_USE_AVX_INTRINSICS) && ! JUCE_MINGW \
+     && (JUCE_CLANG || (JUCE_MSVC && _MSC_VER >= 1910) || (JUCE_GCC && (__GNUC__ * 100 + __GNUC_MINOR__) >= 409))
+ #define JUCE_USE_AVX_INTRINSICS 1
+#endif
+
+#if ! JUCE_USE_SSE_INTRINSICS
+ #undef JUCE_USE_AVX_INTRINSICS
+#endif
+
+#if JUCE_USE_AVX_INTRINSICS
+ #include <immintrin.h>
+#endif
+
 #ifndef JUCE_USE_VDSP_FRAMEWORK
  #define JUCE_USE_VDSP_FRAMEWORK 1
 #endif
@@ -83,15 +100,19 @@ namespace juce
 #include "buffers/juce_FloatVectorOperations.cpp"
 #include "buffers/juce_AudioChannelSet.cpp"
 #include "effects/juce_IIRFilter.cpp"
+#include "effects/juce_IIRFilterBank.cpp"
+#include "effects/juce_PolyphaseResampler.cpp"
 #include "effects/juce_LagrangeInterpolator.cpp"
 #include "effects/juce_CatmullRomInterpolator.cpp"
 #include "effects/juce_FFT.cpp"
+#include "effects/juce_Convolution.cpp"
 #include "midi/juce_MidiBuffer.cpp"
 #include "midi/juce_MidiFile.cpp"
 #include "midi/juce_MidiKeyboardState.cpp"
 #include "midi/juce_MidiMessage.cpp"
 #include "midi/juce_MidiMessageSequence.cpp"
 #include "midi/juce_MidiRPN.cpp"
+#include "synthesisers/juce_ParallelVoiceRenderer.cpp"
 #include "mpe/juce_MPEValue.cpp"
 #include "mpe/juce_MPENote.cpp"
 #include "mpe/juce_MPEZone.cpp"
@@ -105,8 +126,10 @@ namespace juce
 #include "sources/juce_ChannelRemappingAudioSource.cpp"
 #include "sources/juce_IIRFilterAudioSource.cpp"
 #include "sources/juce_MixerAudioSource.cpp"
+#include "sources/juce_ParallelMixerAudioSource.cpp"
 #include "sources/juce_ResamplingAudioSource.cpp"
 #include "sources/juce_ReverbAudioSource.cpp"
+#include "sources/juce_ConvolutionAudioSource.cpp"
 #include "sources/juce_ToneGeneratorAudioSource.cpp"
 #include "synthesisers/juce_Synthesiser.cpp"
 
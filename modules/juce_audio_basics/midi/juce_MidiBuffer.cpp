@@ -22,21 +22,6 @@
 
 namespace MidiBufferHelpers
 {
-    inline int getEventTime (const void* const d) noexcept
-    {
-        return readUnaligned<int32> (d);
-    }
-
-    inline uint16 getEventDataSize (const void* const d) noexcept
-    {
-        return readUnaligned<uint16> (static_cast<const char*> (d) + sizeof (int32));
-    }
-
-    inline uint16 getEventTotalSize (const void* const d) noexcept
-    {
-        return getEventDataSize (d) + sizeof (int32) + sizeof (uint16);
-    }
-
     static int findActualEventLength (const uint8* const data, const int maxBytes) noexcept
     {
         unsigned int byte = (unsigned int) *data;
@@ -65,44 +50,159 @@ namespace MidiBufferHelpers
 
         return size;
     }
-
-    static uint8* findEventAfter (uint8* d, uint8* endData, const int samplePosition) noexcept
-    {
-        while (d < endData && getEventTime (d) <= samplePosition)
-            d += getEventTotalSize (d);
-
-        return d;
-    }
 }
 
 //==============================================================================
-MidiBuffer::MidiBuffer() noexcept {}
+MidiBuffer::MidiBuffer() noexcept  : numLongMessages (0) {}
 MidiBuffer::~MidiBuffer() {}
 
-MidiBuffer::MidiBuffer (const MidiBuffer& other) noexcept  : data (other.data) {}
+MidiBuffer::MidiBuffer (const MidiBuffer& other) noexcept
+    : events (other.events),
+      longMessageData (other.longMessageData),
+      numLongMessages (other.numLongMessages)
+{
+}
 
 MidiBuffer& MidiBuffer::operator= (const MidiBuffer& other) noexcept
 {
-    data = other.data;
+    events = other.events;
+    longMessageData = other.longMessageData;
+    numLongMessages = other.numLongMessages;
     return *this;
 }
 
-MidiBuffer::MidiBuffer (const MidiMessage& message) noexcept
+MidiBuffer::MidiBuffer (const MidiMessage& message) noexcept  : numLongMessages (0)
 {
     addEvent (message, 0);
 }
 
-void MidiBuffer::swapWith (MidiBuffer& other) noexcept      { data.swapWith (other.data); }
-void MidiBuffer::clear() noexcept                           { data.clearQuick(); }
-void MidiBuffer::ensureSize (size_t minimumNumBytes)        { data.ensureStorageAllocated ((int) minimumNumBytes); }
-bool MidiBuffer::isEmpty() const noexcept                   { return data.size() == 0; }
+void MidiBuffer::swapWith (MidiBuffer& other) noexcept
+{
+    events.swapWith (other.events);
+    longMessageData.swapWith (other.longMessageData);
+    std::swap (numLongMessages, other.numLongMessages);
+}
+
+void MidiBuffer::clear() noexcept
+{
+    events.clearQuick();
+    longMessageData.clearQuick();
+    numLongMessages = 0;
+}
+
+void MidiBuffer::ensureSize (size_t minimumNumBytes)        { reserve ((int) (minimumNumBytes / 3)); }
+bool MidiBuffer::isEmpty() const noexcept                   { return events.size() == 0; }
+
+void MidiBuffer::reserve (const int numEvents, const int numBytesOfLongMessages)
+{
+    events.ensureStorageAllocated (numEvents);
+    longMessageData.ensureStorageAllocated (numBytesOfLongMessages);
+}
 
 void MidiBuffer::clear (const int startSample, const int numSamples)
 {
-    uint8* const start = MidiBufferHelpers::findEventAfter (data.begin(), data.end(), startSample - 1);
-    uint8* const end   = MidiBufferHelpers::findEventAfter (start,        data.end(), startSample + numSamples - 1);
+    const int startIndex = findIndexOfFirstEventAtOrAfter (startSample);
+    const int endIndex   = findIndexOfFirstEventAtOrAfter (startSample + numSamples);
+
+    const int oldNumLongMessages = numLongMessages;
+
+    if (numLongMessages > 0)
+        for (int i = startIndex; i < endIndex; ++i)
+            if (events.getReference (i).numBytes > 4)
+                --numLongMessages;
+
+    events.removeRange (startIndex, endIndex - startIndex);
+
+    if (numLongMessages == 0)
+    {
+        longMessageData.clearQuick();
+    }
+    else if (numLongMessages < oldNumLongMessages)
+    {
+        int numLiveBytes = 0;
+
+        for (int i = 0; i < events.size(); ++i)
+            if (events.getReference (i).numBytes > 4)
+                numLiveBytes += events.getReference (i).numBytes;
+
+        // don't bother tidying up until the gaps take up more space than the messages
+        if (longMessageData.size() > numLiveBytes * 2)
+            compactLongMessageData();
+    }
+}
+
+void MidiBuffer::compactLongMessageData() noexcept
+{
+    // Slides the remaining long messages down over the gaps, taking them in the order that
+    // they're stored, so that nothing gets overwritten before it's been moved.
+    uint8* const data = longMessageData.begin();
+    int numUsed = 0, lastOffset = -1;
 
-    data.removeRange ((int) (start - data.begin()), (int) (end - data.begin()));
+    for (;;)
+    {
+        Event* next = nullptr;
+
+        for (Event* e = events.begin(); e != events.end(); ++e)
+            if (e->numBytes > 4 && e->longDataOffset > lastOffset
+                 && (next == nullptr || e->longDataOffset < next->longDataOffset))
+                next = e;
+
+        if (next == nullptr)
+            break;
+
+        lastOffset = next->longDataOffset;
+        memmove (data + numUsed, data + lastOffset, (size_t) next->numBytes);
+        next->longDataOffset = numUsed;
+        numUsed += next->numBytes;
+    }
+
+    longMessageData.resize (numUsed);
+}
+
+const uint8* MidiBuffer::getEventData (const Event& e) const noexcept
+{
+    return e.numBytes <= 4 ? e.shortData
+                           : longMessageData.begin() + e.longDataOffset;
+}
+
+int MidiBuffer::findIndexOfFirstEventAfter (const int samplePosition) const noexcept
+{
+    const Event* const e = events.begin();
+    int start = 0, end = events.size();
+
+    // events are usually added in order, so try the end first
+    if (end == 0 || e[end - 1].samplePosition <= samplePosition)
+        return end;
+
+    while (start < end)
+    {
+        const int mid = (start + end) / 2;
+
+        if (e[mid].samplePosition <= samplePosition)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    return start;
+}
+
+int MidiBuffer::findIndexOfFirstEventAtOrAfter (const int samplePosition) const noexcept
+{
+    const Event* const e = events.begin();
+    int start = 0, end = events.size();
+
+    while (start < end)
+    {
+        const int mid = (start + end) / 2;
+
+        if (e[mid].samplePosition < samplePosition)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    return start;
 }
 
 void MidiBuffer::addEvent (const MidiMessage& m, const int sampleNumber)
@@ -116,15 +216,23 @@ void MidiBuffer::addEvent (const void* const newData, const int maxBytes, const
 
     if (numBytes > 0)
     {
-        const size_t newItemSize = (size_t) numBytes + sizeof (int32) + sizeof (uint16);
-        const int offset = (int) (MidiBufferHelpers::findEventAfter (data.begin(), data.end(), sampleNumber) - data.begin());
+        Event e;
+        e.samplePosition = sampleNumber;
+        e.numBytes = numBytes;
+        e.longDataOffset = 0;
 
-        data.insertMultiple (offset, 0, (int) newItemSize);
+        if (numBytes <= 4)
+        {
+            memcpy (e.shortData, newData, (size_t) numBytes);
+        }
+        else
+        {
+            e.longDataOffset = longMessageData.size();
+            longMessageData.addArray (static_cast<const uint8*> (newData), numBytes);
+            ++numLongMessages;
+        }
 
-        uint8* const d = data.begin() + offset;
-        writeUnaligned<int32>  (d, sampleNumber);
-        writeUnaligned<uint16> (d + 4, static_cast<uint16> (numBytes));
-        memcpy (d + 6, newData, (size_t) numBytes);
+        events.insert (findIndexOfFirstEventAfter (sampleNumber), e);
     }
 }
 
@@ -133,56 +241,68 @@ void MidiBuffer::addEvents (const MidiBuffer& otherBuffer,
                             const int numSamples,
                             const int sampleDeltaToAdd)
 {
-    Iterator i (otherBuffer);
-    i.setNextSamplePosition (startSample);
+    if (&otherBuffer == this)
+    {
+        const MidiBuffer copy (otherBuffer);
+        addEvents (copy, startSample, numSamples, sampleDeltaToAdd);
+        return;
+    }
+
+    const int startIndex = otherBuffer.findIndexOfFirstEventAtOrAfter (startSample);
+    const int endIndex = numSamples < 0 ? otherBuffer.events.size()
+                                        : otherBuffer.findIndexOfFirstEventAtOrAfter (startSample + numSamples);
 
-    const uint8* eventData;
-    int eventSize, position;
+    if (endIndex <= startIndex)
+        return;
 
-    while (i.getNextEvent (eventData, eventSize, position)
-            && (position < startSample + numSamples || numSamples < 0))
+    int numExisting = events.size();
+    events.resize (numExisting + endIndex - startIndex);
+
+    // Merge from the back, so that each event only gets moved once. If the new events
+    // all come after the existing ones, this is just a copy onto the end.
+    Event* const dest = events.begin();
+    int destIndex = events.size();
+
+    for (int i = endIndex; --i >= startIndex;)
     {
-        addEvent (eventData, eventSize, position + sampleDeltaToAdd);
+        Event e (otherBuffer.events.getReference (i));
+        e.samplePosition += sampleDeltaToAdd;
+
+        // events with the same time go after the ones that were already here
+        while (numExisting > 0 && dest[numExisting - 1].samplePosition > e.samplePosition)
+            dest[--destIndex] = dest[--numExisting];
+
+        if (e.numBytes > 4)
+        {
+            e.longDataOffset = longMessageData.size();
+            longMessageData.addArray (otherBuffer.getEventData (otherBuffer.events.getReference (i)), e.numBytes);
+            ++numLongMessages;
+        }
+
+        dest[--destIndex] = e;
     }
+
+    jassert (destIndex == numExisting);
 }
 
 int MidiBuffer::getNumEvents() const noexcept
 {
-    int n = 0;
-    const uint8* const end = data.end();
-
-    for (const uint8* d = data.begin(); d < end; ++n)
-        d += MidiBufferHelpers::getEventTotalSize (d);
-
-    return n;
+    return events.size();
 }
 
 int MidiBuffer::getFirstEventTime() const noexcept
 {
-    return data.size() > 0 ? MidiBufferHelpers::getEventTime (data.begin()) : 0;
+    return events.size() > 0 ? events.getReference (0).samplePosition : 0;
 }
 
 int MidiBuffer::getLastEventTime() const noexcept
 {
-    if (data.size() == 0)
-        return 0;
-
-    const uint8* const endData = data.end();
-
-    for (const uint8* d = data.begin();;)
-    {
-        const uint8* const nextOne = d + MidiBufferHelpers::getEventTotalSize (d);
-
-        if (nextOne >= endData)
-            return MidiBufferHelpers::getEventTime (d);
-
-        d = nextOne;
-    }
+    return events.size() > 0 ? events.getReference (events.size() - 1).samplePosition : 0;
 }
 
 //==============================================================================
 MidiBuffer::Iterator::Iterator (const MidiBuffer& b) noexcept
-    : buffer (b), data (b.data.begin())
+    : buffer (b), nextIndex (0)
 {
 }
 
@@ -192,36 +312,336 @@ MidiBuffer::Iterator::~Iterator() noexcept
 
 void MidiBuffer::Iterator::setNextSamplePosition (const int samplePosition) noexcept
 {
-    data = buffer.data.begin();
-    const uint8* const dataEnd = buffer.data.end();
-
-    while (data < dataEnd && MidiBufferHelpers::getEventTime (data) < samplePosition)
-        data += MidiBufferHelpers::getEventTotalSize (data);
+    nextIndex = buffer.findIndexOfFirstEventAtOrAfter (samplePosition);
 }
 
 bool MidiBuffer::Iterator::getNextEvent (const uint8* &midiData, int& numBytes, int& samplePosition) noexcept
 {
-    if (data >= buffer.data.end())
+    if (nextIndex >= buffer.events.size())
         return false;
 
-    samplePosition = MidiBufferHelpers::getEventTime (data);
-    const int itemSize = MidiBufferHelpers::getEventDataSize (data);
-    numBytes = itemSize;
-    midiData = data + sizeof (int32) + sizeof (uint16);
-    data += sizeof (int32) + sizeof (uint16) + (size_t) itemSize;
+    const Event& e = buffer.events.getReference (nextIndex++);
+    samplePosition = e.samplePosition;
+    numBytes = e.numBytes;
+    midiData = buffer.getEventData (e);
 
     return true;
 }
 
 bool MidiBuffer::Iterator::getNextEvent (MidiMessage& result, int& samplePosition) noexcept
 {
-    if (data >= buffer.data.end())
+    if (nextIndex >= buffer.events.size())
         return false;
 
-    samplePosition = MidiBufferHelpers::getEventTime (data);
-    const int itemSize = MidiBufferHelpers::getEventDataSize (data);
-    result = MidiMessage (data + sizeof (int32) + sizeof (uint16), itemSize, samplePosition);
-    data += sizeof (int32) + sizeof (uint16) + (size_t) itemSize;
+    const Event& e = buffer.events.getReference (nextIndex++);
+    samplePosition = e.samplePosition;
+    result = MidiMessage (buffer.getEventData (e), e.numBytes, samplePosition);
 
     return true;
 }
+
+bool MidiBuffer::Iterator::getNextEvent (MidiMessageView& result, int& samplePosition) noexcept
+{
+    if (nextIndex >= buffer.events.size())
+        return false;
+
+    const Event& e = buffer.events.getReference (nextIndex++);
+    samplePosition = e.samplePosition;
+    result = MidiMessageView (buffer.getEventData (e), e.numBytes, samplePosition);
+
+    return true;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MidiBufferTests  : public UnitTest
+{
+public:
+    MidiBufferTests() : UnitTest ("MidiBuffer") {}
+
+    // A simple list of messages, kept in order, to check the buffer against
+    struct Reference
+    {
+        void add (const MidiMessage& m, int time)
+        {
+            size_t i = messages.size();
+
+            while (i > 0 && messages[i - 1].getTimeStamp() > time)
+                --i;
+
+            messages.insert (messages.begin() + (std::ptrdiff_t) i, MidiMessage (m, time));
+        }
+
+        void clear (int start, int numSamples)
+        {
+            for (size_t i = messages.size(); i > 0; --i)
+                if (messages[i - 1].getTimeStamp() >= start
+                     && messages[i - 1].getTimeStamp() < start + numSamples)
+                    messages.erase (messages.begin() + (std::ptrdiff_t) (i - 1));
+        }
+
+        int size() const noexcept                               { return (int) messages.size(); }
+        const MidiMessage& operator[] (int index) const         { return messages[(size_t) index]; }
+
+        // (a std::vector, because MidiMessage can't be moved around with memcpy like Array does)
+        std::vector<MidiMessage> messages;
+    };
+
+    void runTest() override
+    {
+        Random r = getRandom();
+
+        beginTest ("Random edits");
+        {
+            for (int run = 0; run < 20; ++run)
+            {
+                MidiBuffer buffer, other;
+                Reference reference, otherReference;
+
+                for (int i = 0; i < 300; ++i)
+                {
+                    const int op = r.nextInt (10);
+                    const int time = r.nextInt (1000);
+
+                    if (op < 6)
+                    {
+                        const MidiMessage m (createRandomMessage (r));
+                        buffer.addEvent (m, time);
+                        reference.add (m, time);
+                    }
+                    else if (op < 8)
+                    {
+                        const MidiMessage m (createRandomMessage (r));
+                        other.addEvent (m, time);
+                        otherReference.add (m, time);
+                    }
+                    else if (op < 9)
+                    {
+                        const int numSamples = r.nextInt (500) - 50;
+                        const int delta = r.nextInt (200) - 100;
+                        buffer.addEvents (other, time, numSamples, delta);
+
+                        for (int j = 0; j < otherReference.size(); ++j)
+                        {
+                            const MidiMessage& m = otherReference[j];
+                            const int t = (int) m.getTimeStamp();
+
+                            if (t >= time && (numSamples < 0 || t < time + numSamples))
+                                reference.add (m, t + delta);
+                        }
+                    }
+                    else
+                    {
+                        const int numSamples = r.nextInt (100);
+                        buffer.clear (time, numSamples);
+                        reference.clear (time, numSamples);
+                    }
+                }
+
+                expectMatches (buffer, reference);
+
+                const int start = r.nextInt (1100) - 50;
+                MidiBuffer::Iterator iter (buffer);
+                iter.setNextSamplePosition (start);
+
+                MidiMessage m;
+                int position;
+
+                int expectedIndex = 0;
+
+                while (expectedIndex < reference.size()
+                        && reference[expectedIndex].getTimeStamp() < start)
+                    ++expectedIndex;
+
+                if (expectedIndex < reference.size())
+                {
+                    expect (iter.getNextEvent (m, position));
+                    expectEquals (position, (int) reference[expectedIndex].getTimeStamp());
+                }
+                else
+                {
+                    expect (! iter.getNextEvent (m, position));
+                }
+            }
+        }
+
+        beginTest ("Reserved space is re-used");
+        {
+            MidiBuffer buffer;
+            buffer.reserve (1000, 1000);
+
+            const uint8 sysex[] = { 0xf0, 1, 2, 3, 4, 5, 0xf7 };
+            buffer.addEvent (sysex, sizeof (sysex), 0);
+
+            MidiBuffer::Iterator iter (buffer);
+            const uint8* firstData = nullptr;
+            int numBytes = 0, position = 0;
+            expect (iter.getNextEvent (firstData, numBytes, position));
+            expectEquals (numBytes, (int) sizeof (sysex));
+
+            for (int i = 1; i < 100; ++i)
+            {
+                buffer.addEvent (sysex, sizeof (sysex), i);
+                buffer.addEvent (MidiMessage::controllerEvent (1, 7, i), i);
+            }
+
+            const uint8* data = nullptr;
+            iter.setNextSamplePosition (0);
+            expect (iter.getNextEvent (data, numBytes, position));
+            expect (data == firstData);
+            expectEquals (buffer.getNumEvents(), 199);
+            expectEquals (buffer.getLastEventTime(), 99);
+        }
+
+        beginTest ("Space left by cleared long messages is reclaimed");
+        {
+            MidiBuffer buffer;
+            const int numLive = 10;
+
+            // a sliding window of sysex messages, so there's never a point where they've all gone
+            for (int i = 0; i < 1000; ++i)
+            {
+                const uint8 sysex[] = { 0xf0, (uint8) (i & 0x7f), (uint8) (i >> 7), 3, 4, 5, 0xf7 };
+                buffer.addEvent (sysex, sizeof (sysex), i);
+                buffer.clear (i - numLive, 1);
+            }
+
+            expectEquals (buffer.getNumEvents(), numLive);
+
+            MidiBuffer::Iterator iter (buffer);
+            const uint8* data = nullptr;
+            const uint8* lowest = nullptr;
+            const uint8* highest = nullptr;
+            int numBytes = 0, position = 0;
+
+            while (iter.getNextEvent (data, numBytes, position))
+            {
+                expectEquals (numBytes, 7);
+                expectEquals ((int) data[1] + ((int) data[2] << 7), position);
+
+                if (lowest == nullptr || data < lowest)    lowest = data;
+                if (highest == nullptr || data > highest)  highest = data;
+            }
+
+            expect (highest - lowest < 2 * numLive * 7);
+        }
+
+        beginTest ("Clearing part of a reserved buffer doesn't allocate");
+        {
+            MidiBuffer buffer;
+            buffer.reserve (1000, 4000);
+
+            for (int i = 0; i < 500; ++i)
+            {
+                const uint8 sysex[] = { 0xf0, (uint8) (i & 0x7f), 2, 3, 4, 5, 0xf7 };
+                buffer.addEvent (sysex, sizeof (sysex), i);
+                buffer.addEvent (MidiMessage::noteOn (1, i & 0x7f, (uint8) 100), i);
+            }
+
+            {
+               #if JUCE_ENABLE_ALLOCATION_HOOKS
+                const ScopedAllocationCounter counter;
+               #endif
+
+                // clearing most of each stretch leaves enough gaps for the sysex data to get compacted
+                for (int i = 0; i < 500; i += 50)
+                    buffer.clear (i, 30);
+
+               #if JUCE_ENABLE_ALLOCATION_HOOKS
+                expectEquals (counter.getNumCalls(), 0);
+               #endif
+            }
+
+            expectEquals (buffer.getNumEvents(), 400);
+            expectEquals (buffer.getFirstEventTime(), 30);
+
+            buffer.clear (0, 500);
+            expect (buffer.isEmpty());
+        }
+
+        beginTest ("Iterating with a MidiMessageView");
+        {
+            MidiBuffer buffer;
+
+            for (int i = 0; i < 100; ++i)
+                buffer.addEvent (createRandomMessage (r), r.nextInt (1000));
+
+            MidiBuffer::Iterator iter (buffer), viewIter (buffer);
+            MidiMessage m;
+            MidiMessageView view;
+            int position = 0, viewPosition = 0;
+
+            while (iter.getNextEvent (m, position))
+            {
+                expect (viewIter.getNextEvent (view, viewPosition));
+                expectEquals (viewPosition, position);
+                expectEquals (view.getTimeStamp(), m.getTimeStamp());
+                expectEquals (view.getRawDataSize(), m.getRawDataSize());
+                expectEquals (view.getChannel(), m.getChannel());
+                expect (view.isSysEx() == m.isSysEx() && view.isNoteOn() == m.isNoteOn()
+                         && view.isController() == m.isController());
+                expect (memcmp (view.getRawData(), m.getRawData(), (size_t) m.getRawDataSize()) == 0);
+            }
+
+            expect (! viewIter.getNextEvent (view, viewPosition));
+
+           #if JUCE_ENABLE_ALLOCATION_HOOKS
+            const ScopedAllocationCounter counter;
+            int numSysExBytes = 0;
+
+            for (MidiBuffer::Iterator i (buffer); i.getNextEvent (view, position);)
+                numSysExBytes += view.getSysExDataSize();
+
+            expectEquals (counter.getNumCalls(), 0);
+            expect (numSysExBytes > 0);
+           #endif
+        }
+    }
+
+    static MidiMessage createRandomMessage (Random& r)
+    {
+        switch (r.nextInt (4))
+        {
+            case 0:   return MidiMessage::noteOn (1 + r.nextInt (16), r.nextInt (128), (uint8) r.nextInt (128));
+            case 1:   return MidiMessage::programChange (1 + r.nextInt (16), r.nextInt (128));
+            case 2:   return MidiMessage::controllerEvent (1 + r.nextInt (16), r.nextInt (128), r.nextInt (128));
+
+            default:
+            {
+                uint8 data[32];
+                const int size = 2 + r.nextInt (30);
+
+                for (int i = 0; i < size; ++i)
+                    data[i] = (uint8) r.nextInt (128);
+
+                return MidiMessage::createSysExMessage (data, size);
+            }
+        }
+    }
+
+    void expectMatches (const MidiBuffer& buffer, const Reference& reference)
+    {
+        expectEquals (buffer.getNumEvents(), reference.size());
+
+        MidiBuffer::Iterator iter (buffer);
+        MidiMessage m;
+        int position, index = 0;
+
+        while (iter.getNextEvent (m, position))
+        {
+            const MidiMessage& expected = reference[index++];
+
+            expectEquals (position, (int) expected.getTimeStamp());
+            expect (m.getRawDataSize() == expected.getRawDataSize()
+                     && memcmp (m.getRawData(), expected.getRawData(), (size_t) m.getRawDataSize()) == 0);
+        }
+
+        expectEquals (index, reference.size());
+    }
+};
+
+static MidiBufferTests midiBufferTests;
+
+#endif
@@ -35,6 +35,12 @@
     appropriate container. MidiBuffer is designed for lower-level streams of raw
     midi data.
 
+    Internally, each event is a small fixed-size record, with messages of up to 4 bytes
+    stored inside the record and longer ones (e.g. sysex) kept in a separate block. So
+    adding events in time order is a quick append, and finding the events at a particular
+    time is a binary search. If you call reserve() beforehand, and clear() between uses,
+    then the buffer won't need to allocate any memory while it's being filled.
+
     @see MidiMessage
 */
 class JUCE_API  MidiBuffer
@@ -72,12 +78,7 @@ public:
     */
     bool isEmpty() const noexcept;
 
-    /** Counts the number of events in the buffer.
-
-        This is actually quite a slow operation, as it has to iterate through all
-        the events, so you might prefer to call isEmpty() if that's all you need
-        to know.
-    */
+    /** Returns the number of events in the buffer. */
     int getNumEvents() const noexcept;
 
     /** Adds an event to the buffer.
@@ -126,6 +127,9 @@ public:
                                     startSample will be taken.
         @param sampleDeltaToAdd     a value which will be added to the source timestamps of the events
                                     that are added to this buffer
+
+        The events are merged in a single pass, without re-parsing them, so this takes time
+        proportional to the total number of events in both buffers.
     */
     void addEvents (const MidiBuffer& otherBuffer,
                     int startSample,
@@ -152,10 +156,20 @@ public:
 
     /** Preallocates some memory for the buffer to use.
         This helps to avoid needing to reallocate space when the buffer has messages
-        added to it.
+        added to it. It reserves enough space for this many bytes of 3-byte messages.
+        @see reserve
     */
     void ensureSize (size_t minimumNumBytes);
 
+    /** Preallocates enough space for a number of events.
+
+        After this, adding up to numEvents events won't allocate any memory, as long as
+        the total size of all the messages that are longer than 4 bytes (e.g. sysex)
+        doesn't go over numBytesOfLongMessages. Calling clear() keeps the space, so a
+        buffer that's reserved once can be re-used on the audio thread.
+    */
+    void reserve (int numEvents, int numBytesOfLongMessages = 0);
+
     //==============================================================================
     /**
         Used to iterate through the events in a MidiBuffer.
@@ -193,6 +207,23 @@ public:
         bool getNextEvent (MidiMessage& result,
                            int& samplePosition) noexcept;
 
+        /** Retrieves a view of the next event in the buffer.
+
+            This doesn't copy the message data, so unlike the version of this method
+            that returns a MidiMessage, it will never allocate, even for long sysex
+            messages. The view points directly into the MidiBuffer's internal data, so
+            is only valid until the MidiBuffer is altered.
+
+            @param result   on return, this will refer to the message. Its timestamp is
+                            set to the same value as samplePosition.
+            @param samplePosition   on return, this will be the position of the event, as a
+                            sample index in the buffer
+            @returns        true if an event was found, or false if the iterator has reached
+                            the end of the buffer
+        */
+        bool getNextEvent (MidiMessageView& result,
+                           int& samplePosition) noexcept;
+
         /** Retrieves the next event from the buffer.
 
             @param midiData     on return, this pointer will be set to a block of data containing
@@ -213,17 +244,37 @@ public:
     private:
         //==============================================================================
         const MidiBuffer& buffer;
-        const uint8* data;
+        int nextIndex;
 
         JUCE_DECLARE_NON_COPYABLE (Iterator)
     };
 
-    /** The raw data holding this buffer.
-        Obviously access to this data is provided at your own risk. Its internal format could
-        change in future, so don't write code that relies on it!
-    */
-    Array<uint8> data;
-
 private:
+    //==============================================================================
+    struct Event
+    {
+        int samplePosition;
+        int numBytes;
+
+        union
+        {
+            uint8 shortData[4];     // messages of up to 4 bytes are kept here..
+            int longDataOffset;     // ..and longer ones are in longMessageData at this offset
+        };
+    };
+
+    // Removing items from these never gives any memory back, in the same way that clear()
+    // doesn't, so that a reserved buffer can be edited without reallocating.
+    enum { neverShrink = 0x7fffffff };
+
+    Array<Event, DummyCriticalSection, neverShrink> events;
+    Array<uint8, DummyCriticalSection, neverShrink> longMessageData;
+    int numLongMessages;
+
+    const uint8* getEventData (const Event&) const noexcept;
+    void compactLongMessageData() noexcept;
+    int findIndexOfFirstEventAfter (int samplePosition) const noexcept;
+    int findIndexOfFirstEventAtOrAfter (int samplePosition) const noexcept;
+
     JUCE_LEAK_DETECTOR (MidiBuffer)
 };
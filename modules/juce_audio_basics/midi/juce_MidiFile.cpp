@@ -306,7 +306,10 @@ void MidiFile::readNextTrack (const uint8* data, int size)
     double time = 0;
     uint8 lastStatusByte = 0;
 
-    MidiMessageSequence result;
+    // the events are added straight into the new track, rather than to a temporary
+    // sequence that then has to be copied
+    MidiMessageSequence* const result = new MidiMessageSequence();
+    tracks.add (result);
 
     while (size > 0)
     {
@@ -317,7 +320,7 @@ void MidiFile::readNextTrack (const uint8* data, int size)
         time += delay;
 
         int messSize = 0;
-        const MidiMessage mm (data, size, messSize, lastStatusByte, time);
+        MidiMessage mm (data, size, messSize, lastStatusByte, time);
 
         if (messSize <= 0)
             break;
@@ -325,19 +328,17 @@ void MidiFile::readNextTrack (const uint8* data, int size)
         size -= messSize;
         data += messSize;
 
-        result.addEvent (mm);
-
         const uint8 firstByte = *(mm.getRawData());
         if ((firstByte & 0xf0) != 0xf0)
             lastStatusByte = firstByte;
+
+        result->addEvent (static_cast<MidiMessage&&> (mm));
     }
 
     // use a sort that puts all the note-offs before note-ons that have the same time
     MidiFileHelpers::Sorter sorter;
-    result.list.sort (sorter, true);
-
-    addTrack (result);
-    tracks.getLast()->updateMatchedPairs();
+    result->list.sort (sorter, true);
+    result->updateMatchedPairs();
 }
 
 //==============================================================================
@@ -20,13 +20,114 @@
   ==============================================================================
 */
 
+namespace MidiMessageSequenceHelpers
+{
+    typedef MidiMessageSequence::MidiEventHolder EventHolder;
+
+    struct TimeComparator
+    {
+        bool operator() (const EventHolder* first, const EventHolder* second) const noexcept
+        {
+            return first->message.getTimeStamp() < second->message.getTimeStamp();
+        }
+    };
+
+    // Returns the index of the first event whose time is after the given time or,
+    // if includeEventsAtTime is true, the first one whose time is on or after it.
+    static int findFirstIndexAfter (const Array<EventHolder*>& list, double time, bool includeEventsAtTime) noexcept
+    {
+        int start = 0, end = list.size();
+
+        while (start < end)
+        {
+            const int mid = (start + end) / 2;
+            const double t = list.getUnchecked (mid)->message.getTimeStamp();
+
+            if (t < time || (t == time && ! includeEventsAtTime))
+                start = mid + 1;
+            else
+                end = mid;
+        }
+
+        return start;
+    }
+
+    // The end times of the notes are held in a binary tree stored in an array, where each
+    // node holds the latest end time of its children. This searches the leaves below a node
+    // for notes that start before numCandidates and end after the given time.
+    static void findNotesEndingAfter (const Array<int>& noteOnIndexes, const Array<double>& endTimes,
+                                      int node, int rangeStart, int rangeEnd, int numCandidates,
+                                      double time, Array<int>& results)
+    {
+        if (rangeStart >= numCandidates || endTimes.getUnchecked (node) <= time)
+            return;
+
+        if (rangeEnd - rangeStart == 1)
+        {
+            results.add (noteOnIndexes.getUnchecked (rangeStart));
+            return;
+        }
+
+        const int mid = (rangeStart + rangeEnd) / 2;
+        findNotesEndingAfter (noteOnIndexes, endTimes, node * 2,     rangeStart, mid, numCandidates, time, results);
+        findNotesEndingAfter (noteOnIndexes, endTimes, node * 2 + 1, mid, rangeEnd,   numCandidates, time, results);
+    }
+}
+
+//==============================================================================
+// The event holders are handed out as pointers which must stay valid while the list
+// is re-ordered, so rather than allocating each one separately, they're created in
+// blocks and recycled when deleted.
+struct MidiMessageSequence::HolderPool
+{
+    HolderPool() noexcept  : freeList (nullptr), numUsedInLastBlock (0), lastBlockSize (0) {}
+
+    void* allocate()
+    {
+        if (freeList != nullptr)
+        {
+            void* const slot = freeList;
+            freeList = *static_cast<void**> (slot);
+            return slot;
+        }
+
+        if (numUsedInLastBlock >= lastBlockSize)
+        {
+            lastBlockSize = jlimit (32, 4096, lastBlockSize * 2);
+            numUsedInLastBlock = 0;
+            blocks.add (new MemoryBlock ((size_t) lastBlockSize * sizeof (MidiEventHolder)));
+        }
+
+        return static_cast<MidiEventHolder*> (blocks.getLast()->getData()) + numUsedInLastBlock++;
+    }
+
+    void release (void* slot) noexcept
+    {
+        *static_cast<void**> (slot) = freeList;
+        freeList = slot;
+    }
+
+    OwnedArray<MemoryBlock> blocks;
+    void* freeList;
+    int numUsedInLastBlock, lastBlockSize;
+
+    JUCE_DECLARE_NON_COPYABLE (HolderPool)
+};
+
+//==============================================================================
 MidiMessageSequence::MidiMessageSequence()
+    : noteIndexIsValid (false)
 {
 }
 
 MidiMessageSequence::MidiMessageSequence (const MidiMessageSequence& other)
+    : noteIndexIsValid (false)
 {
-    list.addCopiesOf (other.list);
+    list.ensureStorageAllocated (other.list.size());
+
+    for (int i = 0; i < other.list.size(); ++i)
+        list.add (createHolder (other.list.getUnchecked(i)->message));
+
     updateMatchedPairs();
 }
 
@@ -37,20 +138,92 @@ MidiMessageSequence& MidiMessageSequence::operator= (const MidiMessageSequence&
     return *this;
 }
 
+MidiMessageSequence::MidiMessageSequence (MidiMessageSequence&& other) noexcept
+    : list (static_cast<Array<MidiEventHolder*>&&> (other.list)),
+      pool (static_cast<ScopedPointer<HolderPool>&&> (other.pool)),
+      noteOnIndexes (static_cast<Array<int>&&> (other.noteOnIndexes)),
+      noteEndTimes (static_cast<Array<double>&&> (other.noteEndTimes)),
+      noteIndexIsValid (other.noteIndexIsValid)
+{
+    other.noteIndexIsValid = false;
+}
+
+MidiMessageSequence& MidiMessageSequence::operator= (MidiMessageSequence&& other) noexcept
+{
+    if (this != &other)
+    {
+        deleteAllHolders();
+        list = static_cast<Array<MidiEventHolder*>&&> (other.list);
+        pool = static_cast<ScopedPointer<HolderPool>&&> (other.pool);
+        noteOnIndexes = static_cast<Array<int>&&> (other.noteOnIndexes);
+        noteEndTimes = static_cast<Array<double>&&> (other.noteEndTimes);
+        noteIndexIsValid = other.noteIndexIsValid;
+        other.noteIndexIsValid = false;
+    }
+
+    return *this;
+}
+
 void MidiMessageSequence::swapWith (MidiMessageSequence& other) noexcept
 {
     list.swapWith (other.list);
+    pool.swapWith (other.pool);
+    noteOnIndexes.swapWith (other.noteOnIndexes);
+    noteEndTimes.swapWith (other.noteEndTimes);
+    std::swap (noteIndexIsValid, other.noteIndexIsValid);
 }
 
 MidiMessageSequence::~MidiMessageSequence()
 {
+    deleteAllHolders();
 }
 
 void MidiMessageSequence::clear()
 {
+    deleteAllHolders();
     list.clear();
+    pool = nullptr;
+    noteOnIndexes.clear();
+    noteEndTimes.clear();
+    noteIndexIsValid = false;
+}
+
+//==============================================================================
+MidiMessageSequence::MidiEventHolder* MidiMessageSequence::createHolder (const MidiMessage& message)
+{
+    if (pool == nullptr)
+        pool = new HolderPool();
+
+    return new (pool->allocate()) MidiEventHolder (message);
+}
+
+MidiMessageSequence::MidiEventHolder* MidiMessageSequence::createHolder (MidiMessage&& message)
+{
+    if (pool == nullptr)
+        pool = new HolderPool();
+
+    return new (pool->allocate()) MidiEventHolder (static_cast<MidiMessage&&> (message));
+}
+
+void MidiMessageSequence::deleteHolder (MidiEventHolder* holder) noexcept
+{
+    holder->~MidiEventHolder();
+    pool->release (holder);
 }
 
+void MidiMessageSequence::deleteAllHolders() noexcept
+{
+    for (int i = list.size(); --i >= 0;)
+        list.getUnchecked(i)->~MidiEventHolder();
+}
+
+void MidiMessageSequence::removeEvent (const int index) noexcept
+{
+    deleteHolder (list.removeAndReturn (index));
+    noteIndexIsValid = false;
+}
+
+//==============================================================================
 int MidiMessageSequence::getNumEvents() const noexcept
 {
     return list.size();
@@ -73,26 +246,83 @@ double MidiMessageSequence::getTimeOfMatchingKeyUp (const int index) const noexc
 int MidiMessageSequence::getIndexOfMatchingKeyUp (const int index) const noexcept
 {
     if (const MidiEventHolder* const meh = list [index])
-        return list.indexOf (meh->noteOffObject);
+        return getIndexOf (meh->noteOffObject);
 
     return -1;
 }
 
 int MidiMessageSequence::getIndexOf (const MidiEventHolder* const event) const noexcept
 {
-    return list.indexOf (event);
+    if (event == nullptr)
+        return -1;
+
+    const double time = event->message.getTimeStamp();
+
+    for (int i = getNextIndexAtTime (time); i < list.size(); ++i)
+    {
+        const MidiEventHolder* const meh = list.getUnchecked (i);
+
+        if (meh == event)
+            return i;
+
+        if (meh->message.getTimeStamp() != time)
+            break;
+    }
+
+    // If it wasn't found where it should be, the list may not have been re-sorted
+    // after some timestamps were changed, so fall back to checking all the events
+    return list.indexOf (const_cast<MidiEventHolder*> (event));
 }
 
 int MidiMessageSequence::getNextIndexAtTime (const double timeStamp) const noexcept
 {
-    const int numEvents = list.size();
+    return MidiMessageSequenceHelpers::findFirstIndexAfter (list, timeStamp, true);
+}
 
-    int i;
-    for (i = 0; i < numEvents; ++i)
-        if (list.getUnchecked(i)->message.getTimeStamp() >= timeStamp)
-            break;
+Range<int> MidiMessageSequence::getIndexRangeForTimes (const double startTime, const double endTime) const noexcept
+{
+    const int start = getNextIndexAtTime (startTime);
+    return Range<int> (start, jmax (start, getNextIndexAtTime (endTime)));
+}
+
+void MidiMessageSequence::findNotesPlayingAt (const double time, Array<int>& results) const
+{
+    // The note index is built by updateMatchedPairs(), so you need to call that after
+    // changing the sequence!
+    jassert (noteIndexIsValid);
+
+    if (! noteIndexIsValid)
+    {
+        const int end = MidiMessageSequenceHelpers::findFirstIndexAfter (list, time, false);
 
-    return i;
+        for (int i = 0; i < end; ++i)
+        {
+            const MidiEventHolder* const meh = list.getUnchecked (i);
+
+            if (meh->message.isNoteOn()
+                 && (meh->noteOffObject == nullptr || meh->noteOffObject->message.getTimeStamp() > time))
+                results.add (i);
+        }
+
+        return;
+    }
+
+    // find how many of the notes start on or before the time..
+    int numCandidates = 0, end = noteOnIndexes.size();
+
+    while (numCandidates < end)
+    {
+        const int mid = (numCandidates + end) / 2;
+
+        if (list.getUnchecked (noteOnIndexes.getUnchecked (mid))->message.getTimeStamp() <= time)
+            numCandidates = mid + 1;
+        else
+            end = mid;
+    }
+
+    if (numCandidates > 0)
+        MidiMessageSequenceHelpers::findNotesEndingAfter (noteOnIndexes, noteEndTimes, 1, 0, noteEndTimes.size() / 2,
+                                                          numCandidates, time, results);
 }
 
 //==============================================================================
@@ -118,17 +348,27 @@ double MidiMessageSequence::getEventTime (const int index) const noexcept
 MidiMessageSequence::MidiEventHolder* MidiMessageSequence::addEvent (const MidiMessage& newMessage,
                                                                      double timeAdjustment)
 {
-    MidiEventHolder* const newOne = new MidiEventHolder (newMessage);
+    return insertEvent (createHolder (newMessage), timeAdjustment);
+}
+
+MidiMessageSequence::MidiEventHolder* MidiMessageSequence::addEvent (MidiMessage&& newMessage,
+                                                                     double timeAdjustment)
+{
+    return insertEvent (createHolder (static_cast<MidiMessage&&> (newMessage)), timeAdjustment);
+}
 
-    timeAdjustment += newMessage.getTimeStamp();
+MidiMessageSequence::MidiEventHolder* MidiMessageSequence::insertEvent (MidiEventHolder* const newOne,
+                                                                        double timeAdjustment)
+{
+    timeAdjustment += newOne->message.getTimeStamp();
     newOne->message.setTimeStamp (timeAdjustment);
 
-    int i;
-    for (i = list.size(); --i >= 0;)
-        if (list.getUnchecked(i)->message.getTimeStamp() <= timeAdjustment)
-            break;
+    if (list.size() == 0 || list.getLast()->message.getTimeStamp() <= timeAdjustment)
+        list.add (newOne);
+    else
+        list.insert (MidiMessageSequenceHelpers::findFirstIndexAfter (list, timeAdjustment, false), newOne);
 
-    list.insert (i + 1, newOne);
+    noteIndexIsValid = false;
     return newOne;
 }
 
@@ -140,7 +380,7 @@ void MidiMessageSequence::deleteEvent (const int index,
         if (deleteMatchingNoteUp)
             deleteEvent (getIndexOfMatchingKeyUp (index), false);
 
-        list.remove (index);
+        removeEvent (index);
     }
 }
 
@@ -156,16 +396,19 @@ struct MidiMessageSequenceSorter
 
 void MidiMessageSequence::addSequence (const MidiMessageSequence& other, double timeAdjustment)
 {
+    const int firstAddedIndex = list.size();
+    list.ensureStorageAllocated (firstAddedIndex + other.list.size());
+
     for (int i = 0; i < other.list.size(); ++i)
     {
         const MidiMessage& m = other.list.getUnchecked(i)->message;
 
-        MidiEventHolder* const newOne = new MidiEventHolder (m);
+        MidiEventHolder* const newOne = createHolder (m);
         newOne->message.addToTimeStamp (timeAdjustment);
         list.add (newOne);
     }
 
-    sort();
+    mergeAddedEvents (firstAddedIndex);
 }
 
 void MidiMessageSequence::addSequence (const MidiMessageSequence& other,
@@ -173,6 +416,8 @@ void MidiMessageSequence::addSequence (const MidiMessageSequence& other,
                                        double firstAllowableTime,
                                        double endOfAllowableDestTimes)
 {
+    const int firstAddedIndex = list.size();
+
     for (int i = 0; i < other.list.size(); ++i)
     {
         const MidiMessage& m = other.list.getUnchecked(i)->message;
@@ -180,14 +425,31 @@ void MidiMessageSequence::addSequence (const MidiMessageSequence& other,
 
         if (t >= firstAllowableTime && t < endOfAllowableDestTimes)
         {
-            MidiEventHolder* const newOne = new MidiEventHolder (m);
+            MidiEventHolder* const newOne = createHolder (m);
             newOne->message.setTimeStamp (t);
 
             list.add (newOne);
         }
     }
 
-    sort();
+    mergeAddedEvents (firstAddedIndex);
+}
+
+void MidiMessageSequence::mergeAddedEvents (const int firstAddedIndex)
+{
+    // The events that were already here and the new ones are each sorted, so rather
+    // than sorting the whole list again they can just be merged. This keeps the same
+    // order as a stable sort would, with existing events before new ones at the same time.
+    MidiEventHolder** const start = list.begin();
+    MidiEventHolder** const firstAdded = start + firstAddedIndex;
+    MidiEventHolder** const end = list.end();
+    MidiMessageSequenceHelpers::TimeComparator comparator;
+
+    if (! std::is_sorted (firstAdded, end, comparator))
+        std::stable_sort (firstAdded, end, comparator);
+
+    std::inplace_merge (start, firstAdded, end, comparator);
+    noteIndexIsValid = false;
 }
 
 //==============================================================================
@@ -195,45 +457,102 @@ void MidiMessageSequence::sort() noexcept
 {
     MidiMessageSequenceSorter sorter;
     list.sort (sorter, true);
+    noteIndexIsValid = false;
 }
 
 void MidiMessageSequence::updateMatchedPairs() noexcept
 {
-    for (int i = 0; i < list.size(); ++i)
+    // The note-on that's currently waiting for a note-off, for each channel and note number
+    MidiEventHolder* playingNotes[16][128] = {};
+
+    // This is only used if some note-offs have to be added
+    Array<MidiEventHolder*> newList;
+    bool needsNewList = false;
+
+    const int numEvents = list.size();
+
+    for (int i = 0; i < numEvents; ++i)
     {
         MidiEventHolder* const meh = list.getUnchecked(i);
-        const MidiMessage& m1 = meh->message;
+        const MidiMessage& m = meh->message;
 
-        if (m1.isNoteOn())
+        if (m.isNoteOn())
         {
-            meh->noteOffObject = nullptr;
-            const int note = m1.getNoteNumber();
-            const int chan = m1.getChannel();
-            const int len = list.size();
+            const int chan = m.getChannel();
+            const int note = m.getNoteNumber();
+            MidiEventHolder*& playingNote = playingNotes[chan - 1][note];
 
-            for (int j = i + 1; j < len; ++j)
+            if (playingNote != nullptr)
             {
-                const MidiMessage& m = list.getUnchecked(j)->message;
-
-                if (m.getNoteNumber() == note && m.getChannel() == chan)
+                // This note is already playing, so add a note-off for the previous one
+                // at the same time as this one starts
+                if (! needsNewList)
                 {
-                    if (m.isNoteOff())
-                    {
-                        meh->noteOffObject = list[j];
-                        break;
-                    }
-                    else if (m.isNoteOn())
-                    {
-                        MidiEventHolder* const newEvent = new MidiEventHolder (MidiMessage::noteOff (chan, note));
-                        list.insert (j, newEvent);
-                        newEvent->message.setTimeStamp (m.getTimeStamp());
-                        meh->noteOffObject = newEvent;
-                        break;
-                    }
+                    needsNewList = true;
+                    newList.ensureStorageAllocated (numEvents + 16);
+                    newList.addArray (static_cast<MidiEventHolder* const*> (list.begin()), i);
                 }
+
+                MidiEventHolder* const newEvent = createHolder (MidiMessage::noteOff (chan, note));
+                newEvent->message.setTimeStamp (m.getTimeStamp());
+                playingNote->noteOffObject = newEvent;
+                newList.add (newEvent);
+            }
+
+            meh->noteOffObject = nullptr;
+            playingNote = meh;
+        }
+        else if (m.isNoteOff())
+        {
+            MidiEventHolder*& playingNote = playingNotes[m.getChannel() - 1][m.getNoteNumber()];
+
+            if (playingNote != nullptr)
+            {
+                playingNote->noteOffObject = meh;
+                playingNote = nullptr;
             }
         }
+
+        if (needsNewList)
+            newList.add (meh);
+    }
+
+    if (needsNewList)
+        list.swapWith (newList);
+
+    buildNoteIndex();
+}
+
+void MidiMessageSequence::buildNoteIndex()
+{
+    noteOnIndexes.clearQuick();
+    noteEndTimes.clearQuick();
+
+    for (int i = 0; i < list.size(); ++i)
+        if (list.getUnchecked(i)->message.isNoteOn())
+            noteOnIndexes.add (i);
+
+    const int numNotes = noteOnIndexes.size();
+
+    if (numNotes > 0)
+    {
+        const int numLeaves = nextPowerOfTwo (numNotes);
+        noteEndTimes.insertMultiple (0, -std::numeric_limits<double>::max(), numLeaves * 2);
+
+        for (int i = 0; i < numNotes; ++i)
+        {
+            const MidiEventHolder* const noteOff = list.getUnchecked (noteOnIndexes.getUnchecked (i))->noteOffObject;
+
+            noteEndTimes.setUnchecked (numLeaves + i, noteOff != nullptr ? noteOff->message.getTimeStamp()
+                                                                         : std::numeric_limits<double>::max());
+        }
+
+        for (int i = numLeaves; --i > 0;)
+            noteEndTimes.setUnchecked (i, jmax (noteEndTimes.getUnchecked (i * 2),
+                                                noteEndTimes.getUnchecked (i * 2 + 1)));
     }
+
+    noteIndexIsValid = true;
 }
 
 void MidiMessageSequence::addTimeToMessages (const double delta) noexcept
@@ -243,6 +562,8 @@ void MidiMessageSequence::addTimeToMessages (const double delta) noexcept
         MidiMessage& mm = list.getUnchecked(i)->message;
         mm.setTimeStamp (mm.getTimeStamp() + delta);
     }
+
+    noteIndexIsValid = false;
 }
 
 //==============================================================================
@@ -274,14 +595,14 @@ void MidiMessageSequence::deleteMidiChannelMessages (const int channelNumberToRe
 {
     for (int i = list.size(); --i >= 0;)
         if (list.getUnchecked(i)->message.isForChannel (channelNumberToRemove))
-            list.remove(i);
+            removeEvent (i);
 }
 
 void MidiMessageSequence::deleteSysExMessages()
 {
     for (int i = list.size(); --i >= 0;)
         if (list.getUnchecked(i)->message.isSysEx())
-            list.remove(i);
+            removeEvent (i);
 }
 
 //==============================================================================
@@ -291,11 +612,11 @@ void MidiMessageSequence::createControllerUpdatesForTime (const int channelNumbe
     bool donePitchWheel = false;
     bool doneControllers[128] = { 0 };
 
-    for (int i = list.size(); --i >= 0;)
+    for (int i = MidiMessageSequenceHelpers::findFirstIndexAfter (list, time, false); --i >= 0;)
     {
         const MidiMessage& mm = list.getUnchecked(i)->message;
 
-        if (mm.isForChannel (channelNumber) && mm.getTimeStamp() <= time)
+        if (mm.isForChannel (channelNumber))
         {
             if (mm.isProgramChange() && ! doneProg)
             {
@@ -329,6 +650,143 @@ MidiMessageSequence::MidiEventHolder::MidiEventHolder (const MidiMessage& mm)
 {
 }
 
+MidiMessageSequence::MidiEventHolder::MidiEventHolder (MidiMessage&& mm)
+   : message (static_cast<MidiMessage&&> (mm)), noteOffObject (nullptr)
+{
+}
+
 MidiMessageSequence::MidiEventHolder::~MidiEventHolder()
 {
 }
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MidiMessageSequenceTests  : public UnitTest
+{
+public:
+    MidiMessageSequenceTests() : UnitTest ("MidiMessageSequence") {}
+
+    void runTest() override
+    {
+        Random r = getRandom();
+
+        beginTest ("Time searches");
+        {
+            MidiMessageSequence seq;
+
+            for (int i = 0; i < 1000; ++i)
+                seq.addEvent (MidiMessage::controllerEvent (1, 7, i % 128), r.nextInt (200));
+
+            for (int i = 1; i < seq.getNumEvents(); ++i)
+                expect (seq.getEventTime (i - 1) <= seq.getEventTime (i));
+
+            for (int i = 0; i < 100; ++i)
+            {
+                const double time = r.nextInt (220) - 10;
+                int expected = 0;
+
+                while (expected < seq.getNumEvents() && seq.getEventTime (expected) < time)
+                    ++expected;
+
+                expectEquals (seq.getNextIndexAtTime (time), expected);
+                expectEquals (seq.getIndexRangeForTimes (time, time + 10).getEnd(), seq.getNextIndexAtTime (time + 10));
+
+                const int index = r.nextInt (seq.getNumEvents());
+                expectEquals (seq.getIndexOf (seq.getEventPointer (index)), index);
+            }
+        }
+
+        beginTest ("Matched pairs");
+        {
+            for (int run = 0; run < 10; ++run)
+            {
+                MidiMessageSequence seq;
+                createRandomNotes (r, seq);
+                seq.updateMatchedPairs();
+
+                for (int i = 0; i < seq.getNumEvents(); ++i)
+                {
+                    const MidiMessage& m = seq.getEventPointer (i)->message;
+
+                    if (m.isNoteOn())
+                    {
+                        // the note-off must be the next event for this key
+                        const MidiMessageSequence::MidiEventHolder* expected = nullptr;
+
+                        for (int j = i + 1; j < seq.getNumEvents(); ++j)
+                        {
+                            const MidiMessage& other = seq.getEventPointer (j)->message;
+
+                            if ((other.isNoteOn() || other.isNoteOff())
+                                 && other.getChannel() == m.getChannel() && other.getNoteNumber() == m.getNoteNumber())
+                            {
+                                expect (other.isNoteOff());
+                                expected = seq.getEventPointer (j);
+                                break;
+                            }
+                        }
+
+                        expect (seq.getEventPointer (i)->noteOffObject == expected);
+                    }
+                }
+
+                MidiMessageSequence copy (seq);
+                expectEquals (copy.getNumEvents(), seq.getNumEvents());
+
+                for (int i = 0; i < 50; ++i)
+                {
+                    const double time = r.nextDouble() * 1100.0 - 50.0;
+                    Array<int> found, expected;
+                    copy.findNotesPlayingAt (time, found);
+
+                    for (int j = 0; j < copy.getNumEvents(); ++j)
+                        if (copy.getEventPointer (j)->message.isNoteOn() && copy.getEventTime (j) <= time
+                             && (copy.getEventPointer (j)->noteOffObject == nullptr || copy.getTimeOfMatchingKeyUp (j) > time))
+                            expected.add (j);
+
+                    expect (found == expected);
+                }
+            }
+        }
+
+        beginTest ("Merging sequences");
+        {
+            MidiMessageSequence seq, other;
+            createRandomNotes (r, seq);
+            createRandomNotes (r, other);
+
+            const int numEvents = seq.getNumEvents();
+            seq.addSequence (other, 100.0);
+            expectEquals (seq.getNumEvents(), numEvents + other.getNumEvents());
+
+            for (int i = 1; i < seq.getNumEvents(); ++i)
+                expect (seq.getEventTime (i - 1) <= seq.getEventTime (i));
+
+            seq.deleteMidiChannelMessages (1);
+
+            for (int i = 0; i < seq.getNumEvents(); ++i)
+                expect (! seq.getEventPointer (i)->message.isForChannel (1));
+        }
+    }
+
+    static void createRandomNotes (Random& r, MidiMessageSequence& seq)
+    {
+        for (int i = 0; i < 500; ++i)
+        {
+            const int channel = 1 + r.nextInt (2);
+            const int note = 60 + r.nextInt (4);
+            const double time = r.nextInt (1000);
+
+            if (r.nextBool())
+                seq.addEvent (MidiMessage::noteOn (channel, note, 0.5f), time);
+            else
+                seq.addEvent (MidiMessage::noteOff (channel, note), time);
+        }
+    }
+};
+
+static MidiMessageSequenceTests midiMessageSequenceTests;
+
+#endif
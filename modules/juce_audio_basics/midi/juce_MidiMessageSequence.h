@@ -30,6 +30,11 @@
     This allows the sequence to be manipulated, and also to be read from and
     written to a standard midi file.
 
+    The events are kept sorted by time, so finding the events at a given time
+    is a binary search. After updateMatchedPairs() has been called, the sequence
+    also keeps an index of the note-on/note-off pairs, which lets you quickly find
+    which notes are playing at a particular time with findNotesPlayingAt().
+
     @see MidiMessage, MidiFile
 */
 class JUCE_API  MidiMessageSequence
@@ -46,16 +51,10 @@ public:
     MidiMessageSequence& operator= (const MidiMessageSequence&);
 
     /** Move constructor */
-    MidiMessageSequence (MidiMessageSequence&& other) noexcept
-        : list (static_cast<OwnedArray<MidiEventHolder>&&> (other.list))
-    {}
+    MidiMessageSequence (MidiMessageSequence&&) noexcept;
 
     /** Move assignment operator */
-    MidiMessageSequence& operator= (MidiMessageSequence&& other) noexcept
-    {
-        list = static_cast<OwnedArray<MidiEventHolder>&&> (other.list);
-        return *this;
-    }
+    MidiMessageSequence& operator= (MidiMessageSequence&&) noexcept;
 
     /** Destructor. */
     ~MidiMessageSequence();
@@ -92,6 +91,7 @@ public:
         //==============================================================================
         friend class MidiMessageSequence;
         MidiEventHolder (const MidiMessage&);
+        MidiEventHolder (MidiMessage&&);
         JUCE_LEAK_DETECTOR (MidiEventHolder)
     };
 
@@ -126,6 +126,22 @@ public:
     */
     int getNextIndexAtTime (double timeStamp) const noexcept;
 
+    /** Returns the range of indexes of the events whose timestamps are in the
+        range startTime <= t < endTime.
+    */
+    Range<int> getIndexRangeForTimes (double startTime, double endTime) const noexcept;
+
+    /** Finds the notes that are playing at a given time.
+
+        This adds to the results array the index of each note-on event whose time is
+        less than or equal to the given time and whose matching note-off (if it has one)
+        comes after it. It uses the index that updateMatchedPairs() builds, so takes
+        logarithmic time rather than having to scan the whole sequence.
+
+        @see updateMatchedPairs
+    */
+    void findNotesPlayingAt (double time, Array<int>& noteOnIndexes) const;
+
     //==============================================================================
     /** Returns the timestamp of the first event in the sequence.
         @see getEndTime
@@ -158,6 +174,12 @@ public:
     MidiEventHolder* addEvent (const MidiMessage& newMessage,
                                double timeAdjustment = 0);
 
+    /** Inserts a midi message into the sequence, moving its data rather than copying it.
+        @see addEvent
+    */
+    MidiEventHolder* addEvent (MidiMessage&& newMessage,
+                               double timeAdjustment = 0);
+
     /** Deletes one of the events in the sequence.
 
         Remember to call updateMatchedPairs() after removing events.
@@ -202,6 +224,9 @@ public:
         Call this after re-ordering messages or deleting/adding messages, and it
         will scan the list and make sure all the note-offs in the MidiEventHolder
         structures are pointing at the correct ones.
+
+        This takes a single pass through the sequence, and also rebuilds the index
+        used by findNotesPlayingAt().
     */
     void updateMatchedPairs() noexcept;
 
@@ -274,7 +299,23 @@ public:
 private:
     //==============================================================================
     friend class MidiFile;
-    OwnedArray<MidiEventHolder> list;
+    struct HolderPool;
+
+    Array<MidiEventHolder*> list;
+    ScopedPointer<HolderPool> pool;
+
+    Array<int> noteOnIndexes;
+    Array<double> noteEndTimes;
+    bool noteIndexIsValid;
+
+    MidiEventHolder* createHolder (const MidiMessage&);
+    MidiEventHolder* createHolder (MidiMessage&&);
+    MidiEventHolder* insertEvent (MidiEventHolder*, double timeAdjustment);
+    void deleteHolder (MidiEventHolder*) noexcept;
+    void deleteAllHolders() noexcept;
+    void removeEvent (int index) noexcept;
+    void buildNoteIndex();
+    void mergeAddedEvents (int firstAddedIndex);
 
     JUCE_LEAK_DETECTOR (MidiMessageSequence)
 };
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+
+//==============================================================================
+/**
+    A lightweight, non-owning view of the bytes of a MIDI message.
+
+    Unlike a MidiMessage, this doesn't copy the message data, so it can be used to
+    look at messages, including long sysex messages, without any allocation. This
+    makes it safe to use on the audio thread, e.g. with MidiBuffer::Iterator.
+
+    Because it simply points to the data, a view is only valid for as long as the
+    data it was created from remains unchanged. If you need to keep the message,
+    call toMidiMessage() to make a copy.
+
+    The methods here behave in the same way as the MidiMessage methods with the
+    same names.
+
+    MidiBuffer::Iterator can hand out views of the messages in a buffer, and
+    MidiMessageCollector::addMessageToQueue() accepts one. To look at a MidiMessage
+    that already exists, such as an event in a MidiMessageSequence, you can make a
+    view of it without copying its data. Callbacks that pass messages around by
+    value or reference, like MidiInputCallback::handleIncomingMidiMessage() and
+    Synthesiser::handleMidiEvent(), still take a MidiMessage, so a sysex message
+    that goes through one of those will be copied.
+
+    @see MidiMessage, MidiBuffer::Iterator, MidiMessageCollector
+*/
+class JUCE_API  MidiMessageView
+{
+public:
+    //==============================================================================
+    /** Creates an empty view. */
+    MidiMessageView() noexcept
+        : data (nullptr), size (0), timeStamp (0)
+    {}
+
+    /** Creates a view of a block of message data. */
+    MidiMessageView (const uint8* messageData, int numBytes, double time = 0) noexcept
+        : data (messageData), size (numBytes), timeStamp (time)
+    {}
+
+    /** Creates a view of a MidiMessage. */
+    MidiMessageView (const MidiMessage& message) noexcept
+        : data (message.getRawData()), size (message.getRawDataSize()), timeStamp (message.getTimeStamp())
+    {}
+
+    /** Creates a MidiMessage containing a copy of this message's data. */
+    MidiMessage toMidiMessage() const                   { return MidiMessage (data, size, timeStamp); }
+
+    //==============================================================================
+    /** Returns a pointer to the raw midi data. */
+    const uint8* getRawData() const noexcept            { return data; }
+
+    /** Returns the number of bytes of data in the message. */
+    int getRawDataSize() const noexcept                 { return size; }
+
+    /** Returns the timestamp associated with this message. */
+    double getTimeStamp() const noexcept                { return timeStamp; }
+
+    //==============================================================================
+    /** Returns the midi channel associated with the message, or 0 if it has no channel. */
+    int getChannel() const noexcept                     { return (data[0] & 0xf0) != 0xf0 ? (data[0] & 0xf) + 1 : 0; }
+
+    /** Returns true if the message applies to the given midi channel (1 to 16). */
+    bool isForChannel (int channel) const noexcept      { return getChannel() == channel; }
+
+    /** Returns true if this is a note-on message. */
+    bool isNoteOn (bool returnTrueForVelocity0 = false) const noexcept
+    {
+        return (data[0] & 0xf0) == 0x90 && (returnTrueForVelocity0 || data[2] != 0);
+    }
+
+    /** Returns true if this is a note-off message. */
+    bool isNoteOff (bool returnTrueForNoteOnVelocity0 = true) const noexcept
+    {
+        return (data[0] & 0xf0) == 0x80
+                || (returnTrueForNoteOnVelocity0 && data[2] == 0 && (data[0] & 0xf0) == 0x90);
+    }
+
+    /** Returns true if this is a note-on or note-off message. */
+    bool isNoteOnOrOff() const noexcept                 { return (data[0] & 0xe0) == 0x80; }
+
+    /** Returns the note number of a note-on, note-off or aftertouch message. */
+    int getNoteNumber() const noexcept                  { return data[1]; }
+
+    /** Returns the velocity of a note-on or note-off message, or 0 for other messages. */
+    uint8 getVelocity() const noexcept                  { return isNoteOnOrOff() ? data[2] : (uint8) 0; }
+
+    /** Returns the velocity of a note-on or note-off message, in the range 0 to 1.0. */
+    float getFloatVelocity() const noexcept             { return getVelocity() * (1.0f / 127.0f); }
+
+    //==============================================================================
+    /** Returns true if this is a controller message. */
+    bool isController() const noexcept                  { return (data[0] & 0xf0) == 0xb0; }
+
+    /** Returns true if this is a controller message with the given controller number. */
+    bool isControllerOfType (int controllerType) const noexcept  { return isController() && data[1] == controllerType; }
+
+    /** Returns the controller number of a controller message. */
+    int getControllerNumber() const noexcept            { jassert (isController()); return data[1]; }
+
+    /** Returns the value of a controller message. */
+    int getControllerValue() const noexcept             { jassert (isController()); return data[2]; }
+
+    /** Returns true if this is an all-notes-off message. */
+    bool isAllNotesOff() const noexcept                 { return isControllerOfType (123); }
+
+    /** Returns true if this is an all-sound-off message. */
+    bool isAllSoundOff() const noexcept                 { return isControllerOfType (120); }
+
+    /** Returns true if this is a program change message. */
+    bool isProgramChange() const noexcept               { return (data[0] & 0xf0) == 0xc0; }
+
+    /** Returns the program number of a program change message. */
+    int getProgramChangeNumber() const noexcept         { jassert (isProgramChange()); return data[1]; }
+
+    /** Returns true if this is a pitch-wheel message. */
+    bool isPitchWheel() const noexcept                  { return (data[0] & 0xf0) == 0xe0; }
+
+    /** Returns the position of a pitch-wheel message, in the range 0 to 0x3fff. */
+    int getPitchWheelValue() const noexcept             { jassert (isPitchWheel()); return data[1] | (data[2] << 7); }
+
+    /** Returns true if this is a polyphonic aftertouch message. */
+    bool isAftertouch() const noexcept                  { return (data[0] & 0xf0) == 0xa0; }
+
+    /** Returns the amount of a polyphonic aftertouch message. */
+    int getAfterTouchValue() const noexcept             { jassert (isAftertouch()); return data[2]; }
+
+    /** Returns true if this is a channel pressure message. */
+    bool isChannelPressure() const noexcept             { return (data[0] & 0xf0) == 0xd0; }
+
+    /** Returns the amount of a channel pressure message. */
+    int getChannelPressureValue() const noexcept        { jassert (isChannelPressure()); return data[1]; }
+
+    //==============================================================================
+    /** Returns true if this is a sysex message. */
+    bool isSysEx() const noexcept                       { return data[0] == 0xf0; }
+
+    /** Returns a pointer to the data in a sysex message, not including the 0xf0 and 0xf7
+        bytes at either end. For other messages, this returns nullptr.
+    */
+    const uint8* getSysExData() const noexcept          { return isSysEx() ? data + 1 : nullptr; }
+
+    /** Returns the size of the data returned by getSysExData(). */
+    int getSysExDataSize() const noexcept               { return isSysEx() ? size - 2 : 0; }
+
+    /** Returns true if this is a meta-event. */
+    bool isMetaEvent() const noexcept                   { return data[0] == 0xff; }
+
+private:
+    //==============================================================================
+    const uint8* data;
+    int size;
+    double timeStamp;
+};
@@ -24,10 +24,19 @@ namespace
 {
     const uint8 noLSBValueReceived = 0xff;
     const Range<int> allChannels = Range<int> (1, 17);
+
+    // flags for the per-note changes that are waiting to be reported while processing a buffer
+    enum
+    {
+        pressureChangePending   = 1,
+        pitchbendChangePending  = 2,
+        timbreChangePending     = 4
+    };
 }
 
 //==============================================================================
 MPEInstrument::MPEInstrument() noexcept
+    : isProcessingBuffer (false)
 {
     std::fill_n (lastPressureLowerBitReceivedOnChannel, 16, noLSBValueReceived);
     std::fill_n (lastTimbreLowerBitReceivedOnChannel, 16, noLSBValueReceived);
@@ -149,6 +158,25 @@ void MPEInstrument::processNextMidiEvent (const MidiMessage& message)
     else if (message.isController())       processMidiControllerMessage (message);
 }
 
+void MPEInstrument::processNextMidiBuffer (const MidiBuffer& buffer)
+{
+    const ScopedLock sl (lock);
+
+    {
+        const ScopedValueSetter<bool> processingBuffer (isProcessingBuffer, true);
+
+        MidiBuffer::Iterator iter (buffer);
+        MidiMessage message;
+        int samplePosition;
+
+        while (iter.getNextEvent (message, samplePosition))
+            processNextMidiEvent (message);
+    }
+
+    for (int i = 0; i < notes.size(); ++i)
+        sendPendingNoteChanges (notes.getReference (i));
+}
+
 //==============================================================================
 void MPEInstrument::processMidiNoteOnMessage (const MidiMessage& message)
 {
@@ -221,10 +249,11 @@ void MPEInstrument::processMidiAllNotesOffMessage (const MidiMessage& message)
 
             if (note.midiChannel == message.getChannel())
             {
+                sendPendingNoteChanges (note);
                 note.keyState = MPENote::off;
                 note.noteOffVelocity = MPEValue::from7BitInt (64); // some reasonable number
                 listeners.call (&MPEInstrument::Listener::noteReleased, note);
-                notes.remove (i);
+                removeNote (i);
             }
         }
     }
@@ -236,10 +265,11 @@ void MPEInstrument::processMidiAllNotesOffMessage (const MidiMessage& message)
 
             if (zone->isUsingChannelAsNoteChannel (note.midiChannel))
             {
+                sendPendingNoteChanges (note);
                 note.keyState = MPENote::off;
                 note.noteOffVelocity = MPEValue::from7BitInt (64); // some reasonable number
                 listeners.call (&MPEInstrument::Listener::noteReleased, note);
-                notes.remove (i);
+                removeNote (i);
             }
         }
     }
@@ -294,13 +324,14 @@ void MPEInstrument::noteOn (int midiChannel,
     if (MPENote* alreadyPlayingNote = getNotePtr (midiChannel, midiNoteNumber))
     {
         // pathological case: second note-on received for same note -> retrigger it
+        sendPendingNoteChanges (*alreadyPlayingNote);
         alreadyPlayingNote->keyState = MPENote::off;
         alreadyPlayingNote->noteOffVelocity = MPEValue::from7BitInt (64); // some reasonable number
         listeners.call (&MPEInstrument::Listener::noteReleased, *alreadyPlayingNote);
-        notes.remove (alreadyPlayingNote);
+        removeNote (getIndexOfNote (*alreadyPlayingNote));
     }
 
-    notes.add (newNote);
+    addNote (newNote);
     listeners.call (&MPEInstrument::Listener::noteAdded, newNote);
 }
 
@@ -316,6 +347,7 @@ void MPEInstrument::noteOff (int midiChannel,
 
     if (MPENote* note = getNotePtr (midiChannel, midiNoteNumber))
     {
+        sendPendingNoteChanges (*note);
         note->keyState = (note->keyState == MPENote::keyDownAndSustained) ? MPENote::sustained : MPENote::off;
         note->noteOffVelocity = midiNoteOffVelocity;
 
@@ -328,7 +360,7 @@ void MPEInstrument::noteOff (int midiChannel,
         if (note->keyState == MPENote::off)
         {
             listeners.call (&MPEInstrument::Listener::noteReleased, *note);
-            notes.remove (note);
+            removeNote (getIndexOfNote (*note));
         }
         else
         {
@@ -380,13 +412,10 @@ void MPEInstrument::updateDimension (int midiChannel, MPEDimension& dimension, M
     {
         if (dimension.trackingMode == allNotesOnChannel)
         {
-            for (int i = notes.size(); --i >= 0;)
-            {
-                MPENote& note = notes.getReference (i);
+            const Array<int>& indexes = noteIndexesOnChannel[midiChannel - 1];
 
-                if (note.midiChannel == midiChannel)
-                    updateDimensionForNote (note, dimension, value);
-            }
+            for (int i = indexes.size(); --i >= 0;)
+                updateDimensionForNote (notes.getReference (indexes.getUnchecked (i)), dimension, value);
         }
         else
         {
@@ -413,7 +442,7 @@ void MPEInstrument::updateDimensionMaster (MPEZone& zone, MPEDimension& dimensio
             // master pitchbend is a special case: we don't change the note's own pitchbend,
             // instead we have to update its total (master + note) pitchbend.
             updateNoteTotalPitchbend (note);
-            listeners.call (&MPEInstrument::Listener::notePitchbendChanged, note);
+            callListenersDimensionChanged (note, dimension);
         }
         else if (dimension.getValue (note) != value)
         {
@@ -440,6 +469,18 @@ void MPEInstrument::updateDimensionForNote (MPENote& note, MPEDimension& dimensi
 //==============================================================================
 void MPEInstrument::callListenersDimensionChanged (MPENote& note, MPEDimension& dimension)
 {
+    if (isProcessingBuffer)
+    {
+        // when processing a buffer, the listeners are told about the latest values at the end
+        uint8& pending = pendingNoteChanges.getReference (getIndexOfNote (note));
+
+        if (&dimension == &pressureDimension)   pending |= pressureChangePending;
+        if (&dimension == &timbreDimension)     pending |= timbreChangePending;
+        if (&dimension == &pitchbendDimension)  pending |= pitchbendChangePending;
+
+        return;
+    }
+
     if (&dimension == &pressureDimension)  { listeners.call (&MPEInstrument::Listener::notePressureChanged,  note); return; }
     if (&dimension == &timbreDimension)    { listeners.call (&MPEInstrument::Listener::noteTimbreChanged,    note); return; }
     if (&dimension == &pitchbendDimension) { listeners.call (&MPEInstrument::Listener::notePitchbendChanged, note); return; }
@@ -498,6 +539,8 @@ void MPEInstrument::handleSustainOrSostenuto (int midiChannel, bool isDown, bool
 
         if (legacyMode.isEnabled ? (note.midiChannel == midiChannel) : affectedZone->isUsingChannel (note.midiChannel))
         {
+            sendPendingNoteChanges (note);
+
             if (note.keyState == MPENote::keyDown && isDown)
                 note.keyState = MPENote::keyDownAndSustained;
             else if (note.keyState == MPENote::sustained && ! isDown)
@@ -508,7 +551,7 @@ void MPEInstrument::handleSustainOrSostenuto (int midiChannel, bool isDown, bool
             if (note.keyState == MPENote::off)
             {
                 listeners.call (&MPEInstrument::Listener::noteReleased, note);
-                notes.remove (i);
+                removeNote (i);
             }
             else
             {
@@ -588,11 +631,16 @@ MPENote MPEInstrument::getMostRecentNoteOtherThan (MPENote otherThanThisNote) co
 //==============================================================================
 MPENote* MPEInstrument::getNotePtr (int midiChannel, int midiNoteNumber) const noexcept
 {
-    for (int i = 0; i < notes.size(); ++i)
+    if (! allChannels.contains (midiChannel))
+        return nullptr;
+
+    const Array<int>& indexes = noteIndexesOnChannel[midiChannel - 1];
+
+    for (int i = 0; i < indexes.size(); ++i)
     {
-        MPENote& note = notes.getReference (i);
+        MPENote& note = notes.getReference (indexes.getUnchecked (i));
 
-        if (note.midiChannel == midiChannel && note.initialNote == midiNoteNumber)
+        if (note.initialNote == midiNoteNumber)
             return &note;
     }
 
@@ -616,12 +664,16 @@ MPENote* MPEInstrument::getNotePtr (int midiChannel, TrackingMode mode) const no
 //==============================================================================
 MPENote* MPEInstrument::getLastNotePlayedPtr (int midiChannel) const noexcept
 {
-    for (int i = notes.size(); --i >= 0;)
+    if (! allChannels.contains (midiChannel))
+        return nullptr;
+
+    const Array<int>& indexes = noteIndexesOnChannel[midiChannel - 1];
+
+    for (int i = indexes.size(); --i >= 0;)
     {
-        MPENote& note = notes.getReference (i);
+        MPENote& note = notes.getReference (indexes.getUnchecked (i));
 
-        if (note.midiChannel == midiChannel
-             && (note.keyState == MPENote::keyDown || note.keyState == MPENote::keyDownAndSustained))
+        if (note.keyState == MPENote::keyDown || note.keyState == MPENote::keyDownAndSustained)
             return &note;
     }
 
@@ -634,12 +686,16 @@ MPENote* MPEInstrument::getHighestNotePtr (int midiChannel) const noexcept
     int initialNoteMax = -1;
     MPENote* result = nullptr;
 
-    for (int i = notes.size(); --i >= 0;)
+    if (! allChannels.contains (midiChannel))
+        return nullptr;
+
+    const Array<int>& indexes = noteIndexesOnChannel[midiChannel - 1];
+
+    for (int i = indexes.size(); --i >= 0;)
     {
-        MPENote& note = notes.getReference (i);
+        MPENote& note = notes.getReference (indexes.getUnchecked (i));
 
-        if (note.midiChannel == midiChannel
-             && (note.keyState == MPENote::keyDown || note.keyState == MPENote::keyDownAndSustained)
+        if ((note.keyState == MPENote::keyDown || note.keyState == MPENote::keyDownAndSustained)
              && note.initialNote > initialNoteMax)
         {
             result = &note;
@@ -655,12 +711,16 @@ MPENote* MPEInstrument::getLowestNotePtr (int midiChannel) const noexcept
     int initialNoteMin = 128;
     MPENote* result = nullptr;
 
-    for (int i = notes.size(); --i >= 0;)
+    if (! allChannels.contains (midiChannel))
+        return nullptr;
+
+    const Array<int>& indexes = noteIndexesOnChannel[midiChannel - 1];
+
+    for (int i = indexes.size(); --i >= 0;)
     {
-        MPENote& note = notes.getReference (i);
+        MPENote& note = notes.getReference (indexes.getUnchecked (i));
 
-        if (note.midiChannel == midiChannel
-             && (note.keyState == MPENote::keyDown || note.keyState == MPENote::keyDownAndSustained)
+        if ((note.keyState == MPENote::keyDown || note.keyState == MPENote::keyDownAndSustained)
              && note.initialNote < initialNoteMin)
         {
             result = &note;
@@ -679,12 +739,61 @@ void MPEInstrument::releaseAllNotes()
     for (int i = notes.size(); --i >= 0;)
     {
         MPENote& note = notes.getReference (i);
+        sendPendingNoteChanges (note);
         note.keyState = MPENote::off;
         note.noteOffVelocity = MPEValue::from7BitInt (64); // some reasonable number
         listeners.call (&MPEInstrument::Listener::noteReleased, note);
     }
 
     notes.clear();
+    pendingNoteChanges.clear();
+    updateNoteIndexes();
+}
+
+//==============================================================================
+void MPEInstrument::addNote (const MPENote& newNote)
+{
+    noteIndexesOnChannel[newNote.midiChannel - 1].add (notes.size());
+    notes.add (newNote);
+    pendingNoteChanges.add (0);
+}
+
+void MPEInstrument::removeNote (int index)
+{
+    notes.remove (index);
+    pendingNoteChanges.remove (index);
+    updateNoteIndexes();
+}
+
+void MPEInstrument::updateNoteIndexes() noexcept
+{
+    for (int i = 0; i < 16; ++i)
+        noteIndexesOnChannel[i].clearQuick();
+
+    for (int i = 0; i < notes.size(); ++i)
+        noteIndexesOnChannel[notes.getReference (i).midiChannel - 1].add (i);
+}
+
+int MPEInstrument::getIndexOfNote (const MPENote& note) const noexcept
+{
+    const int index = (int) (&note - notes.begin());
+    jassert (isPositiveAndBelow (index, notes.size()));
+    return index;
+}
+
+void MPEInstrument::sendPendingNoteChanges (MPENote& note)
+{
+    uint8& pending = pendingNoteChanges.getReference (getIndexOfNote (note));
+
+    if (pending != 0)
+    {
+        const uint8 changes = pending;
+        pending = 0;
+
+        if ((changes & pressureChangePending) != 0)   listeners.call (&MPEInstrument::Listener::notePressureChanged,  note);
+        if ((changes & pitchbendChangePending) != 0)  listeners.call (&MPEInstrument::Listener::notePitchbendChanged, note);
+        if ((changes & timbreChangePending) != 0)     listeners.call (&MPEInstrument::Listener::noteTimbreChanged,    note);
+    }
 }
 
 //==============================================================================
@@ -1993,6 +2102,123 @@ public:
                 expectEquals (test.getNumPlayingNotes(), 0);
             }
         }
+
+        beginTest ("Processing a buffer");
+        {
+            UnitTestInstrument test;
+            test.setZoneLayout (testLayout);
+
+            MidiBuffer buffer;
+            buffer.addEvent (MidiMessage::noteOn (3, 60, (uint8) 100), 0);
+            buffer.addEvent (MidiMessage::channelPressureChange (3, 20), 1);
+            buffer.addEvent (MidiMessage::channelPressureChange (3, 30), 2);
+            buffer.addEvent (MidiMessage::pitchWheel (3, 4000), 3);
+            buffer.addEvent (MidiMessage::noteOn (4, 61, (uint8) 100), 4);
+            buffer.addEvent (MidiMessage::controllerEvent (4, 74, 90), 5);
+            buffer.addEvent (MidiMessage::controllerEvent (4, 74, 95), 6);
+            buffer.addEvent (MidiMessage::channelPressureChange (3, 40), 7);
+            buffer.addEvent (MidiMessage::noteOff (3, 60, (uint8) 33), 8);
+
+            test.processNextMidiBuffer (buffer);
+
+            // changes to a note are reported once, before it's released..
+            expectEquals (test.noteAddedCallCounter, 2);
+            expectEquals (test.noteReleasedCallCounter, 1);
+            expectEquals (test.notePressureChangedCallCounter, 1);
+            expectEquals (test.notePitchbendChangedCallCounter, 1);
+            expectHasFinishedNote (test, 3, 60, 33);
+            expectEquals (test.lastNoteFinished->pressure.as7BitInt(), 40);
+            expectEquals (test.lastNoteFinished->pitchbend.as14BitInt(), 4000);
+
+            // ..or at the end of the buffer, if it's still playing
+            expectEquals (test.noteTimbreChangedCallCounter, 1);
+            expectEquals (test.getNumPlayingNotes(), 1);
+            expectNote (test.getNote (4, 61), 100, 0, 8192, 95, MPENote::keyDown);
+
+            // and nothing is reported twice
+            buffer.clear();
+            buffer.addEvent (MidiMessage::channelPressureChange (4, 50), 0);
+            test.processNextMidiBuffer (buffer);
+
+            expectEquals (test.notePressureChangedCallCounter, 2);
+            expectEquals (test.noteTimbreChangedCallCounter, 1);
+            expectNote (test.getNote (4, 61), 100, 50, 8192, 95, MPENote::keyDown);
+        }
+
+        beginTest ("Processing buffers of dense MPE data");
+        {
+            // one note on each of 15 channels, each with 1kHz pressure, pitchbend
+            // and timbre streams, in blocks of 512 samples at 48kHz
+            MPEZoneLayout layout;
+            layout.addZone (MPEZone (1, 15));
+
+            UnitTestInstrument blockInstrument, eventInstrument;
+            blockInstrument.setZoneLayout (layout);
+            eventInstrument.setZoneLayout (layout);
+
+            const double sampleRate = 48000.0;
+            const int blockSize = 512;
+            const int numBlocks = roundToInt (sampleRate / blockSize);
+            const int samplesPerUpdate = roundToInt (sampleRate / 1000.0);
+            const int numNotes = 15;
+
+            MidiBuffer buffer;
+            int blockStart = 0;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                buffer.clear();
+
+                for (int channel = 2; channel <= 16; ++channel)
+                {
+                    if (block == 0)
+                        buffer.addEvent (MidiMessage::noteOn (channel, 40 + channel, (uint8) 100), 0);
+
+                    for (int pos = (samplesPerUpdate - blockStart % samplesPerUpdate) % samplesPerUpdate;
+                         pos < blockSize; pos += samplesPerUpdate)
+                    {
+                        const int update = (blockStart + pos) / samplesPerUpdate + channel;
+
+                        buffer.addEvent (MidiMessage::channelPressureChange (channel, update % 128), pos);
+                        buffer.addEvent (MidiMessage::pitchWheel (channel, (update * 97) % 16384), pos);
+                        buffer.addEvent (MidiMessage::controllerEvent (channel, 74, (update * 3) % 128), pos);
+                    }
+                }
+
+                const int numPressureChanges  = blockInstrument.notePressureChangedCallCounter;
+                const int numPitchbendChanges = blockInstrument.notePitchbendChangedCallCounter;
+                const int numTimbreChanges    = blockInstrument.noteTimbreChangedCallCounter;
+
+                blockInstrument.processNextMidiBuffer (buffer);
+
+                MidiBuffer::Iterator iter (buffer);
+                MidiMessage message;
+                int samplePosition;
+
+                while (iter.getNextEvent (message, samplePosition))
+                    eventInstrument.processNextMidiEvent (message);
+
+                expect (blockInstrument.notePressureChangedCallCounter  - numPressureChanges  <= numNotes);
+                expect (blockInstrument.notePitchbendChangedCallCounter - numPitchbendChanges <= numNotes);
+                expect (blockInstrument.noteTimbreChangedCallCounter    - numTimbreChanges    <= numNotes);
+
+                blockStart += blockSize;
+            }
+
+            expectEquals (blockInstrument.getNumPlayingNotes(), numNotes);
+            expectEquals (eventInstrument.getNumPlayingNotes(), numNotes);
+            expect (blockInstrument.notePressureChangedCallCounter < eventInstrument.notePressureChangedCallCounter);
+
+            for (int channel = 2; channel <= 16; ++channel)
+            {
+                const MPENote expected (eventInstrument.getNote (channel, 40 + channel));
+                expectNote (blockInstrument.getNote (channel, 40 + channel),
+                            expected.noteOnVelocity.as7BitInt(), expected.pressure.as7BitInt(),
+                            expected.pitchbend.as14BitInt(), expected.timbre.as7BitInt(), expected.keyState);
+                expectEquals (blockInstrument.getNote (channel, 40 + channel).totalPitchbendInSemitones,
+                              expected.totalPitchbendInSemitones);
+            }
+        }
     }
 
 private:
@@ -129,6 +129,24 @@ public:
     */
     virtual void processNextMidiEvent (const MidiMessage& message);
 
+    /** Processes all the MIDI messages in a buffer.
+
+        This has the same effect on the instrument's notes as calling processNextMidiEvent()
+        for each of the messages in turn, but is more efficient when there's a lot of MPE
+        data, such as high-rate per-note pressure, pitchbend and timbre streams.
+
+        The lock is only taken once for the whole buffer, and instead of calling the
+        listeners every time a note's pressure, pitchbend or timbre changes, any notes
+        whose values have changed are reported once, at the end of the buffer. Notes
+        being added, released or changing key state are still reported straight away,
+        after any pending changes to the same note.
+
+        This makes it suitable for things that only need to update once per block, but
+        not for something like MPESynthesiser that needs to respond to each message at
+        its exact sample position.
+    */
+    void processNextMidiBuffer (const MidiBuffer& buffer);
+
     //==============================================================================
     /** Request a note-on on the given channel, with the given initial note
         number and velocity.
@@ -321,6 +339,9 @@ private:
     //==============================================================================
     CriticalSection lock;
     Array<MPENote> notes;
+    Array<int> noteIndexesOnChannel[16];
+    Array<uint8> pendingNoteChanges;
+    bool isProcessingBuffer;
     MPEZoneLayout zoneLayout;
     ListenerList<Listener> listeners;
 
@@ -372,5 +393,11 @@ private:
     MPENote* getLowestNotePtr (int midiChannel) const noexcept;
     void updateNoteTotalPitchbend (MPENote&);
 
+    void addNote (const MPENote&);
+    void removeNote (int index);
+    void updateNoteIndexes() noexcept;
+    int getIndexOfNote (const MPENote&) const noexcept;
+    void sendPendingNoteChanges (MPENote&);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MPEInstrument)
 };
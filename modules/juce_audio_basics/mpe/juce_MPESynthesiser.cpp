@@ -37,6 +37,7 @@ void MPESynthesiser::startVoice (MPESynthesiserVoice* voice, MPENote noteToStart
 {
     jassert (voice != nullptr);
     voice->currentlyPlayingNote = noteToStart;
+    activeVoices.addIfNotAlreadyThere (voice);
     voice->noteStarted();
 }
 
@@ -282,12 +283,14 @@ void MPESynthesiser::addVoice (MPESynthesiserVoice* const newVoice)
 {
     const ScopedLock sl (voicesLock);
     newVoice->setCurrentSampleRate (getSampleRate());
+    activeVoices.ensureStorageAllocated (voices.size() + 1);
     voices.add (newVoice);
 }
 
 void MPESynthesiser::clearVoices()
 {
     const ScopedLock sl (voicesLock);
+    activeVoices.clear();
     voices.clear();
 }
 
@@ -300,6 +303,7 @@ MPESynthesiserVoice* MPESynthesiser::getVoice (const int index) const
 void MPESynthesiser::removeVoice (const int index)
 {
     const ScopedLock sl (voicesLock);
+    activeVoices.removeFirstMatchingValue (voices [index]);
     voices.remove (index);
 }
 
@@ -312,10 +316,14 @@ void MPESynthesiser::reduceNumVoices (const int newNumVoices)
 
     while (voices.size() > newNumVoices)
     {
-        if (MPESynthesiserVoice* voice = findFreeVoice (MPENote(), true))
-            voices.removeObject (voice);
-        else
-            voices.remove (0); // if there's no voice to steal, kill the oldest voice
+        MPESynthesiserVoice* voice = findFreeVoice (MPENote(), true);
+
+        // if there's no voice to steal, kill the oldest voice
+        if (voice == nullptr)
+            voice = voices.getFirst();
+
+        activeVoices.removeFirstMatchingValue (voice);
+        voices.removeObject (voice);
     }
 }
 
@@ -331,8 +339,44 @@ void MPESynthesiser::turnOffAllVoices (bool allowTailOff)
 }
 
 //==============================================================================
+void MPESynthesiser::setNumVoiceRenderingThreads (int numThreads)
+{
+    ScopedPointer<ParallelVoiceRenderer> newRenderer (numThreads > 0 ? new ParallelVoiceRenderer (numThreads) : nullptr);
+
+    {
+        const ScopedLock sl (voicesLock);
+        voiceRenderer.swapWith (newRenderer);
+    }
+}
+
+int MPESynthesiser::getNumVoiceRenderingThreads() const noexcept
+{
+    return voiceRenderer != nullptr ? voiceRenderer->getNumWorkerThreads() : 0;
+}
+
+template <typename floatType>
+bool MPESynthesiser::renderActiveVoices (AudioBuffer<floatType>& buffer, int startSample, int numSamples)
+{
+    const ScopedLock sl (voicesLock);
+
+    if (voiceRenderer == nullptr)
+        return false;
+
+    // voices stop themselves while rendering, so drop any that have finished since the last sub-block
+    for (int i = activeVoices.size(); --i >= 0;)
+        if (! activeVoices.getUnchecked (i)->isActive())
+            activeVoices.remove (i);
+
+    voiceRenderer->renderVoices (activeVoices.getRawDataPointer(), activeVoices.size(),
+                                 buffer, startSample, numSamples);
+    return true;
+}
+
 void MPESynthesiser::renderNextSubBlock (AudioBuffer<float>& buffer, int startSample, int numSamples)
 {
+    if (voiceRenderer != nullptr && renderActiveVoices (buffer, startSample, numSamples))
+        return;
+
     for (int i = voices.size(); --i >= 0;)
     {
         MPESynthesiserVoice* voice = voices.getUnchecked (i);
@@ -344,6 +388,9 @@ void MPESynthesiser::renderNextSubBlock (AudioBuffer<float>& buffer, int startSa
 
 void MPESynthesiser::renderNextSubBlock (AudioBuffer<double>& buffer, int startSample, int numSamples)
 {
+    if (voiceRenderer != nullptr && renderActiveVoices (buffer, startSample, numSamples))
+        return;
+
     for (int i = voices.size(); --i >= 0;)
     {
         MPESynthesiserVoice* voice = voices.getUnchecked (i);
@@ -125,6 +125,24 @@ public:
     /** Returns true if note-stealing is enabled. */
     bool isVoiceStealingEnabled() const noexcept                { return shouldStealVoices; }
 
+    //==============================================================================
+    /** Shares out the rendering of the active voices between some worker threads.
+
+        If this is more than zero, renderNextSubBlock() spreads the active voices across the
+        calling thread and this many workers, and sums their output at the end of each
+        sub-block. Your voices must then be safe to render at the same time as each other.
+        A value of zero (the default) renders every voice on the calling thread.
+
+        As with Synthesiser, this is only worth turning on once you've measured it helping,
+        as it's slower than the default when there's only one core or the voices are cheap.
+
+        @see Synthesiser::setNumVoiceRenderingThreads
+    */
+    void setNumVoiceRenderingThreads (int numThreads);
+
+    /** Returns the number of worker threads set by setNumVoiceRenderingThreads(). */
+    int getNumVoiceRenderingThreads() const noexcept;
+
     //==============================================================================
     /** Tells the synthesiser what the sample rate is for the audio it's being used to render.
 
@@ -302,6 +320,11 @@ private:
     //==============================================================================
     bool shouldStealVoices;
     CriticalSection voicesLock;
+    ScopedPointer<ParallelVoiceRenderer> voiceRenderer;
+    Array<MPESynthesiserVoice*> activeVoices;
+
+    template <typename floatType>
+    bool renderActiveVoices (AudioBuffer<floatType>&, int startSample, int numSamples);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MPESynthesiser)
 };
@@ -20,6 +20,19 @@
   ==============================================================================
 */
 
+namespace BufferingAudioSourceHelpers
+{
+    // all in milliseconds
+    const double averagingTime      = 500.0;
+    const double peakDecayTime      = 5000.0;
+    const double safetyMargin       = 20.0;
+
+    static double getSmoothingFactor (double elapsedMs, double timeConstantMs) noexcept
+    {
+        return 1.0 - std::exp (-elapsedMs / timeConstantMs);
+    }
+}
+
 BufferingAudioSource::BufferingAudioSource (PositionableAudioSource* s,
                                             TimeSliceThread& thread,
                                             const bool deleteSourceWhenDeleted,
@@ -30,18 +43,37 @@ BufferingAudioSource::BufferingAudioSource (PositionableAudioSource* s,
       backgroundThread (thread),
       numberOfSamplesToBuffer (jmax (1024, bufferSizeSamples)),
       numberOfChannels (numChannels),
+      preparedBufferSize (0),
       bufferValidStart (0),
       bufferValidEnd (0),
       nextPlayPos (0),
       sampleRate (0),
       wasSourceLooping (false),
       isPrepared (false),
-      prefillBuffer (prefillBufferOnPrepareToPlay)
+      prefillBuffer (prefillBufferOnPrepareToPlay),
+      adaptiveBuffering (false),
+      minimumSamplesToBuffer (numberOfSamplesToBuffer),
+      targetSamplesToBuffer (numberOfSamplesToBuffer),
+      blockSizeExpected (0),
+      lastRequestedWait (0),
+      lastPlayPos (0),
+      totalLength (0),
+      lastSliceTime (0),
+      consumptionRate (0),
+      peakConsumptionRate (0),
+      averageReadTime (0),
+      peakReadTime (0),
+      peakSchedulingDelay (0),
+      prefetchStart (0),
+      prefetchValidEnd (0),
+      prefetchRequested (false)
 {
     jassert (source != nullptr);
 
     jassert (numberOfSamplesToBuffer > 1024); // not much point using this class if you're
                                               //  not using a larger buffer..
+
+    zerostruct (statistics);
 }
 
 BufferingAudioSource::~BufferingAudioSource()
@@ -52,16 +84,19 @@ BufferingAudioSource::~BufferingAudioSource()
 //==============================================================================
 void BufferingAudioSource::prepareToPlay (int samplesPerBlockExpected, double newSampleRate)
 {
-    const int bufferSizeNeeded = jmax (samplesPerBlockExpected * 2, numberOfSamplesToBuffer);
+    const int bufferSizeNeeded = jmax (samplesPerBlockExpected * 2, adaptiveBuffering ? (int) minimumSamplesToBuffer
+                                                                                      : numberOfSamplesToBuffer);
 
     if (newSampleRate != sampleRate
-         || bufferSizeNeeded != buffer.getNumSamples()
+         || bufferSizeNeeded != preparedBufferSize
          || ! isPrepared)
     {
         backgroundThread.removeTimeSliceClient (this);
 
         isPrepared = true;
         sampleRate = newSampleRate;
+        preparedBufferSize = bufferSizeNeeded;
+        blockSizeExpected = samplesPerBlockExpected;
 
         source->prepareToPlay (samplesPerBlockExpected, newSampleRate);
 
@@ -71,6 +106,21 @@ void BufferingAudioSource::prepareToPlay (int samplesPerBlockExpected, double ne
         bufferValidStart = 0;
         bufferValidEnd = 0;
 
+        targetSamplesToBuffer = bufferSizeNeeded - 4;
+        totalLength = source->getTotalLength();
+        lastSliceTime = 0;
+        consumptionRate = peakConsumptionRate = 0;
+        averageReadTime = peakReadTime = peakSchedulingDelay = 0;
+        prefetchRequested = false;
+        prefetchStart = prefetchValidEnd = 0;
+
+        {
+            const ScopedLock sl (bufferStartPosLock);
+            zerostruct (statistics);
+            statistics.bufferSize = buffer.getNumSamples();
+            statistics.readAheadSamples = targetSamplesToBuffer;
+        }
+
         backgroundThread.addTimeSliceClient (this);
 
         do
@@ -79,7 +129,7 @@ void BufferingAudioSource::prepareToPlay (int samplesPerBlockExpected, double ne
             Thread::sleep (5);
         }
         while (prefillBuffer
-         && (bufferValidEnd - bufferValidStart < jmin (((int) newSampleRate) / 4, buffer.getNumSamples() / 2)));
+         && (bufferValidEnd - bufferValidStart < jmin (((int) newSampleRate) / 4, bufferSizeNeeded / 2)));
     }
 }
 
@@ -89,6 +139,8 @@ void BufferingAudioSource::releaseResources()
     backgroundThread.removeTimeSliceClient (this);
 
     buffer.setSize (numberOfChannels, 0);
+    prefetchBuffer.setSize (numberOfChannels, 0);
+    preparedBufferSize = 0;
 
     // MSVC2015 seems to need this if statement to not generate a warning during linking.
     // As source is set in the constructor, there is no way that source could
@@ -104,6 +156,20 @@ void BufferingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info
     const int validStart = (int) (jlimit (bufferValidStart, bufferValidEnd, nextPlayPos) - nextPlayPos);
     const int validEnd   = (int) (jlimit (bufferValidStart, bufferValidEnd, nextPlayPos + info.numSamples) - nextPlayPos);
 
+    {
+        // count any samples that the input could have provided, but which weren't ready in time
+        const int64 wantedStart = jmax ((int64) 0, nextPlayPos);
+        const int64 wantedEnd = wasSourceLooping ? nextPlayPos + info.numSamples
+                                                 : jmin (totalLength, nextPlayPos + info.numSamples);
+        const int64 numMissed = (wantedEnd - wantedStart) - (validEnd - validStart);
+
+        if (numMissed > 0)
+        {
+            ++statistics.numUnderruns;
+            statistics.numSamplesMissed += numMissed;
+        }
+    }
+
     if (validStart == validEnd)
     {
         // total cache miss
@@ -212,6 +278,47 @@ void BufferingAudioSource::setNextReadPosition (int64 newPosition)
     backgroundThread.moveToFrontOfQueue (this);
 }
 
+void BufferingAudioSource::prefetchPosition (int64 positionToPrefetch)
+{
+    const ScopedLock sl (bufferStartPosLock);
+
+    prefetchStart = prefetchValidEnd = jmax ((int64) 0, positionToPrefetch);
+    prefetchRequested = true;
+    backgroundThread.moveToFrontOfQueue (this);
+}
+
+//==============================================================================
+void BufferingAudioSource::setAdaptiveBuffering (bool shouldAdapt, int minimumSamples)
+{
+    // the minimum can't be more than the buffer size that was given to the constructor
+    jassert (minimumSamples <= numberOfSamplesToBuffer);
+
+    const ScopedLock sl (bufferStartPosLock);
+
+    minimumSamplesToBuffer = jlimit (1024, numberOfSamplesToBuffer, minimumSamples);
+    adaptiveBuffering = shouldAdapt;
+    backgroundThread.moveToFrontOfQueue (this);
+}
+
+BufferingAudioSource::BufferingStatistics BufferingAudioSource::getBufferingStatistics() const
+{
+    const ScopedLock sl (bufferStartPosLock);
+
+    BufferingStatistics s (statistics);
+    s.bufferedSamples = (int) jmax ((int64) 0, bufferValidEnd - jmax (bufferValidStart, nextPlayPos));
+    s.fillLevel = s.readAheadSamples > 0 ? jmin (1.0, s.bufferedSamples / (double) s.readAheadSamples) : 0.0;
+    return s;
+}
+
+void BufferingAudioSource::resetBufferingStatistics()
+{
+    const ScopedLock sl (bufferStartPosLock);
+
+    statistics.numUnderruns = 0;
+    statistics.numSamplesMissed = 0;
+}
+
+//==============================================================================
 bool BufferingAudioSource::readNextBufferChunk()
 {
     int64 newBVS, newBVE, sectionToReadStart, sectionToReadEnd;
@@ -227,14 +334,19 @@ bool BufferingAudioSource::readNextBufferChunk()
         }
 
         newBVS = jmax ((int64) 0, nextPlayPos);
-        newBVE = newBVS + buffer.getNumSamples() - 4;
+        newBVE = newBVS + (adaptiveBuffering ? jmin (targetSamplesToBuffer, buffer.getNumSamples() - 4)
+                                             : buffer.getNumSamples() - 4);
         sectionToReadStart = 0;
         sectionToReadEnd = 0;
 
-        const int maxChunkSize = 2048;
+        // when adapting, bigger buffers are filled in bigger chunks, to cut down the number of reads
+        const int maxChunkSize = adaptiveBuffering ? jlimit (2048, 16384, targetSamplesToBuffer / 4) : 2048;
 
         if (newBVS < bufferValidStart || newBVS >= bufferValidEnd)
         {
+            if (adoptPrefetchedSection())
+                return true;
+
             newBVE = jmin (newBVE, newBVS + maxChunkSize);
 
             sectionToReadStart = newBVS;
@@ -246,7 +358,7 @@ bool BufferingAudioSource::readNextBufferChunk()
         else if (std::abs ((int) (newBVS - bufferValidStart)) > 512
                   || std::abs ((int) (newBVE - bufferValidEnd)) > 512)
         {
-            newBVE = jmin (newBVE, bufferValidEnd + maxChunkSize);
+            newBVE = jlimit (bufferValidEnd, bufferValidEnd + maxChunkSize, newBVE);
 
             sectionToReadStart = bufferValidEnd;
             sectionToReadEnd = newBVE;
@@ -259,6 +371,8 @@ bool BufferingAudioSource::readNextBufferChunk()
     if (sectionToReadStart == sectionToReadEnd)
         return false;
 
+    const double readStartTime = Time::getMillisecondCounterHiRes();
+
     jassert (buffer.getNumSamples() > 0);
     const int bufferIndexStart = (int) (sectionToReadStart % buffer.getNumSamples());
     const int bufferIndexEnd   = (int) (sectionToReadEnd   % buffer.getNumSamples());
@@ -282,6 +396,10 @@ bool BufferingAudioSource::readNextBufferChunk()
                            0);
     }
 
+    const double readTime = Time::getMillisecondCounterHiRes() - readStartTime;
+    averageReadTime += (readTime - averageReadTime) * 0.1;
+    peakReadTime = jmax (peakReadTime, readTime);
+
     {
         const ScopedLock sl2 (bufferStartPosLock);
 
@@ -294,16 +412,403 @@ bool BufferingAudioSource::readNextBufferChunk()
     return true;
 }
 
+bool BufferingAudioSource::readNextPrefetchChunk()
+{
+    int64 sectionToReadStart;
+    int bufferOffset, numToRead;
+
+    {
+        const ScopedLock sl (bufferStartPosLock);
+
+        if (! prefetchRequested)
+            return false;
+
+        // a small section is enough to cover the time that it takes to get the main buffer going again
+        const int prefetchSize = jlimit (2048, jmax (2048, numberOfSamplesToBuffer / 2),
+                                         jmax (targetSamplesToBuffer / 2, blockSizeExpected * 4));
+
+        // the prefetch buffer is only used by this thread, so it can be reallocated without the lock
+        if (prefetchBuffer.getNumChannels() != numberOfChannels || prefetchBuffer.getNumSamples() < prefetchSize)
+        {
+            {
+                const ScopedUnlock ul (bufferStartPosLock);
+                AudioSampleBuffer newPrefetchBuffer (numberOfChannels, prefetchSize);
+                prefetchBuffer = static_cast<AudioSampleBuffer&&> (newPrefetchBuffer);
+            }
+
+            prefetchValidEnd = prefetchStart;
+        }
+
+        sectionToReadStart = prefetchValidEnd;
+        bufferOffset = (int) (prefetchValidEnd - prefetchStart);
+        numToRead = jmin (2048, prefetchSize - bufferOffset);
+
+        if (numToRead <= 0)
+        {
+            prefetchRequested = false;
+            return false;
+        }
+    }
+
+    readSection (prefetchBuffer, sectionToReadStart, numToRead, bufferOffset);
+
+    const ScopedLock sl (bufferStartPosLock);
+
+    // only keep what's been read if the position hasn't changed in the meantime
+    if (prefetchValidEnd == sectionToReadStart)
+        prefetchValidEnd += numToRead;
+
+    return true;
+}
+
+bool BufferingAudioSource::adoptPrefetchedSection()
+{
+    // this is called by readNextBufferChunk() while it holds the lock
+    const int64 playPos = jmax ((int64) 0, nextPlayPos);
+
+    if (prefetchValidEnd <= prefetchStart
+         || (playPos >= bufferValidStart && playPos < bufferValidEnd)
+         || playPos < prefetchStart || playPos >= prefetchValidEnd)
+        return false;
+
+    // The playback position has jumped into the prefetched section, so it's copied into the
+    // main buffer. This happens while holding the lock, as the audio thread could otherwise
+    // read from the buffer before it's been marked as valid.
+    const int bufferSize = buffer.getNumSamples();
+    const int64 end = jmin (prefetchValidEnd, playPos + bufferSize - 4);
+
+    for (int64 pos = playPos; pos < end;)
+    {
+        const int bufferIndex = (int) (pos % bufferSize);
+        const int num = (int) jmin (end - pos, (int64) (bufferSize - bufferIndex));
+
+        for (int chan = 0; chan < numberOfChannels; ++chan)
+            buffer.copyFrom (chan, bufferIndex, prefetchBuffer, chan, (int) (pos - prefetchStart), num);
+
+        pos += num;
+    }
+
+    bufferValidStart = playPos;
+    bufferValidEnd = end;
+    prefetchStart = prefetchValidEnd = 0;
+    prefetchRequested = false;
+
+    bufferReadyEvent.signal();
+    return true;
+}
+
 void BufferingAudioSource::readBufferSection (const int64 start, const int length, const int bufferOffset)
+{
+    readSection (buffer, start, length, bufferOffset);
+}
+
+void BufferingAudioSource::readSection (AudioSampleBuffer& dest, const int64 start, const int length, const int bufferOffset)
 {
     if (source->getNextReadPosition() != start)
         source->setNextReadPosition (start);
 
-    AudioSourceChannelInfo info (&buffer, bufferOffset, length);
+    AudioSourceChannelInfo info (&dest, bufferOffset, length);
     source->getNextAudioBlock (info);
 }
 
+//==============================================================================
+void BufferingAudioSource::updateReadAhead()
+{
+    using namespace BufferingAudioSourceHelpers;
+
+    const double now = Time::getMillisecondCounterHiRes();
+    int64 playPos;
+
+    {
+        const ScopedLock sl (bufferStartPosLock);
+        playPos = nextPlayPos;
+    }
+
+    if (lastSliceTime > 0 && now > lastSliceTime)
+    {
+        const double elapsed = now - lastSliceTime;
+        const double peakDecay = std::exp (-elapsed / peakDecayTime);
+
+        // how much later than requested this call came, which grows with the number of
+        // sources sharing the thread and the time that they take to read
+        peakSchedulingDelay = jmax (elapsed - lastRequestedWait, peakSchedulingDelay * peakDecay);
+        peakReadTime *= peakDecay;
+
+        // the playback rate, ignoring any jumps caused by seeking
+        const int64 numConsumed = playPos - lastPlayPos;
+
+        if (numConsumed >= 0 && numConsumed < 8.0 * sampleRate * elapsed / 1000.0 + blockSizeExpected)
+        {
+            consumptionRate += (numConsumed / elapsed - consumptionRate) * getSmoothingFactor (elapsed, averagingTime);
+            peakConsumptionRate = jmax (consumptionRate, peakConsumptionRate * peakDecay);
+        }
+    }
+
+    lastSliceTime = now;
+    lastPlayPos = playPos;
+
+    if (! adaptiveBuffering)
+    {
+        targetSamplesToBuffer = buffer.getNumSamples() - 4;
+    }
+    else
+    {
+        // Enough to keep playing while waiting for a couple of slow reads and a slow trip
+        // round the other clients of the thread. Before the rate is known, it assumes that
+        // playback is running at normal speed.
+        const double rate = peakConsumptionRate > 0 ? peakConsumptionRate : sampleRate / 1000.0;
+        const double timeNeeded = 2.0 * (peakReadTime + peakSchedulingDelay) + safetyMargin;
+        const int target = roundToInt (rate * timeNeeded) + 2 * blockSizeExpected;
+
+        targetSamplesToBuffer = jlimit ((int) minimumSamplesToBuffer, numberOfSamplesToBuffer - 4, (target + 1023) & ~1023);
+
+        // leave some room above the target, and only shrink when it's well below the current size
+        const int wantedSize = jmax (blockSizeExpected * 2, jmin (numberOfSamplesToBuffer, targetSamplesToBuffer + targetSamplesToBuffer / 2 + 4));
+
+        if (wantedSize > buffer.getNumSamples() || wantedSize < buffer.getNumSamples() / 2)
+            resizeBuffer (wantedSize);
+    }
+
+    const int64 newTotalLength = source->getTotalLength();
+
+    const ScopedLock sl (bufferStartPosLock);
+
+    totalLength = newTotalLength;
+    statistics.bufferSize = buffer.getNumSamples();
+    statistics.readAheadSamples = targetSamplesToBuffer;
+    statistics.consumptionRate = consumptionRate * 1000.0;
+    statistics.averageReadTimeMs = averageReadTime;
+    statistics.maxReadTimeMs = peakReadTime;
+}
+
+void BufferingAudioSource::resizeBuffer (const int newSize)
+{
+    // the new buffer is allocated, and the old one freed, without holding the lock
+    AudioSampleBuffer newBuffer (numberOfChannels, newSize), oldBuffer;
+
+    {
+        const ScopedLock sl (bufferStartPosLock);
+
+        const int oldSize = buffer.getNumSamples();
+        const int64 start = jmax (bufferValidStart, jmax ((int64) 0, nextPlayPos));
+        const int64 end = jmin (bufferValidEnd, start + newSize - 4);
+
+        // copy across whatever's still to be played, which will be at different indexes in the new buffer
+        for (int64 pos = start; pos < end;)
+        {
+            const int sourceIndex = (int) (pos % oldSize);
+            const int destIndex   = (int) (pos % newSize);
+            const int num = (int) jmin (end - pos, (int64) (oldSize - sourceIndex), (int64) (newSize - destIndex));
+
+            for (int chan = 0; chan < numberOfChannels; ++chan)
+                newBuffer.copyFrom (chan, destIndex, buffer, chan, sourceIndex, num);
+
+            pos += num;
+        }
+
+        bufferValidStart = start < end ? start : 0;
+        bufferValidEnd   = start < end ? end : 0;
+
+        oldBuffer = static_cast<AudioSampleBuffer&&> (buffer);
+        buffer = static_cast<AudioSampleBuffer&&> (newBuffer);
+    }
+}
+
+int BufferingAudioSource::getTimeUntilNextRead (const bool didRead) const
+{
+    int64 numBuffered;
+
+    {
+        const ScopedLock sl (bufferStartPosLock);
+        numBuffered = bufferValidEnd - jmax (bufferValidStart, nextPlayPos);
+    }
+
+    if (didRead && numBuffered < targetSamplesToBuffer)
+        return 0;
+
+    // Come back when the buffer has dropped to three quarters of the target. Because the
+    // thread calls whichever client is due first, this means that the sources that are
+    // closest to running out get read first.
+    const double rate = jmax (consumptionRate, 0.001);
+    const int timeUntilLow = roundToInt ((numBuffered - targetSamplesToBuffer * 3 / 4) / rate);
+
+    return jlimit (didRead ? 1 : 10, 100, timeUntilLow);
+}
+
 int BufferingAudioSource::useTimeSlice()
 {
-    return readNextBufferChunk() ? 1 : 100;
+    updateReadAhead();
+
+    const bool didRead = readNextBufferChunk();
+    bool isWaitingToPrefetch;
+
+    {
+        // prefetching can wait until the main buffer is at least half full
+        const ScopedLock sl (bufferStartPosLock);
+        isWaitingToPrefetch = prefetchRequested && bufferValidEnd - jmax (bufferValidStart, nextPlayPos) < targetSamplesToBuffer / 2;
+    }
+
+    if (isWaitingToPrefetch)
+        lastRequestedWait = didRead ? 1 : 10;
+    else if (! adaptiveBuffering)
+        lastRequestedWait = (readNextPrefetchChunk() || didRead) ? 1 : 100;
+    else
+        lastRequestedWait = getTimeUntilNextRead (readNextPrefetchChunk() || didRead);
+
+    return lastRequestedWait;
 }
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class BufferingAudioSourceTests  : public UnitTest
+{
+public:
+    BufferingAudioSourceTests() : UnitTest ("BufferingAudioSource") {}
+
+    // Produces a different value for each position and channel, and can be made slow or broken
+    struct TestSource  : public PositionableAudioSource
+    {
+        TestSource (int delay) noexcept  : readDelayMs (delay), position (0) {}
+
+        void prepareToPlay (int, double) override       {}
+        void releaseResources() override                {}
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            if (readDelayMs > 0)
+                Thread::sleep (readDelayMs);
+
+            for (int channel = 0; channel < info.buffer->getNumChannels(); ++channel)
+            {
+                float* const dest = info.buffer->getWritePointer (channel, info.startSample);
+
+                for (int i = 0; i < info.numSamples; ++i)
+                    dest[i] = isBroken.get() != 0 ? 0.0f : getExpectedSample (position + i, channel);
+            }
+
+            position += info.numSamples;
+            numSamplesRead += info.numSamples;
+        }
+
+        void setNextReadPosition (int64 newPosition) override   { position = newPosition; }
+        int64 getNextReadPosition() const override              { return position; }
+        int64 getTotalLength() const override                   { return 10000000; }
+        bool isLooping() const override                         { return false; }
+
+        static float getExpectedSample (int64 pos, int channel) noexcept
+        {
+            return (float) (pos % 1000) * 0.001f + (float) channel;
+        }
+
+        const int readDelayMs;
+        int64 position;
+        Atomic<int> isBroken, numSamplesRead;
+    };
+
+    bool isBlockCorrect (const AudioSampleBuffer& block, int64 startPos)
+    {
+        for (int channel = 0; channel < block.getNumChannels(); ++channel)
+            for (int i = 0; i < block.getNumSamples(); ++i)
+                if (block.getSample (channel, i) != TestSource::getExpectedSample (startPos + i, channel))
+                    return false;
+
+        return true;
+    }
+
+    void runTest() override
+    {
+        TimeSliceThread thread ("BufferingAudioSource test");
+        thread.startThread();
+
+        AudioSampleBuffer block (2, 512);
+        AudioSourceChannelInfo info (&block, 0, block.getNumSamples());
+
+        beginTest ("Reading");
+        {
+            BufferingAudioSource buffering (new TestSource (0), thread, true, 32768);
+            buffering.prepareToPlay (512, 44100.0);
+
+            bool allCorrect = true;
+
+            for (int i = 0; i < 100; ++i)
+            {
+                const int64 pos = buffering.getNextReadPosition();
+                expect (buffering.waitForNextAudioBlockReady (info, 2000));
+                buffering.getNextAudioBlock (info);
+                allCorrect = allCorrect && isBlockCorrect (block, pos);
+            }
+
+            expect (allCorrect);
+            expectEquals (buffering.getBufferingStatistics().numUnderruns, 0);
+            buffering.releaseResources();
+        }
+
+        beginTest ("Underruns");
+        {
+            BufferingAudioSource buffering (new TestSource (50), thread, true, 32768, 2, false);
+            buffering.prepareToPlay (512, 44100.0);
+            buffering.getNextAudioBlock (info);
+
+            BufferingAudioSource::BufferingStatistics stats (buffering.getBufferingStatistics());
+            expectEquals (stats.numUnderruns, 1);
+            expect (stats.numSamplesMissed == 512);
+
+            buffering.resetBufferingStatistics();
+            expectEquals (buffering.getBufferingStatistics().numUnderruns, 0);
+            buffering.releaseResources();
+        }
+
+        beginTest ("Adaptive read-ahead");
+        {
+            BufferingAudioSource buffering (new TestSource (20), thread, true, 65536);
+            buffering.setAdaptiveBuffering (true, 2048);
+            buffering.prepareToPlay (512, 44100.0);
+
+            // play for about half a second in real time
+            for (int i = 0; i < 40; ++i)
+            {
+                buffering.getNextAudioBlock (info);
+                Thread::sleep (11);
+            }
+
+            const BufferingAudioSource::BufferingStatistics stats (buffering.getBufferingStatistics());
+
+            // slow reads need more than the minimum, but not the whole buffer
+            expect (stats.readAheadSamples > 2048);
+            expect (stats.readAheadSamples < 65536);
+            expect (stats.bufferSize >= stats.readAheadSamples);
+            expect (stats.consumptionRate > 10000.0);
+            expect (stats.averageReadTimeMs >= 15.0);
+            buffering.releaseResources();
+        }
+
+        beginTest ("Seeking to a prefetched position");
+        {
+            TestSource* const source = new TestSource (0);
+            BufferingAudioSource buffering (source, thread, true, 32768);
+            buffering.prepareToPlay (512, 44100.0);
+            buffering.getNextAudioBlock (info);
+
+            const int numReadBeforePrefetch = source->numSamplesRead.get();
+            buffering.prefetchPosition (500000);
+
+            for (int i = 0; i < 200 && source->numSamplesRead.get() < numReadBeforePrefetch + 4096; ++i)
+                Thread::sleep (5);
+
+            // the source is broken from now on, so the audio can only come from the prefetched section
+            source->isBroken = 1;
+            buffering.setNextReadPosition (500000);
+
+            expect (buffering.waitForNextAudioBlockReady (info, 2000));
+            buffering.getNextAudioBlock (info);
+            expect (isBlockCorrect (block, 500000));
+            buffering.releaseResources();
+        }
+    }
+};
+
+static BufferingAudioSourceTests bufferingAudioSourceTests;
+
+#endif
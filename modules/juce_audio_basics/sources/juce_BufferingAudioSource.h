@@ -31,6 +31,11 @@
     a background thread to smooth out playback. You can either create one of these
     directly, or use it indirectly using an AudioTransportSource.
 
+    By default it keeps a fixed number of samples buffered, but if many sources are
+    sharing the same background thread, you can call setAdaptiveBuffering() to let each
+    one size its buffer to suit how quickly it's being played and how long its reads
+    take, with the sources that are closest to running out being read first.
+
     @see PositionableAudioSource, AudioTransportSource
 */
 class JUCE_API  BufferingAudioSource  : public PositionableAudioSource,
@@ -95,11 +100,69 @@ public:
     */
     bool waitForNextAudioBlockReady (const AudioSourceChannelInfo& info, const uint32 timeout);
 
+    //==============================================================================
+    /** Enables or disables adaptive read-ahead.
+
+        When this is enabled, rather than always keeping numberOfSamplesToBuffer samples
+        buffered, the source measures how quickly its samples are being consumed, how long
+        reading from its input takes, and how long the background thread takes to get back
+        to it, and uses these to decide how much it needs to read ahead. The buffer grows
+        and shrinks to match, between minimumSamplesToBuffer and the numberOfSamplesToBuffer
+        that was given to the constructor.
+
+        It also asks the background thread to call it back when its buffer is about to run
+        low, rather than at a fixed rate, so that sources which are closer to running out
+        are read before ones that have plenty left.
+
+        This can be called at any time, and the change will be picked up by the background
+        thread.
+    */
+    void setAdaptiveBuffering (bool shouldAdapt, int minimumSamplesToBuffer = 8192);
+
+    /** Returns true if adaptive read-ahead has been enabled.
+        @see setAdaptiveBuffering
+    */
+    bool isAdaptiveBufferingEnabled() const noexcept        { return adaptiveBuffering; }
+
+    /** Starts reading ahead from a position that playback is expected to jump to.
+
+        If setNextReadPosition() is later called with a position that falls within the
+        audio that has been prefetched, playback can carry on from there without waiting
+        for the input to be read again. Only one position can be prefetched at a time, so
+        calling this again replaces any earlier one.
+    */
+    void prefetchPosition (int64 positionToPrefetch);
+
+    //==============================================================================
+    /** Information about how well the read-ahead is keeping up.
+        @see getBufferingStatistics
+    */
+    struct BufferingStatistics
+    {
+        int bufferSize;             /**< The size of the buffer, in samples. */
+        int readAheadSamples;       /**< The number of samples that the source is trying to keep buffered. */
+        int bufferedSamples;        /**< The number of samples that are currently buffered ahead of the playback position. */
+        double fillLevel;           /**< bufferedSamples as a proportion of readAheadSamples. */
+        int numUnderruns;           /**< The number of blocks that couldn't be completely filled from the buffer. */
+        int64 numSamplesMissed;     /**< The total number of samples that were missing from those blocks. */
+        double consumptionRate;     /**< The rate at which playback has been using samples, in samples per second. */
+        double averageReadTimeMs;   /**< The average time taken to read a chunk from the input source. */
+        double maxReadTimeMs;       /**< The longest time that a recent read from the input source has taken. */
+    };
+
+    /** Returns the current state of the read-ahead buffer, along with the underruns that
+        have happened since the source was prepared or resetBufferingStatistics() was called.
+    */
+    BufferingStatistics getBufferingStatistics() const;
+
+    /** Clears the underrun counts. */
+    void resetBufferingStatistics();
+
 private:
     //==============================================================================
     OptionalScopedPointer<PositionableAudioSource> source;
     TimeSliceThread& backgroundThread;
-    int numberOfSamplesToBuffer, numberOfChannels;
+    int numberOfSamplesToBuffer, numberOfChannels, preparedBufferSize;
     AudioSampleBuffer buffer;
     CriticalSection bufferStartPosLock;
     WaitableEvent bufferReadyEvent;
@@ -107,8 +170,29 @@ private:
     double volatile sampleRate;
     bool wasSourceLooping, isPrepared, prefillBuffer;
 
+    // adaptive read-ahead, which is only touched by the background thread apart from the settings
+    bool volatile adaptiveBuffering;
+    int volatile minimumSamplesToBuffer;
+    int targetSamplesToBuffer, blockSizeExpected, lastRequestedWait;
+    int64 lastPlayPos, totalLength;
+    double lastSliceTime, consumptionRate, peakConsumptionRate;
+    double averageReadTime, peakReadTime, peakSchedulingDelay;
+
+    // a section of the input that has been read in advance of a seek
+    AudioSampleBuffer prefetchBuffer;
+    int64 prefetchStart, prefetchValidEnd;
+    bool prefetchRequested;
+
+    BufferingStatistics statistics;
+
     bool readNextBufferChunk();
+    bool readNextPrefetchChunk();
+    bool adoptPrefetchedSection();
     void readBufferSection (int64 start, int length, int bufferOffset);
+    void readSection (AudioSampleBuffer&, int64 start, int length, int bufferOffset);
+    void updateReadAhead();
+    void resizeBuffer (int newSize);
+    int getTimeUntilNextRead (bool didRead) const;
     int useTimeSlice() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BufferingAudioSource)
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+ConvolutionAudioSource::ConvolutionAudioSource (AudioSource* const inputSource, const bool deleteInputWhenDeleted)
+   : input (inputSource, deleteInputWhenDeleted),
+     bypass (false)
+{
+    jassert (inputSource != nullptr);
+}
+
+ConvolutionAudioSource::~ConvolutionAudioSource() {}
+
+void ConvolutionAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    const ScopedLock sl (lock);
+    input->prepareToPlay (samplesPerBlockExpected, sampleRate);
+
+    if (convolution != nullptr)
+        convolution->reset();
+}
+
+void ConvolutionAudioSource::releaseResources()
+{
+    const ScopedLock sl (lock);
+    input->releaseResources();
+}
+
+void ConvolutionAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    const ScopedLock sl (lock);
+
+    input->getNextAudioBlock (bufferToFill);
+
+    if (! bypass && convolution != nullptr)
+    {
+        const int numChannels = jmin (bufferToFill.buffer->getNumChannels(), convolution->getNumChannels());
+
+        for (int i = 0; i < numChannels; ++i)
+            channels[i] = bufferToFill.buffer->getWritePointer (i, bufferToFill.startSample);
+
+        convolution->process (channels, channels, numChannels, bufferToFill.numSamples);
+    }
+}
+
+void ConvolutionAudioSource::setImpulseResponse (const AudioSampleBuffer& impulseResponse, int numChannelsToProcess)
+{
+    ScopedPointer<Convolution> newConvolution (new Convolution());
+    newConvolution->loadImpulseResponse (impulseResponse, numChannelsToProcess);
+    HeapBlock<float*> newChannels ((size_t) jmax (1, numChannelsToProcess));
+
+    {
+        const ScopedLock sl (lock);
+        convolution.swapWith (newConvolution);
+        channels.swapWith (newChannels);
+    }
+}
+
+void ConvolutionAudioSource::clearImpulseResponse()
+{
+    ScopedPointer<Convolution> oldConvolution;
+
+    {
+        const ScopedLock sl (lock);
+        convolution.swapWith (oldConvolution);
+    }
+}
+
+void ConvolutionAudioSource::setBypassed (bool b) noexcept
+{
+    if (bypass != b)
+    {
+        const ScopedLock sl (lock);
+        bypass = b;
+
+        if (convolution != nullptr)
+            convolution->reset();
+    }
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+
+//==============================================================================
+/**
+    An AudioSource that uses the Convolution class to apply an impulse response to
+    another AudioSource.
+
+    @see Convolution, ReverbAudioSource
+*/
+class JUCE_API  ConvolutionAudioSource   : public AudioSource
+{
+public:
+    /** Creates a ConvolutionAudioSource to process a given input source.
+
+        It won't change the input until you give it an impulse response with
+        setImpulseResponse().
+
+        @param inputSource              the input source to read from - this must not be null
+        @param deleteInputWhenDeleted   if true, the input source will be deleted when
+                                        this object is deleted
+    */
+    ConvolutionAudioSource (AudioSource* inputSource,
+                            bool deleteInputWhenDeleted);
+
+    /** Destructor. */
+    ~ConvolutionAudioSource();
+
+    //==============================================================================
+    /** Sets the impulse response that the input will be convolved with.
+
+        The response should be at the sample rate that the source will be played at, and
+        if it has fewer channels than numChannelsToProcess, they'll be re-used cyclically.
+
+        All the preparation is done on the calling thread before the new response is swapped
+        in, so this can safely be called while the source is playing.
+
+        @see Convolution::loadImpulseResponse
+    */
+    void setImpulseResponse (const AudioSampleBuffer& impulseResponse,
+                             int numChannelsToProcess = 2);
+
+    /** Removes the impulse response, so that the input passes through unchanged. */
+    void clearImpulseResponse();
+
+    void setBypassed (bool isBypassed) noexcept;
+    bool isBypassed() const noexcept                            { return bypass; }
+
+    //==============================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock (const AudioSourceChannelInfo&) override;
+
+private:
+    //==============================================================================
+    CriticalSection lock;
+    OptionalScopedPointer<AudioSource> input;
+    ScopedPointer<Convolution> convolution;
+    HeapBlock<float*> channels;
+    volatile bool bypass;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionAudioSource)
+};
@@ -0,0 +1,713 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace ParallelMixerHelpers
+{
+    // the audio thread's state, which another thread can only change while it's idle
+    enum
+    {
+        idle,
+        rendering,
+        adopting
+    };
+}
+
+struct ParallelMixerAudioSource::Input
+{
+    Input (AudioSource* s, bool shouldDelete) noexcept
+        : source (s), deleteWhenRemoved (shouldDelete), removedInGeneration (0)
+    {
+    }
+
+    void addTiming (int64 ticks) noexcept
+    {
+        ++numBlocks;
+        totalTicks += ticks;
+        lastTicks = ticks;
+
+        for (;;)
+        {
+            const int64 currentMax = maxTicks.get();
+
+            if (ticks <= currentMax || maxTicks.compareAndSetBool (ticks, currentMax))
+                break;
+        }
+    }
+
+    void resetTimings() noexcept
+    {
+        numBlocks = 0;
+        totalTicks = 0;
+        lastTicks = 0;
+        maxTicks = 0;
+    }
+
+    AudioSource* const source;
+    const bool deleteWhenRemoved;
+    int removedInGeneration;
+
+    Atomic<int> numBlocks;
+    Atomic<int64> totalTicks, lastTicks, maxTicks;
+
+    JUCE_DECLARE_NON_COPYABLE (Input)
+};
+
+struct ParallelMixerAudioSource::InputSnapshot
+{
+    explicit InputSnapshot (int g) noexcept  : generation (g) {}
+
+    Array<Input*> inputs;
+    const int generation;
+
+    JUCE_DECLARE_NON_COPYABLE (InputSnapshot)
+};
+
+/** Each thread renders the first input it picks up straight into its mix buffer, and
+    any others into a second buffer which is then added to it.
+*/
+struct ParallelMixerAudioSource::MixingJob  : public ParallelWorkerPool::Job
+{
+    MixingJob (ParallelMixerAudioSource& m, int channels, int samples) noexcept
+        : mixer (m), numChannels (channels), numSamples (samples)
+    {
+    }
+
+    void startWorker (int) override {}
+
+    void doItem (int item, int worker) override
+    {
+        Input& input = *mixer.activeInputs.getUnchecked (item);
+        AudioSampleBuffer& mix = *mixer.mixBuffers.getUnchecked (worker);
+        const bool isFirstInput = ! mixer.workerHasMixed[worker];
+        AudioSampleBuffer& dest = isFirstInput ? mix : *mixer.renderBuffers.getUnchecked (worker);
+
+        const int64 startTicks = Time::getHighResolutionTicks();
+        input.source->getNextAudioBlock (AudioSourceChannelInfo (&dest, 0, numSamples));
+        input.addTiming (Time::getHighResolutionTicks() - startTicks);
+
+        if (isFirstInput)
+        {
+            mixer.workerHasMixed[worker] = true;
+        }
+        else
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                FloatVectorOperations::add (mix.getWritePointer (channel), dest.getReadPointer (channel), numSamples);
+        }
+    }
+
+    ParallelMixerAudioSource& mixer;
+    const int numChannels, numSamples;
+
+    JUCE_DECLARE_NON_COPYABLE (MixingJob)
+};
+
+/** Releases the inputs that were removed while the mixer was rendering, once the audio
+    thread has moved on from them. All the mixers share the same background thread.
+*/
+struct ParallelMixerAudioSource::RetiredInputCollector  : private TimeSliceClient
+{
+    RetiredInputCollector (ParallelMixerAudioSource& m) : mixer (m)  {}
+    ~RetiredInputCollector()                                        { thread->removeTimeSliceClient (this); }
+
+    void schedule()                                                 { thread->addTimeSliceClient (this, pollInterval); }
+
+    int useTimeSlice() override
+    {
+        // The thread that deletes this may be waiting for this call to finish, so it
+        // mustn't block here.
+        const ScopedTryLock sl (mixer.lock);
+
+        if (! sl.isLocked())
+            return 1;
+
+        return mixer.releaseFinishedInputs() ? pollInterval : idleInterval;
+    }
+
+    struct SharedThread  : public TimeSliceThread
+    {
+        SharedThread() : TimeSliceThread ("Audio mixer cleanup")    { startThread (3); }
+    };
+
+    enum { pollInterval = 20, idleInterval = 1000 };
+
+    ParallelMixerAudioSource& mixer;
+    SharedResourcePointer<SharedThread> thread;
+
+    JUCE_DECLARE_NON_COPYABLE (RetiredInputCollector)
+};
+
+//==============================================================================
+ParallelMixerAudioSource::ParallelMixerAudioSource (int numWorkerThreads, int maximumNumChannels)
+    : maxNumChannels (jmax (1, maximumNumChannels)),
+      preparedBlockSize (0),
+      lastPublishedGeneration (0),
+      currentSampleRate (0.0),
+      bufferSizeExpected (0),
+      workers ("Mixer input renderer", jmax (0, numWorkerThreads)),
+      pendingSnapshot (nullptr)
+{
+    const int numThreads = workers.getNumWorkerThreads() + 1;
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        mixBuffers.add (new AudioSampleBuffer (maxNumChannels, 0));
+        renderBuffers.add (new AudioSampleBuffer (maxNumChannels, 0));
+    }
+
+    workerHasMixed.calloc ((size_t) numThreads);
+}
+
+ParallelMixerAudioSource::~ParallelMixerAudioSource()
+{
+    retiredInputCollector = nullptr;
+
+    // nothing can be rendering now, so the inputs can all be released straight away
+    renderState = ParallelMixerHelpers::idle;
+    removeAllInputs();
+}
+
+int ParallelMixerAudioSource::getNumWorkerThreads() const noexcept
+{
+    return workers.getNumWorkerThreads();
+}
+
+//==============================================================================
+void ParallelMixerAudioSource::addInputSource (AudioSource* input, const bool deleteWhenRemoved)
+{
+    if (input == nullptr)
+        return;
+
+    // The audio thread never takes this lock, so unlike MixerAudioSource, the input can be
+    // prepared while holding it. That way, it can't be released by the background thread
+    // in between, if it's still on the retire list from an earlier removal.
+    const ScopedLock sl (lock);
+
+    for (int i = inputList.size(); --i >= 0;)
+        if (inputList.getUnchecked (i)->source == input)
+            return;
+
+    if (currentSampleRate > 0.0)
+        input->prepareToPlay (bufferSizeExpected, currentSampleRate);
+
+    inputList.add (new Input (input, deleteWhenRemoved));
+    publishChanges();
+    retireRemovedInputs();
+}
+
+void ParallelMixerAudioSource::removeInputSource (AudioSource* const input)
+{
+    if (input == nullptr)
+        return;
+
+    const ScopedLock sl (lock);
+
+    for (int i = inputList.size(); --i >= 0;)
+    {
+        if (inputList.getUnchecked (i)->source == input)
+        {
+            Input* const removed = inputList.removeAndReturn (i);
+            removed->removedInGeneration = lastPublishedGeneration + 1;
+            removedInputs.add (removed);
+
+            publishChanges();
+            retireRemovedInputs();
+            return;
+        }
+    }
+}
+
+void ParallelMixerAudioSource::removeAllInputs()
+{
+    const ScopedLock sl (lock);
+
+    while (inputList.size() > 0)
+    {
+        Input* const removed = inputList.removeAndReturn (inputList.size() - 1);
+        removed->removedInGeneration = lastPublishedGeneration + 1;
+        removedInputs.add (removed);
+    }
+
+    publishChanges();
+    retireRemovedInputs();
+}
+
+//==============================================================================
+Array<ParallelMixerAudioSource::InputTimings> ParallelMixerAudioSource::getInputTimings() const
+{
+    Array<InputTimings> timings;
+
+    const ScopedLock sl (lock);
+
+    for (int i = 0; i < inputList.size(); ++i)
+    {
+        const Input& input = *inputList.getUnchecked (i);
+        const int numBlocks = input.numBlocks.get();
+
+        InputTimings t;
+        t.source = input.source;
+        t.numBlocks = numBlocks;
+        t.lastMs    = Time::highResolutionTicksToSeconds (input.lastTicks.get()) * 1000.0;
+        t.maxMs     = Time::highResolutionTicksToSeconds (input.maxTicks.get()) * 1000.0;
+        t.averageMs = numBlocks > 0 ? Time::highResolutionTicksToSeconds (input.totalTicks.get()) * 1000.0 / numBlocks
+                                    : 0.0;
+        timings.add (t);
+    }
+
+    return timings;
+}
+
+void ParallelMixerAudioSource::resetInputTimings()
+{
+    const ScopedLock sl (lock);
+
+    for (int i = inputList.size(); --i >= 0;)
+        inputList.getUnchecked (i)->resetTimings();
+}
+
+//==============================================================================
+void ParallelMixerAudioSource::publishChanges()
+{
+    // the caller must hold the lock
+    InputSnapshot* const snapshot = publishedSnapshots.add (new InputSnapshot (++lastPublishedGeneration));
+    snapshot->inputs.ensureStorageAllocated (inputList.size());
+
+    for (int i = 0; i < inputList.size(); ++i)
+        snapshot->inputs.add (inputList.getUnchecked (i));
+
+    // if the audio thread never saw the previous one, it can just be thrown away
+    if (InputSnapshot* const superseded = pendingSnapshot.exchange (snapshot))
+        publishedSnapshots.removeObject (superseded);
+}
+
+void ParallelMixerAudioSource::adoptPendingChanges() noexcept
+{
+    if (InputSnapshot* const snapshot = pendingSnapshot.exchange (nullptr))
+    {
+        // the old list goes back in the snapshot, to be freed by whichever thread deletes it
+        activeInputs.swapWith (snapshot->inputs);
+        adoptedGeneration = snapshot->generation;
+    }
+}
+
+void ParallelMixerAudioSource::adoptChangesIfIdle() noexcept
+{
+    using namespace ParallelMixerHelpers;
+
+    // if the audio thread isn't running, the changes can be taken on here instead
+    if (renderState.compareAndSetBool (adopting, idle))
+    {
+        adoptPendingChanges();
+        renderState = idle;
+    }
+}
+
+void ParallelMixerAudioSource::retireRemovedInputs()
+{
+    // the caller must hold the lock
+    adoptChangesIfIdle();
+
+    // anything that the audio thread might still be using gets released in the background later
+    if (releaseFinishedInputs())
+    {
+        if (retiredInputCollector == nullptr)
+            retiredInputCollector = new RetiredInputCollector (*this);
+
+        retiredInputCollector->schedule();
+    }
+}
+
+bool ParallelMixerAudioSource::releaseFinishedInputs()
+{
+    // the caller must hold the lock
+    const int adopted = adoptedGeneration.get();
+
+    for (int i = publishedSnapshots.size(); --i >= 0;)
+        if (publishedSnapshots.getUnchecked (i)->generation <= adopted)
+            publishedSnapshots.remove (i);
+
+    for (int i = 0; i < removedInputs.size();)
+    {
+        Input* const input = removedInputs.getUnchecked (i);
+
+        if (input->removedInGeneration > adopted)
+        {
+            ++i;
+            continue;
+        }
+
+        removedInputs.remove (i, false);
+
+        // if the source has been added again since, it's now looked after by its newer entry
+        if (! isSourceStillListed (input->source))
+        {
+            input->source->releaseResources();
+
+            if (input->deleteWhenRemoved)
+                delete input->source;
+        }
+
+        delete input;
+    }
+
+    return removedInputs.size() > 0 || publishedSnapshots.size() > 0;
+}
+
+bool ParallelMixerAudioSource::isSourceStillListed (AudioSource* source) const noexcept
+{
+    for (int i = inputList.size(); --i >= 0;)
+        if (inputList.getUnchecked (i)->source == source)
+            return true;
+
+    for (int i = removedInputs.size(); --i >= 0;)
+        if (removedInputs.getUnchecked (i)->source == source)
+            return true;
+
+    return false;
+}
+
+void ParallelMixerAudioSource::prepareBuffers (const int numChannels, const int numSamples)
+{
+    for (int i = 0; i < mixBuffers.size(); ++i)
+    {
+        mixBuffers.getUnchecked (i)->setSize (numChannels, numSamples);
+        renderBuffers.getUnchecked (i)->setSize (numChannels, numSamples);
+    }
+
+    preparedBlockSize = numSamples;
+}
+
+//==============================================================================
+void ParallelMixerAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    const ScopedLock sl (lock);
+
+    prepareBuffers (maxNumChannels, samplesPerBlockExpected);
+
+    currentSampleRate = sampleRate;
+    bufferSizeExpected = samplesPerBlockExpected;
+
+    for (int i = inputList.size(); --i >= 0;)
+        inputList.getUnchecked (i)->source->prepareToPlay (samplesPerBlockExpected, sampleRate);
+}
+
+void ParallelMixerAudioSource::releaseResources()
+{
+    const ScopedLock sl (lock);
+
+    for (int i = inputList.size(); --i >= 0;)
+        inputList.getUnchecked (i)->source->releaseResources();
+
+    // the audio thread has stopped, so anything that's still on the retire list can go now
+    renderState = ParallelMixerHelpers::idle;
+    adoptPendingChanges();
+    releaseFinishedInputs();
+
+    prepareBuffers (maxNumChannels, 0);
+
+    currentSampleRate = 0;
+    bufferSizeExpected = 0;
+}
+
+void ParallelMixerAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
+{
+    using namespace ParallelMixerHelpers;
+
+    // This only has to wait if another thread is taking on changes itself because the
+    // mixer was idle, which takes no longer than swapping a couple of pointers.
+    if (renderState.get() != rendering)
+        while (! renderState.compareAndSetBool (rendering, idle))
+            Thread::yield();
+
+    adoptPendingChanges();
+
+    const int numInputs = activeInputs.size();
+
+    if (numInputs == 0)
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    if (numInputs == 1)
+    {
+        Input& input = *activeInputs.getUnchecked (0);
+
+        const int64 startTicks = Time::getHighResolutionTicks();
+        input.source->getNextAudioBlock (info);
+        input.addTiming (Time::getHighResolutionTicks() - startTicks);
+        return;
+    }
+
+    AudioSampleBuffer& output = *info.buffer;
+    const int numChannels = jmin (output.getNumChannels(), maxNumChannels);
+
+    // If this fails, the mixer is being asked for more channels than it was created with,
+    // and the extra ones will be silent.
+    jassert (output.getNumChannels() <= maxNumChannels);
+
+    // If this fails, the mixer hasn't been prepared, so it has no buffers to mix into.
+    jassert (preparedBlockSize > 0);
+
+    if (numChannels <= 0 || preparedBlockSize <= 0)
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    // a block that's longer than the buffers is mixed in pieces, rather than resizing them here
+    for (int pos = 0; pos < info.numSamples;)
+    {
+        const int numThisTime = jmin (info.numSamples - pos, preparedBlockSize);
+        mixBlock (output, info.startSample + pos, numChannels, numThisTime);
+        pos += numThisTime;
+    }
+
+    for (int channel = numChannels; channel < output.getNumChannels(); ++channel)
+        output.clear (channel, info.startSample, info.numSamples);
+}
+
+void ParallelMixerAudioSource::mixBlock (AudioSampleBuffer& output, const int startSample,
+                                         const int numChannels, const int numSamples)
+{
+    // prepareToPlay() made room for the maximum number of channels, so this never allocates
+    for (int i = 0; i < mixBuffers.size(); ++i)
+    {
+        AudioSampleBuffer* const buffers[] = { mixBuffers.getUnchecked (i), renderBuffers.getUnchecked (i) };
+
+        for (int j = 0; j < numElementsInArray (buffers); ++j)
+            if (buffers[j]->getNumChannels() != numChannels)
+                buffers[j]->setSize (numChannels, preparedBlockSize, false, false, true);
+    }
+
+    zeromem (workerHasMixed, sizeof (bool) * (size_t) mixBuffers.size());
+
+    MixingJob job (*this, numChannels, numSamples);
+    workers.run (job, activeInputs.size());
+
+    bool isFirstBuffer = true;
+
+    for (int worker = 0; worker < mixBuffers.size(); ++worker)
+    {
+        if (workerHasMixed[worker])
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                if (isFirstBuffer)
+                    output.copyFrom (channel, startSample, *mixBuffers.getUnchecked (worker), channel, 0, numSamples);
+                else
+                    output.addFrom (channel, startSample, *mixBuffers.getUnchecked (worker), channel, 0, numSamples);
+            }
+
+            isFirstBuffer = false;
+        }
+    }
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ParallelMixerAudioSourceTests  : public UnitTest
+{
+public:
+    ParallelMixerAudioSourceTests() : UnitTest ("ParallelMixerAudioSource") {}
+
+    // Writes a ramp that's different for each source and channel, so that any inputs that
+    // are missed or mixed twice will show up in the sum
+    struct TestSource  : public AudioSource
+    {
+        TestSource (int i) noexcept  : index (i), position (0) {}
+
+        void prepareToPlay (int, double) override       { isReleased = 0; }
+        void releaseResources() override                { isReleased = 1; }
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            if (isReleased.get() != 0)
+                ++numCallsAfterRelease;
+
+            for (int channel = 0; channel < info.buffer->getNumChannels(); ++channel)
+            {
+                float* const dest = info.buffer->getWritePointer (channel, info.startSample);
+
+                for (int i = 0; i < info.numSamples; ++i)
+                    dest[i] = (float) (((position + i) * (index + 1) + channel * 17) % 101) * 0.001f;
+            }
+
+            position += info.numSamples;
+        }
+
+        const int index;
+        int position;
+        Atomic<int> isReleased, numCallsAfterRelease;
+    };
+
+    struct RenderThread  : public Thread
+    {
+        RenderThread (AudioSource& s)  : Thread ("Mixer test"), source (s), buffer (3, 256), numBlocks (0) {}
+
+        void run() override
+        {
+            // like an audio device, this leaves some time between blocks for the other threads
+            while (! threadShouldExit())
+            {
+                source.getNextAudioBlock (AudioSourceChannelInfo (&buffer, 0, buffer.getNumSamples()));
+                ++numBlocks;
+                wait (1);
+            }
+        }
+
+        AudioSource& source;
+        AudioSampleBuffer buffer;
+        Atomic<int> numBlocks;
+    };
+
+    void runTest() override
+    {
+        beginTest ("Matches MixerAudioSource");
+        {
+            const int numInputs = 37, numChannels = 5, blockSize = 300;
+
+            for (int numThreads = 0; numThreads <= 3; ++numThreads)
+            {
+                MixerAudioSource expectedMixer;
+                ParallelMixerAudioSource mixer (numThreads, numChannels);
+
+                for (int i = 0; i < numInputs; ++i)
+                {
+                    expectedMixer.addInputSource (new TestSource (i), true);
+                    mixer.addInputSource (new TestSource (i), true);
+                }
+
+                // the parallel mixer is told to expect shorter blocks, so it has to split them up
+                expectedMixer.prepareToPlay (blockSize, 44100.0);
+                mixer.prepareToPlay (blockSize / 3 + 7, 44100.0);
+
+                AudioSampleBuffer expected (numChannels, blockSize + 10), output (numChannels, blockSize + 10);
+                float maxError = 0;
+
+                for (int block = 0; block < 20; ++block)
+                {
+                    expected.clear();
+                    output.clear();
+
+                    expectedMixer.getNextAudioBlock (AudioSourceChannelInfo (&expected, 10, blockSize));
+
+                    {
+                       #if JUCE_ENABLE_ALLOCATION_HOOKS
+                        const ScopedAllocationCounter counter;
+                       #endif
+
+                        mixer.getNextAudioBlock (AudioSourceChannelInfo (&output, 10, blockSize));
+
+                       #if JUCE_ENABLE_ALLOCATION_HOOKS
+                        expectEquals (counter.getNumCalls(), 0);
+                       #endif
+                    }
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        for (int i = 0; i < output.getNumSamples(); ++i)
+                            maxError = jmax (maxError, std::abs (output.getSample (channel, i) - expected.getSample (channel, i)));
+                }
+
+                expect (maxError < 1.0e-4f, "error = " + String (maxError));
+
+                const Array<ParallelMixerAudioSource::InputTimings> timings (mixer.getInputTimings());
+                expectEquals (timings.size(), numInputs);
+
+                for (int i = 0; i < timings.size(); ++i)
+                {
+                    expect (timings.getReference (i).numBlocks >= 20);
+                    expect (timings.getReference (i).maxMs >= timings.getReference (i).averageMs);
+                }
+
+                mixer.resetInputTimings();
+                expectEquals (mixer.getInputTimings().getReference (0).numBlocks, 0);
+
+                mixer.releaseResources();
+                expectedMixer.releaseResources();
+            }
+        }
+
+        beginTest ("Adding and removing inputs while rendering");
+        {
+            ParallelMixerAudioSource mixer (2, 3);
+            OwnedArray<TestSource> sources;
+            SortedSet<TestSource*> sourcesUsed;
+
+            for (int i = 0; i < 64; ++i)
+                sources.add (new TestSource (i));
+
+            mixer.prepareToPlay (256, 44100.0);
+
+            RenderThread renderThread (mixer);
+            renderThread.startThread();
+
+            Random r = getRandom();
+
+            for (int i = 0; i < 500; ++i)
+            {
+                TestSource* const source = sources.getUnchecked (r.nextInt (sources.size()));
+
+                if (r.nextBool())
+                {
+                    mixer.addInputSource (source, false);
+                    sourcesUsed.add (source);
+                }
+                else
+                {
+                    mixer.removeInputSource (source);
+                }
+            }
+
+            mixer.removeAllInputs();
+
+            // the removed inputs are released in the background while the mixer carries on rendering
+            for (int i = 0; i < sourcesUsed.size(); ++i)
+                for (int timeout = 5000; sourcesUsed.getUnchecked (i)->isReleased.get() == 0 && --timeout > 0;)
+                    Thread::sleep (1);
+
+            for (int i = 0; i < sourcesUsed.size(); ++i)
+                expect (sourcesUsed.getUnchecked (i)->isReleased.get() != 0);
+
+            const int numBlocks = renderThread.numBlocks.get();
+
+            while (renderThread.numBlocks.get() < numBlocks + 10)
+                Thread::sleep (1);
+
+            renderThread.stopThread (5000);
+            mixer.releaseResources();
+
+            for (int i = 0; i < sources.size(); ++i)
+                expectEquals (sources.getUnchecked (i)->numCallsAfterRelease.get(), 0);
+
+            expect (renderThread.numBlocks.get() > 0);
+            expect (mixer.getInputTimings().isEmpty());
+        }
+    }
+};
+
+static ParallelMixerAudioSourceTests parallelMixerAudioSourceTests;
+
+#endif
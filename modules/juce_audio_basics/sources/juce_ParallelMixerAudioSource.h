@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+
+//==============================================================================
+/**
+    An AudioSource that mixes together the output of a set of other AudioSources,
+    pulling them on a pool of worker threads.
+
+    This does the same job as MixerAudioSource, but is designed for mixing large numbers
+    of inputs which each take a significant amount of time to render, e.g. a hundred or
+    more AudioTransportSources.
+
+    The inputs are shared out between the audio thread and the worker threads, so they
+    mustn't share any state that they modify while rendering, and no guarantees are made
+    about which thread calls each input's getNextAudioBlock() method. Each thread renders
+    into its own buffers, which are summed at the end of the block, so any number of
+    channels can be mixed, up to the maximum given to the constructor. The buffers are
+    allocated by prepareToPlay(), and a block that's longer than it asked for is mixed in
+    several pieces, so the audio thread never allocates.
+
+    Inputs can be added and removed while the mixer is running, without blocking the
+    audio thread or the thread making the change. The changes are published to it, and
+    take effect at the start of its next block.
+
+    It can also keep track of how long each input is taking to render, so that slow
+    sources can be spotted.
+
+    @see MixerAudioSource, ParallelWorkerPool
+*/
+class JUCE_API  ParallelMixerAudioSource  : public AudioSource
+{
+public:
+    //==============================================================================
+    /** Creates a ParallelMixerAudioSource.
+
+        The audio thread joins in with the worker threads when pulling the inputs, so
+        the number of worker threads should usually be one less than the number of
+        cores that you want to use. If it's 0, all the inputs are pulled on the audio
+        thread.
+
+        The maximum number of channels is the most that the audio thread can ask the mixer
+        for. Any channels beyond that are left silent.
+    */
+    ParallelMixerAudioSource (int numWorkerThreads, int maximumNumChannels = 2);
+
+    /** Destructor. */
+    ~ParallelMixerAudioSource();
+
+    //==============================================================================
+    /** Adds an input source to the mixer.
+
+        If the mixer is running you'll need to make sure that the input source
+        is ready to play by calling its prepareToPlay() method before adding it.
+        If the mixer is stopped, then its input sources will be automatically
+        prepared when the mixer's prepareToPlay() method is called.
+
+        This can be called on any thread apart from the audio thread.
+
+        @param newInput             the source to add to the mixer
+        @param deleteWhenRemoved    if true, then this source will be deleted when
+                                    no longer needed by the mixer.
+    */
+    void addInputSource (AudioSource* newInput, bool deleteWhenRemoved);
+
+    /** Removes an input source.
+
+        This doesn't wait for the audio thread. If the mixer is in the middle of rendering,
+        the input may still be used for the rest of the current block, so it's put on a
+        retire list, and a background thread calls its releaseResources() method once the
+        audio thread has moved on to the next block. If the source was added by calling
+        addInputSource() with the deleteWhenRemoved flag set, it's deleted at that point.
+
+        So if you still own the source, you mustn't delete it straight after removing it
+        while the mixer is running. Hand it over with the deleteWhenRemoved flag instead,
+        or stop the mixer with releaseResources() first, in which case the input is
+        released straight away.
+    */
+    void removeInputSource (AudioSource* input);
+
+    /** Removes all the input sources.
+        As with removeInputSource(), the inputs are released, and deleted if they were
+        added with the deleteWhenRemoved flag, once the audio thread has stopped using them.
+    */
+    void removeAllInputs();
+
+    /** Returns the number of worker threads that the mixer is using. */
+    int getNumWorkerThreads() const noexcept;
+
+    //==============================================================================
+    /** The time that an input has been taking to render its blocks.
+        @see getInputTimings
+    */
+    struct InputTimings
+    {
+        AudioSource* source;    /**< The input source that these timings are for. */
+        int numBlocks;          /**< The number of blocks that have been timed. */
+        double lastMs;          /**< The time that the input took to render its most recent block. */
+        double averageMs;       /**< The average time that the input took to render a block. */
+        double maxMs;           /**< The longest time that the input took to render a block. */
+    };
+
+    /** Returns the timings of all the current inputs, since they were added or since
+        the last call to resetInputTimings().
+        @see resetInputTimings
+    */
+    Array<InputTimings> getInputTimings() const;
+
+    /** Clears the timings that have been gathered for all the inputs. */
+    void resetInputTimings();
+
+    //==============================================================================
+    /** Implementation of the AudioSource method.
+        This will call prepareToPlay() on all its input sources.
+    */
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+
+    /** Implementation of the AudioSource method.
+        This will call releaseResources() on all its input sources, and on any removed
+        inputs that are still waiting to be released.
+    */
+    void releaseResources() override;
+
+    /** Implementation of the AudioSource method. */
+    void getNextAudioBlock (const AudioSourceChannelInfo&) override;
+
+private:
+    //==============================================================================
+    struct Input;
+    struct InputSnapshot;
+    struct MixingJob;
+    struct RetiredInputCollector;
+
+    // state used by the audio thread
+    Array<Input*> activeInputs;
+    OwnedArray<AudioSampleBuffer> mixBuffers, renderBuffers;
+    HeapBlock<bool> workerHasMixed;
+    const int maxNumChannels;
+    int preparedBlockSize;
+
+    // the inputs as other threads see them, which are published to the audio thread
+    CriticalSection lock;
+    OwnedArray<Input> inputList, removedInputs;
+    OwnedArray<InputSnapshot> publishedSnapshots;
+    int lastPublishedGeneration;
+    double currentSampleRate;
+    int bufferSizeExpected;
+
+    ParallelWorkerPool workers;
+    ScopedPointer<RetiredInputCollector> retiredInputCollector;
+    Atomic<InputSnapshot*> pendingSnapshot;
+    Atomic<int> adoptedGeneration, renderState;
+
+    void publishChanges();
+    void adoptPendingChanges() noexcept;
+    void adoptChangesIfIdle() noexcept;
+    void retireRemovedInputs();
+    bool releaseFinishedInputs();
+    bool isSourceStillListed (AudioSource*) const noexcept;
+    void prepareBuffers (int numChannels, int numSamples);
+    void mixBlock (AudioSampleBuffer& output, int startSample, int numChannels, int numSamples);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelMixerAudioSource)
+};
@@ -26,6 +26,8 @@ ResamplingAudioSource::ResamplingAudioSource (AudioSource* const inputSource,
     : input (inputSource, deleteInputWhenDeleted),
       ratio (1.0),
       lastRatio (1.0),
+      quality (linearInterpolation),
+      lastQuality (linearInterpolation),
       bufferPos (0),
       sampsInBuffer (0),
       subSampleOffset (0),
@@ -45,6 +47,12 @@ void ResamplingAudioSource::setResamplingRatio (const double samplesInPerOutputS
     ratio = jmax (0.0, samplesInPerOutputSample);
 }
 
+void ResamplingAudioSource::setQuality (const Quality newQuality)
+{
+    const SpinLock::ScopedLockType sl (ratioLock);
+    quality = newQuality;
+}
+
 void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
 {
     const SpinLock::ScopedLockType sl (ratioLock);
@@ -59,6 +67,14 @@ void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double s
     destBuffers.calloc ((size_t) numChannels);
     createLowPass (ratio);
 
+    lastQuality = quality;
+
+    if (quality != linearInterpolation)
+        polyphaseResampler.setQuality ((PolyphaseResampler::Quality) (quality - polyphaseLowQuality));
+
+    polyphaseResampler.setRatio (ratio);
+    polyphaseResampler.prepare (numChannels);
+
     flushBuffers();
 }
 
@@ -69,6 +85,7 @@ void ResamplingAudioSource::flushBuffers()
     sampsInBuffer = 0;
     subSampleOffset = 0.0;
     resetFilters();
+    polyphaseResampler.reset();
 }
 
 void ResamplingAudioSource::releaseResources()
@@ -80,10 +97,27 @@ void ResamplingAudioSource::releaseResources()
 void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
 {
     double localRatio;
+    Quality localQuality;
 
     {
         const SpinLock::ScopedLockType sl (ratioLock);
         localRatio = ratio;
+        localQuality = quality;
+    }
+
+    if (lastQuality != localQuality)
+    {
+        if (localQuality != linearInterpolation)
+            polyphaseResampler.setQuality ((PolyphaseResampler::Quality) (localQuality - polyphaseLowQuality));
+
+        lastQuality = localQuality;
+        flushBuffers();
+    }
+
+    if (localQuality != linearInterpolation)
+    {
+        getNextPolyphaseBlock (info, localRatio);
+        return;
     }
 
     if (lastRatio != localRatio)
@@ -193,6 +227,31 @@ void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& inf
     jassert (sampsInBuffer >= 0);
 }
 
+void ResamplingAudioSource::getNextPolyphaseBlock (const AudioSourceChannelInfo& info, const double localRatio)
+{
+    polyphaseResampler.setRatio (localRatio);
+
+    const int sampsNeeded = polyphaseResampler.getNumInputSamplesNeeded (info.numSamples);
+    const int channelsToProcess = jmin (numChannels, info.buffer->getNumChannels());
+
+    if (buffer.getNumSamples() < sampsNeeded)
+        buffer.setSize (numChannels, sampsNeeded + 32, false, false, true);
+
+    if (sampsNeeded > 0)
+    {
+        AudioSourceChannelInfo readInfo (&buffer, 0, sampsNeeded);
+        input->getNextAudioBlock (readInfo);
+    }
+
+    for (int channel = 0; channel < channelsToProcess; ++channel)
+    {
+        destBuffers[channel] = info.buffer->getWritePointer (channel, info.startSample);
+        srcBuffers[channel] = buffer.getReadPointer (channel);
+    }
+
+    polyphaseResampler.process (srcBuffers, destBuffers, channelsToProcess, info.numSamples);
+}
+
 void ResamplingAudioSource::createLowPass (const double frequencyRatio)
 {
     const double proportionalRate = (frequencyRatio > 1.0) ? 0.5 / frequencyRatio
@@ -27,7 +27,10 @@
 /**
     A type of AudioSource that takes an input source and changes its sample rate.
 
-    @see AudioSource, LagrangeInterpolator, CatmullRomInterpolator
+    By default this uses linear interpolation, which has no latency but lets some
+    aliasing through. Use setQuality() to switch to a PolyphaseResampler instead.
+
+    @see AudioSource, PolyphaseResampler, LagrangeInterpolator, CatmullRomInterpolator
 */
 class JUCE_API  ResamplingAudioSource  : public AudioSource
 {
@@ -63,6 +66,28 @@ public:
     */
     double getResamplingRatio() const noexcept                  { return ratio; }
 
+    /** The algorithms that the source can use to resample. */
+    enum Quality
+    {
+        linearInterpolation,        /**< Linear interpolation with a simple anti-aliasing filter. This is the default. */
+        polyphaseLowQuality,        /**< A PolyphaseResampler using PolyphaseResampler::lowQuality. */
+        polyphaseMediumQuality,     /**< A PolyphaseResampler using PolyphaseResampler::mediumQuality. */
+        polyphaseHighQuality,       /**< A PolyphaseResampler using PolyphaseResampler::highQuality. */
+        polyphaseBestQuality        /**< A PolyphaseResampler using PolyphaseResampler::bestQuality. */
+    };
+
+    /** Chooses the resampling algorithm.
+
+        The polyphase qualities don't alias, but delay the output by the filter's latency.
+        This can be called while the source is running, but the change will flush the
+        resampler's buffers, and the next audio callback will need to calculate a new
+        filter table.
+    */
+    void setQuality (Quality newQuality);
+
+    /** Returns the algorithm that was chosen with setQuality(). */
+    Quality getQuality() const noexcept                         { return quality; }
+
     /** Clears any buffers and filters that the resampler is using. */
     void flushBuffers();
 
@@ -75,6 +100,8 @@ private:
     //==============================================================================
     OptionalScopedPointer<AudioSource> input;
     double ratio, lastRatio;
+    Quality quality, lastQuality;
+    PolyphaseResampler polyphaseResampler;
     AudioSampleBuffer buffer;
     int bufferPos, sampsInBuffer;
     double subSampleOffset;
@@ -84,6 +111,7 @@ private:
     HeapBlock<float*> destBuffers;
     HeapBlock<const float*> srcBuffers;
 
+    void getNextPolyphaseBlock (const AudioSourceChannelInfo&, double localRatio);
     void setFilterCoefficients (double c1, double c2, double c3, double c4, double c5, double c6);
     void createLowPass (double proportionalRate);
 
@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+ParallelVoiceRenderer::ParallelVoiceRenderer (int numWorkerThreads)
+    : pool ("Voice renderer", jmax (0, numWorkerThreads))
+{
+    // the calling thread is worker 0, so it needs a scratch buffer too
+    for (int i = 0; i <= pool.getNumWorkerThreads(); ++i)
+    {
+        floatScratch.add (new AudioBuffer<float> (2, 512));
+        doubleScratch.add (new AudioBuffer<double> (2, 512));
+    }
+
+    workerWasUsed.calloc ((size_t) pool.getNumWorkerThreads() + 1);
+}
+
+ParallelVoiceRenderer::~ParallelVoiceRenderer()
+{
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ParallelVoiceRendererTests  : public UnitTest
+{
+public:
+    ParallelVoiceRendererTests() : UnitTest ("ParallelVoiceRenderer") {}
+
+    struct TestSound  : public SynthesiserSound
+    {
+        bool appliesToNote (int) override       { return true; }
+        bool appliesToChannel (int) override    { return true; }
+    };
+
+    // Writes a ramp that depends on the note, so that any missing or doubled voices show up in the sum
+    struct TestVoice  : public SynthesiserVoice
+    {
+        bool canPlaySound (SynthesiserSound*) override  { return true; }
+
+        void startNote (int note, float, SynthesiserSound*, int) override
+        {
+            level = (float) note / 128.0f;
+            samplesLeft = 300 + note * 7;
+        }
+
+        void stopNote (float, bool) override            { clearCurrentNote(); }
+        void pitchWheelMoved (int) override             {}
+        void controllerMoved (int, int) override        {}
+
+        void renderNextBlock (AudioBuffer<float>& buffer, int startSample, int numSamples) override
+        {
+            if (! isVoiceActive())
+                return;
+
+            const int num = jmin (numSamples, samplesLeft);
+
+            for (int i = 0; i < num; ++i)
+            {
+                level += 0.001f;
+
+                for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                    buffer.addSample (channel, startSample + i, level * (float) (channel + 1));
+            }
+
+            samplesLeft -= num;
+
+            if (samplesLeft <= 0)
+                clearCurrentNote();
+        }
+
+        float level = 0;
+        int samplesLeft = 0;
+    };
+
+    void runTest() override
+    {
+        beginTest ("Matches single-threaded rendering");
+
+        Random r = getRandom();
+        MidiBuffer midi;
+
+        for (int i = 0; i < 200; ++i)
+        {
+            const int note = r.nextInt (128);
+            const int time = r.nextInt (4000);
+            midi.addEvent (MidiMessage::noteOn (1, note, 0.8f), time);
+            midi.addEvent (MidiMessage::noteOff (1, note), time + r.nextInt (2000));
+        }
+
+        AudioBuffer<float> expected (2, 8192), output (2, 8192);
+        render (expected, midi, 0);
+
+        for (int numThreads = 1; numThreads <= 3; ++numThreads)
+        {
+            render (output, midi, numThreads);
+
+            float maxError = 0;
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < output.getNumSamples(); ++i)
+                    maxError = jmax (maxError, std::abs (output.getSample (channel, i) - expected.getSample (channel, i)));
+
+            expect (maxError < 1.0e-3f, "error = " + String (maxError));
+        }
+    }
+
+    static void render (AudioBuffer<float>& buffer, const MidiBuffer& midi, int numThreads)
+    {
+        Synthesiser synth;
+        synth.addSound (new TestSound());
+
+        for (int i = 0; i < 64; ++i)
+            synth.addVoice (new TestVoice());
+
+        synth.setCurrentPlaybackSampleRate (44100.0);
+        synth.setNumVoiceRenderingThreads (numThreads);
+        buffer.clear();
+
+        for (int pos = 0; pos < buffer.getNumSamples(); pos += 512)
+        {
+            MidiBuffer blockMidi;
+            blockMidi.addEvents (midi, pos, 512, 0);
+            synth.renderNextBlock (buffer, blockMidi, pos, 512);
+        }
+    }
+};
+
+static ParallelVoiceRendererTests parallelVoiceRendererTests;
+
+#endif
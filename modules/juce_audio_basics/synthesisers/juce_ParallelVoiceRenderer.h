@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+
+//==============================================================================
+/**
+    Renders a set of synthesiser voices on a pool of worker threads.
+
+    This is used by Synthesiser and MPESynthesiser when you give them some rendering
+    threads, and you probably won't need to use it directly.
+
+    The calling thread joins in with the workers. Each thread renders the voices it picks
+    up into its own scratch buffer, and when all of them are done, the scratch buffers are
+    added to the output. So the voices mustn't share any state that they modify while
+    rendering, and the order in which they're summed isn't defined.
+
+    @see Synthesiser::setNumVoiceRenderingThreads, MPESynthesiser::setNumVoiceRenderingThreads,
+         ParallelWorkerPool
+*/
+class JUCE_API  ParallelVoiceRenderer
+{
+public:
+    //==============================================================================
+    /** Starts the given number of worker threads. */
+    explicit ParallelVoiceRenderer (int numWorkerThreads);
+
+    /** Destructor. This stops the worker threads. */
+    ~ParallelVoiceRenderer();
+
+    /** Returns the number of worker threads, not including the calling thread. */
+    int getNumWorkerThreads() const noexcept                { return pool.getNumWorkerThreads(); }
+
+    //==============================================================================
+    /** Calls renderNextBlock() on each voice in the list, and adds the results to the
+        given region of the output buffer.
+
+        If the output has more channels than the scratch buffers have room for, or the block
+        is longer than they are, this will allocate, but the buffers only ever grow.
+    */
+    template <typename VoiceType, typename FloatType>
+    void renderVoices (VoiceType* const* voicesToRender, int numVoices,
+                       AudioBuffer<FloatType>& outputAudio, int startSample, int numSamples)
+    {
+        const int numChannels = outputAudio.getNumChannels();
+
+        if (numChannels <= 0 || numVoices <= 0)
+            return;
+
+        // if there's nothing to share out, there's no point in using the scratch buffers
+        if (numVoices == 1)
+        {
+            voicesToRender[0]->renderNextBlock (outputAudio, startSample, numSamples);
+            return;
+        }
+
+        OwnedArray<AudioBuffer<FloatType> >& scratch = getScratchBuffers ((FloatType*) nullptr);
+
+        for (int i = 0; i < scratch.size(); ++i)
+            if (scratch.getUnchecked (i)->getNumChannels() != numChannels
+                 || scratch.getUnchecked (i)->getNumSamples() < numSamples)
+                scratch.getUnchecked (i)->setSize (numChannels, jmax (numSamples, scratch.getUnchecked (i)->getNumSamples()),
+                                                   false, false, true);
+
+        zeromem (workerWasUsed, sizeof (bool) * (size_t) scratch.size());
+
+        VoiceJob<VoiceType, FloatType> job (scratch, workerWasUsed, voicesToRender, numSamples);
+        pool.run (job, numVoices);
+
+        for (int worker = 0; worker < scratch.size(); ++worker)
+            if (workerWasUsed[worker])
+                for (int channel = 0; channel < numChannels; ++channel)
+                    outputAudio.addFrom (channel, startSample, *scratch.getUnchecked (worker), channel, 0, numSamples);
+    }
+
+private:
+    //==============================================================================
+    template <typename VoiceType, typename FloatType>
+    struct VoiceJob  : public ParallelWorkerPool::Job
+    {
+        VoiceJob (OwnedArray<AudioBuffer<FloatType> >& s, bool* used, VoiceType* const* v, int n) noexcept
+            : scratch (s), workerWasUsed (used), voices (v), numSamples (n) {}
+
+        void startWorker (int worker) override
+        {
+            workerWasUsed[worker] = true;
+            scratch.getUnchecked (worker)->clear (0, numSamples);
+        }
+
+        void doItem (int item, int worker) override
+        {
+            voices[item]->renderNextBlock (*scratch.getUnchecked (worker), 0, numSamples);
+        }
+
+        OwnedArray<AudioBuffer<FloatType> >& scratch;
+        bool* const workerWasUsed;
+        VoiceType* const* voices;
+        const int numSamples;
+
+        JUCE_DECLARE_NON_COPYABLE (VoiceJob)
+    };
+
+    ParallelWorkerPool pool;
+    OwnedArray<AudioBuffer<float> > floatScratch;
+    OwnedArray<AudioBuffer<double> > doubleScratch;
+    HeapBlock<bool> workerWasUsed;
+
+    OwnedArray<AudioBuffer<float> >& getScratchBuffers (float*) noexcept      { return floatScratch; }
+    OwnedArray<AudioBuffer<double> >& getScratchBuffers (double*) noexcept    { return doubleScratch; }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelVoiceRenderer)
+};
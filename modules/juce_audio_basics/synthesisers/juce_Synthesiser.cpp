@@ -31,7 +31,11 @@ SynthesiserVoice::SynthesiserVoice()
       noteOnTime (0),
       keyIsDown (false),
       sustainPedalDown (false),
-      sostenutoPedalDown (false)
+      sostenutoPedalDown (false),
+      previousInList (nullptr),
+      nextInList (nullptr),
+      isInVoiceList (false),
+      isInActiveList (false)
 {
 }
 
@@ -81,13 +85,134 @@ void SynthesiserVoice::renderNextBlock (AudioBuffer<double>& outputBuffer,
     subBuffer.makeCopyOf (tempBuffer, true);
 }
 
+//==============================================================================
+/** A note or controller call that was made from another thread while the synth was
+    rendering, and which gets made again through the virtual method at the start of
+    the next block.
+*/
+struct Synthesiser::PendingCommand
+{
+    enum Type
+    {
+        noteOnCommand,
+        noteOffCommand,
+        allNotesOffCommand,
+        pitchWheelCommand,
+        controllerCommand,
+        aftertouchCommand,
+        channelPressureCommand,
+        sustainPedalCommand,
+        sostenutoPedalCommand
+    };
+
+    int type, midiChannel, data1, data2;
+    float velocity;
+};
+
+/** A new set of voice and sound lists, built by a thread that called addVoice(), addSound()
+    etc, and swapped into place by the rendering thread. After the swap it holds the old
+    lists, which get freed once the rendering thread has finished with them.
+*/
+struct Synthesiser::VoiceSnapshot
+{
+    VoiceSnapshot (int gen) noexcept : renderer (nullptr), generation (gen) {}
+
+    ~VoiceSnapshot()
+    {
+        // the synth owns the voices in this list
+        voices.clear (false);
+    }
+
+    OwnedArray<SynthesiserVoice> voices;
+    ReferenceCountedArray<SynthesiserSound> sounds;
+    Array<SynthesiserVoice*> activeVoices;
+    ParallelVoiceRenderer* renderer;
+
+    // objects that were removed by this change, which can only be deleted once it's been adopted
+    OwnedArray<SynthesiserVoice> voicesToDelete;
+    OwnedArray<ParallelVoiceRenderer> renderersToDelete;
+
+    const int generation;
+
+    JUCE_DECLARE_NON_COPYABLE (VoiceSnapshot)
+};
+
+/** Calls from the rendering thread go straight through. Anything else holds the lock, and
+    if rendering has already begun, it has to post its changes rather than make them itself.
+*/
+struct Synthesiser::CallScope
+{
+    CallScope (const Synthesiser& s) noexcept
+        : synth (s), isRenderThread (s.isCalledFromRenderThread())
+    {
+        if (! isRenderThread)
+            synth.lock.enter();
+    }
+
+    ~CallScope() noexcept
+    {
+        if (! isRenderThread)
+            synth.lock.exit();
+    }
+
+    bool mustDefer() const noexcept     { return ! isRenderThread && synth.renderThread.get() != nullptr; }
+
+    const Synthesiser& synth;
+    const bool isRenderThread;
+
+    JUCE_DECLARE_NON_COPYABLE (CallScope)
+};
+
+/** Frees the objects that were replaced while the synth was rendering, once the rendering
+    thread has moved on from them, and moves any commands that didn't fit into the queue
+    across as the rendering thread makes room for them. All the synths share the same
+    background thread.
+*/
+struct Synthesiser::RetiredObjectCollector  : private TimeSliceClient
+{
+    RetiredObjectCollector (Synthesiser& s) : synth (s)     {}
+    ~RetiredObjectCollector()                               { thread->removeTimeSliceClient (this); }
+
+    void schedule()                                         { thread->addTimeSliceClient (this, pollInterval); }
+
+    int useTimeSlice() override
+    {
+        // The thread that deletes this holds the synth's lock while waiting for this call
+        // to finish, so it mustn't block here.
+        const ScopedTryLock sl (synth.lock);
+
+        if (! sl.isLocked())
+            return 1;
+
+        synth.releaseRetiredObjects();
+        synth.queueOverflowCommands();
+        return synth.hasBackgroundWork() ? pollInterval : idleInterval;
+    }
+
+    struct SharedThread  : public TimeSliceThread
+    {
+        SharedThread() : TimeSliceThread ("Synthesiser cleanup")   { startThread (3); }
+    };
+
+    enum { pollInterval = 20, idleInterval = 1000 };
+
+    Synthesiser& synth;
+    SharedResourcePointer<SharedThread> thread;
+
+    JUCE_DECLARE_NON_COPYABLE (RetiredObjectCollector)
+};
+
 //==============================================================================
 Synthesiser::Synthesiser()
     : sampleRate (0),
       lastNoteOnCounter (0),
       minimumSubBlockSize (32),
       subBlockSubdivisionIsStrict (false),
-      shouldStealNotes (true)
+      shouldStealNotes (true),
+      voiceRenderer (nullptr),
+      lastPublishedGeneration (0),
+      commandFifo (1024),
+      pendingCommands ((size_t) commandFifo.getTotalSize())
 {
     for (int i = 0; i < numElementsInArray (lastPitchWheelValues); ++i)
         lastPitchWheelValues[i] = 0x2000;
@@ -95,50 +220,107 @@ Synthesiser::Synthesiser()
 
 Synthesiser::~Synthesiser()
 {
+    // nothing can be rendering now, so take on any outstanding changes and free what they replaced
+    const ScopedLock sl (lock);
+    stopRendering();
 }
 
 //==============================================================================
+int Synthesiser::getNumVoices() const noexcept
+{
+    if (isCalledFromRenderThread())
+        return voices.size();
+
+    const ScopedLock sl (lock);
+    return voiceList.size();
+}
+
 SynthesiserVoice* Synthesiser::getVoice (const int index) const
 {
+    if (isCalledFromRenderThread())
+        return voices [index];
+
     const ScopedLock sl (lock);
-    return voices [index];
+    return voiceList [index];
 }
 
 void Synthesiser::clearVoices()
 {
     const ScopedLock sl (lock);
-    voices.clear();
+    ScopedPointer<VoiceSnapshot> snapshot (new VoiceSnapshot (lastPublishedGeneration + 1));
+
+    for (int i = 0; i < voiceList.size(); ++i)
+        snapshot->voicesToDelete.add (voiceList.getUnchecked (i));
+
+    voiceList.clear();
+    publishChanges (snapshot.release());
 }
 
 SynthesiserVoice* Synthesiser::addVoice (SynthesiserVoice* const newVoice)
 {
     const ScopedLock sl (lock);
     newVoice->setCurrentPlaybackSampleRate (sampleRate);
-    return voices.add (newVoice);
+    voiceList.add (newVoice);
+    publishChanges (new VoiceSnapshot (lastPublishedGeneration + 1));
+    return newVoice;
 }
 
 void Synthesiser::removeVoice (const int index)
 {
     const ScopedLock sl (lock);
-    voices.remove (index);
+
+    if (SynthesiserVoice* const voice = voiceList [index])
+    {
+        ScopedPointer<VoiceSnapshot> snapshot (new VoiceSnapshot (lastPublishedGeneration + 1));
+        snapshot->voicesToDelete.add (voice);
+        voiceList.remove (index);
+        publishChanges (snapshot.release());
+    }
+}
+
+int Synthesiser::getNumSounds() const noexcept
+{
+    if (isCalledFromRenderThread())
+        return sounds.size();
+
+    const ScopedLock sl (lock);
+    return soundList.size();
+}
+
+SynthesiserSound* Synthesiser::getSound (const int index) const noexcept
+{
+    if (isCalledFromRenderThread())
+        return sounds [index];
+
+    const ScopedLock sl (lock);
+    return soundList [index];
 }
 
 void Synthesiser::clearSounds()
 {
     const ScopedLock sl (lock);
-    sounds.clear();
+    retiredSounds.addArray (soundList);
+    soundList.clear();
+    publishChanges (new VoiceSnapshot (lastPublishedGeneration + 1));
 }
 
 SynthesiserSound* Synthesiser::addSound (const SynthesiserSound::Ptr& newSound)
 {
     const ScopedLock sl (lock);
-    return sounds.add (newSound);
+    soundList.add (newSound);
+    publishChanges (new VoiceSnapshot (lastPublishedGeneration + 1));
+    return newSound;
 }
 
 void Synthesiser::removeSound (const int index)
 {
     const ScopedLock sl (lock);
-    sounds.remove (index);
+
+    if (isPositiveAndBelow (index, soundList.size()))
+    {
+        retiredSounds.add (soundList.removeAndReturn (index));
+        publishChanges (new VoiceSnapshot (lastPublishedGeneration + 1));
+    }
 }
 
 void Synthesiser::setNoteStealingEnabled (const bool shouldSteal)
@@ -153,22 +335,337 @@ void Synthesiser::setMinimumRenderingSubdivisionSize (int numSamples, bool shoul
     subBlockSubdivisionIsStrict = shouldBeStrict;
 }
 
+void Synthesiser::setNumVoiceRenderingThreads (int numThreads)
+{
+    ScopedPointer<ParallelVoiceRenderer> newRenderer (numThreads > 0 ? new ParallelVoiceRenderer (numThreads) : nullptr);
+
+    const ScopedLock sl (lock);
+    ScopedPointer<VoiceSnapshot> snapshot (new VoiceSnapshot (lastPublishedGeneration + 1));
+
+    if (requestedRenderer != nullptr)
+        snapshot->renderersToDelete.add (requestedRenderer.release());
+
+    requestedRenderer = newRenderer.release();
+    publishChanges (snapshot.release());
+}
+
+int Synthesiser::getNumVoiceRenderingThreads() const noexcept
+{
+    const ScopedLock sl (lock);
+    return requestedRenderer != nullptr ? requestedRenderer->getNumWorkerThreads() : 0;
+}
+
 //==============================================================================
-void Synthesiser::setCurrentPlaybackSampleRate (const double newRate)
+bool Synthesiser::isCalledFromRenderThread() const noexcept
 {
-    if (sampleRate != newRate)
+    return renderThread.get() == Thread::getCurrentThreadId();
+}
+
+bool Synthesiser::isRenderingOnAnotherThread() const noexcept
+{
+    return renderThread.get() != nullptr && ! isCalledFromRenderThread();
+}
+
+void Synthesiser::postCommand (int type, int midiChannel, int data1, int data2, float velocity)
+{
+    // The caller must hold the lock.
+    PendingCommand c;
+    c.type = type;
+    c.midiChannel = midiChannel;
+    c.data1 = data1;
+    c.data2 = data2;
+    c.velocity = velocity;
+
+    // Once anything has overflowed, later commands have to wait behind it to keep them in order
+    if (overflowCommands.size() == 0 && writeToCommandFifo (c))
+        return;
+
+    // The queue is full, which means that lots of events are being sent from another thread
+    // faster than the synth is being rendered, so these wait until the rendering thread has
+    // made some room.
+    overflowCommands.add (c);
+    scheduleBackgroundWork();
+}
+
+bool Synthesiser::writeToCommandFifo (const PendingCommand& c) noexcept
+{
+    int start1, size1, start2, size2;
+    commandFifo.prepareToWrite (1, start1, size1, start2, size2);
+
+    if (size1 == 0)
+        return false;
+
+    pendingCommands[start1] = c;
+    commandFifo.finishedWrite (1);
+    return true;
+}
+
+void Synthesiser::queueOverflowCommands()
+{
+    // The caller must hold the lock.
+    int numQueued = 0;
+
+    while (numQueued < overflowCommands.size()
+            && writeToCommandFifo (overflowCommands.getReference (numQueued)))
+        ++numQueued;
+
+    overflowCommands.removeRange (0, numQueued);
+}
+
+void Synthesiser::handlePendingCommands()
+{
+    int start1, size1, start2, size2;
+    commandFifo.prepareToRead (commandFifo.getNumReady(), start1, size1, start2, size2);
+
+    for (int i = 0; i < size1; ++i)
+        performCommand (pendingCommands[start1 + i]);
+
+    for (int i = 0; i < size2; ++i)
+        performCommand (pendingCommands[start2 + i]);
+
+    commandFifo.finishedRead (size1 + size2);
+}
+
+void Synthesiser::performCommand (const PendingCommand& c)
+{
+    // These go through the virtual methods, so that any overrides get to see the call
+    // on the thread that's rendering.
+    switch (c.type)
     {
-        const ScopedLock sl (lock);
+        case PendingCommand::noteOnCommand:          noteOn (c.midiChannel, c.data1, c.velocity); break;
+        case PendingCommand::noteOffCommand:         noteOff (c.midiChannel, c.data1, c.velocity, c.data2 != 0); break;
+        case PendingCommand::allNotesOffCommand:     allNotesOff (c.midiChannel, c.data2 != 0); break;
+        case PendingCommand::pitchWheelCommand:      handlePitchWheel (c.midiChannel, c.data1); break;
+        case PendingCommand::controllerCommand:      handleController (c.midiChannel, c.data1, c.data2); break;
+        case PendingCommand::aftertouchCommand:      handleAftertouch (c.midiChannel, c.data1, c.data2); break;
+        case PendingCommand::channelPressureCommand: handleChannelPressure (c.midiChannel, c.data1); break;
+        case PendingCommand::sustainPedalCommand:    handleSustainPedal (c.midiChannel, c.data1 != 0); break;
+        case PendingCommand::sostenutoPedalCommand:  handleSostenutoPedal (c.midiChannel, c.data1 != 0); break;
+
+        default:
+            jassertfalse;
+            break;
+    }
+}
 
-        allNotesOff (0, false);
+void Synthesiser::publishChanges (VoiceSnapshot* const snapshot)
+{
+    // The caller must hold the lock, and fill in the parts of the snapshot that aren't
+    // simply copied from the lists here.
+    jassert (snapshot->generation == lastPublishedGeneration + 1);
+    lastPublishedGeneration = snapshot->generation;
+
+    snapshot->voices.addArray (voiceList);
+    snapshot->sounds.addArray (soundList);
+    snapshot->activeVoices.ensureStorageAllocated (voiceList.size());
+    snapshot->renderer = requestedRenderer;
+    publishedSnapshots.add (snapshot);
+
+    if (VoiceSnapshot* const superseded = pendingSnapshot.exchange (snapshot))
+    {
+        // The audio thread never saw this one, so whatever it was waiting to delete
+        // now has to wait for its replacement instead.
+        while (superseded->voicesToDelete.size() > 0)
+            snapshot->voicesToDelete.add (superseded->voicesToDelete.removeAndReturn (0));
+
+        while (superseded->renderersToDelete.size() > 0)
+            snapshot->renderersToDelete.add (superseded->renderersToDelete.removeAndReturn (0));
+
+        publishedSnapshots.removeObject (superseded);
+    }
+
+    // If nothing's rendering yet, or this is the rendering thread, there's nobody to hand over to
+    if (renderThread.get() == nullptr || isCalledFromRenderThread())
+        adoptPendingChanges();
+
+    releaseRetiredObjects();
+
+    // anything that's still in use gets freed in the background once the rendering thread lets go of it
+    if (hasRetiredObjects())
+        scheduleBackgroundWork();
+}
+
+void Synthesiser::scheduleBackgroundWork()
+{
+    if (retiredObjectCollector == nullptr)
+        retiredObjectCollector = new RetiredObjectCollector (*this);
+
+    retiredObjectCollector->schedule();
+}
+
+void Synthesiser::adoptPendingChanges() noexcept
+{
+    if (VoiceSnapshot* const snapshot = pendingSnapshot.exchange (nullptr))
+    {
+        voices.swapWith (snapshot->voices);
+        sounds.swapWith (snapshot->sounds);
+        activeVoices.swapWith (snapshot->activeVoices);
+        voiceRenderer = snapshot->renderer;
+        rebuildVoiceLists();
+
+        adoptedGeneration.set (snapshot->generation);
+    }
+}
+
+void Synthesiser::releaseRetiredObjects()
+{
+    const int adopted = adoptedGeneration.get();
+
+    for (int i = publishedSnapshots.size(); --i >= 0;)
+        if (publishedSnapshots.getUnchecked (i)->generation <= adopted)
+            publishedSnapshots.remove (i);
+
+    // a sound that's been removed may still be held by a voice, in which case it mustn't
+    // be left for the audio thread to delete when the voice lets go of it
+    for (int i = retiredSounds.size(); --i >= 0;)
+        if (retiredSounds.getObjectPointerUnchecked (i)->getReferenceCount() == 1)
+            retiredSounds.remove (i);
+}
+
+bool Synthesiser::hasRetiredObjects() const noexcept
+{
+    return publishedSnapshots.size() > 0 || retiredSounds.size() > 0;
+}
+
+bool Synthesiser::hasBackgroundWork() const noexcept
+{
+    return hasRetiredObjects() || overflowCommands.size() > 0;
+}
+
+void Synthesiser::stopRendering()
+{
+    // The caller must hold the lock. With nothing rendering, this thread can take over
+    // anything that was waiting for the next block.
+    renderThread = nullptr;
+    retiredObjectCollector = nullptr;
+
+    adoptPendingChanges();
+    handlePendingCommands();
+
+    for (int i = 0; i < overflowCommands.size(); ++i)
+        performCommand (overflowCommands.getReference (i));
+
+    overflowCommands.clear();
+    releaseRetiredObjects();
+}
+
+//==============================================================================
+void Synthesiser::linkVoice (SynthesiserVoice* const voice, const bool active) noexcept
+{
+    VoiceList& list = active ? activeVoiceList : freeVoiceList;
 
+    voice->isInVoiceList = true;
+    voice->isInActiveList = active;
+    voice->nextInList = nullptr;
+    voice->previousInList = list.last;
+
+    if (list.last != nullptr)
+        list.last->nextInList = voice;
+    else
+        list.first = voice;
+
+    list.last = voice;
+}
+
+void Synthesiser::unlinkVoice (SynthesiserVoice* const voice) noexcept
+{
+    if (! voice->isInVoiceList)
+        return;
+
+    VoiceList& list = voice->isInActiveList ? activeVoiceList : freeVoiceList;
+
+    if (voice->previousInList != nullptr)
+        voice->previousInList->nextInList = voice->nextInList;
+    else
+        list.first = voice->nextInList;
+
+    if (voice->nextInList != nullptr)
+        voice->nextInList->previousInList = voice->previousInList;
+    else
+        list.last = voice->previousInList;
+
+    voice->previousInList = voice->nextInList = nullptr;
+    voice->isInVoiceList = voice->isInActiveList = false;
+}
+
+void Synthesiser::rebuildVoiceLists() noexcept
+{
+    freeVoiceList = VoiceList();
+    activeVoiceList = VoiceList();
+
+    for (int i = 0; i < voices.size(); ++i)
+    {
+        SynthesiserVoice* const voice = voices.getUnchecked (i);
+        voice->isInVoiceList = false;
+
+        if (! voice->isVoiceActive())
+        {
+            linkVoice (voice, false);
+            continue;
+        }
+
+        // keep the sounding voices in the order they were started
+        SynthesiserVoice* previous = activeVoiceList.last;
+
+        while (previous != nullptr && voice->wasStartedBefore (*previous))
+            previous = previous->previousInList;
+
+        SynthesiserVoice* const next = (previous != nullptr ? previous->nextInList : activeVoiceList.first);
+
+        voice->isInVoiceList = voice->isInActiveList = true;
+        voice->previousInList = previous;
+        voice->nextInList = next;
+
+        if (previous != nullptr)  previous->nextInList = voice;
+        else                      activeVoiceList.first = voice;
+
+        if (next != nullptr)      next->previousInList = voice;
+        else                      activeVoiceList.last = voice;
+    }
+}
+
+void Synthesiser::reclaimFinishedVoices() noexcept
+{
+    // voices stop themselves while rendering, so move any that have finished onto the free list
+    for (SynthesiserVoice* voice = activeVoiceList.first; voice != nullptr;)
+    {
+        SynthesiserVoice* const next = voice->nextInList;
+
+        if (! voice->isVoiceActive())
+        {
+            unlinkVoice (voice);
+            linkVoice (voice, false);
+        }
+
+        voice = next;
+    }
+}
+
+//==============================================================================
+void Synthesiser::setCurrentPlaybackSampleRate (const double newRate)
+{
+    const CallScope scope (*this);
+
+    // this gets called before rendering starts, so whatever was rendering has stopped
+    if (! scope.isRenderThread)
+        stopRendering();
+
+    if (sampleRate != newRate)
+    {
         sampleRate = newRate;
+        allNotesOff (0, false);
 
         for (int i = voices.size(); --i >= 0;)
             voices.getUnchecked (i)->setCurrentPlaybackSampleRate (newRate);
     }
 }
 
+void Synthesiser::releaseResources()
+{
+    const ScopedLock sl (lock);
+    stopRendering();
+}
+
 template <typename floatType>
 void Synthesiser::processNextBlock (AudioBuffer<floatType>& outputAudio,
                                     const MidiBuffer& midiData,
@@ -186,7 +683,17 @@ void Synthesiser::processNextBlock (AudioBuffer<floatType>& outputAudio,
     int midiEventPos;
     MidiMessage m;
 
-    const ScopedLock sl (lock);
+    if (! isCalledFromRenderThread())
+    {
+        // This only happens for the first block, or if the host moves rendering onto a
+        // different thread. From then on, other threads will queue their changes.
+        const ScopedLock sl (lock);
+        renderThread = Thread::getCurrentThreadId();
+    }
+
+    adoptPendingChanges();
+    handlePendingCommands();
+    reclaimFinishedVoices();
 
     while (numSamples > 0)
     {
@@ -241,16 +748,43 @@ template void Synthesiser::processNextBlock<double> (AudioBuffer<double>& output
 
 void Synthesiser::renderVoices (AudioBuffer<float>& buffer, int startSample, int numSamples)
 {
+    if (voiceRenderer != nullptr)
+    {
+        renderActiveVoices (buffer, startSample, numSamples);
+        return;
+    }
+
     for (int i = voices.size(); --i >= 0;)
         voices.getUnchecked (i)->renderNextBlock (buffer, startSample, numSamples);
 }
 
 void Synthesiser::renderVoices (AudioBuffer<double>& buffer, int startSample, int numSamples)
 {
+    if (voiceRenderer != nullptr)
+    {
+        renderActiveVoices (buffer, startSample, numSamples);
+        return;
+    }
+
     for (int i = voices.size(); --i >= 0;)
         voices.getUnchecked (i)->renderNextBlock (buffer, startSample, numSamples);
 }
 
+template <typename floatType>
+void Synthesiser::renderActiveVoices (AudioBuffer<floatType>& buffer, int startSample, int numSamples)
+{
+    reclaimFinishedVoices();
+
+    // the storage for this was allocated by the thread that added the voices
+    activeVoices.clearQuick();
+
+    for (SynthesiserVoice* voice = activeVoiceList.first; voice != nullptr; voice = voice->nextInList)
+        activeVoices.add (voice);
+
+    voiceRenderer->renderVoices (activeVoices.getRawDataPointer(), activeVoices.size(),
+                                 buffer, startSample, numSamples);
+}
+
 void Synthesiser::handleMidiEvent (const MidiMessage& m)
 {
     const int channel = m.getChannel();
@@ -296,7 +830,13 @@ void Synthesiser::noteOn (const int midiChannel,
                           const int midiNoteNumber,
                           const float velocity)
 {
-    const ScopedLock sl (lock);
+    const CallScope scope (*this);
+
+    if (scope.mustDefer())
+    {
+        postCommand (PendingCommand::noteOnCommand, midiChannel, midiNoteNumber, 0, velocity);
+        return;
+    }
 
     for (int i = sounds.size(); --i >= 0;)
     {
@@ -307,10 +847,8 @@ void Synthesiser::noteOn (const int midiChannel,
         {
             // If hitting a note that's still ringing, stop it first (it could be
             // still playing because of the sustain or sostenuto pedal).
-            for (int j = voices.size(); --j >= 0;)
+            for (SynthesiserVoice* voice = activeVoiceList.first; voice != nullptr; voice = voice->nextInList)
             {
-                SynthesiserVoice* const voice = voices.getUnchecked (j);
-
                 if (voice->getCurrentlyPlayingNote() == midiNoteNumber
                      && voice->isPlayingChannel (midiChannel))
                     stopVoice (voice, 1.0f, true);
@@ -338,6 +876,8 @@ void Synthesiser::startVoice (SynthesiserVoice* const voice,
         voice->noteOnTime = ++lastNoteOnCounter;
         voice->currentlyPlayingSound = sound;
         voice->keyIsDown = true;
+        unlinkVoice (voice);
+        linkVoice (voice, true);
         voice->sostenutoPedalDown = false;
         voice->sustainPedalDown = sustainPedalsDown[midiChannel];
 
@@ -361,12 +901,17 @@ void Synthesiser::noteOff (const int midiChannel,
                            const float velocity,
                            const bool allowTailOff)
 {
-    const ScopedLock sl (lock);
+    const CallScope scope (*this);
 
-    for (int i = voices.size(); --i >= 0;)
+    if (scope.mustDefer())
     {
-        SynthesiserVoice* const voice = voices.getUnchecked (i);
+        postCommand (PendingCommand::noteOffCommand, midiChannel, midiNoteNumber, allowTailOff ? 1 : 0, velocity);
+        return;
+    }
 
+    // a voice that isn't in the active list can't be playing anything
+    for (SynthesiserVoice* voice = activeVoiceList.first; voice != nullptr; voice = voice->nextInList)
+    {
         if (voice->getCurrentlyPlayingNote() == midiNoteNumber
               && voice->isPlayingChannel (midiChannel))
         {
@@ -389,7 +934,13 @@ void Synthesiser::noteOff (const int midiChannel,
 
 void Synthesiser::allNotesOff (const int midiChannel, const bool allowTailOff)
 {
-    const ScopedLock sl (lock);
+    const CallScope scope (*this);
+
+    if (scope.mustDefer())
+    {
+        postCommand (PendingCommand::allNotesOffCommand, midiChannel, 0, allowTailOff ? 1 : 0, 0.0f);
+        return;
+    }
 
     for (int i = voices.size(); --i >= 0;)
     {
@@ -404,7 +955,13 @@ void Synthesiser::allNotesOff (const int midiChannel, const bool allowTailOff)
 
 void Synthesiser::handlePitchWheel (const int midiChannel, const int wheelValue)
 {
-    const ScopedLock sl (lock);
+    const CallScope scope (*this);
+
+    if (scope.mustDefer())
+    {
+        postCommand (PendingCommand::pitchWheelCommand, midiChannel, wheelValue, 0, 0.0f);
+        return;
+    }
 
     for (int i = voices.size(); --i >= 0;)
     {
@@ -419,6 +976,14 @@ void Synthesiser::handleController (const int midiChannel,
                                     const int controllerNumber,
                                     const int controllerValue)
 {
+    const CallScope scope (*this);
+
+    if (scope.mustDefer())
+    {
+        postCommand (PendingCommand::controllerCommand, midiChannel, controllerNumber, controllerValue, 0.0f);
+        return;
+    }
+
     switch (controllerNumber)
     {
         case 0x40:  handleSustainPedal   (midiChannel, controllerValue >= 64); break;
@@ -427,8 +992,6 @@ void Synthesiser::handleController (const int midiChannel,
         default:    break;
     }
 
-    const ScopedLock sl (lock);
-
     for (int i = voices.size(); --i >= 0;)
     {
         SynthesiserVoice* const voice = voices.getUnchecked (i);
@@ -440,7 +1003,13 @@ void Synthesiser::handleController (const int midiChannel,
 
 void Synthesiser::handleAftertouch (int midiChannel, int midiNoteNumber, int aftertouchValue)
 {
-    const ScopedLock sl (lock);
+    const CallScope scope (*this);
+
+    if (scope.mustDefer())
+    {
+        postCommand (PendingCommand::aftertouchCommand, midiChannel, midiNoteNumber, aftertouchValue, 0.0f);
+        return;
+    }
 
     for (int i = voices.size(); --i >= 0;)
     {
@@ -454,7 +1023,13 @@ void Synthesiser::handleAftertouch (int midiChannel, int midiNoteNumber, int aft
 
 void Synthesiser::handleChannelPressure (int midiChannel, int channelPressureValue)
 {
-    const ScopedLock sl (lock);
+    const CallScope scope (*this);
+
+    if (scope.mustDefer())
+    {
+        postCommand (PendingCommand::channelPressureCommand, midiChannel, channelPressureValue, 0, 0.0f);
+        return;
+    }
 
     for (int i = voices.size(); --i >= 0;)
     {
@@ -468,7 +1043,13 @@ void Synthesiser::handleChannelPressure (int midiChannel, int channelPressureVal
 void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
 {
     jassert (midiChannel > 0 && midiChannel <= 16);
-    const ScopedLock sl (lock);
+    const CallScope scope (*this);
+
+    if (scope.mustDefer())
+    {
+        postCommand (PendingCommand::sustainPedalCommand, midiChannel, isDown ? 1 : 0, 0, 0.0f);
+        return;
+    }
 
     if (isDown)
     {
@@ -504,7 +1085,13 @@ void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
 void Synthesiser::handleSostenutoPedal (int midiChannel, bool isDown)
 {
     jassert (midiChannel > 0 && midiChannel <= 16);
-    const ScopedLock sl (lock);
+    const CallScope scope (*this);
+
+    if (scope.mustDefer())
+    {
+        postCommand (PendingCommand::sostenutoPedalCommand, midiChannel, isDown ? 1 : 0, 0, 0.0f);
+        return;
+    }
 
     for (int i = voices.size(); --i >= 0;)
     {
@@ -537,15 +1124,16 @@ SynthesiserVoice* Synthesiser::findFreeVoice (SynthesiserSound* soundToPlay,
                                               int midiChannel, int midiNoteNumber,
                                               const bool stealIfNoneAvailable) const
 {
-    const ScopedLock sl (lock);
-
-    for (int i = 0; i < voices.size(); ++i)
-    {
-        SynthesiserVoice* const voice = voices.getUnchecked (i);
+    // The free list is in the order that voices stopped, so this picks the one that
+    // has been idle for longest, which is usually the first one that it looks at.
+    for (SynthesiserVoice* voice = freeVoiceList.first; voice != nullptr; voice = voice->nextInList)
+        if ((! voice->isVoiceActive()) && voice->canPlaySound (soundToPlay))
+            return voice;
 
+    // Voices that have finished since the lists were last tidied up are still in the active list
+    for (SynthesiserVoice* voice = activeVoiceList.first; voice != nullptr; voice = voice->nextInList)
         if ((! voice->isVoiceActive()) && voice->canPlaySound (soundToPlay))
             return voice;
-    }
 
     if (stealIfNoneAvailable)
         return findVoiceToSteal (soundToPlay, midiChannel, midiNoteNumber);
@@ -553,14 +1141,6 @@ SynthesiserVoice* Synthesiser::findFreeVoice (SynthesiserSound* soundToPlay,
     return nullptr;
 }
 
-struct VoiceAgeSorter
-{
-    static int compareElements (SynthesiserVoice* v1, SynthesiserVoice* v2) noexcept
-    {
-        return v1->wasStartedBefore (*v2) ? -1 : (v2->wasStartedBefore (*v1) ? 1 : 0);
-    }
-};
-
 SynthesiserVoice* Synthesiser::findVoiceToSteal (SynthesiserSound* soundToPlay,
                                                  int /*midiChannel*/, int midiNoteNumber) const
 {
@@ -575,25 +1155,25 @@ SynthesiserVoice* Synthesiser::findVoiceToSteal (SynthesiserSound* soundToPlay,
     SynthesiserVoice* low = nullptr; // Lowest sounding note, might be sustained, but NOT in release phase
     SynthesiserVoice* top = nullptr; // Highest sounding note, might be sustained, but NOT in release phase
 
-    // this is a list of voices we can steal, sorted by how long they've been running
-    Array<SynthesiserVoice*> usableVoices;
-    usableVoices.ensureStorageAllocated (voices.size());
+    // The oldest note that's playing with the target pitch is ideal..
+    SynthesiserVoice* samePitch = nullptr;
 
-    for (int i = 0; i < voices.size(); ++i)
+    // The active list is already sorted by how long the voices have been running, so
+    // one pass finds the protected notes, and a second one picks the oldest voice in
+    // each category.
+    for (SynthesiserVoice* voice = activeVoiceList.first; voice != nullptr; voice = voice->nextInList)
     {
-        SynthesiserVoice* const voice = voices.getUnchecked (i);
-
         if (voice->canPlaySound (soundToPlay))
         {
             jassert (voice->isVoiceActive()); // We wouldn't be here otherwise
 
-            VoiceAgeSorter sorter;
-            usableVoices.addSorted (sorter, voice);
+            const int note = voice->getCurrentlyPlayingNote();
+
+            if (samePitch == nullptr && note == midiNoteNumber)
+                samePitch = voice;
 
             if (! voice->isPlayingButReleased()) // Don't protect released notes
             {
-                const int note = voice->getCurrentlyPlayingNote();
-
                 if (low == nullptr || note < low->getCurrentlyPlayingNote())
                     low = voice;
 
@@ -603,54 +1183,306 @@ SynthesiserVoice* Synthesiser::findVoiceToSteal (SynthesiserSound* soundToPlay,
         }
     }
 
+    if (samePitch != nullptr)
+        return samePitch;
+
     // Eliminate pathological cases (ie: only 1 note playing): we always give precedence to the lowest note(s)
     if (top == low)
         top = nullptr;
 
-    const int numUsableVoices = usableVoices.size();
+    SynthesiserVoice* oldestReleased = nullptr;   // no finger on it and not held by sustain pedal
+    SynthesiserVoice* oldestKeyUp = nullptr;      // doesn't have a finger on it
+    SynthesiserVoice* oldestUnprotected = nullptr;
 
-    // The oldest note that's playing with the target pitch is ideal..
-    for (int i = 0; i < numUsableVoices; ++i)
+    for (SynthesiserVoice* voice = activeVoiceList.first; voice != nullptr; voice = voice->nextInList)
     {
-        SynthesiserVoice* const voice = usableVoices.getUnchecked (i);
+        if (voice != low && voice != top && voice->canPlaySound (soundToPlay))
+        {
+            if (voice->isPlayingButReleased())
+            {
+                oldestReleased = voice;
+                break;
+            }
 
-        if (voice->getCurrentlyPlayingNote() == midiNoteNumber)
-            return voice;
+            if (oldestKeyUp == nullptr && ! voice->isKeyDown())
+                oldestKeyUp = voice;
+
+            if (oldestUnprotected == nullptr)
+                oldestUnprotected = voice;
+        }
     }
 
-    // Oldest voice that has been released (no finger on it and not held by sustain pedal)
-    for (int i = 0; i < numUsableVoices; ++i)
+    if (oldestReleased != nullptr)      return oldestReleased;
+    if (oldestKeyUp != nullptr)         return oldestKeyUp;
+    if (oldestUnprotected != nullptr)   return oldestUnprotected;
+
+    // We've only got "protected" voices now: lowest note takes priority
+    jassert (low != nullptr);
+
+    // Duophonic synth: give priority to the bass note:
+    if (top != nullptr)
+        return top;
+
+    return low;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SynthesiserTests  : public UnitTest
+{
+public:
+    SynthesiserTests() : UnitTest ("Synthesiser") {}
+
+    struct TestSound  : public SynthesiserSound
     {
-        SynthesiserVoice* const voice = usableVoices.getUnchecked (i);
+        bool appliesToNote (int) override       { return true; }
+        bool appliesToChannel (int) override    { return true; }
+    };
 
-        if (voice != low && voice != top && voice->isPlayingButReleased())
-            return voice;
-    }
+    struct TestVoice  : public SynthesiserVoice
+    {
+        TestVoice (Atomic<int>& counter) : numVoices (counter)  { ++numVoices; }
+        ~TestVoice()                                    { --numVoices; }
+
+        bool canPlaySound (SynthesiserSound*) override  { return true; }
+        void startNote (int, float, SynthesiserSound*, int) override {}
+        void stopNote (float, bool) override            { clearCurrentNote(); }
+        void pitchWheelMoved (int) override             {}
+        void controllerMoved (int, int) override        {}
+        void renderNextBlock (AudioBuffer<float>&, int, int) override {}
 
-    // Oldest voice that doesn't have a finger on it:
-    for (int i = 0; i < numUsableVoices; ++i)
+        Atomic<int>& numVoices;
+    };
+
+    // Keeps track of the threads that its overridden methods get called on
+    struct TestSynth  : public Synthesiser
     {
-        SynthesiserVoice* const voice = usableVoices.getUnchecked (i);
+        TestSynth() : numNoteOns (0), lastNoteOnThread (nullptr) {}
 
-        if (voice != low && voice != top && ! voice->isKeyDown())
-            return voice;
+        void noteOn (int midiChannel, int midiNoteNumber, float velocity) override
+        {
+            if (! isRenderingOnAnotherThread())
+            {
+                ++numNoteOns;
+                lastNoteOnThread = Thread::getCurrentThreadId();
+            }
+
+            Synthesiser::noteOn (midiChannel, midiNoteNumber, velocity);
+        }
+
+        Atomic<int> numNoteOns;
+        Atomic<Thread::ThreadID> lastNoteOnThread;
+    };
+
+    // Makes some calls to the synth from a thread that isn't rendering it
+    struct OtherThread  : public Thread
+    {
+        OtherThread (std::function<void()> f) : Thread ("Synthesiser test"), function (f)
+        {
+            startThread();
+            waitForThreadToExit (-1);
+        }
+
+        void run() override     { function(); }
+
+        std::function<void()> function;
+    };
+
+    void runTest() override
+    {
+        Atomic<int> numVoices;
+
+        {
+            TestSynth synth;
+            synth.addSound (new TestSound());
+
+            for (int i = 0; i < 4; ++i)
+                synth.addVoice (new TestVoice (numVoices));
+
+            synth.setCurrentPlaybackSampleRate (44100.0);
+
+            AudioBuffer<float> buffer (2, 256);
+            MidiBuffer midi;
+
+            beginTest ("Calls from other threads are deferred");
+            {
+                synth.renderNextBlock (buffer, midi, 0, 256);
+
+                OtherThread ([&] { synth.noteOn (1, 60, 1.0f); });
+                expectEquals (numPlaying (synth), 0);
+
+                synth.renderNextBlock (buffer, midi, 0, 256);
+                expectEquals (numPlaying (synth), 1);
+
+                OtherThread ([&] { synth.allNotesOff (0, false); });
+                expectEquals (numPlaying (synth), 1);
+
+                synth.renderNextBlock (buffer, midi, 0, 256);
+                expectEquals (numPlaying (synth), 0);
+            }
+
+            beginTest ("Overridden methods run on the rendering thread");
+            {
+                OtherThread ([&] { synth.noteOn (1, 60, 1.0f); });
+                expectEquals (synth.numNoteOns.get(), 1);
+
+                // the queued call goes through the override again, this time on the rendering thread
+                synth.renderNextBlock (buffer, midi, 0, 256);
+                expectEquals (synth.numNoteOns.get(), 2);
+                expect (synth.lastNoteOnThread.get() == Thread::getCurrentThreadId());
+                expectEquals (numPlaying (synth), 1);
+
+                synth.allNotesOff (0, false);
+                synth.renderNextBlock (buffer, midi, 0, 256);
+            }
+
+            beginTest ("Calls that overflow the queue aren't lost");
+            {
+                const int numCalls = 5000, firstCount = synth.numNoteOns.get();
+
+                OtherThread ([&]
+                {
+                    for (int i = 0; i < numCalls; ++i)
+                        synth.noteOn (1, 60, 1.0f);
+                });
+
+                for (int i = 0; i < 500 && synth.numNoteOns.get() < firstCount + numCalls; ++i)
+                {
+                    synth.renderNextBlock (buffer, midi, 0, 256);
+                    Thread::sleep (10);
+                }
+
+                expectEquals (synth.numNoteOns.get(), firstCount + numCalls);
+
+                synth.allNotesOff (0, false);
+                synth.renderNextBlock (buffer, midi, 0, 256);
+            }
+
+            beginTest ("Calls take effect immediately once rendering stops");
+            {
+                OtherThread ([&] { synth.noteOn (1, 60, 1.0f); });
+                expectEquals (numPlaying (synth), 0);
+
+                // the queued call gets made by releaseResources()
+                synth.releaseResources();
+                expectEquals (numPlaying (synth), 1);
+
+                OtherThread ([&] { synth.allNotesOff (0, false); synth.addVoice (new TestVoice (numVoices)); });
+                expectEquals (numPlaying (synth), 0);
+                expectEquals (synth.getNumVoices(), 5);
+
+                synth.removeVoice (4);
+                expectEquals (numVoices.get(), 4);
+
+                synth.renderNextBlock (buffer, midi, 0, 256);
+                OtherThread ([&] { synth.noteOn (1, 60, 1.0f); });
+                expectEquals (numPlaying (synth), 0);
+
+                // a host calls this from another thread before restarting
+                OtherThread ([&] { synth.setCurrentPlaybackSampleRate (48000.0); });
+                expectEquals (numPlaying (synth), 0);
+                expectEquals (synth.getVoice (0)->getSampleRate(), 48000.0);
+
+                OtherThread ([&] { synth.noteOn (1, 60, 1.0f); });
+                expectEquals (numPlaying (synth), 1);
+
+                synth.allNotesOff (0, false);
+                synth.renderNextBlock (buffer, midi, 0, 256);
+            }
+
+            beginTest ("Voices change at the start of the next block");
+            {
+                OtherThread ([&]
+                {
+                    for (int i = 0; i < 4; ++i)
+                        synth.addVoice (new TestVoice (numVoices));
+
+                    synth.removeVoice (0);
+                    expectEquals (synth.getNumVoices(), 7);
+                });
+
+                expectEquals (synth.getNumVoices(), 4);
+                synth.renderNextBlock (buffer, midi, 0, 256);
+                expectEquals (synth.getNumVoices(), 7);
+
+                // the removed voice gets deleted in the background once the rendering thread has let go of it
+                for (int i = 0; i < 200 && numVoices.get() != 7; ++i)
+                    Thread::sleep (10);
+
+                expectEquals (numVoices.get(), 7);
+            }
+
+            beginTest ("Stealing protects the highest and lowest notes");
+            {
+                synth.renderNextBlock (buffer, midi, 0, 256);
+
+                const int notes[] = { 60, 40, 80, 50, 70, 55, 65 };
+
+                for (int i = 0; i < numElementsInArray (notes); ++i)
+                    synth.noteOn (1, notes[i], 1.0f);
+
+                expectEquals (numPlaying (synth), 7);
+
+                synth.noteOn (1, 90, 1.0f);
+                expect (isPlaying (synth, 90) && ! isPlaying (synth, 60));
+
+                synth.noteOn (1, 30, 1.0f);
+                expect (isPlaying (synth, 30) && ! isPlaying (synth, 80) && isPlaying (synth, 40));
+
+                synth.noteOff (1, 70, 1.0f, true);
+                synth.noteOn (1, 100, 1.0f);
+                expect (isPlaying (synth, 100) && isPlaying (synth, 55) && ! isPlaying (synth, 70));
+            }
+
+           #if JUCE_ENABLE_ALLOCATION_HOOKS
+            beginTest ("Rendering doesn't allocate");
+            {
+                MidiBuffer events;
+
+                for (int i = 0; i < 16; ++i)
+                {
+                    events.addEvent (MidiMessage::noteOn (1 + i % 2, 40 + i, 1.0f), i * 16);
+                    events.addEvent (MidiMessage::pitchWheel (1, i * 1000), i * 16 + 4);
+                    events.addEvent (MidiMessage::controllerEvent (1, 64, i % 2 == 0 ? 127 : 0), i * 16 + 8);
+                    events.addEvent (MidiMessage::noteOff (1 + i % 2, 40 + i), i * 16 + 12);
+                }
+
+                synth.renderNextBlock (buffer, midi, 0, 256);
+
+                const ScopedAllocationCounter counter;
+                synth.renderNextBlock (buffer, events, 0, 256);
+                synth.renderNextBlock (buffer, midi, 0, 256);
+                expectEquals (counter.getNumCalls(), 0);
+            }
+           #endif
+        }
+
+        expectEquals (numVoices.get(), 0);
     }
 
-    // Oldest voice that isn't protected
-    for (int i = 0; i < numUsableVoices; ++i)
+    static int numPlaying (const Synthesiser& synth)
     {
-        SynthesiserVoice* const voice = usableVoices.getUnchecked (i);
+        int num = 0;
 
-        if (voice != low && voice != top)
-            return voice;
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+            if (synth.getVoice (i)->isVoiceActive())
+                ++num;
+
+        return num;
     }
 
-    // We've only got "protected" voices now: lowest note takes priority
-    jassert (low != nullptr);
+    static bool isPlaying (const Synthesiser& synth, int note)
+    {
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+            if (synth.getVoice (i)->getCurrentlyPlayingNote() == note)
+                return true;
 
-    // Duophonic synth: give priority to the bass note:
-    if (top != nullptr)
-        return top;
+        return false;
+    }
+};
 
-    return low;
-}
+static SynthesiserTests synthesiserTests;
+
+#endif
@@ -255,6 +255,11 @@ private:
     SynthesiserSound::Ptr currentlyPlayingSound;
     bool keyIsDown, sustainPedalDown, sostenutoPedalDown;
 
+    // links for the synthesiser's lists of free and sounding voices
+    SynthesiserVoice* previousInList;
+    SynthesiserVoice* nextInList;
+    bool isInVoiceList, isInActiveList;
+
     AudioBuffer<float> tempBuffer;
 
    #if JUCE_CATCH_DEPRECATED_CODE_MISUSE
@@ -286,6 +291,39 @@ private:
     While it's playing, you can also cause notes to be triggered by calling the noteOn(),
     noteOff() and other controller methods.
 
+    The rendering callback never waits for a lock. Once renderNextBlock() has been called,
+    any note or controller calls made from other threads are put into a lock-free queue,
+    and the changes made by addVoice(), addSound() and their friends are built into new
+    voice and sound lists on the calling thread. The audio thread picks all of these up
+    at the start of the next block that it renders, and anything that has been removed
+    is deleted shortly afterwards by a shared background thread, so it's never deleted
+    while it's being rendered, or by the audio thread itself.
+
+    If you override noteOn(), noteOff() or any of the other controller methods, a call
+    that gets queued like this is made again through your override on the rendering
+    thread, which is where it takes effect. So your override sees the call twice: once
+    on the thread that made it, where calling the base class just queues it, and again
+    on the rendering thread. If your override does anything besides calling the base
+    class, use isRenderingOnAnotherThread() to do that work only once, e.g.
+
+    @code
+    void noteOn (int midiChannel, int midiNoteNumber, float velocity) override
+    {
+        if (! isRenderingOnAnotherThread())
+            updateMyNoteState (midiChannel, midiNoteNumber);
+
+        Synthesiser::noteOn (midiChannel, midiNoteNumber, velocity);
+    }
+    @endcode
+
+    Calls from other threads are never dropped: if more arrive between two blocks than
+    the queue can hold, the rest are handed over by the background thread as the
+    rendering thread makes room for them.
+
+    When rendering stops, call releaseResources() (or setCurrentPlaybackSampleRate()
+    before starting again), so that calls from other threads go back to taking effect
+    immediately rather than waiting for a block that'll never arrive.
+
     Before rendering, be sure to call the setCurrentPlaybackSampleRate() to tell it
     what the target playback rate is. This value is passed on to the voices so that
     they can pitch their output correctly.
@@ -307,7 +345,7 @@ public:
     void clearVoices();
 
     /** Returns the number of voices that have been added. */
-    int getNumVoices() const noexcept                               { return voices.size(); }
+    int getNumVoices() const noexcept;
 
     /** Returns one of the voices that have been added. */
     SynthesiserVoice* getVoice (int index) const;
@@ -330,10 +368,10 @@ public:
     void clearSounds();
 
     /** Returns the number of sounds that have been added to the synth. */
-    int getNumSounds() const noexcept                               { return sounds.size(); }
+    int getNumSounds() const noexcept;
 
     /** Returns one of the sounds. */
-    SynthesiserSound* getSound (int index) const noexcept           { return sounds [index]; }
+    SynthesiserSound* getSound (int index) const noexcept;
 
     /** Adds a new sound to the synthesiser.
 
@@ -491,9 +529,23 @@ public:
 
         This value is propagated to the voices so that they can use it to render the correct
         pitches.
+
+        Call this before rendering starts, e.g. from your AudioProcessor::prepareToPlay().
+        Unless it's called from the rendering thread itself, it assumes that any rendering
+        has stopped, and also does the same job as releaseResources().
     */
     virtual void setCurrentPlaybackSampleRate (double sampleRate);
 
+    /** Tells the synth that it won't be rendered again until renderNextBlock() is next called.
+
+        Call this when playback stops, e.g. from your AudioProcessor::releaseResources().
+        Any calls that were queued for the audio thread are carried out, anything that
+        has been removed is deleted, and from then on calls from any thread take effect
+        immediately. You must make sure that renderNextBlock() isn't running on another
+        thread when you call this.
+    */
+    void releaseResources();
+
     /** Creates the next block of audio output.
 
         This will process the next numSamples of data from all the voices, and add that output
@@ -545,11 +597,39 @@ public:
     */
     void setMinimumRenderingSubdivisionSize (int numSamples, bool shouldBeStrict = false) noexcept;
 
+    //==============================================================================
+    /** Shares out the rendering of the voices between some worker threads.
+
+        If this is more than zero, the default renderVoices() only renders the voices that
+        are active, and spreads them across the calling thread and this many workers. Each
+        thread renders into its own scratch buffer, and these are added to the output at the
+        end of each sub-block.
+
+        Your voices must then be safe to render at the same time as each other, so they
+        mustn't modify any shared state in their renderNextBlock() methods. A value of
+        zero (the default) renders every voice on the calling thread.
+
+        Handing the voices out has a cost of its own, so with only one core, or a handful
+        of cheap voices, this will be slower than leaving it at zero. Only turn it on if
+        you've measured it helping on the machines you're targeting - the --synth-benchmark
+        option of the AudioPerformanceTest app will time it for you.
+    */
+    void setNumVoiceRenderingThreads (int numThreads);
+
+    /** Returns the number of worker threads set by setNumVoiceRenderingThreads(). */
+    int getNumVoiceRenderingThreads() const noexcept;
+
 protected:
     //==============================================================================
-    /** This is used to control access to the rendering callback and the note trigger methods. */
+    /** This is held by calls made from threads other than the one that's rendering, while
+        they queue up their changes. The rendering callback itself never takes it.
+    */
     CriticalSection lock;
 
+    /** The voices and sounds that are being rendered. These should only be used from
+        the rendering thread - changes made from other threads appear here at the start
+        of the next block.
+    */
     OwnedArray<SynthesiserVoice> voices;
     ReferenceCountedArray<SynthesiserSound> sounds;
 
@@ -607,6 +687,15 @@ protected:
     /** Can be overridden to do custom handling of incoming midi events. */
     virtual void handleMidiEvent (const MidiMessage&);
 
+    /** Returns true if the synth is being rendered by a thread other than this one.
+
+        When this is true, calling one of the base class note or controller methods just
+        queues the call, and it'll be made again through the same virtual method on the
+        rendering thread at the start of the next block. Your overrides of these methods
+        can use this to avoid doing their own work twice.
+    */
+    bool isRenderingOnAnotherThread() const noexcept;
+
 private:
     //==============================================================================
     template <typename floatType>
@@ -614,6 +703,45 @@ private:
                            const MidiBuffer& inputMidi,
                            int startSample,
                            int numSamples);
+
+    template <typename floatType>
+    void renderActiveVoices (AudioBuffer<floatType>& outputAudio,
+                             int startSample,
+                             int numSamples);
+
+    //==============================================================================
+    struct PendingCommand;
+    struct VoiceSnapshot;
+    struct CallScope;
+    struct RetiredObjectCollector;
+
+    struct VoiceList
+    {
+        VoiceList() noexcept : first (nullptr), last (nullptr) {}
+
+        SynthesiserVoice* first;
+        SynthesiserVoice* last;
+    };
+
+    bool isCalledFromRenderThread() const noexcept;
+    void postCommand (int type, int midiChannel, int data1, int data2, float velocity);
+    bool writeToCommandFifo (const PendingCommand&) noexcept;
+    void queueOverflowCommands();
+    void handlePendingCommands();
+    void performCommand (const PendingCommand&);
+    void publishChanges (VoiceSnapshot*);
+    void adoptPendingChanges() noexcept;
+    void releaseRetiredObjects();
+    bool hasRetiredObjects() const noexcept;
+    bool hasBackgroundWork() const noexcept;
+    void scheduleBackgroundWork();
+    void stopRendering();
+
+    void rebuildVoiceLists() noexcept;
+    void reclaimFinishedVoices() noexcept;
+    void linkVoice (SynthesiserVoice*, bool active) noexcept;
+    void unlinkVoice (SynthesiserVoice*) noexcept;
+
     //==============================================================================
     double sampleRate;
     uint32 lastNoteOnCounter;
@@ -622,6 +750,26 @@ private:
     bool shouldStealNotes;
     BigInteger sustainPedalsDown;
 
+    // state used by the rendering thread
+    ParallelVoiceRenderer* voiceRenderer;
+    Array<SynthesiserVoice*> activeVoices;
+    VoiceList freeVoiceList, activeVoiceList;
+
+    // the lists as other threads see them, which are published to the rendering thread
+    Array<SynthesiserVoice*> voiceList;
+    ReferenceCountedArray<SynthesiserSound> soundList, retiredSounds;
+    ScopedPointer<ParallelVoiceRenderer> requestedRenderer;
+    OwnedArray<VoiceSnapshot> publishedSnapshots;
+    int lastPublishedGeneration;
+
+    Atomic<Thread::ThreadID> renderThread;
+    Atomic<VoiceSnapshot*> pendingSnapshot;
+    Atomic<int> adoptedGeneration;
+    AbstractFifo commandFifo;
+    HeapBlock<PendingCommand> pendingCommands;
+    Array<PendingCommand> overflowCommands;
+    ScopedPointer<RetiredObjectCollector> retiredObjectCollector;
+
    #if JUCE_CATCH_DEPRECATED_CODE_MISUSE
     // Note the new parameters for these methods.
     virtual int findFreeVoice (const bool) const { return 0; }
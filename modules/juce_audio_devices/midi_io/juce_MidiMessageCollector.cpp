@@ -20,10 +20,172 @@
   ==============================================================================
 */
 
+// A single-producer, single-consumer FIFO of messages, each stored as a header followed
+// by the message data.
+struct MidiMessageCollector::Queue
+{
+    Queue (MidiInput* sourceInput, int numBytes)
+        : source (sourceInput), lastWriteTime (Time::getMillisecondCounter()),
+          fifo (numBytes), data ((size_t) numBytes)
+    {
+    }
+
+    // A queue that belongs to a MidiInput can be handed over to a different one once it's
+    // empty and has been quiet for a while, because there's no way to find out when a
+    // MidiInput has been deleted. So an input has to claim its queue before writing to it,
+    // and check that it's still the owner.
+    bool claim (MidiInput* owner) noexcept
+    {
+        if (! writing.compareAndSetBool (1, 0))
+            return false;
+
+        if (source.get() == owner)
+            return true;
+
+        writing = 0;
+        return false;
+    }
+
+    void release() noexcept
+    {
+        lastWriteTime = Time::getMillisecondCounter();
+        writing = 0;
+    }
+
+    bool reassign (MidiInput* newOwner) noexcept
+    {
+        if (! writing.compareAndSetBool (1, 0))
+            return false;
+
+        const uint32 now = Time::getMillisecondCounter();
+        const bool canReuse = fifo.getNumReady() == 0 && now - lastWriteTime >= (uint32) minIdleTimeMs;
+
+        if (canReuse)
+        {
+            source = newOwner;
+            lastWriteTime = now;
+        }
+
+        writing = 0;
+        return canReuse;
+    }
+
+    struct Header
+    {
+        double timeStamp;
+        int numBytes;
+    };
+
+    bool write (const MidiMessageView& message) noexcept
+    {
+        const Header header = { message.getTimeStamp(), message.getRawDataSize() };
+        const int totalSize = (int) sizeof (Header) + header.numBytes;
+
+        if (fifo.getFreeSpace() < totalSize)
+            return false;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (totalSize, start1, size1, start2, size2);
+
+        copyIn (&header, (int) sizeof (Header), 0, start1, size1, start2);
+        copyIn (message.getRawData(), header.numBytes, (int) sizeof (Header), start1, size1, start2);
+
+        fifo.finishedWrite (totalSize);
+        return true;
+    }
+
+    bool readNextHeader (Header& header) const noexcept
+    {
+        if (fifo.getNumReady() < (int) sizeof (Header))
+            return false;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead ((int) sizeof (Header), start1, size1, start2, size2);
+        copyOut (&header, (int) sizeof (Header), 0, start1, size1, start2);
+        return true;
+    }
+
+    // Adds the next message to a buffer, using the scratch space if its data wraps
+    // around the end of the FIFO, and then removes it.
+    void moveNextMessage (const Header& header, MidiBuffer& dest, int samplePosition, uint8* scratch) noexcept
+    {
+        const int totalSize = (int) sizeof (Header) + header.numBytes;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (totalSize, start1, size1, start2, size2);
+
+        if (size1 >= totalSize)
+        {
+            dest.addEvent (data + start1 + sizeof (Header), header.numBytes, samplePosition);
+        }
+        else
+        {
+            copyOut (scratch, header.numBytes, (int) sizeof (Header), start1, size1, start2);
+            dest.addEvent (scratch, header.numBytes, samplePosition);
+        }
+
+        fifo.finishedRead (totalSize);
+    }
+
+    void skipNextMessage (const Header& header) noexcept
+    {
+        fifo.finishedRead ((int) sizeof (Header) + header.numBytes);
+    }
+
+    void clear() noexcept
+    {
+        fifo.finishedRead (fifo.getNumReady());
+    }
+
+    Atomic<MidiInput*> source;
+
+private:
+    enum { minIdleTimeMs = 1000 };
+
+    Atomic<int> writing;
+    uint32 lastWriteTime;
+    AbstractFifo fifo;
+    HeapBlock<uint8> data;
+
+    // These copy a range of bytes, starting at an offset into the message, to or from
+    // the two blocks that the fifo returned
+    void copyIn (const void* bytes, int numBytes, int offset, int start1, int size1, int start2) noexcept
+    {
+        const uint8* const src = static_cast<const uint8*> (bytes);
+        const int numInFirstBlock = jlimit (0, numBytes, size1 - offset);
+
+        memcpy (data + start1 + offset, src, (size_t) numInFirstBlock);
+        memcpy (data + start2 + jmax (0, offset - size1), src + numInFirstBlock, (size_t) (numBytes - numInFirstBlock));
+    }
+
+    void copyOut (void* dest, int numBytes, int offset, int start1, int size1, int start2) const noexcept
+    {
+        uint8* const dst = static_cast<uint8*> (dest);
+        const int numInFirstBlock = jlimit (0, numBytes, size1 - offset);
+
+        memcpy (dst, data + start1 + offset, (size_t) numInFirstBlock);
+        memcpy (dst + numInFirstBlock, data + start2 + jmax (0, offset - size1), (size_t) (numBytes - numInFirstBlock));
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Queue)
+};
+
+//==============================================================================
 MidiMessageCollector::MidiMessageCollector()
-    : lastCallbackTime (0),
-      sampleRate (44100.0001)
+    : sampleRate (44100.0001),
+      blockClockIsRunning (false),
+      blockStartTime (0),
+      nextBlockStartTime (0),
+      secondsPerSample (1.0 / 44100.0),
+      scratchBuffer ((size_t) queueSizeBytes)
 {
+    // The audio thread reads the queues without locking, so the array mustn't
+    // be reallocated when a queue is added.
+    queues.ensureStorageAllocated (maxNumQueues);
+    queues.add (new Queue (nullptr, queueSizeBytes));
+    numQueues = 1;
+
+    resetLatencyStatistics();
 }
 
 MidiMessageCollector::~MidiMessageCollector()
@@ -35,13 +197,22 @@ void MidiMessageCollector::reset (const double newSampleRate)
 {
     jassert (newSampleRate > 0);
 
-    const ScopedLock sl (midiCallbackLock);
     sampleRate = newSampleRate;
-    incomingMessages.clear();
-    lastCallbackTime = Time::getMillisecondCounterHiRes();
+    secondsPerSample = 1.0 / newSampleRate;
+    blockClockIsRunning = false;
+
+    for (int i = numQueues.get(); --i >= 0;)
+        queues.getUnchecked (i)->clear();
+
+    resetLatencyStatistics();
 }
 
 void MidiMessageCollector::addMessageToQueue (const MidiMessage& message)
+{
+    addMessageToQueue (MidiMessageView (message));
+}
+
+void MidiMessageCollector::addMessageToQueue (const MidiMessageView& message)
 {
     // you need to call reset() to set the correct sample rate before using this object
     jassert (sampleRate != 44100.0001);
@@ -50,17 +221,75 @@ void MidiMessageCollector::addMessageToQueue (const MidiMessage& message)
     // for details of what the number should be.
     jassert (message.getTimeStamp() != 0);
 
-    const ScopedLock sl (midiCallbackLock);
+    const SpinLock::ScopedLockType sl (sharedQueueLock);
+    pushMessage (*queues.getUnchecked (0), message);
+}
 
-    const int sampleNumber
-        = (int) ((message.getTimeStamp() - 0.001 * lastCallbackTime) * sampleRate);
+void MidiMessageCollector::pushMessage (Queue& queue, const MidiMessageView& message)
+{
+    if (! queue.write (message))
+        ++numMessagesDropped;
+}
 
-    incomingMessages.addEvent (message, sampleNumber);
+MidiMessageCollector::Queue* MidiMessageCollector::getQueueFor (MidiInput* source)
+{
+    if (source == nullptr)
+        return nullptr;
+
+    for (int i = 1; i < numQueues.get(); ++i)
+        if (queues.getUnchecked (i)->source.get() == source)
+            return queues.getUnchecked (i);
+
+    const SpinLock::ScopedLockType sl (queueCreationLock);
+    const int num = numQueues.get();
+
+    for (int i = 1; i < num; ++i)
+        if (queues.getUnchecked (i)->source.get() == source)
+            return queues.getUnchecked (i);
+
+    if (num >= maxNumQueues)
+    {
+        // they're all taken, but the inputs that some of them belong to may have gone away
+        for (int i = 1; i < num; ++i)
+            if (queues.getUnchecked (i)->reassign (source))
+                return queues.getUnchecked (i);
 
-    // if the messages don't get used for over a second, we'd better
-    // get rid of any old ones to avoid the queue getting too big
-    if (sampleNumber > sampleRate)
-        incomingMessages.clear (0, sampleNumber - (int) sampleRate);
+        return nullptr;
+    }
+
+    Queue* const newQueue = new Queue (source, queueSizeBytes);
+    queues.add (newQueue);
+    numQueues = num + 1;
+    return newQueue;
+}
+
+//==============================================================================
+void MidiMessageCollector::updateBlockClock (const int numSamples) noexcept
+{
+    const double now = Time::getMillisecondCounterHiRes() * 0.001;
+    const double error = now - nextBlockStartTime;
+
+    if (blockClockIsRunning && std::abs (error) < 0.1)
+    {
+        // This is a delay-locked loop, which smooths out the jitter in the times at
+        // which the callbacks arrive, while following any drift between the audio
+        // and system clocks.
+        const double bandwidth = 1.0;
+        const double omega = 2.0 * double_Pi * bandwidth * numSamples * secondsPerSample;
+
+        blockStartTime = nextBlockStartTime;
+        secondsPerSample = jlimit (0.9 / sampleRate, 1.1 / sampleRate,
+                                   secondsPerSample + omega * omega * error / numSamples);
+        nextBlockStartTime = blockStartTime + std::sqrt (2.0) * omega * error + numSamples * secondsPerSample;
+    }
+    else
+    {
+        // This is the first block, or the callbacks stopped for a while, so start again
+        blockClockIsRunning = true;
+        blockStartTime = now;
+        secondsPerSample = 1.0 / sampleRate;
+        nextBlockStartTime = now + numSamples * secondsPerSample;
+    }
 }
 
 void MidiMessageCollector::removeNextBlockOfMessages (MidiBuffer& destBuffer,
@@ -70,62 +299,83 @@ void MidiMessageCollector::removeNextBlockOfMessages (MidiBuffer& destBuffer,
     jassert (sampleRate != 44100.0001);
     jassert (numSamples > 0);
 
-    const double timeNow = Time::getMillisecondCounterHiRes();
-    const double msElapsed = timeNow - lastCallbackTime;
+    updateBlockClock (numSamples);
 
-    const ScopedLock sl (midiCallbackLock);
-    lastCallbackTime = timeNow;
+    // Each message is placed at the position in this block that matches its timestamp,
+    // a block later. Any messages that are more recent than that are left in the
+    // queue for the next block.
+    const int num = numQueues.get();
 
-    if (! incomingMessages.isEmpty())
+    for (int i = 0; i < num; ++i)
     {
-        int numSourceSamples = jmax (1, roundToInt (msElapsed * 0.001 * sampleRate));
-
-        int startSample = 0;
-        int scale = 1 << 16;
+        Queue& queue = *queues.getUnchecked (i);
+        Queue::Header header;
 
-        const uint8* midiData;
-        int numBytes, samplePosition;
-
-        MidiBuffer::Iterator iter (incomingMessages);
-
-        if (numSourceSamples > numSamples)
+        while (queue.readNextHeader (header))
         {
-            // if our list of events is longer than the buffer we're being
-            // asked for, scale them down to squeeze them all in..
-            const int maxBlockLengthToUse = numSamples << 5;
+            const int samplePosition = numSamples + (int) std::floor ((header.timeStamp - blockStartTime) / secondsPerSample);
+
+            if (samplePosition >= numSamples)
+                break;
 
-            if (numSourceSamples > maxBlockLengthToUse)
+            // if the messages don't get used for over a second, we'd better
+            // get rid of any old ones to avoid the queue getting too big
+            if (samplePosition < -(int) sampleRate)
             {
-                startSample = numSourceSamples - maxBlockLengthToUse;
-                numSourceSamples = maxBlockLengthToUse;
-                iter.setNextSamplePosition (startSample);
+                queue.skipNextMessage (header);
+                ++numMessagesDropped;
+                continue;
             }
 
-            scale = (numSamples << 10) / numSourceSamples;
+            const int position = jmax (0, samplePosition);
+            addLatencyMeasurement (blockStartTime + position * secondsPerSample - header.timeStamp);
+            queue.moveNextMessage (header, destBuffer, position, scratchBuffer);
+        }
+    }
+}
 
-            while (iter.getNextEvent (midiData, numBytes, samplePosition))
-            {
-                samplePosition = ((samplePosition - startSample) * scale) >> 10;
+//==============================================================================
+void MidiMessageCollector::addLatencyMeasurement (const double latencySeconds) noexcept
+{
+    const int64 microseconds = (int64) (latencySeconds * 1.0e6);
 
-                destBuffer.addEvent (midiData, numBytes,
-                                     jlimit (0, numSamples - 1, samplePosition));
-            }
-        }
-        else
-        {
-            // if our event list is shorter than the number we need, put them
-            // towards the end of the buffer
-            startSample = numSamples - numSourceSamples;
+    ++numMessagesDelivered;
+    totalLatencyMicroseconds += microseconds;
 
-            while (iter.getNextEvent (midiData, numBytes, samplePosition))
-            {
-                destBuffer.addEvent (midiData, numBytes,
-                                     jlimit (0, numSamples - 1, samplePosition + startSample));
-            }
-        }
+    if (microseconds < minLatencyMicroseconds.get())
+        minLatencyMicroseconds = microseconds;
+
+    if (microseconds > maxLatencyMicroseconds.get())
+        maxLatencyMicroseconds = microseconds;
+}
+
+MidiMessageCollector::LatencyStatistics MidiMessageCollector::getLatencyStatistics() const noexcept
+{
+    LatencyStatistics stats;
+    stats.numMessages = numMessagesDelivered.get();
+    stats.numMessagesDropped = numMessagesDropped.get();
 
-        incomingMessages.clear();
+    if (stats.numMessages > 0)
+    {
+        stats.averageLatencyMs = (double) totalLatencyMicroseconds.get() * 0.001 / stats.numMessages;
+        stats.minimumLatencyMs = (double) minLatencyMicroseconds.get() * 0.001;
+        stats.maximumLatencyMs = (double) maxLatencyMicroseconds.get() * 0.001;
+    }
+    else
+    {
+        stats.averageLatencyMs = stats.minimumLatencyMs = stats.maximumLatencyMs = 0;
     }
+
+    return stats;
+}
+
+void MidiMessageCollector::resetLatencyStatistics() noexcept
+{
+    numMessagesDelivered = 0;
+    numMessagesDropped = 0;
+    totalLatencyMicroseconds = 0;
+    minLatencyMicroseconds = std::numeric_limits<int64>::max();
+    maxLatencyMicroseconds = std::numeric_limits<int64>::min();
 }
 
 //==============================================================================
@@ -145,7 +395,212 @@ void MidiMessageCollector::handleNoteOff (MidiKeyboardState*, int midiChannel, i
     addMessageToQueue (m);
 }
 
-void MidiMessageCollector::handleIncomingMidiMessage (MidiInput*, const MidiMessage& message)
+void MidiMessageCollector::handleIncomingMidiMessage (MidiInput* source, const MidiMessage& message)
 {
+    // If the input's queue gets handed to another input between finding it and claiming it,
+    // this just goes round again to find a different one.
+    while (Queue* const queue = getQueueFor (source))
+    {
+        if (queue->claim (source))
+        {
+            // you need to call reset() to set the correct sample rate before using this object
+            jassert (sampleRate != 44100.0001);
+
+            pushMessage (*queue, MidiMessageView (message));
+            queue->release();
+            return;
+        }
+    }
+
     addMessageToQueue (message);
 }
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MidiMessageCollectorTests  : public UnitTest
+{
+public:
+    MidiMessageCollectorTests() : UnitTest ("MidiMessageCollector") {}
+
+    void runTest() override
+    {
+        // 100ms blocks, so that the time it takes to get from here to the collector's
+        // own reading of the clock is small compared with the positions being checked
+        const double sampleRate = 48000.0;
+        const int blockSize = 4800;
+
+        MidiMessageCollector collector;
+        MidiBuffer buffer;
+        buffer.ensureSize (1024);
+
+        beginTest ("Messages are placed a block after their timestamps");
+        {
+            collector.reset (sampleRate);
+            const double now = getTimeNow();
+
+            collector.addMessageToQueue (MidiMessage (MidiMessage::noteOn (1, 60, 1.0f), now - 0.08));
+            collector.addMessageToQueue (MidiMessage (MidiMessage::noteOn (1, 64, 1.0f), now - 0.06));
+            collector.addMessageToQueue (MidiMessage (MidiMessage::noteOff (1, 60), now - 0.02));
+
+            // this one's due in a later block, so should be left in the queue
+            collector.addMessageToQueue (MidiMessage (MidiMessage::noteOff (1, 64), now + 0.5));
+
+            collector.removeNextBlockOfMessages (buffer, blockSize);
+            expectEquals (buffer.getNumEvents(), 3);
+
+            Array<int> positions;
+            MidiBuffer::Iterator iter (buffer);
+            MidiMessage m;
+            int position = 0;
+
+            while (iter.getNextEvent (m, position))
+                positions.add (position);
+
+            if (positions.size() == 3)
+            {
+                // the block started a little later than 'now', which moves every message earlier
+                expect (positions[0] <= 960 && positions[0] > 0);
+
+                // ..but the spacing between them matches their timestamps
+                expect (std::abs (positions[1] - positions[0] - 960) <= 1);
+                expect (std::abs (positions[2] - positions[0] - 2880) <= 1);
+            }
+
+            buffer.clear();
+            collector.removeNextBlockOfMessages (buffer, blockSize);
+            expectEquals (buffer.getNumEvents(), 0);
+        }
+
+        beginTest ("Latency statistics");
+        {
+            const MidiMessageCollector::LatencyStatistics stats (collector.getLatencyStatistics());
+
+            expectEquals (stats.numMessages, 3);
+            expectEquals (stats.numMessagesDropped, 0);
+
+            // every message is played one block after its timestamp, to within a sample
+            const double blockMs = 1000.0 * blockSize / sampleRate;
+            const double sampleMs = 1000.0 / sampleRate;
+
+            expect (std::abs (stats.averageLatencyMs - blockMs) <= sampleMs);
+            // (the measurements are stored as whole microseconds)
+            expect (stats.averageLatencyMs >= stats.minimumLatencyMs - 0.001
+                     && stats.averageLatencyMs <= stats.maximumLatencyMs + 0.001);
+            expect (stats.getJitterMs() <= sampleMs);
+
+            collector.resetLatencyStatistics();
+            expectEquals (collector.getLatencyStatistics().numMessages, 0);
+        }
+
+        beginTest ("Messages are dropped when the queue is full or they're too old");
+        {
+            collector.reset (sampleRate);
+            const double now = getTimeNow();
+            const int numMessages = 5000;
+
+            for (int i = 0; i < numMessages; ++i)
+                collector.addMessageToQueue (MidiMessage (MidiMessage::noteOn (1, i % 128, 1.0f), now + 10.0));
+
+            const int numDropped = collector.getLatencyStatistics().numMessagesDropped;
+            expect (numDropped > 0 && numDropped < numMessages);
+
+            // the ones that did fit are still there, and waiting for their time to come
+            buffer.clear();
+            collector.removeNextBlockOfMessages (buffer, blockSize);
+            expectEquals (buffer.getNumEvents(), 0);
+
+            collector.reset (sampleRate);
+            expectEquals (collector.getLatencyStatistics().numMessagesDropped, 0);
+
+            const double later = getTimeNow();
+            collector.addMessageToQueue (MidiMessage (MidiMessage::noteOn (1, 60, 1.0f), later - 2.0));
+            collector.addMessageToQueue (MidiMessage (MidiMessage::noteOn (1, 62, 1.0f), later - 0.05));
+
+            collector.removeNextBlockOfMessages (buffer, blockSize);
+            expectEquals (buffer.getNumEvents(), 1);
+            expectEquals (collector.getLatencyStatistics().numMessagesDropped, 1);
+            expectEquals (collector.getLatencyStatistics().numMessages, 1);
+        }
+
+        beginTest ("Queues are handed over once their inputs have gone quiet");
+        {
+            collector.reset (sampleRate);
+            buffer.clear();
+
+            // (the collector only uses these to tell its inputs apart)
+            char fakeInputs[40];
+            const int numInputs = (int) sizeof (fakeInputs);
+
+            for (int round = 0; round < 2; ++round)
+            {
+                for (int i = 0; i < numInputs / 2; ++i)
+                {
+                    MidiInput* const input = reinterpret_cast<MidiInput*> (fakeInputs + round * numInputs / 2 + i);
+                    collector.handleIncomingMidiMessage (input, MidiMessage (MidiMessage::noteOn (1, i, 1.0f), getTimeNow() - 0.05));
+                }
+
+                collector.removeNextBlockOfMessages (buffer, blockSize);
+                expectEquals (buffer.getNumEvents(), numInputs / 2);
+                buffer.clear();
+
+                // the first round of inputs take all the queues, so the second round can
+                // only have their own once those have been left empty for long enough
+                if (round == 0)
+                    Thread::sleep (1100);
+            }
+
+            expectEquals (collector.getLatencyStatistics().numMessagesDropped, 0);
+        }
+
+        beginTest ("Sysex data is collected from a view without allocating");
+        {
+            collector.reset (sampleRate);
+
+            uint8 sysex[1000];
+            sysex[0] = 0xf0;
+            sysex[sizeof (sysex) - 1] = 0xf7;
+
+            for (int i = 1; i < (int) sizeof (sysex) - 1; ++i)
+                sysex[i] = (uint8) (i & 0x7f);
+
+            buffer.clear();
+            buffer.reserve (16, 4096);
+
+            {
+               #if JUCE_ENABLE_ALLOCATION_HOOKS
+                const ScopedAllocationCounter counter;
+               #endif
+
+                for (int i = 0; i < 3; ++i)
+                    collector.addMessageToQueue (MidiMessageView (sysex, (int) sizeof (sysex), getTimeNow() - 0.05));
+
+                collector.removeNextBlockOfMessages (buffer, blockSize);
+
+               #if JUCE_ENABLE_ALLOCATION_HOOKS
+                expectEquals (counter.getNumCalls(), 0);
+               #endif
+            }
+
+            expectEquals (buffer.getNumEvents(), 3);
+
+            MidiBuffer::Iterator iter (buffer);
+            MidiMessageView view;
+            int position = 0;
+
+            while (iter.getNextEvent (view, position))
+                expect (view.getRawDataSize() == (int) sizeof (sysex)
+                         && memcmp (view.getRawData(), sysex, sizeof (sysex)) == 0);
+        }
+    }
+
+    static double getTimeNow()
+    {
+        return Time::getMillisecondCounterHiRes() * 0.001;
+    }
+};
+
+static MidiMessageCollectorTests midiMessageCollectorTests;
+
+#endif
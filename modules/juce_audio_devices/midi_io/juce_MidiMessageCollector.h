@@ -31,6 +31,16 @@
     The class can also be used as either a MidiKeyboardStateListener or a MidiInputCallback
     so it can easily use a midi input or keyboard component as its source.
 
+    Incoming messages are written into lock-free FIFOs, with a separate one for each
+    MidiInput that sends messages to it, so neither the midi input threads nor the audio
+    callback ever have to wait for each other. Up to 15 inputs get a FIFO of their own,
+    and once they're all taken, one that has been empty and quiet for a second can be
+    handed over to a new input. Anything else shares the FIFO used by addMessageToQueue(). The audio callback keeps a smoothed estimate
+    of when each block starts, and each message is placed in the next block at the position
+    that matches its timestamp, delayed by one block. This means that the delay between a
+    message arriving and it being played stays constant, instead of varying with the timing
+    of the audio callbacks.
+
     @see MidiMessage, MidiInput
 */
 class JUCE_API  MidiMessageCollector    : public MidiKeyboardStateListener,
@@ -48,7 +58,10 @@ public:
     /** Clears any messages from the queue.
 
         You need to call this method before starting to use the collector, so that
-        it knows the correct sample rate to use.
+        it knows the correct sample rate to use. It changes state that the audio callback
+        uses without any locking, so it mustn't be called while removeNextBlockOfMessages()
+        could be running on another thread - call it from somewhere like prepareToPlay(),
+        or from the audio callback itself.
     */
     void reset (double sampleRate);
 
@@ -58,10 +71,22 @@ public:
         of the block returned by the next call to removeNextBlockOfMessages().
 
         This method is fully thread-safe when overlapping calls are made with
-        removeNextBlockOfMessages().
+        removeNextBlockOfMessages(), and never blocks the thread that calls that.
+        If the queue is full, the message will be dropped.
+
+        Each queue holds 32KB, including a few bytes of bookkeeping for each message, so a
+        sysex message of more than about 32000 bytes can never fit, and is always dropped.
     */
     void addMessageToQueue (const MidiMessage& message);
 
+    /** Adds a message to the queue, straight from a view of its data.
+
+        This does the same job as addMessageToQueue (const MidiMessage&), but lets you
+        pass in a message such as a sysex that you've been given as raw bytes without
+        first making a MidiMessage out of it, so it doesn't allocate anything.
+    */
+    void addMessageToQueue (const MidiMessageView& message);
+
     /** Removes all the pending messages from the queue as a buffer.
 
         This will also correct the messages' timestamps to make sure they're in
@@ -72,12 +97,41 @@ public:
         midi event positions.
 
         This method is fully thread-safe when overlapping calls are made with
-        addMessageToQueue().
+        addMessageToQueue(), and doesn't take any locks or allocate any memory,
+        as long as the destination buffer has enough space reserved.
 
         Precondition: numSamples must be greater than 0.
     */
     void removeNextBlockOfMessages (MidiBuffer& destBuffer, int numSamples);
 
+    //==============================================================================
+    /** Measurements of the delay between messages being received and played. */
+    struct LatencyStatistics
+    {
+        /** The number of messages that have been passed to removeNextBlockOfMessages(). */
+        int numMessages;
+
+        /** The number of messages that were lost because a queue was full, or because
+            they weren't collected for more than a second.
+        */
+        int numMessagesDropped;
+
+        /** The average, shortest and longest times between a message's timestamp and
+            the time at which its position in the audio stream is due to be played.
+        */
+        double averageLatencyMs, minimumLatencyMs, maximumLatencyMs;
+
+        /** Returns the difference between the longest and shortest latencies. */
+        double getJitterMs() const noexcept         { return maximumLatencyMs - minimumLatencyMs; }
+    };
+
+    /** Returns the latency measurements for the messages that have been collected
+        since the last call to reset() or resetLatencyStatistics().
+    */
+    LatencyStatistics getLatencyStatistics() const noexcept;
+
+    /** Clears the latency measurements. */
+    void resetLatencyStatistics() noexcept;
 
     //==============================================================================
     /** @internal */
@@ -89,10 +143,31 @@ public:
 
 private:
     //==============================================================================
-    double lastCallbackTime;
-    CriticalSection midiCallbackLock;
-    MidiBuffer incomingMessages;
+    struct Queue;
+
+    // the size of each queue, which is also the size of the largest message that can be collected
+    enum { maxNumQueues = 16, queueSizeBytes = 32768 };
+
+    // The first queue is shared by any callers of addMessageToQueue(), which have to
+    // take the sharedQueueLock. The others each belong to a single MidiInput.
+    OwnedArray<Queue> queues;
+    Atomic<int> numQueues;
+    SpinLock sharedQueueLock, queueCreationLock;
+
     double sampleRate;
 
+    // the audio callback's estimate of when the current block started
+    bool blockClockIsRunning;
+    double blockStartTime, nextBlockStartTime, secondsPerSample;
+    HeapBlock<uint8> scratchBuffer;
+
+    Atomic<int> numMessagesDelivered, numMessagesDropped;
+    Atomic<int64> totalLatencyMicroseconds, minLatencyMicroseconds, maxLatencyMicroseconds;
+
+    Queue* getQueueFor (MidiInput*);
+    void pushMessage (Queue&, const MidiMessageView&);
+    void updateBlockClock (int numSamples) noexcept;
+    void addLatencyMeasurement (double latencySeconds) noexcept;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiMessageCollector)
 };
@@ -332,14 +332,17 @@ private:
 
                             if (snd_seq_event_input (seqHandle, &inputEvent) >= 0)
                             {
+                                // take the time as soon as the event arrives, and with enough
+                                // precision for the collector to place it accurately
+                                const double timeStamp = Time::getMillisecondCounterHiRes() * 0.001;
+
                                 // xxx what about SYSEXes that are too big for the buffer?
                                 const long numBytes = snd_midi_event_decode (midiParser, buffer,
                                                                             maxEventSize, inputEvent);
 
                                 snd_midi_event_reset_decode (midiParser);
 
-                                concatenator.pushMidiData (buffer, (int) numBytes,
-                                                           Time::getMillisecondCounter() * 0.001,
+                                concatenator.pushMidiData (buffer, (int) numBytes, timeStamp,
                                                            inputEvent, client);
 
                                 snd_seq_free_event (inputEvent);
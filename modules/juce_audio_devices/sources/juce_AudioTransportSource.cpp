@@ -34,6 +34,7 @@ AudioTransportSource::AudioTransportSource()
       sourceSampleRate (0.0),
       blockSize (128),
       readAheadBufferSize (0),
+      resamplingQuality (ResamplingAudioSource::linearInterpolation),
       isPrepared (false),
       inputStreamEOF (false)
 {
@@ -87,8 +88,12 @@ void AudioTransportSource::setSource (PositionableAudioSource* const newSource,
         newPositionableSource->setNextReadPosition (0);
 
         if (sourceSampleRateToCorrectFor > 0)
+        {
             newMasterSource = newResamplerSource
                 = new ResamplingAudioSource (newPositionableSource, false, maxNumChannels);
+
+            newResamplerSource->setQuality (resamplingQuality);
+        }
         else
             newMasterSource = newPositionableSource;
 
@@ -118,6 +123,15 @@ void AudioTransportSource::setSource (PositionableAudioSource* const newSource,
         oldMasterSource->releaseResources();
 }
 
+void AudioTransportSource::setResamplingQuality (ResamplingAudioSource::Quality newQuality)
+{
+    const ScopedLock sl (callbackLock);
+    resamplingQuality = newQuality;
+
+    if (resamplerSource != nullptr)
+        resamplerSource->setQuality (newQuality);
+}
+
 void AudioTransportSource::start()
 {
     if ((! playing) && masterSource != nullptr)
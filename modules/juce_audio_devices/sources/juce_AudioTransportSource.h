@@ -79,6 +79,14 @@ public:
                     double sourceSampleRateToCorrectFor = 0.0,
                     int maxNumChannels = 2);
 
+    /** Chooses the algorithm that's used when the source's sample rate is being corrected.
+        @see ResamplingAudioSource::setQuality
+    */
+    void setResamplingQuality (ResamplingAudioSource::Quality newQuality);
+
+    /** Returns the algorithm that was chosen with setResamplingQuality(). */
+    ResamplingAudioSource::Quality getResamplingQuality() const noexcept    { return resamplingQuality; }
+
     //==============================================================================
     /** Changes the current playback position in the source stream.
 
@@ -166,6 +174,7 @@ private:
     bool volatile playing, stopped;
     double sampleRate, sourceSampleRate;
     int blockSize, readAheadBufferSize;
+    ResamplingAudioSource::Quality resamplingQuality;
     bool volatile isPrepared, inputStreamEOF;
 
     void releaseMasterResources();
@@ -63,6 +63,7 @@ public:
     Array<int> getPossibleBitDepths() override;
     bool canDoStereo() override;
     bool canDoMono() override;
+    bool hasSampleAccurateSeeking() override;
 
    #if JUCE_MAC
     bool canHandleFile (const File& fileToTest) override;
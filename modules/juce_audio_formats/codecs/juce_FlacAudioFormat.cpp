@@ -583,6 +583,10 @@ bool FlacAudioFormat::canDoStereo()     { return true; }
 bool FlacAudioFormat::canDoMono()       { return true; }
 bool FlacAudioFormat::isCompressed()    { return true; }
 
+// libFLAC decodes forward from the frame containing the target sample (using the
+// stream's seek table when there is one), so any position can be reached exactly
+bool FlacAudioFormat::hasSampleAccurateSeeking()    { return true; }
+
 AudioFormatReader* FlacAudioFormat::createReaderFor (InputStream* in, const bool deleteStreamIfOpeningFails)
 {
     ScopedPointer<FlacReader> r (new FlacReader (in));
@@ -47,6 +47,7 @@ public:
     bool canDoStereo() override;
     bool canDoMono() override;
     bool isCompressed() override;
+    bool hasSampleAccurateSeeking() override;
     StringArray getQualityOptions() override;
 
     //==============================================================================
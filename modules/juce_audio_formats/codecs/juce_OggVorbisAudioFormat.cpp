@@ -465,6 +465,10 @@ bool OggVorbisAudioFormat::canDoStereo()    { return true; }
 bool OggVorbisAudioFormat::canDoMono()      { return true; }
 bool OggVorbisAudioFormat::isCompressed()   { return true; }
 
+// the reader uses ov_pcm_seek, which pre-rolls from the preceding page to land
+// exactly on the requested sample
+bool OggVorbisAudioFormat::hasSampleAccurateSeeking()   { return true; }
+
 AudioFormatReader* OggVorbisAudioFormat::createReaderFor (InputStream* in, const bool deleteStreamIfOpeningFails)
 {
     ScopedPointer<OggReader> r (new OggReader (in));
@@ -1153,6 +1153,19 @@ public:
     //==============================================================================
     bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
                       int64 startSampleInFile, int numSamples) override
+    {
+        return readSampleData (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+    }
+
+    bool readSamplesAsFloat (float** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                             int64 startSampleInFile, int numSamples) override
+    {
+        return readSampleData (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+    }
+
+    template <typename SampleType>
+    bool readSampleData (SampleType** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                         int64 startSampleInFile, int numSamples)
     {
         clearSamplesBeyondAvailableLength (destSamples, numDestChannels, startOffsetInDestBuffer,
                                            startSampleInFile, numSamples, lengthInSamples);
@@ -1202,6 +1215,31 @@ public:
         }
     }
 
+    static void copySampleData (unsigned int bitsPerSample, const bool usesFloatingPointData,
+                                float* const* destSamples, int startOffsetInDestBuffer, int numDestChannels,
+                                const void* sourceData, int numChannels, int numSamples) noexcept
+    {
+        switch (bitsPerSample)
+        {
+            case 8:     ReadHelper<AudioData::Float32, AudioData::UInt8, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numChannels, numSamples); break;
+            case 16:    ReadHelper<AudioData::Float32, AudioData::Int16, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numChannels, numSamples); break;
+            case 24:    ReadHelper<AudioData::Float32, AudioData::Int24, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numChannels, numSamples); break;
+            case 32:
+                if (usesFloatingPointData)
+                {
+                    ReadHelper<AudioData::Float32, AudioData::Float32, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numChannels, numSamples);
+                }
+                else
+                {
+                    ReadHelper<AudioData::Float32, AudioData::Int32,   AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numChannels, numSamples);
+                }
+
+                break;
+
+            default:    jassertfalse; break;
+        }
+    }
+
     int64 bwavChunkStart, bwavSize;
     int64 dataChunkStart, dataLength;
     int bytesPerFrame;
@@ -1474,15 +1512,31 @@ public:
         : MemoryMappedAudioFormatReader (wavFile, reader, reader.dataChunkStart,
                                          reader.dataLength, reader.bytesPerFrame)
     {
+       #if JUCE_LITTLE_ENDIAN
+        hasNativeFloatData = usesFloatingPointData && bitsPerSample == 32;
+       #endif
     }
 
     bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
                       int64 startSampleInFile, int numSamples) override
+    {
+        return readSampleData (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+    }
+
+    bool readSamplesAsFloat (float** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                             int64 startSampleInFile, int numSamples) override
+    {
+        return readSampleData (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+    }
+
+    template <typename SampleType>
+    bool readSampleData (SampleType** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                         int64 startSampleInFile, int numSamples)
     {
         clearSamplesBeyondAvailableLength (destSamples, numDestChannels, startOffsetInDestBuffer,
                                            startSampleInFile, numSamples, lengthInSamples);
 
-        if (map == nullptr || ! mappedSection.contains (Range<int64> (startSampleInFile, startSampleInFile + numSamples)))
+        if (! ensureMapped (Range<int64> (startSampleInFile, startSampleInFile + numSamples)))
         {
             jassertfalse; // you must make sure that the window contains all the samples you're going to attempt to read.
             return false;
@@ -1524,7 +1578,7 @@ public:
     {
         numSamples = jmin (numSamples, lengthInSamples - startSampleInFile);
 
-        if (map == nullptr || numSamples <= 0 || ! mappedSection.contains (Range<int64> (startSampleInFile, startSampleInFile + numSamples)))
+        if (numSamples <= 0 || ! ensureMapped (Range<int64> (startSampleInFile, startSampleInFile + numSamples)))
         {
             jassert (numSamples <= 0); // you must make sure that the window contains all the samples you're going to attempt to read.
 
@@ -1578,6 +1632,9 @@ Array<int> WavAudioFormat::getPossibleBitDepths()
 bool WavAudioFormat::canDoStereo()  { return true; }
 bool WavAudioFormat::canDoMono()    { return true; }
 
+// every frame is the same size, so the reader can jump straight to any sample
+bool WavAudioFormat::hasSampleAccurateSeeking()     { return true; }
+
 AudioFormatReader* WavAudioFormat::createReaderFor (InputStream* sourceStream,
                                                     const bool deleteStreamIfOpeningFails)
 {
@@ -1751,6 +1808,143 @@ public:
             expect (reader != nullptr);
             expect (reader->metadataValues == metadataValues, "Somehow, the metadata is different!");
         }
+
+        beginTest ("Round-tripping sample data");
+
+        const int bitDepths[] = { 16, 24, 32 };
+
+        for (int i = 0; i < numElementsInArray (bitDepths); ++i)
+            checkRoundTrip (format, bitDepths[i]);
+
+        beginTest ("Memory-mapped float data");
+        checkMappedFloatData (format);
+    }
+
+    // Reads a float file through a small sliding window and checks it against what was written
+    void checkMappedFloatData (WavAudioFormat& format)
+    {
+        const int numSamples = 100000;
+        AudioSampleBuffer original (numTestAudioBufferChannels, numSamples);
+        Random r (1234);
+
+        for (int chan = 0; chan < numTestAudioBufferChannels; ++chan)
+            for (int i = 0; i < numSamples; ++i)
+                original.setSample (chan, i, r.nextFloat() * 2.0f - 1.0f);
+
+        TemporaryFile floatFile (".wav"), intFile (".wav");
+        writeTestFile (format, floatFile.getFile(), original, 32);
+        writeTestFile (format, intFile.getFile(), original, 16);
+
+        {
+            ScopedPointer<MemoryMappedAudioFormatReader> reader (format.createMemoryMappedReader (floatFile.getFile()));
+            expect (reader != nullptr);
+            expect (reader->canReadMappedFloatData());
+
+            const int64 windowSize = 4096;
+            reader->setSlidingWindowSize (windowSize);
+            reader->setAccessPattern (MemoryMappedFile::randomAccess);
+
+            const int64 starts[] = { 0, 70000, 5000, numSamples - 1000 };
+
+            for (int i = 0; i < numElementsInArray (starts); ++i)
+            {
+                const Range<int64> range (starts[i], starts[i] + 1000);
+                const MemoryMappedAudioFormatReader::MappedFloatData block (reader->getMappedFloatData (range));
+
+                expect (block.data != nullptr);
+                expect (block.startSample == range.getStart() && block.numSamples == range.getLength());
+                expect (reader->getMappedSection().contains (range));
+                expect (reader->getMappedSection().getLength() <= windowSize + 1024); // (the start gets rounded down to a page boundary)
+
+                bool allSame = true;
+
+                for (int chan = 0; chan < numTestAudioBufferChannels; ++chan)
+                    for (int n = 0; n < (int) block.numSamples; ++n)
+                        allSame = allSame && block.getSample (chan, n) == original.getSample (chan, (int) block.startSample + n);
+
+                expect (allSame);
+
+                reader->prefetch (range);
+                reader->evict (range);
+            }
+
+            AudioSampleBuffer buffer (numTestAudioBufferChannels, 500);
+            reader->read (&buffer, 0, 500, 40000, true, true);
+            expect (reader->getMappedSection().contains (Range<int64> (40000, 40500)));
+            expect (buffer.getSample (1, 123) == original.getSample (1, 40123));
+
+            reader->setSlidingWindowSize (0);
+            const MemoryMappedAudioFormatReader::MappedFloatData clipped (reader->getMappedFloatData (Range<int64> (0, numSamples)));
+            expect (clipped.data != nullptr && reader->getMappedSection() == Range<int64> (clipped.startSample, clipped.startSample + clipped.numSamples));
+        }
+
+        {
+            ScopedPointer<MemoryMappedAudioFormatReader> reader (format.createMemoryMappedReader (intFile.getFile()));
+            expect (reader != nullptr);
+            expect (! reader->canReadMappedFloatData());
+            expect (reader->mapEntireFile());
+            expect (reader->getMappedFloatData (Range<int64> (0, 100)).data == nullptr);
+        }
+    }
+
+    void writeTestFile (WavAudioFormat& format, const File& file, const AudioSampleBuffer& source, int bitDepth)
+    {
+        ScopedPointer<AudioFormatWriter> writer (format.createWriterFor (file.createOutputStream(), 44100.0,
+                                                                         (unsigned int) source.getNumChannels(),
+                                                                         bitDepth, StringPairArray(), 0));
+        expect (writer != nullptr);
+        expect (writer->writeFromAudioSampleBuffer (source, 0, source.getNumSamples()));
+    }
+
+    // Writes some audio and reads it back, both as floats and via the fixed-point path
+    void checkRoundTrip (WavAudioFormat& format, int bitDepth)
+    {
+        const int numSamples = 3001;
+        AudioSampleBuffer original (numTestAudioBufferChannels, numSamples);
+        Random r (bitDepth);
+
+        for (int chan = 0; chan < numTestAudioBufferChannels; ++chan)
+            for (int i = 0; i < numSamples; ++i)
+                original.setSample (chan, i, r.nextFloat() * 1.8f - 0.9f);
+
+        MemoryBlock memoryBlock;
+
+        {
+            ScopedPointer<AudioFormatWriter> writer (format.createWriterFor (new MemoryOutputStream (memoryBlock, false),
+                                                                             44100.0, numTestAudioBufferChannels,
+                                                                             bitDepth, StringPairArray(), 0));
+            expect (writer != nullptr);
+            expect (writer->writeFromAudioSampleBuffer (original, 0, numSamples));
+        }
+
+        ScopedPointer<AudioFormatReader> reader (format.createReaderFor (new MemoryInputStream (memoryBlock, false), false));
+        expect (reader != nullptr);
+        expectEquals ((int) reader->lengthInSamples, numSamples);
+
+        AudioSampleBuffer asFloats (numTestAudioBufferChannels, numSamples), viaInts (numTestAudioBufferChannels, numSamples);
+        reader->read (&asFloats, 0, numSamples, 0, true, true);
+        expect (reader->read (reinterpret_cast<int* const*> (viaInts.getArrayOfWritePointers()),
+                              numTestAudioBufferChannels, 0, numSamples, false));
+
+        const double errorMargin = 1.0 / (double) (1 << (jmin (bitDepth, 24) - 1)) + 1.0e-7;
+        double biggestError = 0, biggestDifference = 0;
+
+        for (int chan = 0; chan < numTestAudioBufferChannels; ++chan)
+        {
+            if (! reader->usesFloatingPointData)
+                FloatVectorOperations::convertFixedToFloat (viaInts.getWritePointer (chan),
+                                                            reinterpret_cast<const int*> (viaInts.getReadPointer (chan)),
+                                                            1.0f / 0x7fffffff, numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                biggestError = jmax (biggestError, std::abs ((double) asFloats.getSample (chan, i) - original.getSample (chan, i)));
+                biggestDifference = jmax (biggestDifference, std::abs ((double) asFloats.getSample (chan, i) - viaInts.getSample (chan, i)));
+            }
+        }
+
+        expect (biggestError <= errorMargin);
+        expect (biggestDifference <= 1.0e-7);
     }
 
 private:
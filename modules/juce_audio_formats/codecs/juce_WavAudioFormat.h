@@ -180,6 +180,7 @@ public:
     Array<int> getPossibleBitDepths() override;
     bool canDoStereo() override;
     bool canDoMono() override;
+    bool hasSampleAccurateSeeking() override;
 
     //==============================================================================
     AudioFormatReader* createReaderFor (InputStream* sourceStream,
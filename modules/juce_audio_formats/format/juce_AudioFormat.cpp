@@ -50,6 +50,7 @@ bool AudioFormat::canHandleFile (const File& f)
 const String& AudioFormat::getFormatName() const                { return formatName; }
 const StringArray& AudioFormat::getFileExtensions() const       { return fileExtensions; }
 bool AudioFormat::isCompressed()                                { return false; }
+bool AudioFormat::hasSampleAccurateSeeking()                    { return false; }
 StringArray AudioFormat::getQualityOptions()                    { return {}; }
 
 MemoryMappedAudioFormatReader* AudioFormat::createMemoryMappedReader (const File&)
@@ -80,6 +80,16 @@ public:
     /** Returns true if the format uses compressed data. */
     virtual bool isCompressed();
 
+    /** Returns true if this format's readers can start reading at any sample position
+        and produce exactly the same data as they would have done when reading the
+        stream from the beginning.
+
+        This is what lets AudioFormatManager::decodeFileInParallel() split a file into
+        independently-decoded sections. The default implementation returns false, so
+        a format has to override it to opt in.
+    */
+    virtual bool hasSampleAccurateSeeking();
+
     /** Returns a list of different qualities that can be used when writing.
 
         Non-compressed formats will just return an empty array, but for something
@@ -129,6 +129,13 @@ String AudioFormatManager::getWildcardForAllFormats() const
 
 //==============================================================================
 AudioFormatReader* AudioFormatManager::createReaderFor (const File& file)
+{
+    ScopedPointer<AudioFormatReader> reader;
+    findFormatThatCanOpen (file, reader);
+    return reader.release();
+}
+
+AudioFormat* AudioFormatManager::findFormatThatCanOpen (const File& file, ScopedPointer<AudioFormatReader>& reader) const
 {
     // you need to actually register some formats before the manager can
     // use them to open a file!
@@ -139,9 +146,15 @@ AudioFormatReader* AudioFormatManager::createReaderFor (const File& file)
         AudioFormat* const af = getKnownFormat(i);
 
         if (af->canHandleFile (file))
+        {
             if (InputStream* const in = file.createInputStream())
-                if (AudioFormatReader* const r = af->createReaderFor (in, true))
-                    return r;
+            {
+                reader = af->createReaderFor (in, true);
+
+                if (reader != nullptr)
+                    return af;
+            }
+        }
     }
 
     return nullptr;
@@ -177,3 +190,225 @@ AudioFormatReader* AudioFormatManager::createReaderFor (InputStream* audioFileSt
 
     return nullptr;
 }
+
+//==============================================================================
+struct AudioFormatManager::ParallelDecodeJob  : public ThreadPoolJob
+{
+    ParallelDecodeJob (AudioFormat& f, const File& fileToRead, float* const* dest, int numDestChannels,
+                       int64 start, int num)
+        : ThreadPoolJob ("Audio decoder"), format (f), file (fileToRead),
+          buffer (dest, numDestChannels, num), startSample (start)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        if (FileInputStream* const in = file.createInputStream())
+        {
+            ScopedPointer<AudioFormatReader> reader (format.createReaderFor (in, true));
+
+            if (reader != nullptr)
+            {
+                decode (*reader, buffer, startSample);
+                succeeded = true;
+            }
+        }
+
+        return jobHasFinished;
+    }
+
+    static void decode (AudioFormatReader& reader, AudioBuffer<float>& dest, int64 start)
+    {
+        const int numSamples = dest.getNumSamples();
+        const int numAvailable = (int) jlimit ((int64) 0, (int64) numSamples, reader.lengthInSamples - start);
+
+        reader.read (&dest, 0, numAvailable, start, true, true);
+        dest.clear (numAvailable, numSamples - numAvailable);
+    }
+
+    AudioFormat& format;
+    const File file;
+    AudioBuffer<float> buffer;
+    const int64 startSample;
+    bool succeeded = false;
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelDecodeJob)
+};
+
+bool AudioFormatManager::decodeFileInParallel (const File& file,
+                                               float* const* destChannels, const int numDestChannels,
+                                               const int64 startSampleInFile, const int numSamples,
+                                               ThreadPool& threadPool, const int minimumSamplesPerSegment)
+{
+    jassert (destChannels != nullptr && numDestChannels > 0 && numSamples >= 0);
+
+    ScopedPointer<AudioFormatReader> reader;
+    AudioFormat* const format = findFormatThatCanOpen (file, reader);
+
+    if (format == nullptr)
+        return false;
+
+    // Segments start on multiples of this in the file, so that a FLAC seek lands on the
+    // start of a frame rather than having to decode and discard part of one
+    const int segmentAlignment = 4096;
+    Array<int64> segmentStarts;
+    segmentStarts.add (startSampleInFile);
+
+    if (format->hasSampleAccurateSeeking() && threadPool.getNumThreads() > 1)
+    {
+        const int numSegments = jmin (threadPool.getNumThreads() * 2,
+                                      numSamples / jmax (segmentAlignment, minimumSamplesPerSegment));
+
+        for (int i = 1; i < numSegments; ++i)
+        {
+            const int64 pos = startSampleInFile + (numSamples * (int64) i) / numSegments;
+            const int64 alignedPos = pos - (pos % segmentAlignment);
+
+            if (alignedPos > segmentStarts.getLast())
+                segmentStarts.add (alignedPos);
+        }
+    }
+
+    segmentStarts.add (startSampleInFile + numSamples);
+
+    HeapBlock<float*> channels ((size_t) numDestChannels);
+    OwnedArray<ParallelDecodeJob> jobs;
+
+    for (int i = 1; i < segmentStarts.size() - 1; ++i)
+    {
+        const int offset = (int) (segmentStarts.getUnchecked (i) - startSampleInFile);
+
+        for (int chan = 0; chan < numDestChannels; ++chan)
+            channels[chan] = destChannels[chan] + offset;
+
+        ParallelDecodeJob* const job = new ParallelDecodeJob (*format, file, channels, numDestChannels,
+                                                              segmentStarts.getUnchecked (i),
+                                                              (int) (segmentStarts.getUnchecked (i + 1) - segmentStarts.getUnchecked (i)));
+        jobs.add (job);
+        threadPool.addJob (job, false);
+    }
+
+    // The first segment is decoded here using the reader we've already opened,
+    // while the pool gets on with the rest
+    {
+        AudioBuffer<float> firstSegment (destChannels, numDestChannels,
+                                         (int) (segmentStarts.getUnchecked (1) - startSampleInFile));
+        ParallelDecodeJob::decode (*reader, firstSegment, startSampleInFile);
+    }
+
+    bool ok = true;
+
+    for (int i = 0; i < jobs.size(); ++i)
+    {
+        threadPool.waitForJobToFinish (jobs.getUnchecked (i), -1);
+        ok = ok && jobs.getUnchecked (i)->succeeded;
+    }
+
+    return ok;
+}
+
+bool AudioFormatManager::decodeFileInParallel (const File& file, AudioBuffer<float>& destBuffer,
+                                               ThreadPool& threadPool, const int minimumSamplesPerSegment)
+{
+    ScopedPointer<AudioFormatReader> reader (createReaderFor (file));
+
+    if (reader == nullptr || reader->lengthInSamples > std::numeric_limits<int>::max())
+        return false;
+
+    destBuffer.setSize ((int) reader->numChannels, (int) reader->lengthInSamples);
+    reader = nullptr;
+
+    return decodeFileInParallel (file, destBuffer.getArrayOfWritePointers(), destBuffer.getNumChannels(),
+                                 0, destBuffer.getNumSamples(), threadPool, minimumSamplesPerSegment);
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioFormatManagerTests  : public UnitTest
+{
+public:
+    AudioFormatManagerTests() : UnitTest ("AudioFormatManager") {}
+
+    static void writeTestFile (AudioFormat& format, const File& file, int numSamples)
+    {
+        AudioSampleBuffer buffer (2, numSamples);
+        Random r (0x1234);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            buffer.setSample (0, i, 0.5f * std::sin (i * 0.01f) + 0.1f * (r.nextFloat() - 0.5f));
+            buffer.setSample (1, i, 0.3f * std::sin (i * 0.0037f));
+        }
+
+        ScopedPointer<AudioFormatWriter> writer (format.createWriterFor (file.createOutputStream(), 44100.0,
+                                                                         2, 16, StringPairArray(), 0));
+        writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+    }
+
+    void checkFormat (AudioFormatManager& manager, AudioFormat& format, ThreadPool& pool)
+    {
+        // otherwise the file would just be decoded in one go
+        expect (format.hasSampleAccurateSeeking());
+
+        const int numSamples = 200000;
+        TemporaryFile tempFile (format.getFileExtensions()[0]);
+        writeTestFile (format, tempFile.getFile(), numSamples);
+
+        AudioSampleBuffer expected (2, numSamples);
+        {
+            ScopedPointer<AudioFormatReader> reader (manager.createReaderFor (tempFile.getFile()));
+            expect (reader != nullptr);
+            reader->read (&expected, 0, numSamples, 0, true, true);
+        }
+
+        AudioSampleBuffer whole;
+        expect (manager.decodeFileInParallel (tempFile.getFile(), whole, pool, 8192));
+        expectEquals (whole.getNumSamples(), numSamples);
+        expect (buffersMatch (whole, 0, expected, 0, numSamples));
+
+        // an unaligned section that runs off the end of the file
+        const int sectionStart = 12345, sectionLength = numSamples;
+        AudioSampleBuffer section (2, sectionLength);
+        section.clear();
+        expect (manager.decodeFileInParallel (tempFile.getFile(), section.getArrayOfWritePointers(), 2,
+                                              sectionStart, sectionLength, pool, 8192));
+        expect (buffersMatch (section, 0, expected, sectionStart, numSamples - sectionStart));
+        expectEquals (section.getMagnitude (numSamples - sectionStart, sectionStart), 0.0f);
+    }
+
+    static bool buffersMatch (const AudioSampleBuffer& a, int startA,
+                              const AudioSampleBuffer& b, int startB, int num)
+    {
+        for (int chan = 0; chan < 2; ++chan)
+            for (int i = 0; i < num; ++i)
+                if (a.getSample (chan, startA + i) != b.getSample (chan, startB + i))
+                    return false;
+
+        return true;
+    }
+
+    void runTest() override
+    {
+        AudioFormatManager manager;
+        manager.registerBasicFormats();
+        ThreadPool pool (4);
+
+        beginTest ("Parallel decoding of WAV");
+        checkFormat (manager, *manager.findFormatForFileExtension ("wav"), pool);
+
+       #if JUCE_USE_FLAC
+        beginTest ("Parallel decoding of FLAC");
+        checkFormat (manager, *manager.findFormatForFileExtension ("flac"), pool);
+       #endif
+
+       #if JUCE_USE_OGGVORBIS
+        beginTest ("Parallel decoding of Ogg Vorbis");
+        checkFormat (manager, *manager.findFormatForFileExtension ("ogg"), pool);
+       #endif
+    }
+};
+
+static AudioFormatManagerTests audioFormatManagerTests;
+
+#endif
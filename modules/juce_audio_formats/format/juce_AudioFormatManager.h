@@ -132,10 +132,51 @@ public:
     */
     AudioFormatReader* createReaderFor (InputStream* audioFileStream);
 
+    //==============================================================================
+    /** Decodes a section of a file into some float channels, splitting the work
+        across the threads of a ThreadPool.
+
+        The section is divided into segments of at least minimumSamplesPerSegment
+        samples, aligned to multiples of 4096 samples in the file (which is also where
+        FLAC encoders normally put their frame boundaries), and each segment is decoded
+        by a job on the pool using its own reader. Formats whose readers can't seek
+        with sample accuracy (see AudioFormat::hasSampleAccurateSeeking()) are decoded
+        on the calling thread in one go instead.
+
+        The destination pointers can point anywhere that's big enough to hold
+        numSamples samples, e.g. into a memory-mapped file. If the file has fewer
+        channels than numDestChannels, the extra channels get copies of the last
+        one; any part of the section that lies beyond the end of the file is cleared.
+
+        This method blocks until all the segments have been decoded, and returns
+        false if the file couldn't be opened by any of the registered formats.
+    */
+    bool decodeFileInParallel (const File& audioFile,
+                               float* const* destChannels, int numDestChannels,
+                               int64 startSampleInFile, int numSamples,
+                               ThreadPool& threadPool,
+                               int minimumSamplesPerSegment = 1 << 18);
+
+    /** Decodes the whole of a file into an AudioBuffer, splitting the work across the
+        threads of a ThreadPool.
+
+        The buffer is resized to fit the file's channels and length, and then filled
+        using the other version of decodeFileInParallel(). Returns false if the file
+        couldn't be opened, or is too long to fit into an AudioBuffer.
+    */
+    bool decodeFileInParallel (const File& audioFile,
+                               AudioBuffer<float>& destBuffer,
+                               ThreadPool& threadPool,
+                               int minimumSamplesPerSegment = 1 << 18);
+
 private:
     //==============================================================================
     OwnedArray<AudioFormat> knownFormats;
     int defaultFormatIndex;
 
+    struct ParallelDecodeJob;
+
+    AudioFormat* findFormatThatCanOpen (const File&, ScopedPointer<AudioFormatReader>&) const;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFormatManager)
 };
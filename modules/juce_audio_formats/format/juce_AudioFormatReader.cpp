@@ -40,79 +40,119 @@ AudioFormatReader::~AudioFormatReader()
     delete input;
 }
 
-bool AudioFormatReader::read (int* const* destSamples,
-                              int numDestChannels,
-                              int64 startSampleInSource,
-                              int numSamplesToRead,
-                              const bool fillLeftoverChannelsWithCopies)
+//==============================================================================
+namespace AudioFormatReaderHelpers
 {
-    jassert (numDestChannels > 0); // you have to actually give this some channels to work with!
+    // Does the work of both versions of read(), around a function that calls either
+    // readSamples() or readSamplesAsFloat()
+    template <typename SampleType, typename ReadFunction>
+    static bool readWithPadding (SampleType* const* destSamples, int numDestChannels, int numChannels,
+                                 int64 startSampleInSource, int numSamplesToRead,
+                                 bool fillLeftoverChannelsWithCopies, ReadFunction readSamples)
+    {
+        jassert (numDestChannels > 0); // you have to actually give this some channels to work with!
 
-    const size_t originalNumSamplesToRead = (size_t) numSamplesToRead;
-    int startOffsetInDestBuffer = 0;
+        const size_t originalNumSamplesToRead = (size_t) numSamplesToRead;
+        int startOffsetInDestBuffer = 0;
 
-    if (startSampleInSource < 0)
-    {
-        const int silence = (int) jmin (-startSampleInSource, (int64) numSamplesToRead);
+        if (startSampleInSource < 0)
+        {
+            const int silence = (int) jmin (-startSampleInSource, (int64) numSamplesToRead);
 
-        for (int i = numDestChannels; --i >= 0;)
-            if (destSamples[i] != nullptr)
-                zeromem (destSamples[i], sizeof (int) * (size_t) silence);
+            for (int i = numDestChannels; --i >= 0;)
+                if (destSamples[i] != nullptr)
+                    zeromem (destSamples[i], sizeof (SampleType) * (size_t) silence);
 
-        startOffsetInDestBuffer += silence;
-        numSamplesToRead -= silence;
-        startSampleInSource = 0;
-    }
+            startOffsetInDestBuffer += silence;
+            numSamplesToRead -= silence;
+            startSampleInSource = 0;
+        }
 
-    if (numSamplesToRead <= 0)
-        return true;
+        if (numSamplesToRead <= 0)
+            return true;
 
-    if (! readSamples (const_cast<int**> (destSamples),
-                       jmin ((int) numChannels, numDestChannels), startOffsetInDestBuffer,
-                       startSampleInSource, numSamplesToRead))
-        return false;
+        if (! readSamples (const_cast<SampleType**> (destSamples),
+                           jmin (numChannels, numDestChannels), startOffsetInDestBuffer,
+                           startSampleInSource, numSamplesToRead))
+            return false;
 
-    if (numDestChannels > (int) numChannels)
-    {
-        if (fillLeftoverChannelsWithCopies)
+        if (numDestChannels > numChannels)
         {
-            int* lastFullChannel = destSamples[0];
-
-            for (int i = (int) numChannels; --i > 0;)
+            if (fillLeftoverChannelsWithCopies)
             {
-                if (destSamples[i] != nullptr)
+                SampleType* lastFullChannel = destSamples[0];
+
+                for (int i = numChannels; --i > 0;)
                 {
-                    lastFullChannel = destSamples[i];
-                    break;
+                    if (destSamples[i] != nullptr)
+                    {
+                        lastFullChannel = destSamples[i];
+                        break;
+                    }
                 }
-            }
 
-            if (lastFullChannel != nullptr)
-                for (int i = (int) numChannels; i < numDestChannels; ++i)
+                if (lastFullChannel != nullptr)
+                    for (int i = numChannels; i < numDestChannels; ++i)
+                        if (destSamples[i] != nullptr)
+                            memcpy (destSamples[i], lastFullChannel, sizeof (SampleType) * originalNumSamplesToRead);
+            }
+            else
+            {
+                for (int i = numChannels; i < numDestChannels; ++i)
                     if (destSamples[i] != nullptr)
-                        memcpy (destSamples[i], lastFullChannel, sizeof (int) * originalNumSamplesToRead);
-        }
-        else
-        {
-            for (int i = (int) numChannels; i < numDestChannels; ++i)
-                if (destSamples[i] != nullptr)
-                    zeromem (destSamples[i], sizeof (int) * originalNumSamplesToRead);
+                        zeromem (destSamples[i], sizeof (SampleType) * originalNumSamplesToRead);
+            }
         }
+
+        return true;
     }
+}
+
+bool AudioFormatReader::read (int* const* destSamples,
+                              int numDestChannels,
+                              int64 startSampleInSource,
+                              int numSamplesToRead,
+                              const bool fillLeftoverChannelsWithCopies)
+{
+    return AudioFormatReaderHelpers::readWithPadding (destSamples, numDestChannels, (int) numChannels,
+                                                      startSampleInSource, numSamplesToRead, fillLeftoverChannelsWithCopies,
+                                                      [this] (int** dest, int numDest, int offset, int64 start, int num)
+                                                      {
+                                                          return readSamples (dest, numDest, offset, start, num);
+                                                      });
+}
+
+bool AudioFormatReader::readSamplesAsFloat (float** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                                            int64 startSampleInFile, int numSamples)
+{
+    if (! readSamples (reinterpret_cast<int**> (destSamples), numDestChannels, startOffsetInDestBuffer,
+                       startSampleInFile, numSamples))
+        return false;
+
+    if (! usesFloatingPointData)
+        for (int i = 0; i < numDestChannels; ++i)
+            if (float* const d = destSamples[i] != nullptr ? destSamples[i] + startOffsetInDestBuffer : nullptr)
+                FloatVectorOperations::convertFixedToFloat (d, reinterpret_cast<const int*> (d), 1.0f / 0x7fffffff, numSamples);
 
     return true;
 }
 
 static void readChannels (AudioFormatReader& reader,
-                          int** const chans, AudioSampleBuffer* const buffer,
+                          float** const chans, AudioSampleBuffer* const buffer,
                           const int startSample, const int numSamples,
                           const int64 readerStartSample, const int numTargetChannels)
 {
     for (int j = 0; j < numTargetChannels; ++j)
-        chans[j] = reinterpret_cast<int*> (buffer->getWritePointer (j, startSample));
+        chans[j] = buffer->getWritePointer (j, startSample);
 
     chans[numTargetChannels] = nullptr;
-    reader.read (chans, numTargetChannels, readerStartSample, numSamples, true);
+
+    AudioFormatReaderHelpers::readWithPadding (chans, numTargetChannels, (int) reader.numChannels,
+                                               readerStartSample, numSamples, true,
+                                               [&reader] (float** dest, int numDest, int offset, int64 start, int num)
+                                               {
+                                                   return reader.readSamplesAsFloat (dest, numDest, offset, start, num);
+                                               });
 }
 
 void AudioFormatReader::read (AudioSampleBuffer* buffer,
@@ -131,9 +171,9 @@ void AudioFormatReader::read (AudioSampleBuffer* buffer,
 
         if (numTargetChannels <= 2)
         {
-            int* const dest0 = reinterpret_cast<int*> (buffer->getWritePointer (0, startSample));
-            int* const dest1 = reinterpret_cast<int*> (numTargetChannels > 1 ? buffer->getWritePointer (1, startSample) : nullptr);
-            int* chans[3];
+            float* const dest0 = buffer->getWritePointer (0, startSample);
+            float* const dest1 = numTargetChannels > 1 ? buffer->getWritePointer (1, startSample) : nullptr;
+            float* chans[3];
 
             if (useReaderLeftChan == useReaderRightChan)
             {
@@ -152,7 +192,12 @@ void AudioFormatReader::read (AudioSampleBuffer* buffer,
             }
 
             chans[2] = nullptr;
-            read (chans, 2, readerStartSample, numSamples, true);
+
+            AudioFormatReaderHelpers::readWithPadding (chans, 2, (int) numChannels, readerStartSample, numSamples, true,
+                                                       [this] (float** dest, int numDest, int offset, int64 start, int num)
+                                                       {
+                                                           return readSamplesAsFloat (dest, numDest, offset, start, num);
+                                                       });
 
             // if the target's stereo and the source is mono, dupe the first channel..
             if (numTargetChannels > 1 && (chans[0] == nullptr || chans[1] == nullptr))
@@ -160,19 +205,14 @@ void AudioFormatReader::read (AudioSampleBuffer* buffer,
         }
         else if (numTargetChannels <= 64)
         {
-            int* chans[65];
+            float* chans[65];
             readChannels (*this, chans, buffer, startSample, numSamples, readerStartSample, numTargetChannels);
         }
         else
         {
-            HeapBlock<int*> chans ((size_t) numTargetChannels + 1);
+            HeapBlock<float*> chans ((size_t) numTargetChannels + 1);
             readChannels (*this, chans, buffer, startSample, numSamples, readerStartSample, numTargetChannels);
         }
-
-        if (! usesFloatingPointData)
-            for (int j = 0; j < numTargetChannels; ++j)
-                if (float* const d = buffer->getWritePointer (j, startSample))
-                    FloatVectorOperations::convertFixedToFloat (d, reinterpret_cast<const int*> (d), 1.0f / 0x7fffffff, numSamples);
     }
 }
 
@@ -369,7 +409,8 @@ int64 AudioFormatReader::searchForLevel (int64 startSample,
 MemoryMappedAudioFormatReader::MemoryMappedAudioFormatReader (const File& f, const AudioFormatReader& reader,
                                                               int64 start, int64 length, int frameSize)
     : AudioFormatReader (nullptr, reader.getFormatName()), file (f),
-      dataChunkStart (start), dataLength (length), bytesPerFrame (frameSize)
+      dataChunkStart (start), dataLength (length), bytesPerFrame (frameSize), hasNativeFloatData (false),
+      slidingWindowSize (0), accessPattern (MemoryMappedFile::normalAccess)
 {
     sampleRate      = reader.sampleRate;
     bitsPerSample   = reader.bitsPerSample;
@@ -396,15 +437,91 @@ bool MemoryMappedAudioFormatReader::mapSectionOfFile (Range<int64> samplesToMap)
         map = new MemoryMappedFile (file, fileRange, MemoryMappedFile::readOnly);
 
         if (map->getData() == nullptr)
+        {
             map = nullptr;
+        }
         else
+        {
             mappedSection = Range<int64> (jmax ((int64) 0, filePosToSample (map->getRange().getStart() + (bytesPerFrame - 1))),
                                           jmin (lengthInSamples, filePosToSample (map->getRange().getEnd())));
+
+            if (accessPattern != MemoryMappedFile::normalAccess)
+                map->setAccessPattern (accessPattern);
+        }
     }
 
     return map != nullptr;
 }
 
+void MemoryMappedAudioFormatReader::setSlidingWindowSize (int64 numSamplesToKeepMapped) noexcept
+{
+    slidingWindowSize = jmax ((int64) 0, numSamplesToKeepMapped);
+}
+
+bool MemoryMappedAudioFormatReader::ensureMapped (Range<int64> samples)
+{
+    if (map != nullptr && mappedSection.contains (samples))
+        return true;
+
+    if (slidingWindowSize <= 0 || samples.getStart() < 0 || samples.getEnd() > lengthInSamples)
+        return false;
+
+    // The window starts a little before the samples that are needed, so that reading slightly
+    // backwards (e.g. to interpolate) doesn't immediately move it again
+    const int64 start = jmax ((int64) 0, samples.getStart() - slidingWindowSize / 8);
+    const int64 end = jmin (lengthInSamples, jmax (samples.getEnd(), start + slidingWindowSize));
+
+    return mapSectionOfFile (Range<int64> (start, end)) && mappedSection.contains (samples);
+}
+
+void MemoryMappedAudioFormatReader::setAccessPattern (MemoryMappedFile::AccessPattern pattern) noexcept
+{
+    accessPattern = pattern;
+
+    if (map != nullptr)
+        map->setAccessPattern (pattern);
+}
+
+void MemoryMappedAudioFormatReader::prefetch (Range<int64> samples) const noexcept
+{
+    if (map != nullptr)
+        map->prefetch (Range<int64> (sampleToFilePos (samples.getStart()), sampleToFilePos (samples.getEnd())));
+}
+
+void MemoryMappedAudioFormatReader::evict (Range<int64> samples) const noexcept
+{
+    if (map != nullptr)
+        map->evict (Range<int64> (sampleToFilePos (samples.getStart()), sampleToFilePos (samples.getEnd())));
+}
+
+bool MemoryMappedAudioFormatReader::canReadMappedFloatData() const noexcept
+{
+    // (the mapping always starts on a page boundary, so the samples are aligned if the data chunk is)
+    return hasNativeFloatData && (dataChunkStart % (int64) sizeof (float)) == 0;
+}
+
+MemoryMappedAudioFormatReader::MappedFloatData MemoryMappedAudioFormatReader::getMappedFloatData (Range<int64> samples)
+{
+    MappedFloatData result = { nullptr, (int) numChannels, samples.getStart(), 0 };
+
+    if (! canReadMappedFloatData())
+        return result;
+
+    samples = samples.getIntersectionWith (Range<int64> (0, lengthInSamples));
+
+    if (! ensureMapped (samples))
+        samples = samples.getIntersectionWith (mappedSection);
+
+    if (map != nullptr && ! samples.isEmpty())
+    {
+        result.data = static_cast<const float*> (sampleToPointer (samples.getStart()));
+        result.startSample = samples.getStart();
+        result.numSamples = samples.getLength();
+    }
+
+    return result;
+}
+
 static int memoryReadDummyVariable; // used to force the compiler not to optimise-away the read operation
 
 void MemoryMappedAudioFormatReader::touchSample (int64 sample) const noexcept
@@ -241,6 +241,21 @@ public:
                               int64 startSampleInFile,
                               int numSamples) = 0;
 
+    /** Performs a low-level read straight into floating-point buffers.
+
+        This takes the same parameters as readSamples(), and is what the version of read()
+        that fills an AudioSampleBuffer uses. The default implementation calls readSamples()
+        and then converts any fixed-point data to floats in place, but formats that can
+        convert their data to floats directly can override it to avoid that second pass.
+
+        Callers should use read() instead of calling this directly.
+    */
+    virtual bool readSamplesAsFloat (float** destSamples,
+                                     int numDestChannels,
+                                     int startOffsetInDestBuffer,
+                                     int64 startSampleInFile,
+                                     int numSamples);
+
 
 protected:
     //==============================================================================
@@ -255,6 +270,21 @@ protected:
         static void read (TargetType* const* destData, int destOffset, int numDestChannels,
                           const void* sourceData, int numSourceChannels, int numSamples) noexcept
         {
+            // The packed formats that AudioDataConverters knows about are converted a whole
+            // block of frames at a time, which is much quicker than going sample-by-sample
+            const int packedFormat = AudioDataConverters::getDataFormat<SourceSampleType, SourceEndianness>();
+            TargetType* destChans[64];
+
+            if (packedFormat >= 0 && numDestChannels <= numElementsInArray (destChans))
+            {
+                for (int i = 0; i < numDestChannels; ++i)
+                    destChans[i] = destData[i] != nullptr ? destData[i] + destOffset : nullptr;
+
+                if (convertPacked ((const DestSampleType*) nullptr, (AudioDataConverters::DataFormat) packedFormat,
+                                   destChans, numDestChannels, sourceData, numSourceChannels, numSamples))
+                    return;
+            }
+
             for (int i = 0; i < numDestChannels; ++i)
             {
                 if (void* targetChan = destData[i])
@@ -269,12 +299,41 @@ protected:
                 }
             }
         }
+
+    private:
+        template <typename TargetType>
+        static bool convertPacked (const AudioData::Float32*, AudioDataConverters::DataFormat format, TargetType* const* dest,
+                                   int numDestChannels, const void* sourceData, int numSourceChannels, int numSamples) noexcept
+        {
+            AudioDataConverters::deinterleaveToFloat (format, sourceData, numSourceChannels,
+                                                      reinterpret_cast<float* const*> (dest), numDestChannels, numSamples);
+            return true;
+        }
+
+        static bool convertPacked (const AudioData::Int32*, AudioDataConverters::DataFormat format, int* const* dest,
+                                   int numDestChannels, const void* sourceData, int numSourceChannels, int numSamples) noexcept
+        {
+            // (converting floats to ints needs clipping, which the block conversions don't do)
+            if (format == AudioDataConverters::float32LE || format == AudioDataConverters::float32BE)
+                return false;
+
+            AudioDataConverters::deinterleaveToInt32 (format, sourceData, numSourceChannels, dest, numDestChannels, numSamples);
+            return true;
+        }
+
+        template <typename TargetType>
+        static bool convertPacked (const void*, AudioDataConverters::DataFormat, TargetType* const*,
+                                   int, const void*, int, int) noexcept
+        {
+            return false;
+        }
     };
 
     /** Used by AudioFormatReader subclasses to clear any parts of the data blocks that lie
         beyond the end of their available length.
     */
-    static void clearSamplesBeyondAvailableLength (int** destSamples, int numDestChannels,
+    template <typename SampleType>
+    static void clearSamplesBeyondAvailableLength (SampleType** destSamples, int numDestChannels,
                                                    int startOffsetInDestBuffer, int64 startSampleInFile,
                                                    int& numSamples, int64 fileLengthInSamples)
     {
@@ -285,7 +344,7 @@ protected:
         {
             for (int i = numDestChannels; --i >= 0;)
                 if (destSamples[i] != nullptr)
-                    zeromem (destSamples[i] + startOffsetInDestBuffer, sizeof (int) * (size_t) numSamples);
+                    zeromem (destSamples[i] + startOffsetInDestBuffer, sizeof (SampleType) * (size_t) numSamples);
 
             numSamples = (int) samplesAvailable;
         }
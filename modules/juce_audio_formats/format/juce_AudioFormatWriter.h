@@ -248,6 +248,28 @@ protected:
         static void write (void* destData, int numDestChannels, const int* const* source,
                            int numSamples, const int sourceOffset = 0) noexcept
         {
+            // The packed formats that AudioDataConverters knows about are converted a whole
+            // block of frames at a time, which is much quicker than going sample-by-sample
+            const int packedFormat = AudioDataConverters::getDataFormat<DestSampleType, DestEndianness>();
+            const int* sourceChans[64];
+
+            if (packedFormat >= 0 && numDestChannels <= numElementsInArray (sourceChans)
+                 && canConvertPacked ((const SourceSampleType*) nullptr, (AudioDataConverters::DataFormat) packedFormat))
+            {
+                // (the source array ends at the first null pointer, and any channels after that are silent)
+                bool reachedEnd = false;
+
+                for (int i = 0; i < numDestChannels; ++i)
+                {
+                    reachedEnd = reachedEnd || source[i] == nullptr;
+                    sourceChans[i] = reachedEnd ? nullptr : source[i] + sourceOffset;
+                }
+
+                AudioDataConverters::interleaveFromInt32 ((AudioDataConverters::DataFormat) packedFormat,
+                                                          sourceChans, numDestChannels, destData, numSamples);
+                return;
+            }
+
             for (int i = 0; i < numDestChannels; ++i)
             {
                 const DestType dest (addBytesToPointer (destData, i * DestType::getBytesPerSample()), numDestChannels);
@@ -263,6 +285,15 @@ protected:
                 }
             }
         }
+
+    private:
+        static bool canConvertPacked (const AudioData::Int32*, AudioDataConverters::DataFormat format) noexcept
+        {
+            // (writing ints into a float format needs scaling, which the block conversions don't do)
+            return format != AudioDataConverters::float32LE && format != AudioDataConverters::float32BE;
+        }
+
+        static bool canConvertPacked (const void*, AudioDataConverters::DataFormat) noexcept    { return false; }
     };
 
 private:
@@ -0,0 +1,473 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+struct AudioReadScheduler::ReadThread  : public Thread
+{
+    ReadThread (AudioReadScheduler& o, int index)
+        : Thread ("Audio read scheduler " + String (index)), owner (o)
+    {
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+            if (! owner.readNextRequest (scratch))
+                owner.workAvailable.wait (50);
+    }
+
+    AudioReadScheduler& owner;
+    AudioSampleBuffer scratch;
+
+    JUCE_DECLARE_NON_COPYABLE (ReadThread)
+};
+
+//==============================================================================
+AudioReadScheduler::AudioReadScheduler (int numThreads, int maxSamples)
+    : maxSamplesPerRead (jmax ((int) PrefetchingAudioReader::samplesPerBlock, maxSamples)),
+      statisticsStartTime (Time::getMillisecondCounterHiRes())
+{
+    for (int i = 0; i < jmax (1, numThreads); ++i)
+    {
+        ReadThread* const t = threads.add (new ReadThread (*this, i + 1));
+        t->startThread (6);
+    }
+}
+
+AudioReadScheduler::~AudioReadScheduler()
+{
+    // all the readers that use this scheduler must be deleted before it is!
+    jassert (readers.size() == 0);
+
+    for (int i = 0; i < threads.size(); ++i)
+        threads.getUnchecked (i)->signalThreadShouldExit();
+
+    for (int i = 0; i < threads.size(); ++i)
+    {
+        workAvailable.signal();
+        threads.getUnchecked (i)->stopThread (4000);
+    }
+}
+
+//==============================================================================
+double AudioReadScheduler::Statistics::getBytesPerSecond() const noexcept
+{
+    return secondsElapsed > 0 ? bytesRead / secondsElapsed : 0.0;
+}
+
+double AudioReadScheduler::Statistics::getDeadlineHitRate() const noexcept
+{
+    return numRequests > 0 ? 1.0 - jmin (numRequests, numDeadlinesMissed) / (double) numRequests : 1.0;
+}
+
+AudioReadScheduler::Statistics AudioReadScheduler::getStatistics() const
+{
+    Statistics stats;
+
+    {
+        const ScopedLock sl (lock);
+        stats.queueDepth = queue.size();
+        stats.numReaders = readers.size();
+    }
+
+    stats.numRequests           = numRequests.get();
+    stats.numReads              = numReads.get();
+    stats.numDeadlinesMissed    = numDeadlinesMissed.get();
+    stats.samplesRead           = samplesRead.get();
+    stats.bytesRead             = bytesRead.get();
+    stats.secondsSpentReading   = Time::highResolutionTicksToSeconds (ticksSpentReading.get());
+    stats.secondsElapsed        = (Time::getMillisecondCounterHiRes() - statisticsStartTime) / 1000.0;
+    return stats;
+}
+
+void AudioReadScheduler::resetStatistics()
+{
+    const ScopedLock sl (lock);
+
+    numRequests = 0;
+    numReads = 0;
+    numDeadlinesMissed = 0;
+    samplesRead = 0;
+    bytesRead = 0;
+    ticksSpentReading = 0;
+    statisticsStartTime = Time::getMillisecondCounterHiRes();
+}
+
+//==============================================================================
+void AudioReadScheduler::addReader (PrefetchingAudioReader* reader)
+{
+    {
+        const ScopedLock sl (lock);
+        readers.add (reader);
+    }
+
+    reader->requestUpdate();
+}
+
+void AudioReadScheduler::removeReader (PrefetchingAudioReader* reader)
+{
+    for (;;)
+    {
+        {
+            const ScopedLock sl (lock);
+
+            // if a thread is reading from it, this has to wait for it to finish
+            if (! reader->isBeingRead)
+            {
+                removeRequestsForReader (reader, false);
+                readers.removeFirstMatchingValue (reader);
+                return;
+            }
+        }
+
+        Thread::sleep (1);
+    }
+}
+
+void AudioReadScheduler::readerNeedsUpdate() noexcept
+{
+    workAvailable.signal();
+}
+
+void AudioReadScheduler::removeRequestsForReader (PrefetchingAudioReader* reader, bool onlyStaleOnes)
+{
+    // the caller must hold the lock
+    const int64 windowStart = reader->nextReadPosition.get() - (reader->nextReadPosition.get() % PrefetchingAudioReader::samplesPerBlock);
+    const int64 windowEnd = windowStart + reader->blocks.size() * (int64) PrefetchingAudioReader::samplesPerBlock;
+
+    for (int i = queue.size(); --i >= 0;)
+    {
+        const Request& r = queue.getReference (i);
+
+        if (r.reader == reader
+             && ! (onlyStaleOnes && r.startSample >= windowStart && r.startSample < windowEnd))
+        {
+            PrefetchingAudioReader::Block& block = *reader->blocks.getUnchecked (r.blockIndex);
+            block.isQueued = false;
+            block.queuedStart = -1;
+            queue.remove (i);
+        }
+    }
+}
+
+void AudioReadScheduler::updateRequests()
+{
+    // the caller must hold the lock
+    typedef PrefetchingAudioReader::Block Block;
+    const int64 blockSize = PrefetchingAudioReader::samplesPerBlock;
+
+    for (int i = 0; i < readers.size(); ++i)
+    {
+        PrefetchingAudioReader& reader = *readers.getUnchecked (i);
+
+        if (! reader.needsUpdate.compareAndSetBool (0, 1))
+            continue;
+
+        // anything queued that's no longer needed is dropped, so that its block can be re-used
+        removeRequestsForReader (&reader, true);
+
+        const int64 position = jmax ((int64) 0, reader.nextReadPosition.get());
+        const int64 windowStart = position - (position % blockSize);
+        const int64 windowEnd = jmin (windowStart + reader.blocks.size() * blockSize, reader.lengthInSamples);
+        const int64 readTicks = reader.lastReadTicks.get();
+
+        for (int64 start = windowStart; start < windowEnd; start += blockSize)
+        {
+            int freeBlock = -1;
+            bool isNeeded = true;
+
+            for (int j = reader.blocks.size(); --j >= 0;)
+            {
+                const Block& b = *reader.blocks.getUnchecked (j);
+                const int64 blockStart = b.isQueued ? b.queuedStart : b.startSample.get();
+
+                if (blockStart == start)
+                {
+                    isNeeded = false;
+                    break;
+                }
+
+                if (freeBlock < 0 && ! b.isQueued && (blockStart < windowStart || blockStart >= windowEnd))
+                    freeBlock = j;
+            }
+
+            if (! isNeeded || freeBlock < 0)
+                continue;
+
+            Block& block = *reader.blocks.getUnchecked (freeBlock);
+            block.isQueued = true;
+            block.queuedStart = start;
+
+            // the deadline is when playback is expected to reach the block
+            Request r;
+            r.reader = &reader;
+            r.blockIndex = freeBlock;
+            r.startSample = start;
+            r.deadline = readTicks + Time::secondsToHighResolutionTicks (jmax ((int64) 0, start - position) / reader.sampleRate);
+
+            queue.add (r);
+            ++numRequests;
+        }
+    }
+}
+
+bool AudioReadScheduler::readNextRequest (AudioSampleBuffer& scratch)
+{
+    typedef PrefetchingAudioReader::Block Block;
+    const int blockSize = PrefetchingAudioReader::samplesPerBlock;
+
+    enum { maxBlocksPerRead = 64 };
+    Request batch[maxBlocksPerRead];
+    int numInBatch = 0;
+
+    const ScopedLock sl (lock);
+
+    updateRequests();
+
+    // take the request with the earliest deadline whose reader isn't already busy..
+    int next = -1;
+
+    for (int i = 0; i < queue.size(); ++i)
+    {
+        const Request& r = queue.getReference (i);
+
+        if (! r.reader->isBeingRead && (next < 0 || r.deadline < queue.getReference (next).deadline))
+            next = i;
+    }
+
+    if (next < 0)
+        return false;
+
+    batch[numInBatch++] = queue.removeAndReturn (next);
+    PrefetchingAudioReader& reader = *batch[0].reader;
+    int64 start = batch[0].startSample, end = start + blockSize;
+
+    // ..and merge in any other requests for the blocks either side of it
+    const int maxBlocks = jmin ((int) maxBlocksPerRead, maxSamplesPerRead / blockSize);
+
+    for (bool foundOne = true; foundOne && numInBatch < maxBlocks;)
+    {
+        foundOne = false;
+
+        for (int i = queue.size(); --i >= 0 && numInBatch < maxBlocks;)
+        {
+            const Request& r = queue.getReference (i);
+
+            if (r.reader == &reader && (r.startSample == end || r.startSample + blockSize == start))
+            {
+                start = jmin (start, r.startSample);
+                end = jmax (end, r.startSample + blockSize);
+                batch[numInBatch++] = queue.removeAndReturn (i);
+                foundOne = true;
+            }
+        }
+    }
+
+    reader.isBeingRead = true;
+
+    for (int i = 0; i < numInBatch; ++i)
+    {
+        Block& block = *reader.blocks.getUnchecked (batch[i].blockIndex);
+        ++block.version;  // now odd, so readSamples() won't use it
+    }
+
+    // if there's more to do, another thread can get started on it
+    if (queue.size() > 0)
+        workAvailable.signal();
+
+    {
+        const ScopedUnlock ul (lock);
+
+        const int numSamples = (int) (end - start);
+        const int numChannels = (int) reader.numChannels;
+
+        if (scratch.getNumChannels() < numChannels || scratch.getNumSamples() < numSamples)
+            scratch.setSize (jmax (numChannels, scratch.getNumChannels()),
+                             jmax (numSamples, scratch.getNumSamples()), false, false, true);
+
+        const int64 startTicks = Time::getHighResolutionTicks();
+        reader.source->read (&scratch, 0, numSamples, start, true, true);
+        const int64 endTicks = Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numInBatch; ++i)
+        {
+            Block& block = *reader.blocks.getUnchecked (batch[i].blockIndex);
+
+            for (int chan = 0; chan < numChannels; ++chan)
+                block.buffer.copyFrom (chan, 0, scratch, chan, (int) (batch[i].startSample - start), blockSize);
+
+            block.startSample = batch[i].startSample;
+            ++block.version;
+
+            if (endTicks > batch[i].deadline)
+                ++numDeadlinesMissed;
+        }
+
+        ++numReads;
+        ticksSpentReading += endTicks - startTicks;
+        samplesRead += numSamples;
+        bytesRead += (int64) numSamples * reader.source->numChannels * (reader.source->bitsPerSample / 8);
+    }
+
+    reader.isBeingRead = false;
+
+    for (int i = 0; i < numInBatch; ++i)
+    {
+        Block& block = *reader.blocks.getUnchecked (batch[i].blockIndex);
+        block.isQueued = false;
+        block.queuedStart = -1;
+    }
+
+    return true;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioReadSchedulerTests  : public UnitTest
+{
+public:
+    AudioReadSchedulerTests() : UnitTest ("AudioReadScheduler") {}
+
+    // Produces a different value for each position and channel, and counts how it's read
+    struct TestReader  : public AudioFormatReader
+    {
+        TestReader (int64 length, int delay)
+            : AudioFormatReader (nullptr, "Test"), readDelayMs (delay)
+        {
+            sampleRate = 44100.0;
+            lengthInSamples = length;
+            numChannels = 2;
+            bitsPerSample = 32;
+            usesFloatingPointData = true;
+        }
+
+        bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                          int64 startSampleInFile, int numSamples) override
+        {
+            clearSamplesBeyondAvailableLength (destSamples, numDestChannels, startOffsetInDestBuffer,
+                                               startSampleInFile, numSamples, lengthInSamples);
+
+            // a reader must never be used by more than one thread at once
+            if (++numThreadsReading != 1)
+                ++numOverlappingReads;
+
+            if (readDelayMs > 0)
+                Thread::sleep (readDelayMs);
+
+            for (int j = 0; j < numDestChannels; ++j)
+                if (float* dest = (float*) destSamples[j])
+                    for (int i = 0; i < numSamples; ++i)
+                        dest[startOffsetInDestBuffer + i] = getExpectedSample (startSampleInFile + i, j);
+
+            ++numReads;
+            --numThreadsReading;
+            return true;
+        }
+
+        static float getExpectedSample (int64 pos, int channel) noexcept
+        {
+            return (float) (pos % 1000) * 0.001f + (float) channel;
+        }
+
+        const int readDelayMs;
+        Atomic<int> numReads, numThreadsReading, numOverlappingReads;
+    };
+
+    void runTest() override
+    {
+        beginTest ("Reading");
+        {
+            AudioReadScheduler scheduler (3);
+            OwnedArray<PrefetchingAudioReader> readers;
+            Array<TestReader*> sources;
+
+            for (int i = 0; i < 20; ++i)
+            {
+                TestReader* const source = new TestReader (200000, 1);
+                sources.add (source);
+                readers.add (new PrefetchingAudioReader (source, scheduler, 65536));
+            }
+
+            AudioSampleBuffer block (2, 1000);
+            bool allCorrect = true;
+
+            for (int64 pos = 0; pos < 150000; pos += block.getNumSamples())
+            {
+                for (int i = 0; i < readers.size(); ++i)
+                {
+                    PrefetchingAudioReader& reader = *readers.getUnchecked (i);
+                    expect (reader.waitUntilReady (pos, block.getNumSamples(), 5000));
+                    reader.read (&block, 0, block.getNumSamples(), pos, true, true);
+
+                    for (int chan = 0; chan < 2; ++chan)
+                        for (int j = 0; j < block.getNumSamples(); ++j)
+                            allCorrect = allCorrect && block.getSample (chan, j) == TestReader::getExpectedSample (pos + j, chan);
+                }
+            }
+
+            expect (allCorrect);
+
+            for (int i = 0; i < readers.size(); ++i)
+            {
+                expect (readers.getUnchecked (i)->getNumSamplesMissed() == 0);
+                expectEquals (sources.getUnchecked (i)->numOverlappingReads.get(), 0);
+            }
+
+            const AudioReadScheduler::Statistics stats (scheduler.getStatistics());
+            expectEquals (stats.numReaders, 20);
+            expect (stats.samplesRead >= 20 * 150000);
+            expect (stats.bytesRead == stats.samplesRead * 8);
+            expect (stats.getBytesPerSecond() > 0);
+
+            // adjacent blocks should have been merged into fewer reads
+            expect (stats.numReads < stats.numRequests);
+        }
+
+        beginTest ("Reads don't block");
+        {
+            AudioReadScheduler scheduler (1);
+            PrefetchingAudioReader reader (new TestReader (200000, 200), scheduler, 32768);
+
+            AudioSampleBuffer block (2, 512);
+            block.clear();
+
+            const uint32 startTime = Time::getMillisecondCounter();
+            reader.read (&block, 0, block.getNumSamples(), 100000, true, true);
+            expect (Time::getMillisecondCounter() - startTime < 100);
+
+            expect (reader.getNumSamplesMissed() == 512);
+            expectEquals (block.getMagnitude (0, block.getNumSamples()), 0.0f);
+
+            expect (reader.waitUntilReady (100000, 512, 5000));
+            expect (reader.isReady (100000, 512));
+        }
+    }
+};
+
+static AudioReadSchedulerTests audioReadSchedulerTests;
+
+#endif
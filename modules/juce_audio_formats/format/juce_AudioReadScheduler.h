@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class PrefetchingAudioReader;
+
+//==============================================================================
+/**
+    Reads blocks of audio for a set of PrefetchingAudioReaders, using a small pool
+    of background threads.
+
+    Rather than each reader having its own thread or time-slice, all the readers that
+    share a scheduler put their requests into one queue. Each request has a deadline,
+    which is when playback is expected to reach it, and the threads always take the
+    request with the earliest deadline next. Requests from the same reader for adjacent
+    blocks are merged into a single read, so that the source readers are asked for
+    larger chunks in order.
+
+    A source reader is only ever used by one thread at a time, but different readers
+    can be read at the same time on different threads.
+
+    @see PrefetchingAudioReader
+*/
+class JUCE_API  AudioReadScheduler
+{
+public:
+    //==============================================================================
+    /** Creates a scheduler and starts its threads.
+
+        @param numThreads           the number of threads that will read from the sources
+        @param maxSamplesPerRead    the largest number of samples that adjacent requests will
+                                    be merged into
+    */
+    explicit AudioReadScheduler (int numThreads = 2, int maxSamplesPerRead = 65536);
+
+    /** Destructor.
+        Any PrefetchingAudioReaders that use this scheduler must be deleted first.
+    */
+    ~AudioReadScheduler();
+
+    /** Returns the number of threads that the scheduler is using. */
+    int getNumThreads() const noexcept                  { return threads.size(); }
+
+    //==============================================================================
+    /** Some figures describing how the scheduler is keeping up. */
+    struct Statistics
+    {
+        int queueDepth;                 /**< The number of requests that are currently waiting to be read. */
+        int numReaders;                 /**< The number of readers using the scheduler. */
+        int64 numRequests;              /**< The number of blocks that have been requested. */
+        int64 numReads;                 /**< The number of reads, after adjacent requests were merged. */
+        int64 numDeadlinesMissed;       /**< The number of blocks that were read after playback needed them. */
+        int64 samplesRead;              /**< The number of samples that have been read. */
+        int64 bytesRead;                /**< The size of the source data that has been read. */
+        double secondsSpentReading;     /**< The total time spent inside the source readers, by all the threads. */
+        double secondsElapsed;          /**< The time since the statistics were reset. */
+
+        /** Returns the rate at which source data has been read, in bytes per second of real time. */
+        double getBytesPerSecond() const noexcept;
+
+        /** Returns the proportion of the requested blocks that were ready before their deadline. */
+        double getDeadlineHitRate() const noexcept;
+    };
+
+    /** Returns the figures since the scheduler was created, or since resetStatistics() was called. */
+    Statistics getStatistics() const;
+
+    /** Sets all the statistics back to zero. */
+    void resetStatistics();
+
+private:
+    //==============================================================================
+    friend class PrefetchingAudioReader;
+
+    struct Request
+    {
+        PrefetchingAudioReader* reader;
+        int blockIndex;
+        int64 startSample;
+        int64 deadline;     // in high-resolution ticks
+    };
+
+    struct ReadThread;
+    friend struct ReadThread;
+
+    OwnedArray<ReadThread> threads;
+    CriticalSection lock;
+    Array<PrefetchingAudioReader*> readers;
+    Array<Request> queue;
+    WaitableEvent workAvailable;
+    const int maxSamplesPerRead;
+
+    Atomic<int64> numRequests, numReads, numDeadlinesMissed, samplesRead, bytesRead, ticksSpentReading;
+    double statisticsStartTime;
+
+    void addReader (PrefetchingAudioReader*);
+    void removeReader (PrefetchingAudioReader*);
+    void readerNeedsUpdate() noexcept;
+    void updateRequests();
+    bool readNextRequest (AudioSampleBuffer& scratch);
+    void removeRequestsForReader (PrefetchingAudioReader*, bool onlyStaleOnes);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioReadScheduler)
+};
@@ -74,12 +74,96 @@ public:
     /** Returns the samples for all channels at a given sample position.
         The result array must be large enough to hold a value for each channel
         that this reader contains.
+
+        Because this is const, it won't move a sliding window (see setSlidingWindowSize()),
+        so the sample must already be inside the mapped section.
     */
     virtual void getSample (int64 sampleIndex, float* result) const noexcept = 0;
 
     /** Returns the number of bytes currently being mapped */
     size_t getNumBytesUsed() const                          { return map != nullptr ? map->getSize() : 0; }
 
+    //==============================================================================
+    /** Makes the reader move its mapped section around the file as needed.
+
+        With a window size set, readSamples(), readMaxLevels() and getMappedFloatData() will
+        re-map the file whenever they're asked for samples outside the current section, so
+        that only about this many samples are mapped at any one time (or more, if a single
+        read needs it). This lets you stream through files that are too big to map in one go
+        without having to call mapSectionOfFile() yourself.
+
+        Passing 0 turns this off, which is the default - reads outside the mapped section
+        will then fail.
+    */
+    void setSlidingWindowSize (int64 numSamplesToKeepMapped) noexcept;
+
+    /** Makes sure that a range of samples is mapped, moving the sliding window if one has been
+        set with setSlidingWindowSize(). Returns false if the samples aren't available.
+    */
+    bool ensureMapped (Range<int64> samples);
+
+    /** Tells the OS how the sample data is going to be read, so that it can choose how
+        much to read ahead. This applies to the current mapping and to any future ones.
+        @see MemoryMappedFile::setAccessPattern
+    */
+    void setAccessPattern (MemoryMappedFile::AccessPattern pattern) noexcept;
+
+    /** Asks the OS to start loading some of the mapped samples into memory in the background. */
+    void prefetch (Range<int64> samples) const noexcept;
+
+    /** Tells the OS that some of the mapped samples won't be needed for a while, so that it can
+        release the memory that's holding them.
+    */
+    void evict (Range<int64> samples) const noexcept;
+
+    //==============================================================================
+    /** A block of sample data that can be read directly from the mapped memory.
+
+        The channels are interleaved, so successive samples of a channel are numChannels
+        floats apart.
+
+        @see getMappedFloatData
+    */
+    struct MappedFloatData
+    {
+        /** The first sample of the first channel, or nullptr if no data is available. */
+        const float* data;
+
+        /** The number of floats between successive samples of a channel. */
+        int numChannels;
+
+        /** The position in the file of the first sample. */
+        int64 startSample;
+
+        /** The number of samples of each channel that can be read. */
+        int64 numSamples;
+
+        /** Returns the first sample of a channel. Step through it by numChannels floats at a time. */
+        const float* getChannelData (int channel) const noexcept        { return data + channel; }
+
+        /** Returns one of the samples in this block. */
+        float getSample (int channel, int64 index) const noexcept       { return data[index * numChannels + channel]; }
+    };
+
+    /** Returns true if getMappedFloatData() can be used with this file. This is only the case
+        when the samples are stored as 32-bit floats in the CPU's native byte order, e.g.
+        32-bit WAV files on Intel and ARM processors.
+    */
+    bool canReadMappedFloatData() const noexcept;
+
+    /** Returns a view directly into the mapped memory for a range of samples, without
+        copying or converting them.
+
+        If canReadMappedFloatData() is false, the data pointer in the result will be null.
+        If a sliding window has been set, this will move it to cover as much of the range
+        as it can; otherwise only the part of the range that's already mapped is returned,
+        so check the startSample and numSamples of the result.
+
+        The pointer stays valid until the mapped section is next changed - i.e. by
+        mapSectionOfFile(), or by a call that moves the sliding window.
+    */
+    MappedFloatData getMappedFloatData (Range<int64> samples);
+
 protected:
     File file;
     Range<int64> mappedSection;
@@ -87,6 +171,12 @@ protected:
     int64 dataChunkStart, dataLength;
     int bytesPerFrame;
 
+    /** Subclasses should set this to true if their sample data is made of 32-bit floats
+        in the CPU's native byte order, so that it can be read in place.
+        @see getMappedFloatData
+    */
+    bool hasNativeFloatData;
+
     /** Converts a sample index to a byte position in the file. */
     inline int64 sampleToFilePos (int64 sample) const noexcept       { return dataChunkStart + sample * bytesPerFrame; }
 
@@ -106,5 +196,9 @@ protected:
                 .findMinAndMax ((size_t) numSamples);
     }
 
+private:
+    int64 slidingWindowSize;
+    MemoryMappedFile::AccessPattern accessPattern;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryMappedAudioFormatReader)
 };
@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+PrefetchingAudioReader::Block::Block (int numChannels)
+    : buffer (numChannels, samplesPerBlock),
+      startSample (-1),
+      queuedStart (-1),
+      isQueued (false)
+{
+}
+
+//==============================================================================
+PrefetchingAudioReader::PrefetchingAudioReader (AudioFormatReader* sourceReader,
+                                                AudioReadScheduler& s,
+                                                int samplesToBuffer)
+    : AudioFormatReader (nullptr, sourceReader->getFormatName()),
+      source (sourceReader), scheduler (s),
+      lastRequestedBlock (-1),
+      isBeingRead (false)
+{
+    sampleRate            = source->sampleRate;
+    lengthInSamples       = source->lengthInSamples;
+    numChannels           = source->numChannels;
+    metadataValues        = source->metadataValues;
+    bitsPerSample         = 32;
+    usesFloatingPointData = true;
+
+    for (int i = jmax (2, 1 + samplesToBuffer / samplesPerBlock); --i >= 0;)
+        blocks.add (new Block ((int) numChannels));
+
+    lastReadTicks = Time::getHighResolutionTicks();
+    scheduler.addReader (this);
+}
+
+PrefetchingAudioReader::~PrefetchingAudioReader()
+{
+    scheduler.removeReader (this);
+}
+
+//==============================================================================
+void PrefetchingAudioReader::prefetch (int64 startSample)
+{
+    nextReadPosition = startSample;
+    lastReadTicks = Time::getHighResolutionTicks();
+    requestUpdate();
+}
+
+bool PrefetchingAudioReader::isReady (int64 startSample, int numSamples) const noexcept
+{
+    const int64 end = jmin (startSample + numSamples, lengthInSamples);
+
+    for (int64 pos = jmax ((int64) 0, startSample); pos < end;)
+    {
+        const int64 blockStart = pos - (pos % samplesPerBlock);
+        int version;
+
+        if (findBlock (blockStart, version) == nullptr)
+            return false;
+
+        pos = blockStart + samplesPerBlock;
+    }
+
+    return true;
+}
+
+bool PrefetchingAudioReader::waitUntilReady (int64 startSample, int numSamples, int timeoutMilliseconds)
+{
+    const uint32 startTime = Time::getMillisecondCounter();
+
+    if (! isReady (startSample, numSamples))
+        prefetch (startSample);
+
+    while (! isReady (startSample, numSamples))
+    {
+        if (timeoutMilliseconds >= 0 && Time::getMillisecondCounter() >= startTime + (uint32) timeoutMilliseconds)
+            return false;
+
+        Thread::sleep (1);
+    }
+
+    return true;
+}
+
+//==============================================================================
+bool PrefetchingAudioReader::readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                                          int64 startSampleInFile, int numSamples)
+{
+    clearSamplesBeyondAvailableLength (destSamples, numDestChannels, startOffsetInDestBuffer,
+                                       startSampleInFile, numSamples, lengthInSamples);
+
+    lastReadTicks = Time::getHighResolutionTicks();
+    nextReadPosition = startSampleInFile + jmax (0, numSamples);
+
+    bool missedAnything = false;
+
+    while (numSamples > 0)
+    {
+        const int64 blockStart = startSampleInFile - (startSampleInFile % samplesPerBlock);
+        const int offset = (int) (startSampleInFile - blockStart);
+        const int numToDo = jmin (numSamples, samplesPerBlock - offset);
+
+        int version;
+        bool wasCopied = false;
+
+        if (const Block* const block = findBlock (blockStart, version))
+        {
+            for (int j = 0; j < numDestChannels; ++j)
+            {
+                if (float* dest = (float*) destSamples[j])
+                {
+                    dest += startOffsetInDestBuffer;
+
+                    if (j < (int) numChannels)
+                        FloatVectorOperations::copy (dest, block->buffer.getReadPointer (j, offset), numToDo);
+                    else
+                        FloatVectorOperations::clear (dest, numToDo);
+                }
+            }
+
+            // if the block was re-used while it was being copied, the data can't be trusted
+            wasCopied = (block->version.get() == version);
+        }
+
+        if (! wasCopied)
+        {
+            for (int j = 0; j < numDestChannels; ++j)
+                if (float* dest = (float*) destSamples[j])
+                    FloatVectorOperations::clear (dest + startOffsetInDestBuffer, numToDo);
+
+            numSamplesMissed += numToDo;
+            missedAnything = true;
+        }
+
+        startOffsetInDestBuffer += numToDo;
+        startSampleInFile += numToDo;
+        numSamples -= numToDo;
+    }
+
+    // the scheduler only needs to hear about it when the read-ahead window has moved
+    const int64 currentBlock = nextReadPosition.get() / samplesPerBlock;
+
+    if (missedAnything || currentBlock != lastRequestedBlock)
+    {
+        lastRequestedBlock = currentBlock;
+        requestUpdate();
+    }
+
+    return true;
+}
+
+const PrefetchingAudioReader::Block* PrefetchingAudioReader::findBlock (int64 blockStart, int& version) const noexcept
+{
+    for (int i = blocks.size(); --i >= 0;)
+    {
+        const Block* const b = blocks.getUnchecked (i);
+        version = b->version.get();
+
+        if ((version & 1) == 0 && b->startSample.get() == blockStart)
+            return b;
+    }
+
+    return nullptr;
+}
+
+void PrefetchingAudioReader::requestUpdate() noexcept
+{
+    needsUpdate = 1;
+    scheduler.readerNeedsUpdate();
+}
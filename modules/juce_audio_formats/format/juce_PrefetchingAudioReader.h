@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+//==============================================================================
+/**
+    An AudioFormatReader that reads ahead from another reader using an
+    AudioReadScheduler, and never blocks while waiting for it.
+
+    The audio is kept in a set of fixed-size blocks covering the region after the
+    position that was last read. Each time readSamples() moves on, the scheduler is asked
+    to fill the blocks that are now needed, with deadlines based on when playback will
+    reach them. If a block isn't ready when readSamples() needs it, that part of the
+    output is filled with silence, and it's counted as a miss.
+
+    readSamples() doesn't take any locks or allocate, so it can be used on the audio
+    thread, but it should only be called by one thread at a time.
+
+    @see AudioReadScheduler, BufferingAudioReader
+*/
+class JUCE_API  PrefetchingAudioReader  : public AudioFormatReader
+{
+public:
+    //==============================================================================
+    /** Creates a reader.
+
+        @param sourceReader     the source reader to wrap. This PrefetchingAudioReader
+                                takes ownership of this object and will delete it later
+                                when no longer needed
+        @param scheduler        the scheduler that will do the reading. This must not be
+                                deleted while the reader object still exists
+        @param samplesToBuffer  the total number of samples to read ahead
+    */
+    PrefetchingAudioReader (AudioFormatReader* sourceReader,
+                            AudioReadScheduler& scheduler,
+                            int samplesToBuffer);
+
+    /** Destructor. */
+    ~PrefetchingAudioReader();
+
+    //==============================================================================
+    /** Starts reading ahead from a position that the next call to readSamples() is
+        expected to start at, e.g. because playback is about to jump there.
+    */
+    void prefetch (int64 startSample);
+
+    /** Returns true if all the samples in the given range have been read, so that
+        readSamples() will be able to return them straight away.
+    */
+    bool isReady (int64 startSample, int numSamples) const noexcept;
+
+    /** Waits until the given range has been read, or until the timeout expires.
+        This can be useful when rendering offline. A timeout of less than 0 means
+        "wait forever".
+        @returns true if the samples are ready
+    */
+    bool waitUntilReady (int64 startSample, int numSamples, int timeoutMilliseconds);
+
+    /** Returns the number of samples that readSamples() has had to fill with silence
+        because they weren't ready in time.
+    */
+    int64 getNumSamplesMissed() const noexcept          { return numSamplesMissed.get(); }
+
+    //==============================================================================
+    bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                      int64 startSampleInFile, int numSamples) override;
+
+private:
+    //==============================================================================
+    friend class AudioReadScheduler;
+
+    enum { samplesPerBlock = 8192 };
+
+    // The scheduler's threads write into the blocks while readSamples() might be reading
+    // them, so each one has a version number which is odd while it's being written.
+    struct Block
+    {
+        Block (int numChannels);
+
+        AudioSampleBuffer buffer;
+        Atomic<int64> startSample;
+        Atomic<int> version;
+
+        // used by the scheduler, while holding its lock
+        int64 queuedStart;
+        bool isQueued;
+    };
+
+    ScopedPointer<AudioFormatReader> source;
+    AudioReadScheduler& scheduler;
+    OwnedArray<Block> blocks;
+    Atomic<int64> nextReadPosition, lastReadTicks, numSamplesMissed;
+    Atomic<int> needsUpdate;
+    int64 lastRequestedBlock;
+    bool isBeingRead;       // only used by the scheduler, while holding its lock
+
+    const Block* findBlock (int64 blockStart, int& version) const noexcept;
+    void requestUpdate() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PrefetchingAudioReader)
+};
@@ -32,12 +32,12 @@
     A subclass of SynthesiserSound that represents a sampled audio clip.
 
     This is a pretty basic sampler, and just attempts to load the whole audio stream
-    into memory.
+    into memory. For samples that are too big for that, see StreamingSamplerSound.
 
     To use it, create a Synthesiser, add some SamplerVoice objects to it, then
     give it some SampledSound objects to play.
 
-    @see SamplerVoice, Synthesiser, SynthesiserSound
+    @see SamplerVoice, Synthesiser, SynthesiserSound, StreamingSamplerSound
 */
 class JUCE_API  SamplerSound    : public SynthesiserSound
 {
@@ -0,0 +1,625 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+struct SampleStreamer::Stream
+{
+    Stream (int ringSize)
+        : ring (2, ringSize), ringMask (ringSize - 1),
+          currentRequestId (0), writePosition (0)
+    {
+        jassert (isPowerOfTwo (ringSize));
+        ring.clear();
+    }
+
+    AudioSampleBuffer ring;
+    const int ringMask;
+
+    // written by the voice, on the audio thread
+    Atomic<StreamingSamplerSound*> requestedSound;
+    Atomic<int> requestId;
+    Atomic<int64> readPosition;
+
+    // written by the streamer, to say how much of the current request is in the ring
+    Atomic<int> dataRequestId;
+    Atomic<int64> validEnd;
+
+    // only used by the streamer
+    SynthesiserSound::Ptr currentSound;
+    int currentRequestId;
+    int64 writePosition;
+
+    JUCE_DECLARE_NON_COPYABLE (Stream)
+};
+
+//==============================================================================
+SampleStreamer::SampleStreamer (TimeSliceThread& thread)
+    : backgroundThread (thread)
+{
+    backgroundThread.addTimeSliceClient (this);
+}
+
+SampleStreamer::~SampleStreamer()
+{
+    // all the voices that use this streamer must be deleted first!
+    jassert (streams.size() == 0);
+
+    backgroundThread.removeTimeSliceClient (this);
+}
+
+void SampleStreamer::addStream (Stream* const s)
+{
+    const ScopedLock sl (streamLock);
+    streams.add (s);
+}
+
+void SampleStreamer::removeStream (Stream* const s)
+{
+    const ScopedLock sl (streamLock);
+    streams.removeFirstMatchingValue (s);
+}
+
+void SampleStreamer::readAllPendingData()
+{
+    const ScopedLock sl (streamLock);
+
+    while (readNextChunk())
+    {}
+}
+
+int SampleStreamer::useTimeSlice()
+{
+    const ScopedLock sl (streamLock);
+
+    for (int i = 0; i < 16; ++i)
+        if (! readNextChunk())
+            return 5;
+
+    return 0;
+}
+
+bool SampleStreamer::readNextChunk()
+{
+    enum { chunkSize = 4096 };
+
+    Stream* mostUrgent = nullptr;
+    int64 leastBuffered = std::numeric_limits<int64>::max();
+
+    for (int i = streams.size(); --i >= 0;)
+    {
+        Stream& s = *streams.getUnchecked (i);
+        const int id = s.requestId.get();
+
+        if (id != s.currentRequestId)
+        {
+            StreamingSamplerSound* const sound = s.requestedSound.get();
+
+            if (s.requestId.get() != id)
+                continue; // the voice is making another request, so pick it up next time
+
+            s.currentRequestId = id;
+            s.currentSound = sound;
+            s.writePosition = (sound != nullptr ? sound->preloadLength : 0);
+            s.validEnd.set (s.writePosition);
+            s.dataRequestId.set (id);
+        }
+
+        if (const StreamingSamplerSound* const sound = static_cast<const StreamingSamplerSound*> (s.currentSound.get()))
+        {
+            // don't overwrite anything that the voice could still be playing
+            const int64 readPosition = s.readPosition.get();
+            const int64 limit = jmin (sound->length, readPosition + s.ring.getNumSamples() - 1);
+
+            if (s.writePosition < limit && s.writePosition - readPosition < leastBuffered)
+            {
+                // a note that's just started has the least data, so it gets served first
+                leastBuffered = s.writePosition - readPosition;
+                mostUrgent = &s;
+            }
+        }
+    }
+
+    if (mostUrgent == nullptr)
+        return false;
+
+    Stream& s = *mostUrgent;
+    StreamingSamplerSound& sound = *static_cast<StreamingSamplerSound*> (s.currentSound.get());
+
+    const int ringStart = (int) (s.writePosition & s.ringMask);
+    const int64 limit = jmin (sound.length, s.readPosition.get() + s.ring.getNumSamples() - 1);
+    const int numToRead = (int) jmin ((int64) jmin ((int) chunkSize, s.ring.getNumSamples() - ringStart),
+                                      limit - s.writePosition);
+
+    if (numToRead <= 0)
+        return true;
+
+    const int64 startTime = Time::getHighResolutionTicks();
+    sound.readFromSource (s.ring, ringStart, numToRead, s.writePosition);
+    ticksSpentReading += Time::getHighResolutionTicks() - startTime;
+
+    samplesReadFromDisk += numToRead;
+    bytesReadFromDisk += (int64) numToRead * sound.reader->numChannels * (sound.reader->bitsPerSample / 8);
+
+    s.writePosition += numToRead;
+    s.validEnd.set (s.writePosition);
+    return true;
+}
+
+//==============================================================================
+double SampleStreamer::Statistics::getCacheHitRate() const noexcept
+{
+    const int64 numPlayed = samplesFromPreload + samplesFromStream + samplesMissed;
+    return numPlayed > 0 ? (samplesFromPreload + samplesFromStream) / (double) numPlayed : 1.0;
+}
+
+double SampleStreamer::Statistics::getDiskThroughput() const noexcept
+{
+    return secondsSpentReading > 0 ? bytesReadFromDisk / secondsSpentReading : 0.0;
+}
+
+SampleStreamer::Statistics SampleStreamer::getStatistics() const noexcept
+{
+    Statistics stats;
+    stats.samplesFromPreload  = samplesFromPreload.get();
+    stats.samplesFromStream   = samplesFromStream.get();
+    stats.samplesMissed       = samplesMissed.get();
+    stats.numUnderruns        = numUnderruns.get();
+    stats.samplesReadFromDisk = samplesReadFromDisk.get();
+    stats.bytesReadFromDisk   = bytesReadFromDisk.get();
+    stats.secondsSpentReading = Time::highResolutionTicksToSeconds (ticksSpentReading.get());
+    return stats;
+}
+
+void SampleStreamer::resetStatistics() noexcept
+{
+    samplesFromPreload = 0;
+    samplesFromStream = 0;
+    samplesMissed = 0;
+    numUnderruns = 0;
+    samplesReadFromDisk = 0;
+    bytesReadFromDisk = 0;
+    ticksSpentReading = 0;
+}
+
+//==============================================================================
+StreamingSamplerSound::StreamingSamplerSound (const String& soundName,
+                                              AudioFormatReader* const source,
+                                              const BigInteger& notes,
+                                              const int midiNoteForNormalPitch,
+                                              const double attackTimeSecs,
+                                              const double releaseTimeSecs,
+                                              const double maxSampleLengthSeconds,
+                                              const double preloadTimeSecs)
+    : name (soundName),
+      reader (source),
+      sourceSampleRate (0),
+      midiNotes (notes),
+      length (0),
+      preloadLength (0),
+      attackSamples (0),
+      releaseSamples (0),
+      midiRootNote (midiNoteForNormalPitch)
+{
+    jassert (source != nullptr);
+
+    if (source != nullptr && source->sampleRate > 0 && source->lengthInSamples > 0)
+    {
+        sourceSampleRate = source->sampleRate;
+
+        if (MemoryMappedAudioFormatReader* const mapped = dynamic_cast<MemoryMappedAudioFormatReader*> (source))
+            mapped->mapEntireFile();
+
+        length = jmin (source->lengthInSamples, (int64) (maxSampleLengthSeconds * sourceSampleRate));
+        preloadLength = (int) jmin (length, (int64) (preloadTimeSecs * sourceSampleRate));
+
+        preloadedData.setSize (jmin (2, (int) source->numChannels), preloadLength + 4);
+        source->read (&preloadedData, 0, preloadLength + 4, 0, true, true);
+
+        attackSamples = roundToInt (attackTimeSecs * sourceSampleRate);
+        releaseSamples = roundToInt (releaseTimeSecs * sourceSampleRate);
+    }
+}
+
+StreamingSamplerSound::~StreamingSamplerSound()
+{
+}
+
+bool StreamingSamplerSound::appliesToNote (int midiNoteNumber)
+{
+    return midiNotes [midiNoteNumber];
+}
+
+bool StreamingSamplerSound::appliesToChannel (int /*midiChannel*/)
+{
+    return true;
+}
+
+void StreamingSamplerSound::readFromSource (AudioSampleBuffer& buffer, int startSampleInBuffer,
+                                            int numSamples, int64 sourcePosition)
+{
+    // the same sound could be streamed by more than one streamer
+    const ScopedLock sl (readerLock);
+    reader->read (&buffer, startSampleInBuffer, numSamples, sourcePosition, true, true);
+}
+
+//==============================================================================
+StreamingSamplerVoice::StreamingSamplerVoice (SampleStreamer& s, int ringBufferSizeSamples)
+    : streamer (s),
+      stream (new SampleStreamer::Stream (nextPowerOfTwo (jmax (1024, ringBufferSizeSamples)))),
+      requestId (0),
+      pitchRatio (0.0),
+      sourceSamplePosition (0.0),
+      lgain (0.0f), rgain (0.0f),
+      attackReleaseLevel (0), attackDelta (0), releaseDelta (0),
+      isInAttack (false), isInRelease (false)
+{
+    streamer.addStream (stream);
+}
+
+StreamingSamplerVoice::~StreamingSamplerVoice()
+{
+    streamer.removeStream (stream);
+}
+
+bool StreamingSamplerVoice::canPlaySound (SynthesiserSound* sound)
+{
+    return dynamic_cast<const StreamingSamplerSound*> (sound) != nullptr;
+}
+
+void StreamingSamplerVoice::requestStream (StreamingSamplerSound* const sound) noexcept
+{
+    // The sound is kept until the next request, so that it can't be deleted while
+    // the streamer is picking this one up.
+    if (sound != nullptr)
+        streamedSound = sound;
+
+    stream->readPosition.set (0);
+    stream->requestedSound.set (sound);
+    stream->requestId.set (++requestId);
+}
+
+void StreamingSamplerVoice::startNote (const int midiNoteNumber,
+                                       const float velocity,
+                                       SynthesiserSound* s,
+                                       const int /*currentPitchWheelPosition*/)
+{
+    if (StreamingSamplerSound* const sound = dynamic_cast<StreamingSamplerSound*> (s))
+    {
+        pitchRatio = pow (2.0, (midiNoteNumber - sound->midiRootNote) / 12.0)
+                        * sound->sourceSampleRate / getSampleRate();
+
+        sourceSamplePosition = 0.0;
+        lgain = velocity;
+        rgain = velocity;
+
+        isInAttack = (sound->attackSamples > 0);
+        isInRelease = false;
+
+        if (isInAttack)
+        {
+            attackReleaseLevel = 0.0f;
+            attackDelta = (float) (pitchRatio / sound->attackSamples);
+        }
+        else
+        {
+            attackReleaseLevel = 1.0f;
+            attackDelta = 0.0f;
+        }
+
+        if (sound->releaseSamples > 0)
+            releaseDelta = (float) (-pitchRatio / sound->releaseSamples);
+        else
+            releaseDelta = -1.0f;
+
+        requestStream (sound);
+    }
+    else
+    {
+        jassertfalse; // this object can only play StreamingSamplerSounds!
+    }
+}
+
+void StreamingSamplerVoice::stopNote (float /*velocity*/, bool allowTailOff)
+{
+    if (allowTailOff)
+    {
+        isInAttack = false;
+        isInRelease = true;
+    }
+    else
+    {
+        clearCurrentNote();
+        requestStream (nullptr);
+    }
+}
+
+void StreamingSamplerVoice::pitchWheelMoved (const int /*newValue*/)
+{
+}
+
+void StreamingSamplerVoice::controllerMoved (const int /*controllerNumber*/,
+                                             const int /*newValue*/)
+{
+}
+
+//==============================================================================
+static inline float getStreamedSample (const float* preload, const float* ring, int preloadLength,
+                                       int ringMask, int64 length, int64 index) noexcept
+{
+    if (index < preloadLength)  return preload [index];
+    if (index < length)         return ring [index & ringMask];
+
+    return 0.0f;
+}
+
+void StreamingSamplerVoice::renderNextBlock (AudioSampleBuffer& outputBuffer, int startSample, int numSamples)
+{
+    if (const StreamingSamplerSound* const playingSound = static_cast<StreamingSamplerSound*> (getCurrentlyPlayingSound().get()))
+    {
+        const AudioSampleBuffer& preload = playingSound->preloadedData;
+        const bool isStereo = preload.getNumChannels() > 1;
+        const float* const preloadL = preload.getReadPointer (0);
+        const float* const preloadR = preload.getReadPointer (isStereo ? 1 : 0);
+        const float* const ringL = stream->ring.getReadPointer (0);
+        const float* const ringR = stream->ring.getReadPointer (isStereo ? 1 : 0);
+        const int ringMask = stream->ringMask;
+        const int preloadLength = playingSound->preloadLength;
+        const int64 length = playingSound->length;
+
+        // tell the streamer where we've got to, and find out how far it has read
+        stream->readPosition.set ((int64) sourceSamplePosition);
+
+        int64 available = preloadLength;
+
+        if (stream->dataRequestId.get() == requestId)
+            available = jmax (available, stream->validEnd.get());
+
+        int numFromPreload = 0, numFromStream = 0, numMissed = 0;
+
+        float* outL = outputBuffer.getWritePointer (0, startSample);
+        float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
+
+        while (--numSamples >= 0)
+        {
+            const int64 pos = (int64) sourceSamplePosition;
+            float l = 0, r = 0;
+
+            if (jmin (pos + 1, length - 1) < available)
+            {
+                const float alpha = (float) (sourceSamplePosition - (double) pos);
+                const float invAlpha = 1.0f - alpha;
+
+                // just using a very simple linear interpolation here..
+                l = getStreamedSample (preloadL, ringL, preloadLength, ringMask, length, pos) * invAlpha
+                      + getStreamedSample (preloadL, ringL, preloadLength, ringMask, length, pos + 1) * alpha;
+
+                r = isStereo ? getStreamedSample (preloadR, ringR, preloadLength, ringMask, length, pos) * invAlpha
+                                 + getStreamedSample (preloadR, ringR, preloadLength, ringMask, length, pos + 1) * alpha
+                             : l;
+
+                l *= lgain;
+                r *= rgain;
+
+                if (pos < preloadLength)
+                    ++numFromPreload;
+                else
+                    ++numFromStream;
+            }
+            else
+            {
+                // the streamer hasn't caught up, so this sample is lost
+                ++numMissed;
+            }
+
+            if (isInAttack)
+            {
+                l *= attackReleaseLevel;
+                r *= attackReleaseLevel;
+
+                attackReleaseLevel += attackDelta;
+
+                if (attackReleaseLevel >= 1.0f)
+                {
+                    attackReleaseLevel = 1.0f;
+                    isInAttack = false;
+                }
+            }
+            else if (isInRelease)
+            {
+                l *= attackReleaseLevel;
+                r *= attackReleaseLevel;
+
+                attackReleaseLevel += releaseDelta;
+
+                if (attackReleaseLevel <= 0.0f)
+                {
+                    stopNote (0.0f, false);
+                    break;
+                }
+            }
+
+            if (outR != nullptr)
+            {
+                *outL++ += l;
+                *outR++ += r;
+            }
+            else
+            {
+                *outL++ += (l + r) * 0.5f;
+            }
+
+            sourceSamplePosition += pitchRatio;
+
+            if (sourceSamplePosition > length)
+            {
+                stopNote (0.0f, false);
+                break;
+            }
+        }
+
+        streamer.samplesFromPreload += numFromPreload;
+        streamer.samplesFromStream += numFromStream;
+
+        if (numMissed > 0)
+        {
+            streamer.samplesMissed += numMissed;
+            ++streamer.numUnderruns;
+        }
+    }
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class StreamingSamplerTests  : public UnitTest
+{
+public:
+    StreamingSamplerTests() : UnitTest ("StreamingSampler") {}
+
+    void runTest() override
+    {
+        MemoryBlock wavData;
+        createTestFile (wavData);
+
+        BigInteger allNotes;
+        allNotes.setRange (0, 128, true);
+
+        AudioSampleBuffer expected (2, 32768);
+
+        {
+            ScopedPointer<AudioFormatReader> reader (createReader (wavData));
+
+            Synthesiser synth;
+            synth.addSound (new SamplerSound ("test", *reader, allNotes, 60, 0.0, 0.01, 10.0));
+
+            for (int i = 0; i < 4; ++i)
+                synth.addVoice (new SamplerVoice());
+
+            render (synth, expected, nullptr);
+        }
+
+        beginTest ("Matches SamplerVoice");
+        {
+            TimeSliceThread thread ("Sampler test");
+            SampleStreamer streamer (thread);
+            AudioSampleBuffer output (2, expected.getNumSamples());
+
+            {
+                Synthesiser synth;
+                synth.addSound (new StreamingSamplerSound ("test", createReader (wavData), allNotes, 60, 0.0, 0.01, 10.0, 0.02));
+
+                for (int i = 0; i < 4; ++i)
+                    synth.addVoice (new StreamingSamplerVoice (streamer, 4096));
+
+                render (synth, output, &streamer);
+            }
+
+            float maxError = 0;
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < output.getNumSamples(); ++i)
+                    maxError = jmax (maxError, std::abs (output.getSample (channel, i) - expected.getSample (channel, i)));
+
+            expect (maxError < 1.0e-6f, "error = " + String (maxError));
+
+            const SampleStreamer::Statistics stats (streamer.getStatistics());
+            expectEquals ((int) stats.samplesMissed, 0);
+            expect (stats.samplesFromPreload > 0 && stats.samplesFromStream > stats.samplesFromPreload);
+            expect (stats.bytesReadFromDisk == stats.samplesReadFromDisk * 4);
+            expectEquals (stats.getCacheHitRate(), 1.0);
+        }
+
+        beginTest ("Reports underruns");
+        {
+            TimeSliceThread thread ("Sampler test");
+            SampleStreamer streamer (thread);
+            AudioSampleBuffer output (2, expected.getNumSamples());
+
+            {
+                Synthesiser synth;
+                synth.addSound (new StreamingSamplerSound ("test", createReader (wavData), allNotes, 60, 0.0, 0.01, 10.0, 0.02));
+                synth.addVoice (new StreamingSamplerVoice (streamer, 4096));
+
+                // the thread isn't running, so nothing gets streamed
+                render (synth, output, nullptr);
+            }
+
+            const SampleStreamer::Statistics stats (streamer.getStatistics());
+            expect (stats.samplesMissed > 0 && stats.numUnderruns > 0);
+            expectEquals ((int) stats.samplesFromStream, 0);
+            expect (stats.getCacheHitRate() < 1.0);
+
+            streamer.resetStatistics();
+            expectEquals ((int) streamer.getStatistics().samplesMissed, 0);
+        }
+    }
+
+    void createTestFile (MemoryBlock& data)
+    {
+        Random r = getRandom();
+        AudioSampleBuffer source (2, 20000);
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < source.getNumSamples(); ++i)
+                source.setSample (channel, i, r.nextFloat() - 0.5f);
+
+        WavAudioFormat format;
+        ScopedPointer<AudioFormatWriter> writer (format.createWriterFor (new MemoryOutputStream (data, false),
+                                                                         44100.0, 2, 16, StringPairArray(), 0));
+        writer->writeFromAudioSampleBuffer (source, 0, source.getNumSamples());
+    }
+
+    static AudioFormatReader* createReader (const MemoryBlock& data)
+    {
+        return WavAudioFormat().createReaderFor (new MemoryInputStream (data, false), true);
+    }
+
+    static void render (Synthesiser& synth, AudioSampleBuffer& buffer, SampleStreamer* streamer)
+    {
+        synth.setCurrentPlaybackSampleRate (44100.0);
+        buffer.clear();
+
+        MidiBuffer midi;
+        midi.addEvent (MidiMessage::noteOn (1, 60, 0.8f), 0);
+        midi.addEvent (MidiMessage::noteOn (1, 65, 0.5f), 1000);
+        midi.addEvent (MidiMessage::noteOn (1, 53, 0.7f), 3000);
+        midi.addEvent (MidiMessage::noteOff (1, 65), 9000);
+
+        for (int pos = 0; pos < buffer.getNumSamples(); pos += 512)
+        {
+            MidiBuffer blockMidi;
+            blockMidi.addEvents (midi, pos, 512, 0);
+            synth.renderNextBlock (buffer, blockMidi, pos, 512);
+
+            if (streamer != nullptr)
+                streamer->readAllPendingData();
+        }
+    }
+};
+
+static StreamingSamplerTests streamingSamplerTests;
+
+#endif
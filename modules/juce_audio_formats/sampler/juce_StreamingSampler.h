@@ -0,0 +1,252 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class StreamingSamplerVoice;
+
+//==============================================================================
+/**
+    Streams the audio for a set of StreamingSamplerVoices from disk, using a
+    background thread.
+
+    Each voice that is playing has a ring buffer, and on each time-slice this
+    tops up whichever voice has the least data buffered ahead of its playback
+    position, so a note that's just started gets served first.
+
+    It also keeps some statistics about how well it's keeping up, which you can
+    use to tune the preload time and ring buffer sizes.
+
+    @see StreamingSamplerSound, StreamingSamplerVoice
+*/
+class JUCE_API  SampleStreamer  : private TimeSliceClient
+{
+public:
+    //==============================================================================
+    /** Creates a streamer which will do its reading on the given thread.
+
+        The thread must be started by the caller, and must not be deleted until
+        after this object and all the voices using it have been deleted.
+    */
+    SampleStreamer (TimeSliceThread& backgroundThread);
+
+    /** Destructor. */
+    ~SampleStreamer();
+
+    //==============================================================================
+    /** Reads everything that the voices have room for, on the calling thread.
+
+        The background thread normally does this, but if you're rendering faster
+        than real-time, you can call this between blocks so that the voices never
+        run out of data.
+    */
+    void readAllPendingData();
+
+    //==============================================================================
+    /** Some figures describing how the streaming is going. */
+    struct Statistics
+    {
+        int64 samplesFromPreload;       /**< Samples played from the preloaded start of a sound. */
+        int64 samplesFromStream;        /**< Samples played from a voice's ring buffer. */
+        int64 samplesMissed;            /**< Samples that weren't ready in time, and were played as silence. */
+        int64 numUnderruns;             /**< The number of rendered blocks in which a voice ran out of data. */
+        int64 samplesReadFromDisk;      /**< The number of samples read by the streamer. */
+        int64 bytesReadFromDisk;        /**< The size of the source data that was read by the streamer. */
+        double secondsSpentReading;     /**< The time spent inside the readers. */
+
+        /** Returns the proportion of the samples that were played which were ready in memory. */
+        double getCacheHitRate() const noexcept;
+
+        /** Returns the rate at which the streamer reads data, in bytes per second of reading time. */
+        double getDiskThroughput() const noexcept;
+    };
+
+    /** Returns the figures since the streamer was created, or since resetStatistics() was called. */
+    Statistics getStatistics() const noexcept;
+
+    /** Sets all the statistics back to zero. */
+    void resetStatistics() noexcept;
+
+private:
+    //==============================================================================
+    friend class StreamingSamplerVoice;
+    struct Stream;
+
+    TimeSliceThread& backgroundThread;
+    CriticalSection streamLock;
+    Array<Stream*> streams;
+
+    Atomic<int64> samplesFromPreload, samplesFromStream, samplesMissed, numUnderruns,
+                  samplesReadFromDisk, bytesReadFromDisk, ticksSpentReading;
+
+    void addStream (Stream*);
+    void removeStream (Stream*);
+    bool readNextChunk();
+    int useTimeSlice() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleStreamer)
+};
+
+
+//==============================================================================
+/**
+    A SynthesiserSound that plays a sample which is streamed from disk.
+
+    Only the start of the sample is loaded into memory. Once a note has started,
+    a SampleStreamer reads the rest of it into the voice that's playing it, which
+    means that a sound can be much larger than the available RAM.
+
+    To use it, create a Synthesiser, add some StreamingSamplerVoice objects to it,
+    then give it some StreamingSamplerSound objects to play.
+
+    @see StreamingSamplerVoice, SampleStreamer, SamplerSound
+*/
+class JUCE_API  StreamingSamplerSound    : public SynthesiserSound
+{
+public:
+    //==============================================================================
+    /** Creates a sound which will stream its audio from a reader.
+
+        @param name         a name for the sample
+        @param source       the audio to play. This object will be deleted by the sound
+                            when it's no longer needed. If it's a MemoryMappedAudioFormatReader,
+                            the whole file will be mapped
+        @param midiNotes    the set of midi keys that this sound should be played on. This
+                            is used by the SynthesiserSound::appliesToNote() method
+        @param midiNoteForNormalPitch   the midi note at which the sample should be played
+                                        with its natural rate. All other notes will be pitched
+                                        up or down relative to this one
+        @param attackTimeSecs   the attack (fade-in) time, in seconds
+        @param releaseTimeSecs  the decay (fade-out) time, in seconds
+        @param maxSampleLengthSeconds   a maximum length of audio to play from the audio
+                                        source, in seconds
+        @param preloadTimeSecs  the length of the start of the sample to keep in memory. This
+                                needs to cover the time it takes the streamer to start
+                                reading a note, including any pitching-up
+    */
+    StreamingSamplerSound (const String& name,
+                           AudioFormatReader* source,
+                           const BigInteger& midiNotes,
+                           int midiNoteForNormalPitch,
+                           double attackTimeSecs,
+                           double releaseTimeSecs,
+                           double maxSampleLengthSeconds,
+                           double preloadTimeSecs);
+
+    /** Destructor. */
+    ~StreamingSamplerSound();
+
+    //==============================================================================
+    /** Returns the sample's name */
+    const String& getName() const noexcept                  { return name; }
+
+    /** Returns the number of samples that will be played. */
+    int64 getLengthInSamples() const noexcept               { return length; }
+
+    /** Returns the part of the sample that is kept in memory. */
+    const AudioSampleBuffer& getPreloadedData() const noexcept  { return preloadedData; }
+
+    //==============================================================================
+    bool appliesToNote (int midiNoteNumber) override;
+    bool appliesToChannel (int midiChannel) override;
+
+private:
+    //==============================================================================
+    friend class SampleStreamer;
+    friend class StreamingSamplerVoice;
+
+    String name;
+    ScopedPointer<AudioFormatReader> reader;
+    CriticalSection readerLock;
+    AudioSampleBuffer preloadedData;
+    double sourceSampleRate;
+    BigInteger midiNotes;
+    int64 length;
+    int preloadLength, attackSamples, releaseSamples;
+    int midiRootNote;
+
+    void readFromSource (AudioSampleBuffer&, int startSampleInBuffer, int numSamples, int64 sourcePosition);
+
+    JUCE_LEAK_DETECTOR (StreamingSamplerSound)
+};
+
+
+//==============================================================================
+/**
+    A SynthesiserVoice that plays a StreamingSamplerSound.
+
+    Each voice has a ring buffer which its SampleStreamer fills from disk while a
+    note is playing. The voice plays the start of the note from the sound's
+    preloaded data, and carries on from the ring buffer. If the data isn't there
+    in time, it plays silence and reports the underrun to the streamer's statistics.
+
+    The audio thread never waits for the streamer - the two communicate through
+    atomic read and write positions.
+
+    @see StreamingSamplerSound, SampleStreamer, SamplerVoice
+*/
+class JUCE_API  StreamingSamplerVoice    : public SynthesiserVoice
+{
+public:
+    //==============================================================================
+    /** Creates a voice that streams through the given streamer.
+
+        The ring buffer size is rounded up to a power of two. It limits how far ahead of
+        the playback position the streamer can read, so it should be several times the
+        amount of source data that gets played between the streamer's time-slices.
+    */
+    StreamingSamplerVoice (SampleStreamer& streamer, int ringBufferSizeSamples = 32768);
+
+    /** Destructor. */
+    ~StreamingSamplerVoice();
+
+    //==============================================================================
+    bool canPlaySound (SynthesiserSound*) override;
+
+    void startNote (int midiNoteNumber, float velocity, SynthesiserSound*, int pitchWheel) override;
+    void stopNote (float velocity, bool allowTailOff) override;
+
+    void pitchWheelMoved (int newValue) override;
+    void controllerMoved (int controllerNumber, int newValue) override;
+
+    void renderNextBlock (AudioSampleBuffer&, int startSample, int numSamples) override;
+
+private:
+    //==============================================================================
+    SampleStreamer& streamer;
+    ScopedPointer<SampleStreamer::Stream> stream;
+    SynthesiserSound::Ptr streamedSound;
+    int requestId;
+
+    double pitchRatio;
+    double sourceSamplePosition;
+    float lgain, rgain, attackReleaseLevel, attackDelta, releaseDelta;
+    bool isInAttack, isInRelease;
+
+    void requestStream (StreamingSamplerSound*) noexcept;
+
+    JUCE_LEAK_DETECTOR (StreamingSamplerVoice)
+};
@@ -52,7 +52,7 @@ template <typename Impl> struct FloatDoubleUtil<double, Impl> { static inline ty
 struct FloatPlaceholder;
 
 template <typename FloatingType> struct FloatDoubleType<HeapBlock<FloatPlaceholder>,    FloatingType>  { typedef HeapBlock<FloatingType> Type; };
-template <typename FloatingType> struct FloatDoubleType<HeapBlock<FloatPlaceholder*>,   FloatingType>  { typedef HeapBlock<FloatingType*> Type; };
+template <typename FloatingType> struct FloatDoubleType<FloatPlaceholder**,             FloatingType>  { typedef FloatingType** Type; };
 template <typename FloatingType> struct FloatDoubleType<AudioBuffer<FloatPlaceholder>,  FloatingType>  { typedef AudioBuffer<FloatingType> Type; };
 template <typename FloatingType> struct FloatDoubleType<AudioBuffer<FloatPlaceholder>*, FloatingType>  { typedef AudioBuffer<FloatingType>* Type; };
 
@@ -60,6 +60,159 @@ template <typename FloatingType> struct FloatDoubleType<AudioBuffer<FloatPlaceho
 namespace GraphRenderingOps
 {
 
+//==============================================================================
+/** Collects the shared audio channels and midi buffers that a rendering op
+    reads and writes, so that the ops can be arranged into a dependency graph
+    when the graph is being rendered on more than one thread.
+*/
+struct BufferAccessList
+{
+    struct Access
+    {
+        int resource;
+        bool isWrite;
+    };
+
+    void readAudioChannel (int channel)     { accesses.add ({ getAudioChannelResource (channel), false }); }
+    void writeAudioChannel (int channel)    { accesses.add ({ getAudioChannelResource (channel), true }); }
+    void readMidiBuffer (int buffer)        { accesses.add ({ getMidiBufferResource (buffer), false }); }
+    void writeMidiBuffer (int buffer)       { accesses.add ({ getMidiBufferResource (buffer), true }); }
+
+    /** The graph's own input and output buffers, which all AudioGraphIOProcessors share. */
+    void writeGraphIOBuffers()              { accesses.add ({ graphIOResource, true }); }
+
+    static int getAudioChannelResource (int channel) noexcept   { return 1 + 2 * channel; }
+    static int getMidiBufferResource (int buffer) noexcept      { return 2 + 2 * buffer; }
+
+    static int getNumResources (int numAudioChannels, int numMidiBuffers) noexcept
+    {
+        return 2 + 2 * jmax (numAudioChannels, numMidiBuffers);
+    }
+
+    enum { graphIOResource = 0 };
+
+    Array<Access> accesses;
+};
+
+struct NodeTimingRecorder;
+
+//==============================================================================
+/** A lightweight description of one step in the rendering sequence.
+
+    The RenderingOpSequenceCalculator produces a list of these, which can then be
+    optimised before being turned into the real ops in a RenderingProgram.
+*/
+struct RenderingOpDescription
+{
+    enum Type
+    {
+        clearChannelOp,
+        copyChannelOp,
+        addChannelOp,
+        sumChannelsOp,
+        delayChannelOp,
+        clearMidiBufferOp,
+        copyMidiBufferOp,
+        addMidiBufferOp,
+        processBufferOp
+    };
+
+    RenderingOpDescription() noexcept
+        : type (clearChannelOp), dest (0), delaySamples (0), totalChans (0),
+          midiBuffer (-1), accumulate (false), node (nullptr), timingRecorder (nullptr)
+    {}
+
+    static RenderingOpDescription* clearChannel (int channel)           { return create (clearChannelOp, -1, channel); }
+    static RenderingOpDescription* copyChannel (int src, int dst)       { return create (copyChannelOp, src, dst); }
+    static RenderingOpDescription* addChannel (int src, int dst)        { return create (addChannelOp, src, dst); }
+    static RenderingOpDescription* clearMidiBuffer (int buffer)         { return create (clearMidiBufferOp, -1, buffer); }
+    static RenderingOpDescription* copyMidiBuffer (int src, int dst)    { return create (copyMidiBufferOp, src, dst); }
+    static RenderingOpDescription* addMidiBuffer (int src, int dst)     { return create (addMidiBufferOp, src, dst); }
+
+    static RenderingOpDescription* delayChannel (int channel, int numSamplesDelay)
+    {
+        RenderingOpDescription* const d = create (delayChannelOp, -1, channel);
+        d->delaySamples = numSamplesDelay;
+        return d;
+    }
+
+    static RenderingOpDescription* processBuffer (AudioProcessorGraph::Node& n, const Array<int>& audioChannelsUsed,
+                                                  int totalNumChans, int midiBufferToUse)
+    {
+        RenderingOpDescription* const d = create (processBufferOp, -1, -1);
+        d->sources = audioChannelsUsed;
+        d->totalChans = totalNumChans;
+        d->midiBuffer = midiBufferToUse;
+        d->node = &n;
+        return d;
+    }
+
+    String toString() const
+    {
+        switch (type)
+        {
+            case clearChannelOp:        return "clear    chan " + String (dest);
+            case copyChannelOp:         return "copy     chan " + String (sources[0]) + " -> chan " + String (dest);
+            case addChannelOp:          return "add      chan " + String (sources[0]) + " -> chan " + String (dest);
+            case delayChannelOp:        return "delay    chan " + String (dest) + " by " + String (delaySamples) + " samples";
+            case clearMidiBufferOp:     return "clear    midi " + String (dest);
+            case copyMidiBufferOp:      return "copy     midi " + String (sources[0]) + " -> midi " + String (dest);
+            case addMidiBufferOp:       return "add      midi " + String (sources[0]) + " -> midi " + String (dest);
+
+            case sumChannelsOp:
+            {
+                StringArray terms;
+
+                if (accumulate)
+                    terms.add ("chan " + String (dest));
+
+                for (int i = 0; i < sources.size(); ++i)
+                    terms.add ("chan " + String (sources.getUnchecked (i)));
+
+                return "sum      " + terms.joinIntoString (" + ") + " -> chan " + String (dest);
+            }
+
+            case processBufferOp:
+            {
+                StringArray chans;
+
+                for (int i = 0; i < sources.size(); ++i)
+                    chans.add (String (sources.getUnchecked (i)));
+
+                return "process  node " + String (node->nodeId) + " (" + node->getProcessor()->getName() + ")"
+                         + ", chans [" + chans.joinIntoString (", ") + "]"
+                         + (midiBuffer >= 0 ? ", midi " + String (midiBuffer) : String());
+            }
+
+            default:                    jassertfalse; break;
+        }
+
+        return {};
+    }
+
+    Type type;
+    int dest;               // the audio channel or midi buffer that the op writes to
+    Array<int> sources;     // the channels or buffers it reads from, or the channels that a processor uses
+    int delaySamples, totalChans, midiBuffer;
+    bool accumulate;        // true if a sum should add its sources onto the existing contents of dest
+    AudioProcessorGraph::Node* node;
+    NodeTimingRecorder* timingRecorder;     // if a processor is being profiled, this is where its timings go
+
+private:
+    static RenderingOpDescription* create (Type opType, int source, int destination)
+    {
+        RenderingOpDescription* const d = new RenderingOpDescription();
+        d->type = opType;
+        d->dest = destination;
+
+        if (source >= 0)
+            d->sources.add (source);
+
+        return d;
+    }
+};
+
+//==============================================================================
 struct AudioGraphRenderingOpBase
 {
     AudioGraphRenderingOpBase() noexcept {}
@@ -73,6 +226,8 @@ struct AudioGraphRenderingOpBase
                           const OwnedArray<MidiBuffer>& sharedMidiBuffers,
                           const int numSamples) = 0;
 
+    virtual void getBufferAccesses (BufferAccessList&) const = 0;
+
     JUCE_LEAK_DETECTOR (AudioGraphRenderingOpBase)
 };
 
@@ -106,6 +261,11 @@ struct ClearChannelOp  : public AudioGraphRenderingOp<ClearChannelOp>
         sharedBufferChans.clear (channelNum, 0, numSamples);
     }
 
+    void getBufferAccesses (BufferAccessList& list) const override
+    {
+        list.writeAudioChannel (channelNum);
+    }
+
     const int channelNum;
 
     JUCE_DECLARE_NON_COPYABLE (ClearChannelOp)
@@ -124,6 +284,12 @@ struct CopyChannelOp  : public AudioGraphRenderingOp<CopyChannelOp>
         sharedBufferChans.copyFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
     }
 
+    void getBufferAccesses (BufferAccessList& list) const override
+    {
+        list.readAudioChannel (srcChannelNum);
+        list.writeAudioChannel (dstChannelNum);
+    }
+
     const int srcChannelNum, dstChannelNum;
 
     JUCE_DECLARE_NON_COPYABLE (CopyChannelOp)
@@ -142,11 +308,76 @@ struct AddChannelOp  : public AudioGraphRenderingOp<AddChannelOp>
         sharedBufferChans.addFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
     }
 
+    void getBufferAccesses (BufferAccessList& list) const override
+    {
+        list.readAudioChannel (srcChannelNum);
+        list.writeAudioChannel (dstChannelNum);
+    }
+
     const int srcChannelNum, dstChannelNum;
 
     JUCE_DECLARE_NON_COPYABLE (AddChannelOp)
 };
 
+//==============================================================================
+/** Mixes several channels into one in a single pass over the destination. This
+    replaces a copy followed by some adds onto the same channel, or a run of adds.
+
+    The sources are added together in the same order that the separate ops would
+    have used, so the result is exactly the same.
+*/
+struct SumChannelsOp  : public AudioGraphRenderingOp<SumChannelsOp>
+{
+    SumChannelsOp (const Array<int>& srcChans, const int dstChan,
+                   const bool addOntoDest, int* const srcChannelStorage) noexcept
+        : srcChannelNums (srcChannelStorage), numSources (srcChans.size()),
+          dstChannelNum (dstChan), accumulate (addOntoDest)
+    {
+        jassert (numSources > 0);
+
+        for (int i = 0; i < numSources; ++i)
+            srcChannelNums[i] = srcChans.getUnchecked (i);
+    }
+
+    template <typename FloatType>
+    void perform (AudioBuffer<FloatType>& sharedBufferChans, const OwnedArray<MidiBuffer>&, const int numSamples)
+    {
+        FloatType* const dest = sharedBufferChans.getWritePointer (dstChannelNum);
+        int next = 0;
+
+        if (! accumulate)
+        {
+            const FloatType* const src = sharedBufferChans.getReadPointer (srcChannelNums[0]);
+
+            if (numSources == 1)
+            {
+                FloatVectorOperations::copy (dest, src, numSamples);
+                return;
+            }
+
+            FloatVectorOperations::add (dest, src, sharedBufferChans.getReadPointer (srcChannelNums[1]), numSamples);
+            next = 2;
+        }
+
+        for (; next < numSources; ++next)
+            FloatVectorOperations::add (dest, sharedBufferChans.getReadPointer (srcChannelNums[next]), numSamples);
+    }
+
+    void getBufferAccesses (BufferAccessList& list) const override
+    {
+        for (int i = 0; i < numSources; ++i)
+            list.readAudioChannel (srcChannelNums[i]);
+
+        list.writeAudioChannel (dstChannelNum);
+    }
+
+    int* const srcChannelNums;
+    const int numSources, dstChannelNum;
+    const bool accumulate;
+
+    JUCE_DECLARE_NON_COPYABLE (SumChannelsOp)
+};
+
 //==============================================================================
 struct ClearMidiBufferOp  : public AudioGraphRenderingOp<ClearMidiBufferOp>
 {
@@ -158,6 +389,11 @@ struct ClearMidiBufferOp  : public AudioGraphRenderingOp<ClearMidiBufferOp>
         sharedMidiBuffers.getUnchecked (bufferNum)->clear();
     }
 
+    void getBufferAccesses (BufferAccessList& list) const override
+    {
+        list.writeMidiBuffer (bufferNum);
+    }
+
     const int bufferNum;
 
     JUCE_DECLARE_NON_COPYABLE (ClearMidiBufferOp)
@@ -176,6 +412,12 @@ struct CopyMidiBufferOp  : public AudioGraphRenderingOp<CopyMidiBufferOp>
         *sharedMidiBuffers.getUnchecked (dstBufferNum) = *sharedMidiBuffers.getUnchecked (srcBufferNum);
     }
 
+    void getBufferAccesses (BufferAccessList& list) const override
+    {
+        list.readMidiBuffer (srcBufferNum);
+        list.writeMidiBuffer (dstBufferNum);
+    }
+
     const int srcBufferNum, dstBufferNum;
 
     JUCE_DECLARE_NON_COPYABLE (CopyMidiBufferOp)
@@ -195,6 +437,12 @@ struct AddMidiBufferOp  : public AudioGraphRenderingOp<AddMidiBufferOp>
             ->addEvents (*sharedMidiBuffers.getUnchecked (srcBufferNum), 0, numSamples, 0);
     }
 
+    void getBufferAccesses (BufferAccessList& list) const override
+    {
+        list.readMidiBuffer (srcBufferNum);
+        list.writeMidiBuffer (dstBufferNum);
+    }
+
     const int srcBufferNum, dstBufferNum;
 
     JUCE_DECLARE_NON_COPYABLE (AddMidiBufferOp)
@@ -228,6 +476,11 @@ struct DelayChannelOp  : public AudioGraphRenderingOp<DelayChannelOp>
         }
     }
 
+    void getBufferAccesses (BufferAccessList& list) const override
+    {
+        list.writeAudioChannel (channel);
+    }
+
 private:
     FloatAndDoubleComposition<HeapBlock<FloatPlaceholder> > buffer;
     const int channel, bufferSize;
@@ -236,33 +489,162 @@ private:
     JUCE_DECLARE_NON_COPYABLE (DelayChannelOp)
 };
 
+//==============================================================================
+/** Collects the time that a node takes to render each block.
+
+    The audio thread pushes its measurements into a lock-free fifo, and the message
+    thread periodically pulls them out and adds them to the node's statistics. Only
+    one thread ever renders a particular node at a time, so the fifo only ever has
+    a single writer.
+*/
+struct NodeTimingRecorder  : public ReferenceCountedObject
+{
+    NodeTimingRecorder (const uint32 nodeId)  : fifo (fifoSize)
+    {
+        timings.nodeId = nodeId;
+        totalMs = totalLoad = 0;
+    }
+
+    void addTiming (const int64 ticks, const int numSamples) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        // (if the message thread hasn't been keeping up, the timing is lost)
+        if (size1 > 0)
+        {
+            Timing& t = buffer[start1];
+            t.ticks = ticks;
+            t.numSamples = numSamples;
+            fifo.finishedWrite (1);
+        }
+    }
+
+    /** Moves any new timings from the fifo into the statistics. */
+    void update (const double sampleRate)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)    addToStatistics (buffer[start1 + i], sampleRate);
+        for (int i = 0; i < size2; ++i)    addToStatistics (buffer[start2 + i], sampleRate);
+
+        fifo.finishedRead (size1 + size2);
+    }
+
+    void reset()
+    {
+        update (0);
+        const uint32 nodeId = timings.nodeId;
+        timings = AudioProcessorGraph::NodeTimings();
+        timings.nodeId = nodeId;
+        totalMs = totalLoad = 0;
+    }
+
+    typedef ReferenceCountedObjectPtr<NodeTimingRecorder> Ptr;
+
+    AudioProcessorGraph::NodeTimings timings;
+
+private:
+    struct Timing
+    {
+        int64 ticks;
+        int numSamples;
+    };
+
+    enum { fifoSize = 1024 };
+    AbstractFifo fifo;
+    Timing buffer[fifoSize];
+    double totalMs, totalLoad;
+
+    void addToStatistics (const Timing& t, const double sampleRate)
+    {
+        if (sampleRate <= 0 || t.numSamples <= 0)
+            return;
+
+        const double ms = Time::highResolutionTicksToSeconds (t.ticks) * 1000.0;
+        const double load = ms * sampleRate / (1000.0 * t.numSamples);
+
+        timings.minMs = timings.numBlocks > 0 ? jmin (timings.minMs, ms) : ms;
+        timings.maxMs = jmax (timings.maxMs, ms);
+        timings.maxLoad = jmax (timings.maxLoad, load);
+
+        totalMs += ms;
+        totalLoad += load;
+        ++timings.numBlocks;
+
+        // (when every block has taken the same time, rounding errors can push the average just past the extremes)
+        timings.averageMs = jlimit (timings.minMs, timings.maxMs, totalMs / timings.numBlocks);
+        timings.averageLoad = jmin (timings.maxLoad, totalLoad / timings.numBlocks);
+
+        int bin = 0;
+
+        while (bin < AudioProcessorGraph::NodeTimings::numHistogramBins - 1
+                && load >= AudioProcessorGraph::NodeTimings::getHistogramBinLimit (bin))
+            ++bin;
+
+        ++timings.histogram[bin];
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NodeTimingRecorder)
+};
+
 //==============================================================================
 struct ProcessBufferOp   : public AudioGraphRenderingOp<ProcessBufferOp>
 {
+    /** The channel lists are stored in space provided by the RenderingProgram, which
+        must have room for getNumChannelsToStore (totalNumChans) of each type.
+    */
     ProcessBufferOp (const AudioProcessorGraph::Node::Ptr& n,
                      const Array<int>& audioChannelsUsed,
                      const int totalNumChans,
-                     const int midiBuffer)
+                     const int midiBuffer,
+                     NodeTimingRecorder* const recorder,
+                     int* const channelIndexStorage,
+                     float** const floatChannelStorage,
+                     double** const doubleChannelStorage)
         : node (n),
           processor (n->getProcessor()),
-          audioChannelsToUse (audioChannelsUsed),
-          totalChans (jmax (1, totalNumChans)),
+          timingRecorder (recorder),
+          audioChannelsToUse (channelIndexStorage),
+          totalChans (getNumChannelsToStore (totalNumChans)),
+          numOutputChans (n->getProcessor()->getTotalNumOutputChannels()),
           midiBufferToUse (midiBuffer)
     {
-        audioChannels.floatVersion. calloc ((size_t) totalChans);
-        audioChannels.doubleVersion.calloc ((size_t) totalChans);
+        audioChannels.floatVersion  = floatChannelStorage;
+        audioChannels.doubleVersion = doubleChannelStorage;
+
+        for (int i = 0; i < totalChans; ++i)
+            audioChannelsToUse[i] = audioChannelsUsed[i];
+    }
 
-        while (audioChannelsToUse.size() < totalChans)
-            audioChannelsToUse.add (0);
+    static int getNumChannelsToStore (const int totalNumChans) noexcept
+    {
+        return jmax (1, totalNumChans);
     }
 
     template <typename FloatType>
     void perform (AudioBuffer<FloatType>& sharedBufferChans, const OwnedArray<MidiBuffer>& sharedMidiBuffers, const int numSamples)
     {
-        HeapBlock<FloatType*>& channels = audioChannels.get<FloatType>();
+        if (timingRecorder != nullptr)
+        {
+            const int64 startTicks = Time::getHighResolutionTicks();
+            process (sharedBufferChans, sharedMidiBuffers, numSamples);
+            timingRecorder->addTiming (Time::getHighResolutionTicks() - startTicks, numSamples);
+        }
+        else
+        {
+            process (sharedBufferChans, sharedMidiBuffers, numSamples);
+        }
+    }
+
+    template <typename FloatType>
+    void process (AudioBuffer<FloatType>& sharedBufferChans, const OwnedArray<MidiBuffer>& sharedMidiBuffers, const int numSamples)
+    {
+        FloatType** const channels = audioChannels.get<FloatType>();
 
         for (int i = totalChans; --i >= 0;)
-            channels[i] = sharedBufferChans.getWritePointer (audioChannelsToUse.getUnchecked (i), 0);
+            channels[i] = sharedBufferChans.getWritePointer (audioChannelsToUse[i], 0);
 
         AudioBuffer<FloatType> buffer (channels, totalChans, numSamples);
 
@@ -274,10 +656,38 @@ struct ProcessBufferOp   : public AudioGraphRenderingOp<ProcessBufferOp>
         {
             ScopedLock lock (processor->getCallbackLock());
 
-            callProcess (buffer, *sharedMidiBuffers.getUnchecked (midiBufferToUse));
+            if (midiBufferToUse >= 0)
+            {
+                callProcess (buffer, *sharedMidiBuffers.getUnchecked (midiBufferToUse));
+            }
+            else
+            {
+                unusedMidiBuffer.clear();
+                callProcess (buffer, unusedMidiBuffer);
+            }
         }
     }
 
+    void getBufferAccesses (BufferAccessList& list) const override
+    {
+        for (int i = 0; i < totalChans; ++i)
+        {
+            const int chan = audioChannelsToUse[i];
+
+            // (the processor may only modify the channels that it uses as outputs)
+            if (i < numOutputChans)
+                list.writeAudioChannel (chan);
+            else
+                list.readAudioChannel (chan);
+        }
+
+        if (midiBufferToUse >= 0)
+            list.writeMidiBuffer (midiBufferToUse);
+
+        if (dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (processor) != nullptr)
+            list.writeGraphIOBuffers();
+    }
+
     void callProcess (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
     {
         processor->processBlock (buffer, midiMessages);
@@ -305,14 +715,230 @@ struct ProcessBufferOp   : public AudioGraphRenderingOp<ProcessBufferOp>
     AudioProcessor* const processor;
 
 private:
-    Array<int> audioChannelsToUse;
-    FloatAndDoubleComposition<HeapBlock<FloatPlaceholder*> > audioChannels;
+    const NodeTimingRecorder::Ptr timingRecorder;
+    int* const audioChannelsToUse;
+    FloatAndDoubleComposition<FloatPlaceholder**> audioChannels;
     AudioBuffer<float> tempBuffer;
-    const int totalChans;
+    MidiBuffer unusedMidiBuffer;
+    const int totalChans, numOutputChans;
     const int midiBufferToUse;
 
-    JUCE_DECLARE_NON_COPYABLE (ProcessBufferOp)
-};
+    JUCE_DECLARE_NON_COPYABLE (ProcessBufferOp)
+};
+
+//==============================================================================
+/** The ops that render the graph, all packed one after another into a single
+    block of memory along with the channel lists that they use, so that running
+    through them touches as few cache lines as possible.
+*/
+struct RenderingProgram
+{
+    RenderingProgram() noexcept  : numBytesAllocated (0), numBytesUsed (0) {}
+
+    ~RenderingProgram()
+    {
+        for (int i = ops.size(); --i >= 0;)
+            ops.getUnchecked (i)->~AudioGraphRenderingOpBase();
+    }
+
+    void build (const OwnedArray<RenderingOpDescription>& descriptions)
+    {
+        jassert (ops.size() == 0);
+
+        for (int i = 0; i < descriptions.size(); ++i)
+            numBytesAllocated += getNumBytesNeeded (*descriptions.getUnchecked (i));
+
+        storage.malloc (jmax ((size_t) 1, numBytesAllocated));
+        ops.ensureStorageAllocated (descriptions.size());
+
+        for (int i = 0; i < descriptions.size(); ++i)
+            ops.add (createOp (*descriptions.getUnchecked (i)));
+
+        jassert (numBytesUsed == numBytesAllocated);
+    }
+
+    int size() const noexcept                                           { return ops.size(); }
+    AudioGraphRenderingOpBase* getOp (int index) const noexcept         { return ops.getUnchecked (index); }
+    size_t getNumBytes() const noexcept                                 { return numBytesAllocated; }
+
+    template <typename FloatType>
+    void perform (const int firstOp, const int endOp, AudioBuffer<FloatType>& sharedBufferChans,
+                  const OwnedArray<MidiBuffer>& sharedMidiBuffers, const int numSamples) const
+    {
+        for (int i = firstOp; i < endOp; ++i)
+            ops.getUnchecked (i)->perform (sharedBufferChans, sharedMidiBuffers, numSamples);
+    }
+
+private:
+    //==============================================================================
+    HeapBlock<char> storage;
+    size_t numBytesAllocated, numBytesUsed;
+    Array<AudioGraphRenderingOpBase*> ops;
+
+    // Everything in the block is kept 16-byte aligned.
+    template <typename Type>
+    static size_t getNumBytesNeeded (const int numElements = 1) noexcept
+    {
+        return (sizeof (Type) * (size_t) numElements + 15) & ~(size_t) 15;
+    }
+
+    template <typename Type>
+    Type* allocate (const int numElements = 1) noexcept
+    {
+        Type* const space = reinterpret_cast<Type*> (storage + numBytesUsed);
+        numBytesUsed += getNumBytesNeeded<Type> (numElements);
+        jassert (numBytesUsed <= numBytesAllocated);
+        return space;
+    }
+
+    static size_t getNumBytesNeeded (const RenderingOpDescription& d) noexcept
+    {
+        typedef RenderingOpDescription Desc;
+
+        switch (d.type)
+        {
+            case Desc::clearChannelOp:      return getNumBytesNeeded<ClearChannelOp>();
+            case Desc::copyChannelOp:       return getNumBytesNeeded<CopyChannelOp>();
+            case Desc::addChannelOp:        return getNumBytesNeeded<AddChannelOp>();
+            case Desc::sumChannelsOp:       return getNumBytesNeeded<SumChannelsOp>() + getNumBytesNeeded<int> (d.sources.size());
+            case Desc::delayChannelOp:      return getNumBytesNeeded<DelayChannelOp>();
+            case Desc::clearMidiBufferOp:   return getNumBytesNeeded<ClearMidiBufferOp>();
+            case Desc::copyMidiBufferOp:    return getNumBytesNeeded<CopyMidiBufferOp>();
+            case Desc::addMidiBufferOp:     return getNumBytesNeeded<AddMidiBufferOp>();
+
+            case Desc::processBufferOp:
+            {
+                const int numChans = ProcessBufferOp::getNumChannelsToStore (d.totalChans);
+
+                return getNumBytesNeeded<ProcessBufferOp>() + getNumBytesNeeded<int> (numChans)
+                         + getNumBytesNeeded<float*> (numChans) + getNumBytesNeeded<double*> (numChans);
+            }
+
+            default:                        jassertfalse; break;
+        }
+
+        return 0;
+    }
+
+    AudioGraphRenderingOpBase* createOp (const RenderingOpDescription& d)
+    {
+        typedef RenderingOpDescription Desc;
+
+        switch (d.type)
+        {
+            case Desc::clearChannelOp:      return new (allocate<ClearChannelOp>()) ClearChannelOp (d.dest);
+            case Desc::copyChannelOp:       return new (allocate<CopyChannelOp>()) CopyChannelOp (d.sources[0], d.dest);
+            case Desc::addChannelOp:        return new (allocate<AddChannelOp>()) AddChannelOp (d.sources[0], d.dest);
+            case Desc::delayChannelOp:      return new (allocate<DelayChannelOp>()) DelayChannelOp (d.dest, d.delaySamples);
+            case Desc::clearMidiBufferOp:   return new (allocate<ClearMidiBufferOp>()) ClearMidiBufferOp (d.dest);
+            case Desc::copyMidiBufferOp:    return new (allocate<CopyMidiBufferOp>()) CopyMidiBufferOp (d.sources[0], d.dest);
+            case Desc::addMidiBufferOp:     return new (allocate<AddMidiBufferOp>()) AddMidiBufferOp (d.sources[0], d.dest);
+
+            case Desc::sumChannelsOp:
+            {
+                void* const space = allocate<SumChannelsOp>();
+                return new (space) SumChannelsOp (d.sources, d.dest, d.accumulate, allocate<int> (d.sources.size()));
+            }
+
+            case Desc::processBufferOp:
+            {
+                const int numChans = ProcessBufferOp::getNumChannelsToStore (d.totalChans);
+                void* const space = allocate<ProcessBufferOp>();
+                int* const channelIndexes = allocate<int> (numChans);
+                float** const floatChannels = allocate<float*> (numChans);
+                double** const doubleChannels = allocate<double*> (numChans);
+
+                return new (space) ProcessBufferOp (d.node, d.sources, d.totalChans, d.midiBuffer, d.timingRecorder,
+                                                    channelIndexes, floatChannels, doubleChannels);
+            }
+
+            default:                        jassertfalse; break;
+        }
+
+        return nullptr;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderingProgram)
+};
+
+//==============================================================================
+/** Fuses together runs of ops which all write to the same channel, so that the
+    rendering program does fewer passes over the shared buffers.
+
+    A copy into a channel followed by adds onto it becomes a single sum of all the
+    sources, a run of adds becomes a sum which accumulates onto the channel, and a
+    clear whose channel is about to be overwritten is dropped.
+*/
+static void fuseRenderingOps (const OwnedArray<RenderingOpDescription>& ops,
+                              OwnedArray<RenderingOpDescription>& fused, int& numElidedClears)
+{
+    typedef RenderingOpDescription Desc;
+
+    for (int i = 0; i < ops.size(); ++i)
+    {
+        Desc op (*ops.getUnchecked (i));
+
+        if (i + 1 < ops.size() && ops.getUnchecked (i + 1)->dest == op.dest)
+        {
+            const Desc& next = *ops.getUnchecked (i + 1);
+
+            // (adding a channel onto a cleared one is the same as copying it)
+            if (op.type == Desc::clearChannelOp && (next.type == Desc::copyChannelOp || next.type == Desc::addChannelOp))
+            {
+                op.type = Desc::copyChannelOp;
+                op.sources = next.sources;
+                ++numElidedClears;
+                ++i;
+            }
+            else if (op.type == Desc::clearMidiBufferOp && next.type == Desc::copyMidiBufferOp)
+            {
+                op = next;
+                ++numElidedClears;
+                ++i;
+            }
+        }
+
+        if (op.type == Desc::copyChannelOp || op.type == Desc::addChannelOp)
+        {
+            while (i + 1 < ops.size()
+                    && ops.getUnchecked (i + 1)->type == Desc::addChannelOp
+                    && ops.getUnchecked (i + 1)->dest == op.dest
+                    && ops.getUnchecked (i + 1)->sources[0] != op.dest)
+            {
+                if (op.type != Desc::sumChannelsOp)
+                {
+                    op.accumulate = (op.type == Desc::addChannelOp);
+                    op.type = Desc::sumChannelsOp;
+                }
+
+                op.sources.add (ops.getUnchecked (++i)->sources[0]);
+            }
+        }
+
+        fused.add (new Desc (op));
+    }
+}
+
+static AudioProcessorGraph::OpCounts countRenderingOps (const OwnedArray<RenderingOpDescription>& ops) noexcept
+{
+    AudioProcessorGraph::OpCounts counts;
+
+    for (int i = 0; i < ops.size(); ++i)
+    {
+        switch (ops.getUnchecked (i)->type)
+        {
+            case RenderingOpDescription::clearChannelOp:    ++counts.numClears; break;
+            case RenderingOpDescription::copyChannelOp:     ++counts.numCopies; break;
+            case RenderingOpDescription::addChannelOp:      ++counts.numAdds; break;
+            case RenderingOpDescription::sumChannelsOp:     ++counts.numSums; break;
+            case RenderingOpDescription::delayChannelOp:    ++counts.numDelays; break;
+            case RenderingOpDescription::processBufferOp:   ++counts.numProcesses; break;
+            default:                                        ++counts.numMidiOps; break;
+        }
+    }
+
+    return counts;
+}
 
 //==============================================================================
 /** Used to calculate the correct sequence of rendering ops needed, based on
@@ -322,9 +948,11 @@ struct RenderingOpSequenceCalculator
 {
     RenderingOpSequenceCalculator (AudioProcessorGraph& g,
                                    const Array<AudioProcessorGraph::Node*>& nodes,
-                                   Array<void*>& renderingOps)
+                                   OwnedArray<RenderingOpDescription>& renderingOps,
+                                   const bool shouldReuseFreeBuffers)
         : graph (g),
           orderedNodes (nodes),
+          reuseFreeBuffers (shouldReuseFreeBuffers),
           totalLatency (0)
     {
         nodeIds.add ((uint32) zeroNodeID); // first buffer is read-only zeros
@@ -348,6 +976,7 @@ private:
     //==============================================================================
     AudioProcessorGraph& graph;
     const Array<AudioProcessorGraph::Node*>& orderedNodes;
+    const bool reuseFreeBuffers;
     Array<int> channels;
     Array<uint32> nodeIds, midiNodeIds;
 
@@ -393,7 +1022,7 @@ private:
 
     //==============================================================================
     void createRenderingOpsForNode (AudioProcessorGraph::Node& node,
-                                    Array<void*>& renderingOps,
+                                    OwnedArray<RenderingOpDescription>& renderingOps,
                                     const int ourRenderingIndex)
     {
         AudioProcessor& processor = *node.getProcessor();
@@ -437,7 +1066,7 @@ private:
                 else
                 {
                     bufIndex = getFreeBuffer (false);
-                    renderingOps.add (new ClearChannelOp (bufIndex));
+                    renderingOps.add (RenderingOpDescription::clearChannel (bufIndex));
                 }
             }
             else if (sourceNodes.size() == 1)
@@ -464,7 +1093,7 @@ private:
                     // need to use a copy of it..
                     const int newFreeBuffer = getFreeBuffer (false);
 
-                    renderingOps.add (new CopyChannelOp (bufIndex, newFreeBuffer));
+                    renderingOps.add (RenderingOpDescription::copyChannel (bufIndex, newFreeBuffer));
 
                     bufIndex = newFreeBuffer;
                 }
@@ -472,7 +1101,7 @@ private:
                 const int nodeDelay = getNodeDelay (srcNode);
 
                 if (nodeDelay < maxLatency)
-                    renderingOps.add (new DelayChannelOp (bufIndex, maxLatency - nodeDelay));
+                    renderingOps.add (RenderingOpDescription::delayChannel (bufIndex, maxLatency - nodeDelay));
             }
             else
             {
@@ -498,7 +1127,7 @@ private:
 
                         const int nodeDelay = getNodeDelay (sourceNodes.getUnchecked (i));
                         if (nodeDelay < maxLatency)
-                            renderingOps.add (new DelayChannelOp (sourceBufIndex, maxLatency - nodeDelay));
+                            renderingOps.add (RenderingOpDescription::delayChannel (sourceBufIndex, maxLatency - nodeDelay));
 
                         break;
                     }
@@ -515,18 +1144,18 @@ private:
                     if (srcIndex < 0)
                     {
                         // if not found, this is probably a feedback loop
-                        renderingOps.add (new ClearChannelOp (bufIndex));
+                        renderingOps.add (RenderingOpDescription::clearChannel (bufIndex));
                     }
                     else
                     {
-                        renderingOps.add (new CopyChannelOp (srcIndex, bufIndex));
+                        renderingOps.add (RenderingOpDescription::copyChannel (srcIndex, bufIndex));
                     }
 
                     reusableInputIndex = 0;
                     const int nodeDelay = getNodeDelay (sourceNodes.getFirst());
 
                     if (nodeDelay < maxLatency)
-                        renderingOps.add (new DelayChannelOp (bufIndex, maxLatency - nodeDelay));
+                        renderingOps.add (RenderingOpDescription::delayChannel (bufIndex, maxLatency - nodeDelay));
                 }
 
                 for (int j = 0; j < sourceNodes.size(); ++j)
@@ -545,18 +1174,18 @@ private:
                                                            sourceNodes.getUnchecked(j),
                                                            sourceOutputChans.getUnchecked(j)))
                                 {
-                                    renderingOps.add (new DelayChannelOp (srcIndex, maxLatency - nodeDelay));
+                                    renderingOps.add (RenderingOpDescription::delayChannel (srcIndex, maxLatency - nodeDelay));
                                 }
                                 else // buffer is reused elsewhere, can't be delayed
                                 {
                                     const int bufferToDelay = getFreeBuffer (false);
-                                    renderingOps.add (new CopyChannelOp (srcIndex, bufferToDelay));
-                                    renderingOps.add (new DelayChannelOp (bufferToDelay, maxLatency - nodeDelay));
+                                    renderingOps.add (RenderingOpDescription::copyChannel (srcIndex, bufferToDelay));
+                                    renderingOps.add (RenderingOpDescription::delayChannel (bufferToDelay, maxLatency - nodeDelay));
                                     srcIndex = bufferToDelay;
                                 }
                             }
 
-                            renderingOps.add (new AddChannelOp (srcIndex, bufIndex));
+                            renderingOps.add (RenderingOpDescription::addChannel (srcIndex, bufIndex));
                         }
                     }
                 }
@@ -591,11 +1220,13 @@ private:
 
         if (midiSourceNodes.size() == 0)
         {
-            // No midi inputs..
-            midiBufferToUse = getFreeBuffer (true); // need to pick a buffer even if the processor doesn't use midi
-
+            // No midi inputs.. (if the processor doesn't use midi at all, it'll be given
+            // a private empty buffer rather than one of the shared ones)
             if (processor.acceptsMidi() || processor.producesMidi())
-                renderingOps.add (new ClearMidiBufferOp (midiBufferToUse));
+            {
+                midiBufferToUse = getFreeBuffer (true);
+                renderingOps.add (RenderingOpDescription::clearMidiBuffer (midiBufferToUse));
+            }
         }
         else if (midiSourceNodes.size() == 1)
         {
@@ -613,7 +1244,7 @@ private:
                     // can't mess up this channel because it's needed later by another node, so we
                     // need to use a copy of it..
                     const int newFreeBuffer = getFreeBuffer (true);
-                    renderingOps.add (new CopyMidiBufferOp (midiBufferToUse, newFreeBuffer));
+                    renderingOps.add (RenderingOpDescription::copyMidiBuffer (midiBufferToUse, newFreeBuffer));
                     midiBufferToUse = newFreeBuffer;
                 }
             }
@@ -655,9 +1286,9 @@ private:
                 const int srcIndex = getBufferContaining (midiSourceNodes.getUnchecked(0),
                                                           AudioProcessorGraph::midiChannelIndex);
                 if (srcIndex >= 0)
-                    renderingOps.add (new CopyMidiBufferOp (srcIndex, midiBufferToUse));
+                    renderingOps.add (RenderingOpDescription::copyMidiBuffer (srcIndex, midiBufferToUse));
                 else
-                    renderingOps.add (new ClearMidiBufferOp (midiBufferToUse));
+                    renderingOps.add (RenderingOpDescription::clearMidiBuffer (midiBufferToUse));
 
                 reusableInputIndex = 0;
             }
@@ -669,7 +1300,7 @@ private:
                     const int srcIndex = getBufferContaining (midiSourceNodes.getUnchecked(j),
                                                               AudioProcessorGraph::midiChannelIndex);
                     if (srcIndex >= 0)
-                        renderingOps.add (new AddMidiBufferOp (srcIndex, midiBufferToUse));
+                        renderingOps.add (RenderingOpDescription::addMidiBuffer (srcIndex, midiBufferToUse));
                 }
             }
         }
@@ -683,27 +1314,32 @@ private:
         if (numOuts == 0)
             totalLatency = maxLatency;
 
-        renderingOps.add (new ProcessBufferOp (&node, audioChannelsToUse,
-                                               totalChans, midiBufferToUse));
+        renderingOps.add (RenderingOpDescription::processBuffer (node, audioChannelsToUse,
+                                                                 totalChans, midiBufferToUse));
     }
 
     //==============================================================================
     int getFreeBuffer (const bool forMidi)
     {
+        // When rendering in parallel, re-using a buffer that was freed by an earlier node
+        // would make the next node that uses it wait for that one to finish, so each
+        // node is given fresh buffers instead.
         if (forMidi)
         {
-            for (int i = 1; i < midiNodeIds.size(); ++i)
-                if (midiNodeIds.getUnchecked(i) == freeNodeID)
-                    return i;
+            if (reuseFreeBuffers)
+                for (int i = 1; i < midiNodeIds.size(); ++i)
+                    if (midiNodeIds.getUnchecked(i) == freeNodeID)
+                        return i;
 
             midiNodeIds.add ((uint32) freeNodeID);
             return midiNodeIds.size() - 1;
         }
         else
         {
-            for (int i = 1; i < nodeIds.size(); ++i)
-                if (nodeIds.getUnchecked(i) == freeNodeID)
-                    return i;
+            if (reuseFreeBuffers)
+                for (int i = 1; i < nodeIds.size(); ++i)
+                    if (nodeIds.getUnchecked(i) == freeNodeID)
+                        return i;
 
             nodeIds.add ((uint32) freeNodeID);
             channels.add (0);
@@ -813,136 +1449,654 @@ private:
 };
 
 //==============================================================================
-// Holds a fast lookup table for checking which nodes are inputs to others.
-class ConnectionLookupTable
+/** Arranges the nodes so that each one comes after all the nodes that feed into
+    it, in O(nodes + connections) time.
+
+    Nodes which are part of a feedback loop can never satisfy this, so when there's
+    nothing else left that can be placed, the earliest remaining node is taken
+    next, and its feedback inputs will just see silence.
+*/
+static void sortNodesForRendering (const ReferenceCountedArray<AudioProcessorGraph::Node>& nodes,
+                                   const OwnedArray<AudioProcessorGraph::Connection>& connections,
+                                   Array<AudioProcessorGraph::Node*>& orderedNodes)
 {
-public:
-    explicit ConnectionLookupTable (const OwnedArray<AudioProcessorGraph::Connection>& connections)
+    const int numNodes = nodes.size();
+
+    HashMap<int, int> nodeIndexes;
+
+    for (int i = 0; i < numNodes; ++i)
+        nodeIndexes.set ((int) nodes.getUnchecked (i)->nodeId, i);
+
+    // gather the connections into a list of destination nodes for each source node..
+    Array<int> numInputs, firstOutput, outputs;
+    numInputs.insertMultiple (0, 0, numNodes);
+    firstOutput.insertMultiple (0, 0, numNodes + 1);
+
+    for (int i = 0; i < connections.size(); ++i)
+    {
+        const AudioProcessorGraph::Connection* const c = connections.getUnchecked (i);
+
+        if (nodeIndexes.contains ((int) c->sourceNodeId) && nodeIndexes.contains ((int) c->destNodeId))
+        {
+            firstOutput.getReference (nodeIndexes[(int) c->sourceNodeId] + 1)++;
+            numInputs.getReference (nodeIndexes[(int) c->destNodeId])++;
+        }
+    }
+
+    for (int i = 0; i < numNodes; ++i)
+        firstOutput.getReference (i + 1) += firstOutput.getUnchecked (i);
+
+    outputs.insertMultiple (0, 0, firstOutput.getLast());
+    Array<int> nextOutputSlot (firstOutput);
+
+    for (int i = 0; i < connections.size(); ++i)
+    {
+        const AudioProcessorGraph::Connection* const c = connections.getUnchecked (i);
+
+        if (nodeIndexes.contains ((int) c->sourceNodeId) && nodeIndexes.contains ((int) c->destNodeId))
+            outputs.set (nextOutputSlot.getReference (nodeIndexes[(int) c->sourceNodeId])++,
+                         nodeIndexes[(int) c->destNodeId]);
+    }
+
+    // ..and then repeatedly take the nodes which have no inputs left to wait for.
+    Array<bool> isPlaced;
+    isPlaced.insertMultiple (0, false, numNodes);
+    Array<int> order;
+    order.ensureStorageAllocated (numNodes);
+
+    for (int i = 0; i < numNodes; ++i)
+    {
+        if (numInputs.getUnchecked (i) == 0)
+        {
+            order.add (i);
+            isPlaced.set (i, true);
+        }
+    }
+
+    for (int next = 0, earliestUnplaced = 0; order.size() < numNodes || next < order.size();)
+    {
+        if (next == order.size())
+        {
+            // only feedback loops are left..
+            while (isPlaced.getUnchecked (earliestUnplaced))
+                ++earliestUnplaced;
+
+            order.add (earliestUnplaced);
+            isPlaced.set (earliestUnplaced, true);
+        }
+
+        const int nodeIndex = order.getUnchecked (next++);
+
+        for (int i = firstOutput.getUnchecked (nodeIndex); i < firstOutput.getUnchecked (nodeIndex + 1); ++i)
+        {
+            const int destIndex = outputs.getUnchecked (i);
+
+            if (--numInputs.getReference (destIndex) == 0 && ! isPlaced.getUnchecked (destIndex))
+            {
+                order.add (destIndex);
+                isPlaced.set (destIndex, true);
+            }
+        }
+    }
+
+    orderedNodes.clearQuick();
+
+    for (int i = 0; i < order.size(); ++i)
+        orderedNodes.add (nodes.getUnchecked (order.getUnchecked (i)));
+}
+
+//==============================================================================
+struct ConnectionSorter
+{
+    static int compareElements (const AudioProcessorGraph::Connection* const first,
+                                const AudioProcessorGraph::Connection* const second) noexcept
+    {
+        if (first->sourceNodeId < second->sourceNodeId)                return -1;
+        if (first->sourceNodeId > second->sourceNodeId)                return 1;
+        if (first->destNodeId < second->destNodeId)                    return -1;
+        if (first->destNodeId > second->destNodeId)                    return 1;
+        if (first->sourceChannelIndex < second->sourceChannelIndex)    return -1;
+        if (first->sourceChannelIndex > second->sourceChannelIndex)    return 1;
+        if (first->destChannelIndex < second->destChannelIndex)        return -1;
+        if (first->destChannelIndex > second->destChannelIndex)        return 1;
+
+        return 0;
+    }
+};
+
+}
+
+//==============================================================================
+/** The rendering ops, split up into tasks that each end with the ProcessBufferOp
+    for one node, together with the dependencies between them.
+
+    A task depends on an earlier one if it reads a shared buffer that the earlier
+    one writes, or writes a buffer that the earlier one reads or writes. Running
+    the tasks in any order that respects these dependencies therefore produces
+    exactly the same output as running the ops in series.
+*/
+struct AudioProcessorGraph::RenderingTaskGraph
+{
+    RenderingTaskGraph (const GraphRenderingOps::RenderingProgram& program, const int numAudioChannels, const int numMidiBuffers)
     {
-        for (int i = 0; i < connections.size(); ++i)
+        const int numResources = GraphRenderingOps::BufferAccessList::getNumResources (numAudioChannels, numMidiBuffers);
+
+        Array<int> lastWriter;
+        lastWriter.insertMultiple (0, -1, numResources);
+        OwnedArray<Array<int> > readersSinceLastWrite;
+
+        for (int i = 0; i < numResources; ++i)
+            readersSinceLastWrite.add (new Array<int>());
+
+        for (int firstOp = 0; firstOp < program.size();)
         {
-            const AudioProcessorGraph::Connection* const c = connections.getUnchecked(i);
+            GraphRenderingOps::BufferAccessList accessList;
+            int endOp = firstOp;
+
+            while (endOp < program.size())
+            {
+                GraphRenderingOps::AudioGraphRenderingOpBase* const op = program.getOp (endOp++);
+
+                op->getBufferAccesses (accessList);
+
+                if (dynamic_cast<GraphRenderingOps::ProcessBufferOp*> (op) != nullptr)
+                    break;
+            }
 
-            int index;
-            Entry* entry = findEntry (c->destNodeId, index);
+            const int taskIndex = tasks.size();
+            Task* const task = tasks.add (new Task (firstOp, endOp));
+            SortedSet<int> inputs;
 
-            if (entry == nullptr)
+            for (int i = 0; i < accessList.accesses.size(); ++i)
             {
-                entry = new Entry (c->destNodeId);
-                entries.insert (index, entry);
+                const GraphRenderingOps::BufferAccessList::Access& access = accessList.accesses.getReference (i);
+                Array<int>& readers = *readersSinceLastWrite.getUnchecked (access.resource);
+                const int writer = lastWriter.getUnchecked (access.resource);
+
+                if (writer >= 0)
+                    inputs.add (writer);
+
+                if (access.isWrite)
+                {
+                    for (int j = 0; j < readers.size(); ++j)
+                        inputs.add (readers.getUnchecked (j));
+
+                    readers.clearQuick();
+                    lastWriter.set (access.resource, taskIndex);
+                }
+                else
+                {
+                    readers.addIfNotAlreadyThere (taskIndex);
+                }
             }
 
-            entry->srcNodes.add (c->sourceNodeId);
+            inputs.removeValue (taskIndex);
+            task->numInputs = inputs.size();
+
+            for (int i = 0; i < inputs.size(); ++i)
+                tasks.getUnchecked (inputs.getUnchecked (i))->outputs.add (taskIndex);
+
+            if (inputs.size() == 0)
+                initialTasks.add (taskIndex);
+
+            firstOp = endOp;
         }
+
+        readyQueue.calloc ((size_t) jmax (1, tasks.size()));
+    }
+
+    int getNumTasks() const noexcept        { return tasks.size(); }
+
+    /** Must be called before any threads start rendering the next block. */
+    void resetForNextBlock() noexcept
+    {
+        for (int i = 0; i < tasks.size(); ++i)
+        {
+            Task& task = *tasks.getUnchecked (i);
+            task.numInputsRemaining.set (task.numInputs);
+            readyQueue[i].set (-1);
+        }
+
+        numQueued.set (0);
+        numDequeued.set (0);
+        numCompleted.set (0);
+
+        for (int i = 0; i < initialTasks.size(); ++i)
+            pushReadyTask (initialTasks.getUnchecked (i));
     }
 
-    bool isAnInputTo (const uint32 possibleInputId,
-                      const uint32 possibleDestinationId) const noexcept
+    /** Performs any tasks that are ready, returning once all the tasks in the
+        current block have been completed. This may be called by several threads at once,
+        but only one of them may be the audio thread.
+    */
+    template <typename FloatType>
+    void renderTasks (const GraphRenderingOps::RenderingProgram& program, AudioBuffer<FloatType>& sharedBufferChans,
+                      const OwnedArray<MidiBuffer>& sharedMidiBuffers, const int numSamples,
+                      const bool isAudioThread) noexcept
     {
-        return isAnInputToRecursive (possibleInputId, possibleDestinationId, entries.size());
+        const int numTasks = tasks.size();
+        int numFailedAttempts = 0;
+
+        while (numCompleted.get() < numTasks)
+        {
+            const int taskIndex = popReadyTask();
+
+            if (taskIndex < 0)
+            {
+                // nothing can run until another thread finishes its task..
+                if (++numFailedAttempts > maxSpins)
+                {
+                    if (isAudioThread)
+                        waitForTaskToFinish();
+                    else
+                        Thread::yield();
+                }
+
+                continue;
+            }
+
+            numFailedAttempts = 0;
+            const Task& task = *tasks.getUnchecked (taskIndex);
+
+            program.perform (task.firstOp, task.endOp, sharedBufferChans, sharedMidiBuffers, numSamples);
+
+            for (int i = 0; i < task.outputs.size(); ++i)
+            {
+                const int nextTask = task.outputs.getUnchecked (i);
+
+                if (--(tasks.getUnchecked (nextTask)->numInputsRemaining) == 0)
+                    pushReadyTask (nextTask);
+            }
+
+            ++numCompleted;
+
+            if (audioThreadIsWaiting.get() != 0)
+                taskFinished.signal();
+        }
     }
 
 private:
     //==============================================================================
-    struct Entry
+    struct Task
     {
-        explicit Entry (const uint32 destNodeId_) noexcept : destNodeId (destNodeId_) {}
+        Task (int first, int end) noexcept  : firstOp (first), endOp (end), numInputs (0) {}
 
-        const uint32 destNodeId;
-        SortedSet<uint32> srcNodes;
+        const int firstOp, endOp;
+        int numInputs;
+        Array<int> outputs;
+        Atomic<int> numInputsRemaining;
 
-        JUCE_DECLARE_NON_COPYABLE (Entry)
+        JUCE_DECLARE_NON_COPYABLE (Task)
     };
 
-    OwnedArray<Entry> entries;
+    OwnedArray<Task> tasks;
+    Array<int> initialTasks;
+
+    enum { maxSpins = 256 };
+
+    // Used by the audio thread to sleep if it's been left with nothing to do but wait for a
+    // worker that has been descheduled in the middle of a task
+    WaitableEvent taskFinished;
+    Atomic<int> audioThreadIsWaiting;
+
+    // Every task is queued exactly once per block, so the ready queue never needs to wrap around.
+    HeapBlock<Atomic<int> > readyQueue;
+    Atomic<int> numQueued, numDequeued, numCompleted;
+
+    void pushReadyTask (const int taskIndex) noexcept
+    {
+        const int slot = (numQueued += 1) - 1;
+        readyQueue[slot].set (taskIndex);
+    }
 
-    bool isAnInputToRecursive (const uint32 possibleInputId,
-                               const uint32 possibleDestinationId,
-                               int recursionCheck) const noexcept
+    void waitForTaskToFinish() noexcept
     {
-        int index;
+        audioThreadIsWaiting.set (1);
+
+        // (the workers check the flag after finishing a task, so checking again after
+        // setting it means that we can't miss one)
+        if (numDequeued.get() >= numQueued.get() && numCompleted.get() < tasks.size())
+            taskFinished.wait (1);
+
+        audioThreadIsWaiting.set (0);
+    }
 
-        if (const Entry* const entry = findEntry (possibleDestinationId, index))
+    int popReadyTask() noexcept
+    {
+        for (;;)
         {
-            const SortedSet<uint32>& srcNodes = entry->srcNodes;
+            const int slot = numDequeued.get();
 
-            if (srcNodes.contains (possibleInputId))
-                return true;
+            if (slot >= numQueued.get())
+                return -1;
 
-            if (--recursionCheck >= 0)
+            if (numDequeued.compareAndSetBool (slot + 1, slot))
             {
-                for (int i = 0; i < srcNodes.size(); ++i)
-                    if (isAnInputToRecursive (possibleInputId, srcNodes.getUnchecked(i), recursionCheck))
-                        return true;
+                // the slot has been claimed by the thread pushing it, but may not have been filled in yet..
+                for (;;)
+                {
+                    const int taskIndex = readyQueue[slot].get();
+
+                    if (taskIndex >= 0)
+                        return taskIndex;
+                }
             }
         }
+    }
 
-        return false;
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderingTaskGraph)
+};
+
+//==============================================================================
+/** A fixed set of worker threads which help the audio callback thread to work
+    through a RenderingTaskGraph.
+
+    The audio thread always works through the tasks itself as well, so a block never
+    depends on a worker being scheduled in time: the workers just take some of the tasks
+    off its hands when they can.
+*/
+struct AudioProcessorGraph::RenderingThreadPool
+{
+    RenderingThreadPool (const int numWorkerThreads)
+        : lastBlockNumber (0)
+    {
+        for (int i = 0; i < numWorkerThreads; ++i)
+        {
+            WorkerThread* const worker = workers.add (new WorkerThread (*this));
+            worker->startThread (9); // (the same priority that the audio device threads use)
+        }
+    }
+
+    ~RenderingThreadPool()
+    {
+        for (int i = workers.size(); --i >= 0;)
+            workers.getUnchecked (i)->signalThreadShouldExit();
+
+        workers.clear();
     }
 
-    Entry* findEntry (const uint32 destNodeId, int& insertIndex) const noexcept
+    template <typename FloatType>
+    void render (RenderingTaskGraph& taskGraph, const GraphRenderingOps::RenderingProgram& program,
+                 AudioBuffer<FloatType>& sharedBufferChans,
+                 const OwnedArray<MidiBuffer>& sharedMidiBuffers, const int numSamples) noexcept
     {
-        Entry* result = nullptr;
+        // Make sure that no workers are still hanging around from the previous
+        // block before its state gets reset..
+        waitForWorkersToFinish();
+
+        job.set (taskGraph, program, sharedBufferChans, sharedMidiBuffers, numSamples);
+        taskGraph.resetForNextBlock();
+
+        lastBlockNumber = lastBlockNumber < maxBlockNumber ? lastBlockNumber + 1 : 1;
+        blockState.set (makeState (lastBlockNumber, 0));
+
+        // Workers that are still spinning after the last block will see the new block number
+        // by themselves, so only the ones that have gone to sleep need the system call to wake them
+        for (int i = workers.size(); --i >= 0;)
+        {
+            WorkerThread& worker = *workers.getUnchecked (i);
 
-        int start = 0;
-        int end = entries.size();
+            if (worker.isSleeping.get() != 0)
+                worker.notify();
+        }
+
+        taskGraph.renderTasks (program, sharedBufferChans, sharedMidiBuffers, numSamples, true);
+    }
+
+    /** Stops any more workers from joining in with the last block, and waits for the
+        ones that are already helping with it to get out of the way. After this,
+        nothing will touch the last block's task graph.
 
+        By the time the audio thread calls this, every task of the block has been
+        completed, so the only workers left are ones on their way out.
+    */
+    void waitForWorkersToFinish() noexcept
+    {
         for (;;)
         {
-            if (start >= end)
-            {
+            const int64 state = blockState.get();
+
+            if (blockState.compareAndSetBool (makeState (0, getNumActive (state)), state))
                 break;
-            }
-            else if (destNodeId == entries.getUnchecked (start)->destNodeId)
+        }
+
+        for (int numAttempts = 0; getNumActive (blockState.get()) > 0;)
+            if (++numAttempts > 64)
+                Thread::yield();
+    }
+
+private:
+    //==============================================================================
+    struct Job
+    {
+        Job() noexcept
+            : taskGraph (nullptr), program (nullptr), floatBuffers (nullptr),
+              doubleBuffers (nullptr), midiBuffers (nullptr), numSamples (0)
+        {}
+
+        void set (RenderingTaskGraph& g, const GraphRenderingOps::RenderingProgram& p, AudioBuffer<float>& buffers,
+                  const OwnedArray<MidiBuffer>& midi, int num) noexcept
+        {
+            set (g, p, midi, num);
+            floatBuffers = &buffers;
+        }
+
+        void set (RenderingTaskGraph& g, const GraphRenderingOps::RenderingProgram& p, AudioBuffer<double>& buffers,
+                  const OwnedArray<MidiBuffer>& midi, int num) noexcept
+        {
+            set (g, p, midi, num);
+            doubleBuffers = &buffers;
+        }
+
+        void set (RenderingTaskGraph& g, const GraphRenderingOps::RenderingProgram& p,
+                  const OwnedArray<MidiBuffer>& midi, int num) noexcept
+        {
+            taskGraph = &g;
+            program = &p;
+            midiBuffers = &midi;
+            numSamples = num;
+            floatBuffers = nullptr;
+            doubleBuffers = nullptr;
+        }
+
+        void run() const noexcept
+        {
+            if (floatBuffers != nullptr)
+                taskGraph->renderTasks (*program, *floatBuffers, *midiBuffers, numSamples, false);
+            else
+                taskGraph->renderTasks (*program, *doubleBuffers, *midiBuffers, numSamples, false);
+        }
+
+        RenderingTaskGraph* taskGraph;
+        const GraphRenderingOps::RenderingProgram* program;
+        AudioBuffer<float>* floatBuffers;
+        AudioBuffer<double>* doubleBuffers;
+        const OwnedArray<MidiBuffer>* midiBuffers;
+        int numSamples;
+    };
+
+    //==============================================================================
+    struct WorkerThread  : public Thread
+    {
+        WorkerThread (RenderingThreadPool& p)  : Thread ("Graph rendering thread"), pool (p) {}
+
+        ~WorkerThread()
+        {
+            stopThread (2000);
+        }
+
+        void run() override
+        {
+            int lastBlockDone = 0;
+
+            while (! threadShouldExit())
             {
-                result = entries.getUnchecked (start);
-                break;
+                const int blockNumber = waitForNextBlock (lastBlockDone);
+
+                if (blockNumber <= 0 || blockNumber == lastBlockDone)
+                    continue;
+
+                lastBlockDone = blockNumber;
+
+                // if the block has already finished and the next one is being set up, keep out of the way..
+                if (pool.tryToJoinBlock (blockNumber))
+                {
+                    pool.job.run();
+                    pool.blockState -= 1;
+                }
             }
-            else
+        }
+
+        int waitForNextBlock (const int lastBlockDone)
+        {
+            // The next block usually turns up soon, so spin for a little while before going to
+            // sleep, which saves the audio thread from having to make a system call to wake us
+            const uint32 spinEndTime = Time::getMillisecondCounter() + maxSpinMilliseconds;
+
+            for (int numAttempts = 0; ! threadShouldExit(); ++numAttempts)
             {
-                const int halfway = (start + end) / 2;
+                const int blockNumber = getBlockNumber (pool.blockState.get());
+
+                if (blockNumber > 0 && blockNumber != lastBlockDone)
+                    return blockNumber;
+
+                if (numAttempts > 64)
+                {
+                    if (Time::getMillisecondCounter() > spinEndTime)
+                        break;
+
+                    Thread::yield();
+                }
+            }
+
+            isSleeping.set (1);
+
+            // (the audio thread checks isSleeping after it publishes a block, so checking for
+            // a new block after setting it means that we can't miss one)
+            const int blockNumber = getBlockNumber (pool.blockState.get());
+
+            if ((blockNumber <= 0 || blockNumber == lastBlockDone) && ! threadShouldExit())
+                wait (100);
+
+            isSleeping.set (0);
+            return getBlockNumber (pool.blockState.get());
+        }
+
+        RenderingThreadPool& pool;
+        Atomic<int> isSleeping;
+
+        JUCE_DECLARE_NON_COPYABLE (WorkerThread)
+    };
+
+    //==============================================================================
+    enum { maxSpinMilliseconds = 2, maxBlockNumber = 0x7fffffff };
+
+    OwnedArray<WorkerThread> workers;
+    Job job;
+
+    // The number of the block that workers may join in with (or 0 when none is
+    // running) in the high bits, and the number of workers that have joined it in the low bits.
+    Atomic<int64> blockState;
+    int lastBlockNumber;
+
+    static int64 makeState (const int blockNumber, const int numActive) noexcept    { return ((int64) blockNumber << 16) | numActive; }
+    static int getBlockNumber (const int64 state) noexcept                         { return (int) (state >> 16); }
+    static int getNumActive (const int64 state) noexcept                           { return (int) (state & 0xffff); }
+
+    // Workers can only join while the block is still open, so once the audio thread has
+    // closed it, a worker that was descheduled on its way in can't hold it up.
+    bool tryToJoinBlock (const int blockNumber) noexcept
+    {
+        for (;;)
+        {
+            const int64 state = blockState.get();
+
+            if (getBlockNumber (state) != blockNumber)
+                return false;
+
+            if (blockState.compareAndSetBool (state + 1, state))
+                return true;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderingThreadPool)
+};
+
+//==============================================================================
+/** Everything the audio thread needs in order to render the graph: the ops, and
+    the buffers that they work on.
+
+    Each time the graph changes, a new one of these is built on the message thread
+    and published to the audio thread, which swaps it in at the start of its next
+    block and hands the old one back to be deleted on the message thread.
+*/
+struct AudioProcessorGraph::RenderSequence
+{
+    RenderSequence() noexcept  : nextRetired (nullptr) {}
+
+    void prepareBuffers (int numRenderingBuffers, int numMidiBuffers, int blockSize)
+    {
+        renderingBuffers.floatVersion. setSize (numRenderingBuffers, blockSize);
+        renderingBuffers.doubleVersion.setSize (numRenderingBuffers, blockSize);
+
+        renderingBuffers.floatVersion. clear();
+        renderingBuffers.doubleVersion.clear();
+
+        while (midiBuffers.size() < numMidiBuffers)
+            midiBuffers.add (new MidiBuffer());
+    }
+
+    GraphRenderingOps::RenderingProgram program;
+    ScopedPointer<RenderingTaskGraph> taskGraph;
+    FloatAndDoubleComposition<AudioBuffer<FloatPlaceholder> > renderingBuffers;
+    OwnedArray<MidiBuffer> midiBuffers;
+    RenderSequence* nextRetired;
 
-                if (halfway == start)
-                {
-                    if (destNodeId >= entries.getUnchecked (halfway)->destNodeId)
-                        ++start;
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderSequence)
+};
 
-                    break;
-                }
-                else if (destNodeId >= entries.getUnchecked (halfway)->destNodeId)
-                    start = halfway;
-                else
-                    end = halfway;
-            }
-        }
+//==============================================================================
+/** Deletes the sequences that the audio thread has finished with, along with any nodes
+    that they were keeping alive, soon after it moves on to a new one.
+*/
+struct AudioProcessorGraph::RetiredSequenceCollector  : private Timer
+{
+    RetiredSequenceCollector (AudioProcessorGraph& g) noexcept : graph (g) {}
+
+    void collectSoon()      { startTimer (50); }
+
+    void timerCallback() override
+    {
+        // The audio thread retires its old sequence before taking the pending one, so once
+        // there's nothing pending, everything that it's going to retire is already in the list.
+        const bool allAdopted = (graph.pendingRenderSequence.get() == nullptr);
+
+        graph.deleteRetiredRenderSequences();
 
-        insertIndex = start;
-        return result;
+        if (allAdopted)
+            stopTimer();
     }
 
-    JUCE_DECLARE_NON_COPYABLE (ConnectionLookupTable)
+    AudioProcessorGraph& graph;
+
+    JUCE_DECLARE_NON_COPYABLE (RetiredSequenceCollector)
 };
 
 //==============================================================================
-struct ConnectionSorter
+/** Keeps hold of the timing recorders for the nodes that are being profiled. */
+struct AudioProcessorGraph::NodeProfiler
 {
-    static int compareElements (const AudioProcessorGraph::Connection* const first,
-                                const AudioProcessorGraph::Connection* const second) noexcept
+    GraphRenderingOps::NodeTimingRecorder* getRecorderFor (const uint32 nodeId)
     {
-        if (first->sourceNodeId < second->sourceNodeId)                return -1;
-        if (first->sourceNodeId > second->sourceNodeId)                return 1;
-        if (first->destNodeId < second->destNodeId)                    return -1;
-        if (first->destNodeId > second->destNodeId)                    return 1;
-        if (first->sourceChannelIndex < second->sourceChannelIndex)    return -1;
-        if (first->sourceChannelIndex > second->sourceChannelIndex)    return 1;
-        if (first->destChannelIndex < second->destChannelIndex)        return -1;
-        if (first->destChannelIndex > second->destChannelIndex)        return 1;
+        for (int i = recorders.size(); --i >= 0;)
+            if (recorders.getObjectPointerUnchecked (i)->timings.nodeId == nodeId)
+                return recorders.getObjectPointerUnchecked (i);
 
-        return 0;
+        return recorders.add (new GraphRenderingOps::NodeTimingRecorder (nodeId));
     }
-};
 
-}
+    ReferenceCountedArray<GraphRenderingOps::NodeTimingRecorder> recorders;
+};
 
 //==============================================================================
 AudioProcessorGraph::Connection::Connection (const uint32 sourceID, const int sourceChannel,
@@ -1001,20 +2155,8 @@ struct AudioProcessorGraph::AudioProcessorGraphBufferHelpers
         currentAudioInputBuffer.doubleVersion = nullptr;
     }
 
-    void setRenderingBufferSize (int newNumChannels, int newNumSamples)
-    {
-        renderingBuffers.floatVersion. setSize (newNumChannels, newNumSamples);
-        renderingBuffers.doubleVersion.setSize (newNumChannels, newNumSamples);
-
-        renderingBuffers.floatVersion. clear();
-        renderingBuffers.doubleVersion.clear();
-    }
-
     void release()
     {
-        renderingBuffers.floatVersion. setSize (1, 1);
-        renderingBuffers.doubleVersion.setSize (1, 1);
-
         currentAudioInputBuffer.floatVersion  = nullptr;
         currentAudioInputBuffer.doubleVersion = nullptr;
 
@@ -1031,7 +2173,6 @@ struct AudioProcessorGraph::AudioProcessorGraphBufferHelpers
         currentAudioOutputBuffer.doubleVersion.setSize (newNumChannels, newNumSamples);
     }
 
-    FloatAndDoubleComposition<AudioBuffer<FloatPlaceholder> > renderingBuffers;
     FloatAndDoubleComposition<AudioBuffer<FloatPlaceholder>*> currentAudioInputBuffer;
     FloatAndDoubleComposition<AudioBuffer<FloatPlaceholder> > currentAudioOutputBuffer;
 };
@@ -1039,13 +2180,17 @@ struct AudioProcessorGraph::AudioProcessorGraphBufferHelpers
 //==============================================================================
 AudioProcessorGraph::AudioProcessorGraph()
     : lastNodeId (0), audioBuffers (new AudioProcessorGraphBufferHelpers),
+      activeRenderSequence (nullptr), retiredSequenceCollector (new RetiredSequenceCollector (*this)),
+      numRenderingThreads (1), nodeProfilingEnabled (false),
       currentMidiInputBuffer (nullptr), isPrepared (false)
 {
 }
 
 AudioProcessorGraph::~AudioProcessorGraph()
 {
+    retiredSequenceCollector = nullptr;
     clearRenderingSequence();
+    renderingThreadPool = nullptr;
     clear();
 }
 
@@ -1298,22 +2443,60 @@ bool AudioProcessorGraph::removeIllegalConnections()
 }
 
 //==============================================================================
-static void deleteRenderOpArray (Array<void*>& ops)
+void AudioProcessorGraph::clearRenderingSequence()
 {
-    for (int i = ops.size(); --i >= 0;)
-        delete static_cast<GraphRenderingOps::AudioGraphRenderingOpBase*> (ops.getUnchecked(i));
+    // This is only used when the graph isn't playing, so it's safe to lock the
+    // audio thread out while taking away the sequence that it's using.
+    RenderSequence* oldSequence;
+
+    {
+        const ScopedLock sl (getCallbackLock());
+
+        if (renderingThreadPool != nullptr)
+            renderingThreadPool->waitForWorkersToFinish();
+
+        oldSequence = activeRenderSequence;
+        activeRenderSequence = nullptr;
+    }
+
+    delete oldSequence;
+    delete pendingRenderSequence.exchange (nullptr);
+    deleteRetiredRenderSequences();
 }
 
-void AudioProcessorGraph::clearRenderingSequence()
+void AudioProcessorGraph::publishRenderSequence (RenderSequence* newSequence)
 {
-    Array<void*> oldOps;
+    // If the audio thread never picked up the previous sequence, it can go straight in the bin..
+    delete pendingRenderSequence.exchange (newSequence);
+    deleteRetiredRenderSequences();
 
+    // ..and the one that it's using now gets deleted once it has swapped this one in
+    retiredSequenceCollector->collectSoon();
+}
+
+void AudioProcessorGraph::retireRenderSequence (RenderSequence* oldSequence) noexcept
+{
+    if (oldSequence != nullptr)
     {
-        const ScopedLock sl (getCallbackLock());
-        renderingOps.swapWith (oldOps);
+        for (;;)
+        {
+            RenderSequence* const head = retiredRenderSequences.get();
+            oldSequence->nextRetired = head;
+
+            if (retiredRenderSequences.compareAndSetBool (oldSequence, head))
+                break;
+        }
     }
+}
 
-    deleteRenderOpArray (oldOps);
+void AudioProcessorGraph::deleteRetiredRenderSequences()
+{
+    for (RenderSequence* s = retiredRenderSequences.exchange (nullptr); s != nullptr;)
+    {
+        RenderSequence* const next = s->nextRetired;
+        delete s;
+        s = next;
+    }
 }
 
 bool AudioProcessorGraph::isAnInputTo (const uint32 possibleInputId,
@@ -1338,56 +2521,174 @@ bool AudioProcessorGraph::isAnInputTo (const uint32 possibleInputId,
 
 void AudioProcessorGraph::buildRenderingSequence()
 {
-    Array<void*> newRenderingOps;
-    int numRenderingBuffersNeeded = 2;
-    int numMidiBuffersNeeded = 1;
+    ScopedPointer<RenderSequence> newSequence (new RenderSequence());
 
     {
         MessageManagerLock mml;
 
+        for (int i = 0; i < nodes.size(); ++i)
+            nodes.getUnchecked(i)->prepare (getSampleRate(), getBlockSize(), this, getProcessingPrecision());
+
         Array<Node*> orderedNodes;
+        GraphRenderingOps::sortNodesForRendering (nodes, connections, orderedNodes);
 
-        {
-            const GraphRenderingOps::ConnectionLookupTable table (connections);
+        const bool renderInParallel = numRenderingThreads > 1;
 
-            for (int i = 0; i < nodes.size(); ++i)
-            {
-                Node* const node = nodes.getUnchecked(i);
+        OwnedArray<GraphRenderingOps::RenderingOpDescription> ops;
+        GraphRenderingOps::RenderingOpSequenceCalculator calculator (*this, orderedNodes, ops, ! renderInParallel);
 
-                node->prepare (getSampleRate(), getBlockSize(), this, getProcessingPrecision());
+        const int numRenderingBuffersNeeded = calculator.getNumBuffersNeeded();
+        const int numMidiBuffersNeeded = calculator.getNumMidiBuffersNeeded();
 
-                int j = 0;
-                for (; j < orderedNodes.size(); ++j)
-                    if (table.isAnInputTo (node->nodeId, ((Node*) orderedNodes.getUnchecked(j))->nodeId))
-                      break;
+        RenderingStatistics stats;
+        OwnedArray<GraphRenderingOps::RenderingOpDescription> fusedOps;
+        GraphRenderingOps::fuseRenderingOps (ops, fusedOps, stats.numElidedClears);
 
-                orderedNodes.insert (j, node);
-            }
+        if (nodeProfilingEnabled && nodeProfiler != nullptr)
+            for (int i = 0; i < fusedOps.size(); ++i)
+                if (AudioProcessorGraph::Node* const node = fusedOps.getUnchecked (i)->node)
+                    fusedOps.getUnchecked (i)->timingRecorder = nodeProfiler->getRecorderFor (node->nodeId);
+
+        newSequence->program.build (fusedOps);
+        newSequence->prepareBuffers (numRenderingBuffersNeeded, numMidiBuffersNeeded, getBlockSize());
+
+        if (renderInParallel)
+            newSequence->taskGraph = new RenderingTaskGraph (newSequence->program,
+                                                             numRenderingBuffersNeeded, numMidiBuffersNeeded);
+
+        stats.numNodes = nodes.size();
+        stats.numAudioBuffers = numRenderingBuffersNeeded;
+        stats.numMidiBuffers = numMidiBuffersNeeded;
+        stats.opsBeforeFusion = GraphRenderingOps::countRenderingOps (ops);
+        stats.opsAfterFusion = GraphRenderingOps::countRenderingOps (fusedOps);
+        stats.programSizeBytes = newSequence->program.getNumBytes();
+        renderingStatistics = stats;
+
+        StringArray lines;
+
+        for (int i = 0; i < fusedOps.size(); ++i)
+            lines.add (String (i).paddedLeft (' ', 4) + ": " + fusedOps.getUnchecked (i)->toString());
+
+        renderingProgramDescription = lines.joinIntoString (newLine);
+    }
+
+    // The audio thread will switch over to this at the start of its next block.
+    publishRenderSequence (newSequence.release());
+}
+
+void AudioProcessorGraph::setNumRenderingThreads (int newNumThreads)
+{
+    newNumThreads = jmax (1, newNumThreads);
+
+    if (newNumThreads != numRenderingThreads)
+    {
+        ScopedPointer<RenderingThreadPool> newPool (newNumThreads > 1 ? new RenderingThreadPool (newNumThreads - 1)
+                                                                      : nullptr);
+
+        {
+            const ScopedLock sl (getCallbackLock());
+            renderingThreadPool.swapWith (newPool);
+            numRenderingThreads = newNumThreads;
         }
 
-        GraphRenderingOps::RenderingOpSequenceCalculator calculator (*this, orderedNodes, newRenderingOps);
+        // (the old pool's threads are stopped here, outside the lock)
+        newPool = nullptr;
+
+        if (isPrepared)
+            buildRenderingSequence();
+    }
+}
+
+AudioProcessorGraph::OpCounts::OpCounts() noexcept
+    : numClears (0), numCopies (0), numAdds (0), numSums (0),
+      numDelays (0), numMidiOps (0), numProcesses (0)
+{
+}
+
+int AudioProcessorGraph::OpCounts::getTotal() const noexcept
+{
+    return numClears + numCopies + numAdds + numSums + numDelays + numMidiOps + numProcesses;
+}
+
+AudioProcessorGraph::RenderingStatistics::RenderingStatistics() noexcept
+    : numNodes (0), numAudioBuffers (0), numMidiBuffers (0),
+      numElidedClears (0), programSizeBytes (0)
+{
+}
+
+AudioProcessorGraph::RenderingStatistics AudioProcessorGraph::getRenderingStatistics() const
+{
+    return renderingStatistics;
+}
+
+String AudioProcessorGraph::getRenderingProgramDescription() const
+{
+    return renderingProgramDescription;
+}
+
+//==============================================================================
+AudioProcessorGraph::NodeTimings::NodeTimings() noexcept
+    : nodeId (0), numBlocks (0), minMs (0), averageMs (0), maxMs (0),
+      averageLoad (0), maxLoad (0)
+{
+    zerostruct (histogram);
+}
+
+double AudioProcessorGraph::NodeTimings::getHistogramBinLimit (const int binIndex) noexcept
+{
+    static const double limits[] = { 0.005, 0.01, 0.02, 0.05, 0.1, 0.25, 0.5, 1.0 };
 
-        numRenderingBuffersNeeded = calculator.getNumBuffersNeeded();
-        numMidiBuffersNeeded = calculator.getNumMidiBuffersNeeded();
+    return isPositiveAndBelow (binIndex, numElementsInArray (limits)) ? limits[binIndex]
+                                                                     : std::numeric_limits<double>::max();
+}
+
+void AudioProcessorGraph::setNodeProfilingEnabled (const bool shouldBeEnabled)
+{
+    if (nodeProfilingEnabled != shouldBeEnabled)
+    {
+        nodeProfilingEnabled = shouldBeEnabled;
+
+        if (shouldBeEnabled && nodeProfiler == nullptr)
+            nodeProfiler = new NodeProfiler();
+
+        if (isPrepared)
+            buildRenderingSequence();
     }
+}
+
+Array<AudioProcessorGraph::NodeTimings> AudioProcessorGraph::getNodeTimings()
+{
+    Array<NodeTimings> result;
 
+    if (nodeProfiler != nullptr)
     {
-        // swap over to the new rendering sequence..
-        const ScopedLock sl (getCallbackLock());
+        ReferenceCountedArray<GraphRenderingOps::NodeTimingRecorder>& recorders = nodeProfiler->recorders;
 
-        audioBuffers->setRenderingBufferSize (numRenderingBuffersNeeded, getBlockSize());
+        for (int i = recorders.size(); --i >= 0;)
+        {
+            GraphRenderingOps::NodeTimingRecorder& recorder = *recorders.getObjectPointerUnchecked (i);
 
-        for (int i = midiBuffers.size(); --i >= 0;)
-            midiBuffers.getUnchecked(i)->clear();
+            if (getNodeForId (recorder.timings.nodeId) == nullptr)
+            {
+                recorders.remove (i);
+                continue;
+            }
 
-        while (midiBuffers.size() < numMidiBuffersNeeded)
-            midiBuffers.add (new MidiBuffer());
+            recorder.update (getSampleRate());
 
-        renderingOps.swapWith (newRenderingOps);
+            if (recorder.timings.numBlocks > 0)
+                result.insert (0, recorder.timings);
+        }
     }
 
-    // delete the old ones..
-    deleteRenderOpArray (newRenderingOps);
+    return result;
+}
+
+void AudioProcessorGraph::resetNodeTimings()
+{
+    if (nodeProfiler != nullptr)
+        for (int i = 0; i < nodeProfiler->recorders.size(); ++i)
+            nodeProfiler->recorders.getObjectPointerUnchecked (i)->reset();
 }
 
 void AudioProcessorGraph::handleAsyncUpdate()
@@ -1421,8 +2722,8 @@ void AudioProcessorGraph::releaseResources()
     for (int i = 0; i < nodes.size(); ++i)
         nodes.getUnchecked(i)->unprepare();
 
+    clearRenderingSequence();
     audioBuffers->release();
-    midiBuffers.clear();
 
     currentMidiInputBuffer = nullptr;
     currentMidiOutputBuffer.clear();
@@ -1459,7 +2760,6 @@ void AudioProcessorGraph::setPlayHead (AudioPlayHead* audioPlayHead)
 template <typename FloatType>
 void AudioProcessorGraph::processAudio (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages)
 {
-    AudioBuffer<FloatType>&  renderingBuffers         = audioBuffers->renderingBuffers.get<FloatType>();
     AudioBuffer<FloatType>*& currentAudioInputBuffer  = audioBuffers->currentAudioInputBuffer.get<FloatType>();
     AudioBuffer<FloatType>&  currentAudioOutputBuffer = audioBuffers->currentAudioOutputBuffer.get<FloatType>();
 
@@ -1471,12 +2771,28 @@ void AudioProcessorGraph::processAudio (AudioBuffer<FloatType>& buffer, MidiBuff
     currentMidiInputBuffer = &midiMessages;
     currentMidiOutputBuffer.clear();
 
-    for (int i = 0; i < renderingOps.size(); ++i)
+    // pick up the latest rendering sequence, if a new one has been published. The old one
+    // is retired before the new one is taken, so that RetiredSequenceCollector can tell
+    // when there's nothing more to come.
+    if (pendingRenderSequence.get() != nullptr)
+    {
+        if (renderingThreadPool != nullptr)
+            renderingThreadPool->waitForWorkersToFinish();
+
+        retireRenderSequence (activeRenderSequence);
+        activeRenderSequence = pendingRenderSequence.exchange (nullptr);
+    }
+
+    if (RenderSequence* const sequence = activeRenderSequence)
     {
-        GraphRenderingOps::AudioGraphRenderingOpBase* const op
-            = (GraphRenderingOps::AudioGraphRenderingOpBase*) renderingOps.getUnchecked(i);
+        AudioBuffer<FloatType>& renderingBuffers = sequence->renderingBuffers.get<FloatType>();
+        const GraphRenderingOps::RenderingProgram& program = sequence->program;
 
-        op->perform (renderingBuffers, midiBuffers, numSamples);
+        if (renderingThreadPool != nullptr && sequence->taskGraph != nullptr)
+            renderingThreadPool->render (*sequence->taskGraph, program, renderingBuffers,
+                                         sequence->midiBuffers, numSamples);
+        else
+            program.perform (0, program.size(), renderingBuffers, sequence->midiBuffers, numSamples);
     }
 
     for (int i = 0; i < buffer.getNumChannels(); ++i)
@@ -1671,3 +2987,331 @@ void AudioProcessorGraph::AudioGraphIOProcessor::setParentGraph (AudioProcessorG
         updateHostDisplay();
     }
 }
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioProcessorGraphTests  : public UnitTest
+{
+public:
+    AudioProcessorGraphTests() : UnitTest ("AudioProcessorGraph") {}
+
+    void runTest() override
+    {
+        beginTest ("Parallel rendering matches serial rendering");
+        {
+            const ScopedJuceInitialiser_GUI libraryInitialiser;
+            Random r = getRandom();
+            const int numBlocks = 50;
+            const int blockSize = 256;
+
+            AudioBuffer<float> input (2, numBlocks * blockSize);
+
+            for (int ch = 0; ch < input.getNumChannels(); ++ch)
+                for (int i = 0; i < input.getNumSamples(); ++i)
+                    input.setSample (ch, i, r.nextFloat() * 2.0f - 1.0f);
+
+            const AudioBuffer<float> serialOutput (renderGraph (1, input, blockSize));
+
+            for (int numThreads = 2; numThreads <= 4; ++numThreads)
+            {
+                const AudioBuffer<float> parallelOutput (renderGraph (numThreads, input, blockSize));
+
+                expect (buffersAreIdentical (serialOutput, parallelOutput));
+            }
+        }
+
+        beginTest ("Nodes are rendered after their inputs, whatever order they were added in");
+        {
+            const ScopedJuceInitialiser_GUI libraryInitialiser;
+
+            AudioBuffer<float> input (2, 512);
+            Random r = getRandom();
+
+            for (int ch = 0; ch < input.getNumChannels(); ++ch)
+                for (int i = 0; i < input.getNumSamples(); ++i)
+                    input.setSample (ch, i, r.nextFloat() * 2.0f - 1.0f);
+
+            expect (buffersAreIdentical (renderChain (false, input), renderChain (true, input)));
+        }
+
+        beginTest ("Copies and adds onto the same channel are fused into sums");
+        {
+            const ScopedJuceInitialiser_GUI libraryInitialiser;
+            const int blockSize = 64;
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+            typedef AudioProcessorGraph::AudioGraphIOProcessor IOProcessor;
+            const uint32 inputId  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode))->nodeId;
+            const uint32 outputId = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode))->nodeId;
+            const uint32 mixId    = graph.addNode (new GainProcessor (1.0f))->nodeId;
+
+            for (int i = 0; i < 4; ++i)
+            {
+                const uint32 id = graph.addNode (new GainProcessor ((float) (1 << i)))->nodeId;
+                connectStereo (graph, inputId, id);
+                connectStereo (graph, id, mixId);
+            }
+
+            connectStereo (graph, mixId, outputId);
+            graph.prepareToPlay (44100.0, blockSize);
+
+            const AudioProcessorGraph::RenderingStatistics stats (graph.getRenderingStatistics());
+            expect (stats.opsAfterFusion.numSums > 0);
+            expectEquals (stats.opsAfterFusion.numAdds, 0);
+            expect (stats.opsAfterFusion.getTotal() < stats.opsBeforeFusion.getTotal());
+            expectEquals (stats.opsAfterFusion.numProcesses, graph.getNumNodes());
+            expect (stats.programSizeBytes > 0);
+            expect (graph.getRenderingProgramDescription().contains ("sum"));
+
+            // (these values can all be summed without any rounding)
+            AudioBuffer<float> block (2, blockSize), expected (2, blockSize);
+            Random r = getRandom();
+
+            for (int ch = 0; ch < block.getNumChannels(); ++ch)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const float sample = r.nextInt (16) / 8.0f - 1.0f;
+                    block.setSample (ch, i, sample);
+                    expected.setSample (ch, i, sample * 15.0f);
+                }
+            }
+
+            MidiBuffer midi;
+            graph.processBlock (block, midi);
+            expect (buffersAreIdentical (block, expected));
+
+            graph.releaseResources();
+        }
+
+        beginTest ("Node profiling");
+        {
+            const ScopedJuceInitialiser_GUI libraryInitialiser;
+            const int blockSize = 128, numBlocks = 10;
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+            typedef AudioProcessorGraph::AudioGraphIOProcessor IOProcessor;
+            const uint32 inputId  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode))->nodeId;
+            const uint32 filterId = graph.addNode (new FilterProcessor (0.5f, 0))->nodeId;
+            const uint32 outputId = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode))->nodeId;
+            connectStereo (graph, inputId, filterId);
+            connectStereo (graph, filterId, outputId);
+
+            graph.prepareToPlay (44100.0, blockSize);
+
+            AudioBuffer<float> block (2, blockSize);
+            MidiBuffer midi;
+
+            block.clear();
+            graph.processBlock (block, midi);
+            expect (graph.getNodeTimings().size() == 0);
+
+            graph.setNodeProfilingEnabled (true);
+
+            for (int i = 0; i < numBlocks; ++i)
+                graph.processBlock (block, midi);
+
+            const Array<AudioProcessorGraph::NodeTimings> timings (graph.getNodeTimings());
+            expectEquals (timings.size(), graph.getNumNodes());
+
+            for (int i = 0; i < timings.size(); ++i)
+            {
+                const AudioProcessorGraph::NodeTimings& t = timings.getReference (i);
+                expect (graph.getNodeForId (t.nodeId) != nullptr);
+                expectEquals (t.numBlocks, numBlocks);
+                expect (t.minMs <= t.averageMs && t.averageMs <= t.maxMs);
+                expect (t.averageLoad <= t.maxLoad);
+
+                int total = 0;
+
+                for (int bin = 0; bin < AudioProcessorGraph::NodeTimings::numHistogramBins; ++bin)
+                    total += t.histogram[bin];
+
+                expectEquals (total, numBlocks);
+            }
+
+            graph.resetNodeTimings();
+            expect (graph.getNodeTimings().size() == 0);
+
+            graph.setNodeProfilingEnabled (false);
+            graph.processBlock (block, midi);
+            expect (graph.getNodeTimings().size() == 0);
+
+            graph.releaseResources();
+        }
+    }
+
+private:
+    //==============================================================================
+    struct FilterProcessor  : public AudioProcessor
+    {
+        FilterProcessor (float coeff, int latency)
+            : AudioProcessor (BusesProperties().withInput  ("Input",  AudioChannelSet::stereo(), true)
+                                               .withOutput ("Output", AudioChannelSet::stereo(), true)),
+              coefficient (coeff), latencySamples (latency)
+        {}
+
+        const String getName() const override                   { return "Filter"; }
+        void prepareToPlay (double, int) override               { setLatencySamples (latencySamples); reset(); }
+        void releaseResources() override                        {}
+        void reset() override                                   { zeromem (state, sizeof (state)); }
+        double getTailLengthSeconds() const override            { return 0; }
+        bool acceptsMidi() const override                       { return false; }
+        bool producesMidi() const override                      { return false; }
+        bool hasEditor() const override                         { return false; }
+        AudioProcessorEditor* createEditor() override           { return nullptr; }
+        int getNumPrograms() override                           { return 0; }
+        int getCurrentProgram() override                        { return 0; }
+        void setCurrentProgram (int) override                   {}
+        const String getProgramName (int) override              { return {}; }
+        void changeProgramName (int, const String&) override    {}
+        void getStateInformation (juce::MemoryBlock&) override  {}
+        void setStateInformation (const void*, int) override    {}
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer&) override
+        {
+            for (int ch = 0; ch < jmin (2, buffer.getNumChannels()); ++ch)
+            {
+                float* data = buffer.getWritePointer (ch);
+
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                {
+                    state[ch] += (data[i] - state[ch]) * coefficient;
+                    data[i] = std::tanh (3.0f * state[ch]);
+                }
+            }
+        }
+
+        const float coefficient;
+        const int latencySamples;
+        float state[2];
+    };
+
+    struct GainProcessor  : public FilterProcessor
+    {
+        GainProcessor (float g)  : FilterProcessor (0.0f, 0), gain (g) {}
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer&) override    { buffer.applyGain (gain); }
+
+        const float gain;
+    };
+
+    static AudioBuffer<float> renderGraph (int numThreads, const AudioBuffer<float>& input, int blockSize)
+    {
+        AudioProcessorGraph graph;
+        graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+        typedef AudioProcessorGraph::AudioGraphIOProcessor IOProcessor;
+        const uint32 inputId  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode))->nodeId;
+        const uint32 outputId = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode))->nodeId;
+
+        Random r (1234);
+
+        // Some parallel chains of different lengths, some of which get mixed together
+        // before reaching the output..
+        Array<uint32> chainEnds;
+
+        for (int chain = 0; chain < 8; ++chain)
+        {
+            uint32 previousId = inputId;
+
+            for (int i = 0; i <= chain % 3; ++i)
+            {
+                const uint32 id = graph.addNode (new FilterProcessor (0.05f + 0.9f * r.nextFloat(), r.nextInt (3) * 7))->nodeId;
+                connectStereo (graph, previousId, id);
+                previousId = id;
+            }
+
+            chainEnds.add (previousId);
+        }
+
+        const uint32 mixId = graph.addNode (new FilterProcessor (0.5f, 0))->nodeId;
+
+        for (int i = 0; i < chainEnds.size(); ++i)
+            connectStereo (graph, chainEnds.getUnchecked (i), (i & 1) != 0 ? mixId : outputId);
+
+        connectStereo (graph, mixId, outputId);
+
+        graph.setNumRenderingThreads (numThreads);
+        graph.prepareToPlay (44100.0, blockSize);
+
+        AudioBuffer<float> output (input.getNumChannels(), input.getNumSamples());
+        AudioBuffer<float> block (input.getNumChannels(), blockSize);
+        MidiBuffer midi;
+
+        for (int start = 0; start < input.getNumSamples(); start += blockSize)
+        {
+            for (int ch = 0; ch < input.getNumChannels(); ++ch)
+                block.copyFrom (ch, 0, input, ch, start, blockSize);
+
+            graph.processBlock (block, midi);
+
+            for (int ch = 0; ch < input.getNumChannels(); ++ch)
+                output.copyFrom (ch, start, block, ch, 0, blockSize);
+        }
+
+        graph.releaseResources();
+        return output;
+    }
+
+    static AudioBuffer<float> renderChain (bool addNodesInReverse, const AudioBuffer<float>& input)
+    {
+        AudioProcessorGraph graph;
+        graph.setPlayConfigDetails (2, 2, 44100.0, input.getNumSamples());
+
+        typedef AudioProcessorGraph::AudioGraphIOProcessor IOProcessor;
+        const int numFilters = 6;
+        Array<uint32> chain;
+
+        chain.add (graph.addNode (new IOProcessor (IOProcessor::audioInputNode))->nodeId);
+
+        for (int i = 0; i < numFilters; ++i)
+        {
+            const int filterIndex = addNodesInReverse ? numFilters - 1 - i : i;
+            chain.add (graph.addNode (new FilterProcessor (0.1f + 0.1f * filterIndex, 0), (uint32) (100 + filterIndex))->nodeId);
+        }
+
+        chain.add (graph.addNode (new IOProcessor (IOProcessor::audioOutputNode))->nodeId);
+
+        for (int i = 0; i <= numFilters; ++i)
+        {
+            const uint32 sourceId = i == 0 ? chain.getFirst() : (uint32) (100 + i - 1);
+            const uint32 destId = i == numFilters ? chain.getLast() : (uint32) (100 + i);
+            connectStereo (graph, sourceId, destId);
+        }
+
+        graph.prepareToPlay (44100.0, input.getNumSamples());
+
+        AudioBuffer<float> output;
+        output.makeCopyOf (input);
+        MidiBuffer midi;
+        graph.processBlock (output, midi);
+
+        graph.releaseResources();
+        return output;
+    }
+
+    static void connectStereo (AudioProcessorGraph& graph, uint32 sourceId, uint32 destId)
+    {
+        for (int ch = 0; ch < 2; ++ch)
+            graph.addConnection (sourceId, ch, destId, ch);
+    }
+
+    static bool buffersAreIdentical (const AudioBuffer<float>& a, const AudioBuffer<float>& b)
+    {
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            if (memcmp (a.getReadPointer (ch), b.getReadPointer (ch), sizeof (float) * (size_t) a.getNumSamples()) != 0)
+                return false;
+
+        return true;
+    }
+};
+
+static AudioProcessorGraphTests audioProcessorGraphTests;
+
+#endif
@@ -39,6 +39,10 @@
 
     To play back a graph through an audio device, you might want to use an
     AudioProcessorPlayer object.
+
+    Whenever the nodes or connections change, the graph works out a new rendering
+    sequence on the message thread and hands it over to the audio thread without
+    locking, so a graph can be safely re-wired while it's playing.
 */
 class JUCE_API  AudioProcessorGraph   : public AudioProcessor,
                                         private AsyncUpdater
@@ -255,6 +259,157 @@ public:
     */
     static const int midiChannelIndex;
 
+    //==============================================================================
+    /** Sets the number of threads that will be used to render the graph.
+
+        By default, the nodes are rendered one after the other on the audio callback
+        thread. If you set this to a value greater than 1, the graph will start
+        (numThreads - 1) realtime worker threads, and nodes that don't depend on each
+        other will be rendered on these in parallel, with the audio callback thread
+        also joining in.
+
+        The audio that the graph produces is bit-for-bit identical in either mode,
+        but when rendering in parallel, each processor in the graph may be called on
+        a different thread from one block to the next, and at the same time as the
+        other processors in the graph.
+
+        @see getNumRenderingThreads
+    */
+    void setNumRenderingThreads (int numThreads);
+
+    /** Returns the number of threads that are being used to render the graph.
+        @see setNumRenderingThreads
+    */
+    int getNumRenderingThreads() const noexcept                         { return numRenderingThreads; }
+
+    //==============================================================================
+    /** Counts the different kinds of op in a rendering program.
+        @see RenderingStatistics
+    */
+    struct OpCounts
+    {
+        OpCounts() noexcept;
+
+        int numClears;      /**< Ops that clear an audio channel. */
+        int numCopies;      /**< Ops that copy one audio channel into another. */
+        int numAdds;        /**< Ops that add one audio channel onto another. */
+        int numSums;        /**< Fused ops that mix several audio channels in a single pass. */
+        int numDelays;      /**< Ops that delay a channel to compensate for latency. */
+        int numMidiOps;     /**< Ops that clear, copy or merge midi buffers. */
+        int numProcesses;   /**< Ops that call a node's processor. */
+
+        /** Returns the total number of ops. */
+        int getTotal() const noexcept;
+    };
+
+    /** Describes the rendering program that the graph has most recently built.
+
+        Whenever the graph is re-wired, its connections are turned into a list of
+        simple ops which mix the nodes' buffers together and call their processors.
+        This list is then optimised, so that chains of copies and adds that feed the
+        same channel are fused into a single multi-source sum, and clears whose
+        channel is about to be overwritten are dropped. The optimised ops are stored
+        next to each other in a single block of memory, which the audio thread walks
+        through each block.
+
+        @see getRenderingStatistics, getRenderingProgramDescription
+    */
+    struct RenderingStatistics
+    {
+        RenderingStatistics() noexcept;
+
+        int numNodes;                   /**< The number of nodes in the graph. */
+        int numAudioBuffers;            /**< The number of shared audio channels used for rendering. */
+        int numMidiBuffers;             /**< The number of shared midi buffers used for rendering. */
+        OpCounts opsBeforeFusion;       /**< The ops that the graph's connections were turned into. */
+        OpCounts opsAfterFusion;        /**< The ops that are actually performed for each block. */
+        int numElidedClears;            /**< The number of clears that were found to be unnecessary. */
+        size_t programSizeBytes;        /**< The size of the memory block holding the ops. */
+    };
+
+    /** Returns some statistics about the rendering program that the graph has most
+        recently built. This must only be called on the message thread.
+        @see getRenderingProgramDescription
+    */
+    RenderingStatistics getRenderingStatistics() const;
+
+    /** Returns a listing of the ops in the graph's current rendering program, one per
+        line, which can be useful when debugging a graph's performance.
+        This must only be called on the message thread.
+        @see getRenderingStatistics
+    */
+    String getRenderingProgramDescription() const;
+
+    //==============================================================================
+    /** The time that a node's processor has been taking to render its blocks.
+        @see getNodeTimings, setNodeProfilingEnabled
+    */
+    struct NodeTimings
+    {
+        NodeTimings() noexcept;
+
+        uint32 nodeId;          /**< The node that these timings are for. */
+        int numBlocks;          /**< The number of blocks that have been timed. */
+        double minMs;           /**< The shortest time that the node took to render a block. */
+        double averageMs;       /**< The average time that the node took to render a block. */
+        double maxMs;           /**< The longest time that the node took to render a block. */
+
+        /** The average proportion of each block's duration that the node took to render
+            it, i.e. the share of the audio callback's budget that the node is using.
+        */
+        double averageLoad;
+
+        /** The highest proportion of a block's duration that the node took to render it. */
+        double maxLoad;
+
+        enum { numHistogramBins = 9 };
+
+        /** The number of blocks whose load fell into each bin. The bins go up to 0.5%, 1%,
+            2%, 5%, 10%, 25%, 50% and 100% of the block's duration, and the last one counts
+            any blocks that took longer than their duration to render.
+            @see getHistogramBinLimit
+        */
+        int histogram[numHistogramBins];
+
+        /** Returns the load below which a block is counted in the given histogram bin. */
+        static double getHistogramBinLimit (int binIndex) noexcept;
+    };
+
+    /** Enables or disables timing of each node's processing.
+
+        When this is enabled, the time each node takes to render each block is recorded
+        on the audio thread and can be read with getNodeTimings(), which makes it easy to
+        find out which processors are using most of the callback's time. When it's
+        disabled, the nodes aren't timed at all, so it costs nothing.
+
+        This must only be called on the message thread.
+        @see getNodeTimings
+    */
+    void setNodeProfilingEnabled (bool shouldBeEnabled);
+
+    /** Returns true if node profiling has been enabled.
+        @see setNodeProfilingEnabled
+    */
+    bool isNodeProfilingEnabled() const noexcept                        { return nodeProfilingEnabled; }
+
+    /** Returns the timings of all the nodes that have been rendered since profiling was
+        enabled, or since the last call to resetNodeTimings().
+
+        The audio thread passes its timings over without locking, and they're gathered
+        together when this is called, so it should be called regularly (e.g. from a
+        timer) while profiling is enabled. If it isn't called often enough, some of the
+        timings may be lost.
+
+        This must only be called on the message thread.
+        @see setNodeProfilingEnabled, resetNodeTimings
+    */
+    Array<NodeTimings> getNodeTimings();
+
+    /** Clears all the timings that have been gathered so far.
+        This must only be called on the message thread.
+        @see getNodeTimings
+    */
+    void resetNodeTimings();
 
     //==============================================================================
     /** A special type of AudioProcessor that can live inside an AudioProcessorGraph
@@ -381,13 +536,27 @@ private:
     ReferenceCountedArray<Node> nodes;
     OwnedArray<Connection> connections;
     uint32 lastNodeId;
-    OwnedArray<MidiBuffer> midiBuffers;
-    Array<void*> renderingOps;
 
     friend class AudioGraphIOProcessor;
     struct AudioProcessorGraphBufferHelpers;
     ScopedPointer<AudioProcessorGraphBufferHelpers> audioBuffers;
 
+    struct RenderingTaskGraph;
+    struct RenderingThreadPool;
+    struct RenderSequence;
+    Atomic<RenderSequence*> pendingRenderSequence, retiredRenderSequences;
+    RenderSequence* activeRenderSequence;
+    struct RetiredSequenceCollector;
+    ScopedPointer<RetiredSequenceCollector> retiredSequenceCollector;
+    ScopedPointer<RenderingThreadPool> renderingThreadPool;
+    int numRenderingThreads;
+    RenderingStatistics renderingStatistics;
+    String renderingProgramDescription;
+
+    struct NodeProfiler;
+    ScopedPointer<NodeProfiler> nodeProfiler;
+    bool nodeProfilingEnabled;
+
     MidiBuffer* currentMidiInputBuffer;
     MidiBuffer currentMidiOutputBuffer;
 
@@ -396,6 +565,9 @@ private:
     void handleAsyncUpdate() override;
     void clearRenderingSequence();
     void buildRenderingSequence();
+    void publishRenderSequence (RenderSequence*);
+    void retireRenderSequence (RenderSequence*) noexcept;
+    void deleteRetiredRenderSequences();
     bool isAnInputTo (uint32 possibleInputId, uint32 possibleDestinationId, int recursionCheck) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProcessorGraph)
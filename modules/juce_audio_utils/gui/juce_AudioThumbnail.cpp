@@ -24,9 +24,30 @@
   ==============================================================================
 */
 
+// Unlike AudioBuffer::getRMSLevel(), this keeps four separate sums so that the additions
+// don't all have to wait for each other - the thumbnail calls it for every block it's given.
+static float findRMSLevel (const float* data, int numSamples) noexcept
+{
+    if (numSamples <= 0)
+        return 0.0f;
+
+    float sums[4] = { 0 };
+    int i = 0;
+
+    for (; i + 4 <= numSamples; i += 4)
+        for (int j = 0; j < 4; ++j)
+            sums[j] += data[i + j] * data[i + j];
+
+    for (; i < numSamples; ++i)
+        sums[0] += data[i] * data[i];
+
+    return std::sqrt ((sums[0] + sums[1] + sums[2] + sums[3]) / (float) numSamples);
+}
+
+//==============================================================================
 struct AudioThumbnail::MinMaxValue
 {
-    MinMaxValue() noexcept
+    MinMaxValue() noexcept  : rms (0)
     {
         values[0] = 0;
         values[1] = 0;
@@ -74,11 +95,46 @@ struct AudioThumbnail::MinMaxValue
                      std::abs ((int) values[1]));
     }
 
+    inline void setRMS (float newRMS) noexcept      { rms = (uint8) jlimit (0, 255, roundFloatToInt (newRMS * 255.0f)); }
+    inline float getRMS() const noexcept            { return rms * (1.0f / 255.0f); }
+
     inline void read (InputStream& input)      { input.read (values, 2); }
     inline void write (OutputStream& output)   { output.write (values, 2); }
 
+    inline void readRMS (InputStream& input)       { input.read (&rms, 1); }
+    inline void writeRMS (OutputStream& output)    { output.write (&rms, 1); }
+
+    // Combines a run of values into one that covers all of them
+    static MinMaxValue combine (const MinMaxValue* source, int num) noexcept
+    {
+        int8 mn = 127, mx = -128;
+        float sumOfSquares = 0;
+
+        for (int i = 0; i < num; ++i)
+        {
+            const MinMaxValue& v = source[i];
+
+            if (v.getMinValue() < mn)  mn = v.getMinValue();
+            if (v.getMaxValue() > mx)  mx = v.getMaxValue();
+
+            const float r = v.getRMS();
+            sumOfSquares += r * r;
+        }
+
+        MinMaxValue result;
+
+        if (mn <= mx)
+            result.set (mn, mx);
+
+        if (num > 0)
+            result.setRMS (std::sqrt (sumOfSquares / num));
+
+        return result;
+    }
+
 private:
     int8 values[2];
+    uint8 rms;
 };
 
 //==============================================================================
@@ -155,6 +211,7 @@ public:
     {
         const ScopedLock sl (readerLock);
         reader = nullptr;
+        sampleBuffer.setSize (0, 0);
     }
 
     int useTimeSlice() override
@@ -185,6 +242,7 @@ public:
                     return 0;
 
                 justFinished = true;
+                sampleBuffer.setSize (0, 0);
             }
         }
 
@@ -215,6 +273,7 @@ private:
     ScopedPointer<AudioFormatReader> reader;
     CriticalSection readerLock;
     uint32 lastReaderUseTime;
+    AudioSampleBuffer sampleBuffer;
 
     void createReader()
     {
@@ -245,15 +304,19 @@ private:
                 for (int i = 0; i < (int) numChannels; ++i)
                     levels[i] = levelData + i * numThumbSamps;
 
-                HeapBlock<Range<float> > levelsRead (numChannels);
+                // The whole block is read in one go, rather than a thumbnail sample at a time,
+                // which lets the reader convert it in large chunks
+                const int spts = owner.samplesPerThumbSample;
+                sampleBuffer.setSize ((int) numChannels, numThumbSamps * spts, false, false, true);
+                reader->read (&sampleBuffer, 0, numThumbSamps * spts, firstThumbIndex * (int64) spts, true, true);
 
-                for (int i = 0; i < numThumbSamps; ++i)
+                for (int j = 0; j < (int) numChannels; ++j)
                 {
-                    reader->readMaxLevels ((firstThumbIndex + i) * owner.samplesPerThumbSample,
-                                           owner.samplesPerThumbSample, levelsRead, (int) numChannels);
-
-                    for (int j = 0; j < (int) numChannels; ++j)
-                        levels[j][i].setFloat (levelsRead[j]);
+                    for (int i = 0; i < numThumbSamps; ++i)
+                    {
+                        levels[j][i].setFloat (FloatVectorOperations::findMinAndMax (sampleBuffer.getReadPointer (j, i * spts), spts));
+                        levels[j][i].setRMS (findRMSLevel (sampleBuffer.getReadPointer (j, i * spts), spts));
+                    }
                 }
 
                 {
@@ -275,7 +338,7 @@ class AudioThumbnail::ThumbData
 {
 public:
     ThumbData (const int numThumbSamples)
-        : peakLevel (-1)
+        : dirtyStart (0), dirtyEnd (0)
     {
         ensureSize (numThumbSamples);
     }
@@ -291,24 +354,15 @@ public:
         return data.size();
     }
 
-    void getMinMax (int startSample, int endSample, MinMaxValue& result) const noexcept
+    void getMinMax (int startSample, int endSample, MinMaxValue& result) const
     {
         if (startSample >= 0)
         {
-            endSample = jmin (endSample, data.size() - 1);
-
             int8 mx = -128;
             int8 mn = 127;
 
-            while (startSample <= endSample)
-            {
-                const MinMaxValue& v = data.getReference (startSample);
-
-                if (v.getMinValue() < mn)  mn = v.getMinValue();
-                if (v.getMaxValue() > mx)  mx = v.getMaxValue();
-
-                ++startSample;
-            }
+            MinMaxFinder finder (mn, mx);
+            visitRange (startSample, endSample, finder);
 
             if (mn <= mx)
             {
@@ -320,10 +374,22 @@ public:
         result.set (1, 0);
     }
 
-    void write (const MinMaxValue* const values, const int startIndex, const int numValues)
+    float getRMS (int startSample, int endSample) const
     {
-        resetPeak();
+        if (startSample < 0)
+            return 0.0f;
+
+        double sumOfSquares = 0;
+        int64 count = 0;
+
+        RMSFinder finder (sumOfSquares, count);
+        visitRange (startSample, endSample, finder);
+
+        return count > 0 ? (float) std::sqrt (sumOfSquares / (double) count) : 0.0f;
+    }
 
+    void write (const MinMaxValue* const values, const int startIndex, const int numValues)
+    {
         if (startIndex + numValues > data.size())
             ensureSize (startIndex + numValues);
 
@@ -331,31 +397,161 @@ public:
 
         for (int i = 0; i < numValues; ++i)
             dest[i] = values[i];
+
+        markDirty (startIndex, startIndex + numValues);
     }
 
-    void resetPeak() noexcept
+    // Call this after writing directly to the data
+    void rebuildLevels()
     {
-        peakLevel = -1;
+        markDirty (0, data.size());
     }
 
-    int getPeak() noexcept
+    int getPeak() const
     {
-        if (peakLevel < 0)
-        {
-            for (int i = 0; i < data.size(); ++i)
-            {
-                const int peak = data[i].getPeak();
-                if (peak > peakLevel)
-                    peakLevel = peak;
-            }
-        }
+        updateDirtyLevels();
+
+        // (the top level is a single value that summarises everything below it)
+        const Array<MinMaxValue>& top = getLevel (levels.size());
+        int peakLevel = 0;
+
+        for (int i = 0; i < top.size(); ++i)
+            peakLevel = jmax (peakLevel, top.getReference (i).getPeak());
 
         return peakLevel;
     }
 
 private:
+    //==============================================================================
+    /* The data is stored as a pyramid: levels[0] has one value for every levelRatio values
+       in data, levels[1] one for every levelRatio values in levels[0], and so on up to a
+       level with a single value. Any range of the data can then be summarised by looking at
+       no more than 2 * (levelRatio - 1) values at each level, so the time taken to draw
+       a pixel doesn't depend on how far the view is zoomed out.
+    */
+    enum { levelRatio = 4 };
+
     Array<MinMaxValue> data;
-    int peakLevel;
+
+    // The reduced levels are only brought up to date when they're next needed, so that
+    // adding lots of small blocks while recording doesn't recalculate them for each one
+    mutable OwnedArray<Array<MinMaxValue> > levels;
+    mutable int dirtyStart, dirtyEnd;
+
+    void markDirty (int startIndex, int endIndex) noexcept
+    {
+        if (dirtyStart < dirtyEnd)
+        {
+            dirtyStart = jmin (dirtyStart, startIndex);
+            dirtyEnd = jmax (dirtyEnd, endIndex);
+        }
+        else
+        {
+            dirtyStart = startIndex;
+            dirtyEnd = endIndex;
+        }
+    }
+
+    void updateDirtyLevels() const
+    {
+        if (dirtyStart < dirtyEnd)
+        {
+            updateLevels (dirtyStart, dirtyEnd);
+            dirtyStart = dirtyEnd = 0;
+        }
+    }
+
+    const Array<MinMaxValue>& getLevel (int level) const noexcept
+    {
+        return level == 0 ? data : *levels.getUnchecked (level - 1);
+    }
+
+    struct MinMaxFinder
+    {
+        MinMaxFinder (int8& mn, int8& mx) noexcept  : minValue (mn), maxValue (mx) {}
+
+        void visit (const MinMaxValue& v, int64) noexcept
+        {
+            if (v.getMinValue() < minValue)  minValue = v.getMinValue();
+            if (v.getMaxValue() > maxValue)  maxValue = v.getMaxValue();
+        }
+
+        int8& minValue;
+        int8& maxValue;
+    };
+
+    struct RMSFinder
+    {
+        RMSFinder (double& sum, int64& num) noexcept  : sumOfSquares (sum), count (num) {}
+
+        void visit (const MinMaxValue& v, int64 numThumbSamplesCovered) noexcept
+        {
+            const double rms = v.getRMS();
+            sumOfSquares += rms * rms * (double) numThumbSamplesCovered;
+            count += numThumbSamplesCovered;
+        }
+
+        double& sumOfSquares;
+        int64& count;
+    };
+
+    // Calls visitor.visit() for a set of values that exactly covers the thumbnail
+    // samples from startSample to endSample inclusive, using the highest levels possible.
+    template <typename Visitor>
+    void visitRange (int startSample, int endSample, Visitor& visitor) const
+    {
+        updateDirtyLevels();
+
+        int start = startSample;
+        int end = jmin (endSample, data.size() - 1) + 1;
+        int64 numCoveredByEach = 1;
+
+        for (int level = 0; start < end; ++level)
+        {
+            const Array<MinMaxValue>& values = getLevel (level);
+            const bool isTopLevel = (level == levels.size());
+
+            // values that don't make up a whole group at the level above are used individually..
+            while (start < end && (isTopLevel || start % levelRatio != 0))
+                visitor.visit (values.getReference (start++), numCoveredByEach);
+
+            while (start < end && end % levelRatio != 0)
+                visitor.visit (values.getReference (--end), numCoveredByEach);
+
+            // ..and the rest are taken from the next level up.
+            start /= levelRatio;
+            end /= levelRatio;
+            numCoveredByEach *= levelRatio;
+        }
+    }
+
+    // Recalculates the parts of the reduced levels that depend on a range of the data
+    void updateLevels (int startIndex, int endIndex) const
+    {
+        for (int level = 0;; ++level)
+        {
+            const Array<MinMaxValue>& below = getLevel (level);
+
+            if (below.size() <= 1)
+                break;
+
+            if (levels.size() <= level)
+                levels.add (new Array<MinMaxValue>());
+
+            Array<MinMaxValue>& above = *levels.getUnchecked (level);
+            const int numNeeded = (below.size() + levelRatio - 1) / levelRatio;
+
+            if (above.size() < numNeeded)
+                above.insertMultiple (-1, MinMaxValue(), numNeeded - above.size());
+
+            startIndex /= levelRatio;
+            endIndex = (endIndex + levelRatio - 1) / levelRatio;
+
+            for (int i = startIndex; i < endIndex; ++i)
+                above.setUnchecked (i, MinMaxValue::combine (below.begin() + i * levelRatio,
+                                                             jmin ((int) levelRatio, below.size() - i * levelRatio)));
+        }
+    }
 
     void ensureSize (const int thumbSamples)
     {
@@ -615,7 +811,8 @@ bool AudioThumbnail::loadFrom (InputStream& rawInput)
     int32 numThumbnailSamples = input.readInt();  // Number of samples in the thumbnail data.
     numChannels = input.readInt();                // Number of audio channels.
     sampleRate = input.readInt();                 // Source sample rate.
-    input.skipNextBytes (16);                     // (reserved)
+    const int flags = input.readInt();            // Which optional sections follow the min/max data.
+    input.skipNextBytes (12);                     // (reserved)
 
     createChannels (numThumbnailSamples);
 
@@ -623,6 +820,15 @@ bool AudioThumbnail::loadFrom (InputStream& rawInput)
         for (int chan = 0; chan < numChannels; ++chan)
             channels.getUnchecked(chan)->getData(i)->read (input);
 
+    if ((flags & hasRMSData) != 0)
+        for (int i = 0; i < numThumbnailSamples; ++i)
+            for (int chan = 0; chan < numChannels; ++chan)
+                channels.getUnchecked(chan)->getData(i)->readRMS (input);
+
+    // Only the full-resolution data is stored, as the reduced levels are quick to regenerate
+    for (int chan = 0; chan < numChannels; ++chan)
+        channels.getUnchecked(chan)->rebuildLevels();
+
     return true;
 }
 
@@ -639,12 +845,18 @@ void AudioThumbnail::saveTo (OutputStream& output) const
     output.writeInt (numThumbnailSamples);
     output.writeInt (numChannels);
     output.writeInt ((int) sampleRate);
-    output.writeInt64 (0);
+    output.writeInt (hasRMSData);
+    output.writeInt (0);
     output.writeInt64 (0);
 
+    // The RMS values go after the min/max data, so that older versions can still read the rest
     for (int i = 0; i < numThumbnailSamples; ++i)
         for (int chan = 0; chan < numChannels; ++chan)
             channels.getUnchecked(chan)->getData(i)->write (output);
+
+    for (int i = 0; i < numThumbnailSamples; ++i)
+        for (int chan = 0; chan < numChannels; ++chan)
+            channels.getUnchecked(chan)->getData(i)->writeRMS (output);
 }
 
 //==============================================================================
@@ -727,7 +939,9 @@ void AudioThumbnail::addBlock (const int64 startSample, const AudioSampleBuffer&
             for (int i = 0; i < numToDo; ++i)
             {
                 const int start = i * samplesPerThumbSample;
-                dest[i].setFloat (FloatVectorOperations::findMinAndMax (sourceData + start, jmin (samplesPerThumbSample, numSamples - start)));
+                const int num = jmin (samplesPerThumbSample, numSamples - start);
+                dest[i].setFloat (FloatVectorOperations::findMinAndMax (sourceData + start, num));
+                dest[i].setRMS (findRMSLevel (sourceData + start, num));
             }
         }
 
@@ -809,6 +1023,20 @@ void AudioThumbnail::getApproximateMinMax (const double startTime, const double
     maxValue = result.getMaxValue() / 128.0f;
 }
 
+float AudioThumbnail::getApproximateRMS (const double startTime, const double endTime, const int channelIndex) const noexcept
+{
+    const ScopedLock sl (lock);
+    const ThumbData* const data = channels [channelIndex];
+
+    if (data == nullptr || sampleRate <= 0)
+        return 0.0f;
+
+    const int firstThumbIndex = (int) ((startTime * sampleRate) / samplesPerThumbSample);
+    const int lastThumbIndex  = (int) (((endTime * sampleRate) + samplesPerThumbSample - 1) / samplesPerThumbSample);
+
+    return data->getRMS (jmax (0, firstThumbIndex), lastThumbIndex);
+}
+
 void AudioThumbnail::drawChannel (Graphics& g, const Rectangle<int>& area, double startTime,
                                   double endTime, int channelNum, float verticalZoomFactor)
 {
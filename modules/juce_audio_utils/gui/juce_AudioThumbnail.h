@@ -42,7 +42,9 @@
     listeners should repaint themselves.
 
     The thumbnail stores an internal low-res version of the wave data, and this can
-    be loaded and saved to avoid having to scan the file again.
+    be loaded and saved to avoid having to scan the file again. It also keeps summaries
+    of that data at a series of coarser resolutions, so that drawing a zoomed-out view
+    of a long file only takes as long as the number of pixels being drawn.
 
     @see AudioThumbnailCache, AudioThumbnailBase
 */
@@ -186,6 +188,14 @@ public:
     void getApproximateMinMax (double startTime, double endTime, int channelIndex,
                                float& minValue, float& maxValue) const noexcept override;
 
+    /** Returns the approximate RMS level of a section of one of the channels.
+        Like getApproximateMinMax(), this is worked out from the low-res data, so
+        the start and end times will be rounded to the nearest thumbnail samples.
+        If the thumbnail was loaded from data that was saved by an older version, which
+        didn't store RMS levels, this will return 0.
+    */
+    float getApproximateRMS (double startTime, double endTime, int channelIndex) const noexcept;
+
     /** Returns the hash code that was set by setSource() or setReader(). */
     int64 getHashCode() const override;
 
@@ -216,6 +226,8 @@ private:
     double sampleRate;
     CriticalSection lock;
 
+    enum { hasRMSData = 1 };
+
     void clearChannelData();
     bool setDataSource (LevelDataSource* newSource);
     void setLevels (const MinMaxValue* const* values, int thumbIndex, int numChans, int numValues);
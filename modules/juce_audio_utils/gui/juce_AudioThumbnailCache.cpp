@@ -157,11 +157,39 @@ static inline int getThumbnailCacheFileMagicHeader() noexcept
     return (int) ByteOrder::littleEndianInt ("ThmC");
 }
 
+static inline int getCompressedThumbnailCacheFileMagicHeader() noexcept
+{
+    return (int) ByteOrder::littleEndianInt ("ThmZ");
+}
+
 bool AudioThumbnailCache::readFromStream (InputStream& source)
 {
-    if (source.readInt() != getThumbnailCacheFileMagicHeader())
+    const int header = source.readInt();
+
+    if (header == getCompressedThumbnailCacheFileMagicHeader())
+    {
+        // The compressed data is read into memory first, so that the decompressor can't
+        // read past the end of it into whatever follows in the source stream
+        const int64 compressedSize = source.readInt64();
+
+        MemoryBlock compressed;
+
+        if (compressedSize < 0 || source.readIntoMemoryBlock (compressed, (ssize_t) compressedSize) != (size_t) compressedSize)
+            return false;
+
+        MemoryInputStream compressedStream (compressed, false);
+        GZIPDecompressorInputStream uncompressed (compressedStream);
+        return readEntries (uncompressed);
+    }
+
+    if (header != getThumbnailCacheFileMagicHeader())
         return false;
 
+    return readEntries (source);
+}
+
+bool AudioThumbnailCache::readEntries (InputStream& source)
+{
     const ScopedLock sl (lock);
     clear();
     int numThumbnails = jmin (maxNumThumbsToStore, source.readInt());
@@ -176,11 +204,20 @@ void AudioThumbnailCache::writeToStream (OutputStream& out)
 {
     const ScopedLock sl (lock);
 
-    out.writeInt (getThumbnailCacheFileMagicHeader());
-    out.writeInt (thumbs.size());
+    MemoryOutputStream compressed;
+
+    {
+        GZIPCompressorOutputStream zipper (&compressed);
+
+        zipper.writeInt (thumbs.size());
+
+        for (int i = 0; i < thumbs.size(); ++i)
+            thumbs.getUnchecked(i)->write (zipper);
+    }
 
-    for (int i = 0; i < thumbs.size(); ++i)
-        thumbs.getUnchecked(i)->write (out);
+    out.writeInt (getCompressedThumbnailCacheFileMagicHeader());
+    out.writeInt64 ((int64) compressed.getDataSize());
+    out.write (compressed.getData(), compressed.getDataSize());
 }
 
 void AudioThumbnailCache::saveNewlyFinishedThumbnail (const AudioThumbnailBase&, int64)
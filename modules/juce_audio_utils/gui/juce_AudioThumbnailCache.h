@@ -77,11 +77,15 @@ public:
     /** Attempts to re-load a saved cache of thumbnails from a stream.
         The cache data must have been written by the writeToStream() method.
         This will replace all currently-loaded thumbnails with the new data.
+        Data that was saved by older versions, before writeToStream() compressed it,
+        can still be loaded.
     */
     bool readFromStream (InputStream& source);
 
     /** Writes all currently-loaded cache data to a stream.
         The resulting data can be re-loaded with readFromStream().
+        The thumbnails are compressed, so the stream will be a lot smaller than the
+        amount of memory that they take up in the cache.
     */
     void writeToStream (OutputStream& stream);
 
@@ -111,6 +115,7 @@ private:
 
     ThumbnailCacheEntry* findThumbFor (int64 hash) const;
     int findOldestThumb() const;
+    bool readEntries (InputStream&);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioThumbnailCache)
 };
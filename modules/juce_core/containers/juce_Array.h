@@ -65,7 +65,7 @@ public:
     /** Creates a copy of another array.
         @param other    the array to copy
     */
-    Array (const Array<ElementType, TypeOfCriticalSectionToUse>& other)
+    Array (const Array& other)
     {
         const ScopedLockType lock (other.getLock());
         numUsed = other.numUsed;
@@ -75,7 +75,7 @@ public:
             new (data.elements + i) ElementType (other.data.elements[i]);
     }
 
-    Array (Array<ElementType, TypeOfCriticalSectionToUse>&& other) noexcept
+    Array (Array&& other) noexcept
         : data (static_cast<ArrayAllocationBase<ElementType, TypeOfCriticalSectionToUse>&&> (other.data)),
           numUsed (other.numUsed)
     {
@@ -128,7 +128,7 @@ public:
     {
         if (this != &other)
         {
-            Array<ElementType, TypeOfCriticalSectionToUse> otherCopy (other);
+            Array otherCopy (other);
             swapWith (otherCopy);
         }
 
@@ -94,6 +94,44 @@ public:
     /** Returns the section of the file at which the mapped memory represents. */
     Range<int64> getRange() const noexcept      { return range; }
 
+    //==============================================================================
+    /** Describes the order in which the mapped memory is going to be read.
+        @see setAccessPattern
+    */
+    enum AccessPattern
+    {
+        normalAccess,       /**< No particular order - the OS will use its default amount of read-ahead. */
+        sequentialAccess,   /**< The memory will mostly be read in order, so the OS can read further ahead of
+                                 each page that's accessed, and release pages once they've been passed. */
+        randomAccess        /**< The memory will be read in no predictable order, so reading ahead of each
+                                 page that's accessed would be wasted effort. */
+    };
+
+    /** Tells the OS how the mapped memory is going to be read, so that it can decide how to
+        page it in. A new mapping is treated as sequentialAccess.
+
+        This is only a hint, and it's ignored on platforms that can't make use of it.
+    */
+    void setAccessPattern (AccessPattern pattern) noexcept;
+
+    /** Asks the OS to start loading part of the mapped file in the background, so that it's
+        already in memory by the time it gets read.
+
+        The range is in bytes from the start of the file, and is clipped to the mapped range.
+        This returns immediately, and does nothing on platforms that don't support it.
+    */
+    void prefetch (Range<int64> fileRange) const noexcept;
+
+    /** Tells the OS that part of the mapped file won't be needed for a while, so that it can
+        release the memory that's holding it. If it's accessed again, the data will be read
+        back from the file.
+
+        The range is in bytes from the start of the file, and is clipped to the mapped range.
+        Don't use this on a read-write mapping that was opened exclusively, because any changes
+        to it that haven't been written back would be lost.
+    */
+    void evict (Range<int64> fileRange) const noexcept;
+
 private:
     //==============================================================================
     void* address;
@@ -137,6 +137,7 @@ namespace juce
 #include "maths/juce_Expression.cpp"
 #include "maths/juce_Random.cpp"
 #include "memory/juce_MemoryBlock.cpp"
+#include "memory/juce_AllocationHooks.cpp"
 #include "misc/juce_RuntimePermissions.cpp"
 #include "misc/juce_Result.cpp"
 #include "misc/juce_Uuid.cpp"
@@ -164,6 +165,7 @@ namespace juce
 #include "threads/juce_ReadWriteLock.cpp"
 #include "threads/juce_Thread.cpp"
 #include "threads/juce_ThreadPool.cpp"
+#include "threads/juce_ParallelWorkerPool.cpp"
 #include "threads/juce_TimeSliceThread.cpp"
 #include "time/juce_PerformanceCounter.cpp"
 #include "time/juce_RelativeTime.cpp"
@@ -249,3 +251,24 @@ namespace juce
 #endif
 
 }
+
+//==============================================================================
+#if JUCE_ENABLE_ALLOCATION_HOOKS
+void* operator new (size_t size)
+{
+    juce::ScopedAllocationCounter::newOrDeleteCalled();
+
+    if (void* p = std::malloc (size > 0 ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (size_t size)                                  { return operator new (size); }
+void* operator new (size_t size, const std::nothrow_t&) noexcept    { juce::ScopedAllocationCounter::newOrDeleteCalled(); return std::malloc (size > 0 ? size : 1); }
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept  { return operator new (size, std::nothrow); }
+void operator delete (void* p) noexcept                             { juce::ScopedAllocationCounter::newOrDeleteCalled(); std::free (p); }
+void operator delete[] (void* p) noexcept                           { operator delete (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept      { operator delete (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept    { operator delete (p); }
+#endif
@@ -105,6 +105,18 @@
  #define JUCE_CHECK_MEMORY_LEAKS 1
 #endif
 
+//==============================================================================
+/** Config: JUCE_ENABLE_ALLOCATION_HOOKS
+
+    Replaces the global operator new and delete with versions that notify any
+    ScopedAllocationCounter on the calling thread, and makes HeapBlock notify them too. This is intended for use in tests
+    which check that realtime code doesn't allocate, so should be left disabled in
+    release builds.
+*/
+#ifndef JUCE_ENABLE_ALLOCATION_HOOKS
+ #define JUCE_ENABLE_ALLOCATION_HOOKS 0
+#endif
+
 //==============================================================================
 /** Config: JUCE_DONT_AUTOLINK_TO_WIN32_LIBRARIES
 
@@ -214,6 +226,7 @@ extern JUCE_API void JUCE_CALLTYPE logAssertion (const char* file, int line) noe
 #include "text/juce_StringRef.h"
 #include "logging/juce_Logger.h"
 #include "memory/juce_LeakedObjectDetector.h"
+#include "memory/juce_AllocationHooks.h"
 #include "memory/juce_ContainerDeletePolicy.h"
 #include "memory/juce_HeapBlock.h"
 #include "memory/juce_MemoryBlock.h"
@@ -289,6 +302,7 @@ extern JUCE_API void JUCE_CALLTYPE logAssertion (const char* file, int line) noe
 #include "threads/juce_Thread.h"
 #include "threads/juce_ThreadLocalValue.h"
 #include "threads/juce_ThreadPool.h"
+#include "threads/juce_ParallelWorkerPool.h"
 #include "threads/juce_TimeSliceThread.h"
 #include "threads/juce_ReadWriteLock.h"
 #include "threads/juce_ScopedReadLock.h"
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+#if JUCE_ENABLE_ALLOCATION_HOOKS
+
+namespace AllocationHookHelpers
+{
+    // This can't use ThreadLocalValue, because that allocates..
+    static ScopedAllocationCounter*& getCurrentCounter() noexcept
+    {
+        static thread_local ScopedAllocationCounter* counter = nullptr;
+        return counter;
+    }
+}
+
+ScopedAllocationCounter::ScopedAllocationCounter() noexcept
+    : previous (AllocationHookHelpers::getCurrentCounter()), numCalls (0)
+{
+    AllocationHookHelpers::getCurrentCounter() = this;
+}
+
+ScopedAllocationCounter::~ScopedAllocationCounter() noexcept
+{
+    // counters must be destroyed in the reverse order to the one they were created in
+    jassert (AllocationHookHelpers::getCurrentCounter() == this);
+    AllocationHookHelpers::getCurrentCounter() = previous;
+}
+
+void ScopedAllocationCounter::newOrDeleteCalled() noexcept
+{
+    for (ScopedAllocationCounter* c = AllocationHookHelpers::getCurrentCounter(); c != nullptr; c = c->previous)
+        ++(c->numCalls);
+}
+
+#endif
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+#pragma once
+
+#if JUCE_ENABLE_ALLOCATION_HOOKS
+
+//==============================================================================
+/**
+    Counts the calls to operator new and delete that are made on the current thread
+    during its lifetime, along with the memory that HeapBlock allocates.
+
+    This is only available when JUCE_ENABLE_ALLOCATION_HOOKS is enabled, in which case
+    JUCE replaces the global operator new and delete. It's intended for tests that need
+    to check that some code, such as an audio callback, never uses the allocator.
+
+    e.g. @code
+    {
+        ScopedAllocationCounter counter;
+        synth.renderNextBlock (buffer, midi, 0, buffer.getNumSamples());
+        expectEquals (counter.getNumCalls(), 0);
+    }
+    @endcode
+
+    Counters can be nested, in which case each of them will count all the calls
+    made while it exists.
+*/
+class JUCE_API  ScopedAllocationCounter
+{
+public:
+    ScopedAllocationCounter() noexcept;
+    ~ScopedAllocationCounter() noexcept;
+
+    /** Returns the number of times new or delete has been called so far. */
+    int getNumCalls() const noexcept        { return numCalls; }
+
+    /** @internal */
+    static void newOrDeleteCalled() noexcept;
+
+private:
+    ScopedAllocationCounter* const previous;
+    int numCalls;
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedAllocationCounter)
+};
+
+#endif
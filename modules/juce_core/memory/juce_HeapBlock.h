@@ -288,6 +288,11 @@ private:
 
     void throwOnAllocationFailure() const
     {
+       #if JUCE_ENABLE_ALLOCATION_HOOKS
+        // this goes straight to malloc rather than through operator new, so has to report its own allocations
+        ScopedAllocationCounter::newOrDeleteCalled();
+       #endif
+
        #if JUCE_EXCEPTIONS_DISABLED
         jassert (data != nullptr); // without exceptions, you'll need to find a better way to handle this failure case.
        #else
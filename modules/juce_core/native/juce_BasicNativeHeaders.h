@@ -144,6 +144,10 @@
  #include <shlwapi.h>
  #include <mmsystem.h>
 
+ #if JUCE_MSVC
+  #include <immintrin.h> // (for _xgetbv)
+ #endif
+
  #if JUCE_MINGW
   #include <basetyps.h>
   #include <sys/time.h>
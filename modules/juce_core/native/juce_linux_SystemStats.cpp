@@ -133,17 +133,22 @@ String SystemStats::getDisplayLanguage() { return getUserLanguage() + "-" + getU
 //==============================================================================
 void CPUInformation::initialise() noexcept
 {
-    auto flags = getCpuInfo ("flags");
+    // (the flags have to be matched as whole words, as some are prefixes of others - e.g. "fma" and "fma4")
+    StringArray flags;
+    flags.addTokens (getCpuInfo ("flags"), false);
+
     hasMMX   = flags.contains ("mmx");
     hasSSE   = flags.contains ("sse");
     hasSSE2  = flags.contains ("sse2");
-    hasSSE3  = flags.contains ("sse3");
+    hasSSE3  = flags.contains ("pni"); // (this is what the kernel calls SSE3)
     has3DNow = flags.contains ("3dnow");
     hasSSSE3 = flags.contains ("ssse3");
     hasSSE41 = flags.contains ("sse4_1");
     hasSSE42 = flags.contains ("sse4_2");
     hasAVX   = flags.contains ("avx");
     hasAVX2  = flags.contains ("avx2");
+    hasFMA3  = flags.contains ("fma");
+    hasAVX512F = flags.contains ("avx512f");
 
     numLogicalCPUs  = getCpuInfo ("processor").getIntValue() + 1;
 
@@ -59,6 +59,13 @@ namespace SystemStatsHelpers
 
         a = la; b = lb; c = lc; d = ld;
     }
+
+    static uint64 doXGETBV()
+    {
+        uint32 lo = 0, hi = 0;
+        asm (".byte 0x0f, 0x01, 0xd0" : "=a" (lo), "=d" (hi) : "c" (0)); // (xgetbv)
+        return ((uint64) hi << 32) | lo;
+    }
    #endif
 }
 
@@ -78,9 +85,16 @@ void CPUInformation::initialise() noexcept
     hasSSE41 = (c & (1u << 19)) != 0;
     hasSSE42 = (c & (1u << 20)) != 0;
     hasAVX   = (c & (1u << 28)) != 0;
+    hasFMA3  = (c & (1u << 12)) != 0;
+
+    // The CPUID bits only say what the CPU can do: the OS also has to have enabled
+    // saving the AVX-512 registers (the opmask, and upper halves of the ZMM registers)
+    const bool osSavesAVX512State = (c & (1u << 27)) != 0 // (OSXSAVE)
+                                     && (SystemStatsHelpers::doXGETBV() & 0xe6) == 0xe6;
 
     SystemStatsHelpers::doCPUID (a, b, c, d, 7);
-    hasAVX2  = (b & (1u <<  5)) != 0;
+    hasAVX2    = (b & (1u <<  5)) != 0;
+    hasAVX512F = (b & (1u << 16)) != 0 && osSavesAVX512State;
    #endif
 
     numLogicalCPUs = (int) [[NSProcessInfo processInfo] activeProcessorCount];
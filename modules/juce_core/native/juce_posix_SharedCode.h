@@ -623,6 +623,39 @@ void MemoryMappedFile::openInternal (const File& file, AccessMode mode, bool exc
     }
 }
 
+void MemoryMappedFile::setAccessPattern (AccessPattern pattern) noexcept
+{
+    if (address != nullptr)
+        madvise (address, (size_t) range.getLength(), pattern == sequentialAccess ? MADV_SEQUENTIAL
+                                                     : (pattern == randomAccess  ? MADV_RANDOM : MADV_NORMAL));
+}
+
+static void adviseMemoryMappedRange (void* address, Range<int64> mappedRange, Range<int64> fileRange, int advice) noexcept
+{
+    fileRange = fileRange.getIntersectionWith (mappedRange);
+
+    if (address != nullptr && ! fileRange.isEmpty())
+    {
+        // madvise needs a page-aligned address, and the mapping itself always starts on a page
+        const int64 pageSize = (int64) sysconf (_SC_PAGE_SIZE);
+        const int64 start = fileRange.getStart() - mappedRange.getStart();
+        const int64 alignedStart = start - (start % pageSize);
+
+        madvise (addBytesToPointer (address, alignedStart),
+                 (size_t) (fileRange.getEnd() - mappedRange.getStart() - alignedStart), advice);
+    }
+}
+
+void MemoryMappedFile::prefetch (Range<int64> fileRange) const noexcept
+{
+    adviseMemoryMappedRange (address, range, fileRange, MADV_WILLNEED);
+}
+
+void MemoryMappedFile::evict (Range<int64> fileRange) const noexcept
+{
+    adviseMemoryMappedRange (address, range, fileRange, MADV_DONTNEED);
+}
+
 MemoryMappedFile::~MemoryMappedFile()
 {
     if (address != nullptr)
@@ -382,6 +382,42 @@ void MemoryMappedFile::openInternal (const File& file, AccessMode mode, bool exc
     }
 }
 
+void MemoryMappedFile::setAccessPattern (AccessPattern) noexcept
+{
+    // Windows only takes this hint when the file is opened
+}
+
+void MemoryMappedFile::prefetch (Range<int64> fileRange) const noexcept
+{
+    fileRange = fileRange.getIntersectionWith (range);
+
+    if (address == nullptr || fileRange.isEmpty())
+        return;
+
+    // PrefetchVirtualMemory only exists from Windows 8 onwards, so has to be looked up at runtime
+    struct MemoryRangeEntry { void* address; SIZE_T numBytes; };
+    typedef BOOL (WINAPI* PrefetchVirtualMemoryFn) (HANDLE, ULONG_PTR, MemoryRangeEntry*, ULONG);
+
+    static PrefetchVirtualMemoryFn prefetchVirtualMemory
+        = (PrefetchVirtualMemoryFn) GetProcAddress (GetModuleHandleA ("kernel32"), "PrefetchVirtualMemory");
+
+    if (prefetchVirtualMemory != nullptr)
+    {
+        MemoryRangeEntry entry = { addBytesToPointer (address, fileRange.getStart() - range.getStart()),
+                                   (SIZE_T) fileRange.getLength() };
+        prefetchVirtualMemory (GetCurrentProcess(), 1, &entry, 0);
+    }
+}
+
+void MemoryMappedFile::evict (Range<int64> fileRange) const noexcept
+{
+    fileRange = fileRange.getIntersectionWith (range);
+
+    // Unlocking pages that aren't locked fails, but removes them from the process's working set
+    if (address != nullptr && ! fileRange.isEmpty())
+        VirtualUnlock (addBytesToPointer (address, fileRange.getStart() - range.getStart()), (SIZE_T) fileRange.getLength());
+}
+
 MemoryMappedFile::~MemoryMappedFile()
 {
     if (address != nullptr)
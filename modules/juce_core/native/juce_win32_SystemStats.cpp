@@ -51,11 +51,23 @@ static void callCPUID (int result[4], uint32 type)
 
   result[0] = la; result[1] = lb; result[2] = lc; result[3] = ld;
 }
+
+static uint64 callXGETBV()
+{
+    uint32 lo = 0, hi = 0;
+    asm (".byte 0x0f, 0x01, 0xd0" : "=a" (lo), "=d" (hi) : "c" (0)); // (xgetbv)
+    return ((uint64) hi << 32) | lo;
+}
 #else
 static void callCPUID (int result[4], int infoType)
 {
     __cpuid (result, infoType);
 }
+
+static uint64 callXGETBV()
+{
+    return (uint64) _xgetbv (0);
+}
 #endif
 
 String SystemStats::getCpuVendor()
@@ -130,10 +142,17 @@ void CPUInformation::initialise() noexcept
     hasSSE41 = (info[2] & (1 << 19)) != 0;
     hasSSE42 = (info[2] & (1 << 20)) != 0;
     has3DNow = (info[1] & (1 << 31)) != 0;
+    hasFMA3  = (info[2] & (1 << 12)) != 0;
+
+    // The CPUID bits only say what the CPU can do: the OS also has to have enabled
+    // saving the AVX-512 registers (the opmask, and upper halves of the ZMM registers)
+    const bool osSavesAVX512State = (info[2] & (1 << 27)) != 0 // (OSXSAVE)
+                                     && (callXGETBV() & 0xe6) == 0xe6;
 
     callCPUID (info, 7);
 
-    hasAVX2 = (info[1] & (1 << 5)) != 0;
+    hasAVX2    = (info[1] & (1 <<  5)) != 0;
+    hasAVX512F = (info[1] & (1 << 16)) != 0 && osSavesAVX512State;
 
     SYSTEM_INFO systemInfo;
     GetNativeSystemInfo (&systemInfo);
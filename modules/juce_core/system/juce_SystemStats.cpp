@@ -91,7 +91,8 @@ struct CPUInformation
 
     bool hasMMX = false, hasSSE = false, hasSSE2 = false, hasSSE3 = false,
          has3DNow = false, hasSSSE3 = false, hasSSE41 = false,
-         hasSSE42 = false, hasAVX = false, hasAVX2 = false;
+         hasSSE42 = false, hasAVX = false, hasAVX2 = false,
+         hasFMA3 = false, hasAVX512F = false;
 };
 
 static const CPUInformation& getCPUInformation() noexcept
@@ -112,6 +113,8 @@ bool SystemStats::hasSSE41() noexcept           { return getCPUInformation().has
 bool SystemStats::hasSSE42() noexcept           { return getCPUInformation().hasSSE42; }
 bool SystemStats::hasAVX() noexcept             { return getCPUInformation().hasAVX; }
 bool SystemStats::hasAVX2() noexcept            { return getCPUInformation().hasAVX2; }
+bool SystemStats::hasFMA3() noexcept            { return getCPUInformation().hasFMA3; }
+bool SystemStats::hasAVX512F() noexcept         { return getCPUInformation().hasAVX512F; }
 
 
 //==============================================================================
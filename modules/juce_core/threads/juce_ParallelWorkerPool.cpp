@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace ParallelWorkerPoolHelpers
+{
+    enum
+    {
+        itemBits = 16,
+        itemMask = (1 << itemBits) - 1,
+        generationMask = (1 << (31 - itemBits)) - 1
+    };
+}
+
+struct ParallelWorkerPool::WorkerThread  : public Thread
+{
+    WorkerThread (ParallelWorkerPool& o, const String& name, int index)
+        : Thread (name + " " + String (index)), owner (o), workerIndex (index)
+    {
+    }
+
+    void run() override
+    {
+        for (;;)
+        {
+            wakeUp.wait();
+
+            if (threadShouldExit())
+                return;
+
+            owner.doWork (workerIndex);
+        }
+    }
+
+    ParallelWorkerPool& owner;
+    const int workerIndex;
+    WaitableEvent wakeUp;
+
+    JUCE_DECLARE_NON_COPYABLE (WorkerThread)
+};
+
+//==============================================================================
+ParallelWorkerPool::ParallelWorkerPool (const String& threadName, int numWorkerThreads)
+{
+    nextItem.set (ParallelWorkerPoolHelpers::itemMask);
+
+    for (int i = 0; i < numWorkerThreads; ++i)
+    {
+        WorkerThread* const t = threads.add (new WorkerThread (*this, threadName, i + 1));
+        t->startThread (10);
+    }
+}
+
+ParallelWorkerPool::~ParallelWorkerPool()
+{
+    for (int i = 0; i < threads.size(); ++i)
+    {
+        threads.getUnchecked (i)->signalThreadShouldExit();
+        threads.getUnchecked (i)->wakeUp.signal();
+    }
+
+    for (int i = 0; i < threads.size(); ++i)
+        threads.getUnchecked (i)->stopThread (4000);
+}
+
+//==============================================================================
+void ParallelWorkerPool::run (Job& job, int numItems)
+{
+    using namespace ParallelWorkerPoolHelpers;
+
+    jassert (numItems < itemMask);
+    numItems = jmin (numItems, (int) itemMask - 1);
+
+    if (numItems <= 0)
+        return;
+
+    currentJob = &job;
+    numItemsInJob = numItems;
+    numItemsFinished.set (0);
+
+    generation = (generation + 1) & generationMask;
+    nextItem.set (generation << itemBits);
+
+    // the calling thread takes a share, so there's no point waking more workers than that leaves items for
+    for (int i = jmin (threads.size(), numItems - 1); --i >= 0;)
+        threads.getUnchecked (i)->wakeUp.signal();
+
+    doWork (0);
+
+    while (numItemsFinished.get() < numItems)
+        jobFinished.wait (1);
+
+    // close the job, so that a worker that's only just woken up won't touch it
+    nextItem.set ((generation << itemBits) | itemMask);
+    currentJob = nullptr;
+}
+
+void ParallelWorkerPool::doWork (int worker)
+{
+    using namespace ParallelWorkerPoolHelpers;
+
+    bool hasStarted = false;
+
+    for (;;)
+    {
+        const int value = nextItem.get();
+        const int item = value & itemMask;
+        Job* const job = currentJob;
+        const int numItems = numItemsInJob;
+
+        if (job == nullptr || item >= numItems)
+            return;
+
+        // if this fails, another thread got the item first, or the job has changed
+        if (! nextItem.compareAndSetBool (value + 1, value))
+            continue;
+
+        if (! hasStarted)
+        {
+            hasStarted = true;
+            job->startWorker (worker);
+        }
+
+        job->doItem (item, worker);
+
+        if (++numItemsFinished == numItems)
+            jobFinished.signal();
+    }
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ParallelWorkerPoolTests  : public UnitTest
+{
+public:
+    ParallelWorkerPoolTests() : UnitTest ("ParallelWorkerPool") {}
+
+    struct CountingJob  : public ParallelWorkerPool::Job
+    {
+        CountingJob (int numItems, int numWorkers)
+        {
+            timesDone.calloc ((size_t) numItems);
+            timesStarted.calloc ((size_t) numWorkers);
+        }
+
+        void startWorker (int worker) override          { ++timesStarted[worker]; }
+        void doItem (int item, int) override            { ++timesDone[item]; }
+
+        HeapBlock<Atomic<int> > timesDone, timesStarted;
+    };
+
+    void runTest() override
+    {
+        beginTest ("Each item is done once");
+
+        for (int numThreads = 0; numThreads <= 3; ++numThreads)
+        {
+            ParallelWorkerPool pool ("Pool test", numThreads);
+            expectEquals (pool.getNumWorkerThreads(), numThreads);
+
+            for (int numItems = 1; numItems < 300; numItems += 37)
+            {
+                CountingJob job (numItems, numThreads + 1);
+                pool.run (job, numItems);
+
+                for (int i = 0; i < numItems; ++i)
+                    expectEquals (job.timesDone[i].get(), 1);
+
+                for (int i = 0; i <= numThreads; ++i)
+                    expect (job.timesStarted[i].get() <= 1);
+            }
+        }
+    }
+};
+
+static ParallelWorkerPoolTests parallelWorkerPoolTests;
+
+#endif
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+
+//==============================================================================
+/**
+    A pool of worker threads that join in with the calling thread to get through a
+    set of independent items of work as quickly as possible.
+
+    Unlike ThreadPool, this is designed to be used from a time-critical thread such as
+    the audio thread: run() doesn't allocate or take any locks, and it returns as soon
+    as all the items have been done. Only one job can be run at a time.
+
+    The Synthesiser uses this to render its voices in parallel, and
+    ParallelMixerAudioSource uses it to pull its inputs.
+
+    @see ThreadPool
+*/
+class JUCE_API  ParallelWorkerPool
+{
+public:
+    //==============================================================================
+    /** Starts the given number of worker threads.
+
+        The thread that calls run() joins in with the workers, so the number of worker
+        threads should usually be one less than the number of cores you want to use.
+    */
+    ParallelWorkerPool (const String& threadName, int numWorkerThreads);
+
+    /** Destructor. This stops the worker threads. */
+    ~ParallelWorkerPool();
+
+    /** Returns the number of worker threads, not including the calling thread. */
+    int getNumWorkerThreads() const noexcept                { return threads.size(); }
+
+    //==============================================================================
+    /** A set of independent items of work, which run() shares out between the threads.
+
+        Each thread is identified by a worker index, which is 0 for the thread that calls
+        run(), and goes up to getNumWorkerThreads() for the others.
+    */
+    struct Job
+    {
+        virtual ~Job() {}
+
+        /** Called on a thread before it does its first item of the job.
+            Threads that don't end up doing any of the items won't have this called.
+        */
+        virtual void startWorker (int workerIndex) = 0;
+
+        /** Called to do one of the items. */
+        virtual void doItem (int itemIndex, int workerIndex) = 0;
+    };
+
+    /** Shares out the items of a job between the calling thread and the worker threads,
+        and returns when they've all been done.
+    */
+    void run (Job& job, int numItems);
+
+private:
+    //==============================================================================
+    struct WorkerThread;
+    friend struct WorkerThread;
+
+    OwnedArray<WorkerThread> threads;
+
+    // The item counter holds a generation number in its top bits, so that a worker that wakes
+    // up late can't claim an item from a job that has already finished.
+    Atomic<int> nextItem, numItemsFinished;
+    Job* volatile currentJob = nullptr;
+    volatile int numItemsInJob = 0;
+    int generation = 0;
+    WaitableEvent jobFinished;
+
+    void doWork (int worker);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelWorkerPool)
+};